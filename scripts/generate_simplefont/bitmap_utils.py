@@ -36,3 +36,73 @@ def format_c_code_list(code_list: List[int]) -> str:
         for i in range(0, len(parts), per_line)
     ]
     return ",\n".join(lines)
+
+
+def glyph_bytes(width: int, height: int, column_major: bool = False) -> int:
+    """Size of one glyph bitmap in either packing."""
+    if column_major:
+        return width * bytes_per_row(height)
+    return bytes_per_row(width) * height
+
+
+def to_column_major(chunk: List[int], width: int, height: int) -> List[int]:
+    """Repack a row-major glyph bitmap (rows of MSB-first bytes) column by column.
+
+    Each column becomes bytes_per_row(height) bytes holding its pixels top to
+    bottom, MSB first, so one byte covers the 8 rows a byte of the landscape
+    framebuffer holds. Bit values are kept as they are; padding bits are 0.
+    """
+    stride = bytes_per_row(width)
+    out = []
+    for x in range(width):
+        for y0 in range(0, height, 8):
+            byte_val = 0
+            for i in range(8):
+                y = y0 + i
+                if y < height:
+                    bit = (chunk[y * stride + x // 8] >> (7 - x % 8)) & 1
+                    byte_val |= bit << (7 - i)
+            out.append(byte_val)
+    return out
+
+
+# Pixel levels of compressed glyphs, keyed by (BW, gray LSB, gray MSB) bits
+# (see GlyphDecoder in src/rendering/SimpleFont.h)
+LEVELS = {(1, 0, 0): 0, (1, 1, 0): 1, (0, 0, 1): 2, (0, 1, 1): 3, (0, 0, 0): 4}
+
+
+def compress_glyph(bw: List[int], lsb: List[int], msb: List[int], width: int, height: int) -> List[int]:
+    """Run-length code a row-major glyph (one list of plane bytes each; empty
+    gray planes for BW-only fonts) into a GlyphDecoder stream."""
+    stride = bytes_per_row(width)
+    levels = []
+    for y in range(height):
+        for x in range(width):
+            index = y * stride + x // 8
+            shift = 7 - x % 8
+            bits = tuple(
+                (plane[index] >> shift) & 1 if plane else 0 for plane in (bw, lsb, msb)
+            )
+            if bits not in LEVELS:
+                raise ValueError(f"pixel ({x}, {y}) has no compressed level: planes {bits}")
+            levels.append(LEVELS[bits])
+
+    nibbles = []
+    i = 0
+    while i < len(levels):
+        level = levels[i]
+        run = 1
+        limit = 134 if level in (0, 4) else 1
+        while i + run < len(levels) and levels[i + run] == level and run < limit:
+            run += 1
+        if level in (1, 2, 3):
+            nibbles.append(11 + level)
+        elif run <= 6:
+            nibbles.append(run - 1 if level == 0 else run + 5)
+        else:
+            value = (0x80 if level == 4 else 0) | (run - 7)
+            nibbles.extend([15, value >> 4, value & 0x0F])
+        i += run
+    if len(nibbles) % 2:
+        nibbles.append(0)
+    return [(nibbles[k] << 4) | nibbles[k + 1] for k in range(0, len(nibbles), 2)]
@@ -36,7 +36,12 @@ from scripts.generate_simplefont.render import (
     render_preview_from_grayscale,
     render_combined_preview,
 )
-from scripts.generate_simplefont.writer import generate_header, write_header_from_data
+from scripts.generate_simplefont.writer import (
+    PACK_STYLES,
+    generate_header,
+    write_font_pack,
+    write_header_from_data,
+)
 from scripts.generate_simplefont.bitmap_utils import (
     bytes_per_row,
     gen_bitmap_bytes,
@@ -45,6 +50,40 @@ from scripts.generate_simplefont.bitmap_utils import (
 )
 
 
+def write_output(args, codes, glyphs, bitmap_all, bitmap_lsb_all, bitmap_msb_all, yadvance):
+    """Write the rendered glyphs as a font pack (--pack) or a C header."""
+    if args.pack:
+        write_font_pack(
+            args.name,
+            args.pack,
+            codes,
+            glyphs,
+            bitmap_all,
+            bitmap_lsb_all,
+            bitmap_msb_all,
+            yadvance,
+            args.size,
+            style=args.style,
+            grayscale=args.grayscale,
+            column_major=args.column_major,
+            compress=args.compress,
+        )
+        return
+    write_header_from_data(
+        args.name,
+        args.out,
+        codes,
+        glyphs,
+        bitmap_all,
+        bitmap_lsb_all,
+        bitmap_msb_all,
+        yadvance,
+        grayscale=args.grayscale,
+        column_major=args.column_major,
+        compress=args.compress,
+    )
+
+
 def main(argv=None):
     p = argparse.ArgumentParser(description="Generate SimpleGFXfont C header files")
     # Allow shorthand positional invocation: name size ttf
@@ -109,6 +148,37 @@ def main(argv=None):
         default=True,
         help="Disable grayscale output: do not generate the Bitmaps_lsb/Bitmaps_msb arrays (default: enabled)",
     )
+    p.add_argument(
+        "--column-major",
+        action="store_true",
+        default=False,
+        help=(
+            "Store glyph bitmaps column by column (pre-rotated for the landscape panel) "
+            "and set FONT_FLAG_COLUMN_MAJOR on the font; applies to all bitmap planes"
+        ),
+    )
+    p.add_argument(
+        "--compress",
+        action="store_true",
+        default=False,
+        help=(
+            "Run-length code each glyph's pixels into one stream instead of separate "
+            "BW/LSB/MSB planes and set FONT_FLAG_COMPRESSED (row-major only)"
+        ),
+    )
+    p.add_argument(
+        "--pack",
+        help=(
+            "Write a binary font pack (.mfp) to this path instead of a C header; "
+            "copy it to the SD card for FontPack to load glyphs on demand"
+        ),
+    )
+    p.add_argument(
+        "--style",
+        choices=sorted(PACK_STYLES),
+        default="regular",
+        help="Style recorded in the font pack (default: regular)",
+    )
 
     args = p.parse_args(argv)
 
@@ -311,17 +381,7 @@ def main(argv=None):
                         )
 
         yadvance = args.size + 2
-        write_header_from_data(
-            args.name,
-            args.out,
-            codes,
-            glyphs,
-            bitmap_all,
-            bitmap_lsb_all,
-            bitmap_msb_all,
-            yadvance,
-            grayscale=args.grayscale,
-        )
+        write_output(args, codes, glyphs, bitmap_all, bitmap_lsb_all, bitmap_msb_all, yadvance)
         # optional preview: render a combined image showing BW and grayscale side-by-side
         if args.preview_output:
             if args.grayscale:
@@ -429,17 +489,7 @@ def main(argv=None):
             offset += len(bm)
 
         yadvance = args.size + 2
-        write_header_from_data(
-            args.name,
-            args.out,
-            codes,
-            glyphs,
-            bitmap_all,
-            bitmap_lsb_all,
-            bitmap_msb_all,
-            yadvance,
-            grayscale=args.grayscale,
-        )
+        write_output(args, codes, glyphs, bitmap_all, bitmap_lsb_all, bitmap_msb_all, yadvance)
 
         if args.preview_output:
             if args.grayscale:
@@ -470,7 +520,25 @@ def main(argv=None):
         args.yoffset,
         args.fill,
         grayscale=args.grayscale,
+        column_major=args.column_major,
+        compress=args.compress,
     )
+    if args.pack:
+        write_font_pack(
+            args.name,
+            args.pack,
+            codes,
+            glyphs,
+            bitmap_all,
+            bitmap_lsb_all,
+            bitmap_msb_all,
+            yadvance,
+            args.size,
+            style=args.style,
+            grayscale=args.grayscale,
+            column_major=args.column_major,
+            compress=args.compress,
+        )
 
     # optional preview image showing the same characters (use generated bytes)
     # Preview functions not implemented
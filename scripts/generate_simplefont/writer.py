@@ -1,15 +1,132 @@
 """Header generation for SimpleGFXfont from glyph and bitmap data."""
 
 import os
+import struct
 from typing import List, Tuple
 from .bitmap_utils import (
     bytes_per_row,
+    compress_glyph,
     format_c_byte_list,
     format_c_code_list,
     gen_bitmap_bytes,
+    glyph_bytes,
+    to_column_major,
 )
 
 
+def repack_column_major(
+    glyphs: List[dict],
+    bitmap_all: List[int],
+    bitmap_lsb_all: List[int],
+    bitmap_msb_all: List[int],
+    grayscale: bool = True,
+) -> Tuple[List[dict], List[int], List[int], List[int]]:
+    """Return copies of the glyphs and planes in column-major (pre-rotated) order.
+
+    The inputs stay row-major so previews can keep using them; the copies get
+    new bitmap offsets because a column-major glyph has a different size.
+    """
+    out_glyphs = []
+    out_bitmap = []
+    out_lsb = []
+    out_msb = []
+    for g in glyphs:
+        w, h = g["width"], g["height"]
+        start = g["bitmapOffset"]
+        end = start + bytes_per_row(w) * h
+        ng = dict(g)
+        ng["bitmapOffset"] = len(out_bitmap)
+        out_glyphs.append(ng)
+        out_bitmap.extend(to_column_major(bitmap_all[start:end], w, h))
+        if grayscale:
+            out_lsb.extend(to_column_major(bitmap_lsb_all[start:end], w, h))
+            out_msb.extend(to_column_major(bitmap_msb_all[start:end], w, h))
+    return out_glyphs, out_bitmap, out_lsb, out_msb
+
+
+def compress_glyphs(
+    glyphs: List[dict],
+    bitmap_all: List[int],
+    bitmap_lsb_all: List[int],
+    bitmap_msb_all: List[int],
+    grayscale: bool = True,
+) -> Tuple[List[dict], List[int]]:
+    """Return copies of the glyphs and one buffer of their compressed streams.
+
+    Each copy's bitmapOffset points at its stream and bitmapBytes is the
+    stream length.
+    """
+    out_glyphs = []
+    out_stream = []
+    for g in glyphs:
+        w, h = g["width"], g["height"]
+        start = g["bitmapOffset"]
+        end = start + bytes_per_row(w) * h
+        lsb = bitmap_lsb_all[start:end] if grayscale else []
+        msb = bitmap_msb_all[start:end] if grayscale else []
+        stream = compress_glyph(bitmap_all[start:end], lsb, msb, w, h)
+        ng = dict(g)
+        ng["bitmapOffset"] = len(out_stream)
+        ng["bitmapBytes"] = len(stream)
+        out_glyphs.append(ng)
+        out_stream.extend(stream)
+    return out_glyphs, out_stream
+
+
+def emitted_planes(
+    glyphs: List[dict],
+    bitmap_all: List[int],
+    bitmap_lsb_all: List[int],
+    bitmap_msb_all: List[int],
+    grayscale: bool,
+    column_major: bool,
+    compress: bool,
+) -> Tuple[List[dict], List[int], List[int], List[int]]:
+    """Glyphs and planes as written: as built (row-major), repacked column by
+    column, or compressed into one stream buffer (returned as the BW plane,
+    with empty gray planes). Every glyph copy gets its bitmapBytes."""
+    if compress:
+        if column_major:
+            raise ValueError("compressed glyphs are row-major; drop --column-major")
+        out_glyphs, out_stream = compress_glyphs(glyphs, bitmap_all, bitmap_lsb_all, bitmap_msb_all, grayscale)
+        return out_glyphs, out_stream, [], []
+    out_glyphs, out_bitmap, out_lsb, out_msb = glyphs, bitmap_all, bitmap_lsb_all, bitmap_msb_all
+    if column_major:
+        out_glyphs, out_bitmap, out_lsb, out_msb = repack_column_major(
+            glyphs, bitmap_all, bitmap_lsb_all, bitmap_msb_all, grayscale
+        )
+    out_glyphs = [dict(g, bitmapBytes=glyph_bytes(g["width"], g["height"], column_major)) for g in out_glyphs]
+    return out_glyphs, out_bitmap, out_lsb, out_msb
+
+
+def font_initializer(
+    font_name: str,
+    count: int,
+    yadvance: int,
+    grayscale: bool,
+    column_major: bool,
+    compress: bool = False,
+) -> str:
+    """SimpleGFXfont definition with every field written out (the struct must
+    stay an aggregate, so it has no defaults). Compressed fonts point every
+    plane at the one stream array."""
+    if compress:
+        gray = f"{font_name}Bitmaps" if grayscale else "nullptr"
+        planes = f"{font_name}Bitmaps, {gray}, {gray}"
+    elif grayscale:
+        planes = f"{font_name}Bitmaps, {font_name}Bitmaps_lsb, {font_name}Bitmaps_msb"
+    else:
+        planes = f"{font_name}Bitmaps, nullptr, nullptr"
+    if column_major:
+        flags = "FONT_FLAG_COLUMN_MAJOR"
+    elif compress:
+        flags = "FONT_FLAG_COMPRESSED"
+    else:
+        flags = "0"
+    tail = f"{count}, {yadvance}, nullptr, 0, FontStyle::REGULAR, {flags}, nullptr, nullptr"
+    return f"\nconst SimpleGFXfont {font_name} PROGMEM = {{{planes}, {font_name}Glyphs,\n    {tail}}};\n"
+
+
 def generate_header(
     font_name: str,
     out_path: str,
@@ -22,6 +139,8 @@ def generate_header(
     yoffset: int,
     fill: int,
     grayscale: bool = True,
+    column_major: bool = False,
+    compress: bool = False,
 ):
     bitmap_all = []
     bitmap_lsb_all = []
@@ -72,17 +191,20 @@ def generate_header(
         glyphs.append(glyph)
         offset += len(bm)
 
+    out_glyphs, out_bitmap, out_lsb, out_msb = emitted_planes(
+        glyphs, bitmap_all, bitmap_lsb_all, bitmap_msb_all, grayscale, column_major, compress
+    )
     bmp_lines = []
     bmp_lsb_lines = []
     bmp_msb_lines = []
     for idx, ch in enumerate(chars):
-        g = glyphs[idx]
-        per_glyph_bytes = bytes_per_row(g["width"]) * g["height"]
+        g = out_glyphs[idx]
+        per_glyph_bytes = g["bitmapBytes"]
         start = g["bitmapOffset"]
         end = start + per_glyph_bytes
-        chunk = bitmap_all[start:end]
-        chunk_lsb = bitmap_lsb_all[start:end]
-        chunk_msb = bitmap_msb_all[start:end]
+        chunk = out_bitmap[start:end]
+        chunk_lsb = out_lsb[start:end]
+        chunk_msb = out_msb[start:end]
         display = chr(ch)
         comment = f"// 0x{ch:X} '{display}'"
         chunk_c = format_c_byte_list(chunk)
@@ -95,7 +217,7 @@ def generate_header(
     bmp_lsb_c = ",\n".join(bmp_lsb_lines)
     bmp_msb_c = ",\n".join(bmp_msb_lines)
     glyph_lines = []
-    for idx, g in enumerate(glyphs):
+    for idx, g in enumerate(out_glyphs):
         ch = chars[idx]
         glyph_lines.append(
             f"    {{{g['bitmapOffset']}, 0x{ch:X}, {g['width']}, {g['height']}, {g['xAdvance']}, {g['xOffset']}, {g['yOffset']}}}"
@@ -119,7 +241,7 @@ const uint8_t {font_name}Bitmaps[] PROGMEM = {{
 }};
 
 """
-    if grayscale:
+    if grayscale and not compress:
         header += f"\nconst uint8_t {font_name}Bitmaps_lsb[] PROGMEM = {{\n{bmp_lsb_c}\n}};\n\n"
         header += f"\nconst uint8_t {font_name}Bitmaps_msb[] PROGMEM = {{\n{bmp_msb_c}\n}};\n\n"
 
@@ -129,13 +251,7 @@ const uint8_t {font_name}Bitmaps[] PROGMEM = {{
     )
 
     # Final font struct initializer: pick pointers or nullptr based on grayscale
-    if grayscale:
-        header += f"\nconst SimpleGFXfont {font_name} PROGMEM = {{{font_name}Bitmaps, {font_name}Bitmaps_lsb, {font_name}Bitmaps_msb, {font_name}Glyphs,\n    {count}, {yadvance}}};\n"
-    else:
-        header += (
-            f"\nconst SimpleGFXfont {font_name} PROGMEM = {{{font_name}Bitmaps, nullptr, nullptr, {font_name}Glyphs,\n"
-            f"    {count}, {yadvance}}};\n"
-        )
+    header += font_initializer(font_name, count, yadvance, grayscale, column_major, compress)
     os.makedirs(os.path.dirname(out_path), exist_ok=True)
     with open(out_path, "w", encoding="utf-8", newline="\n") as f:
         f.write(header)
@@ -153,18 +269,23 @@ def write_header_from_data(
     bitmap_msb_all: List[int],
     yadvance: int,
     grayscale: bool = True,
+    column_major: bool = False,
+    compress: bool = False,
 ):
+    out_glyphs, out_bitmap, out_lsb, out_msb = emitted_planes(
+        glyphs, bitmap_all, bitmap_lsb_all, bitmap_msb_all, grayscale, column_major, compress
+    )
     bmp_lines = []
     bmp_lsb_lines = []
     bmp_msb_lines = []
     for idx, ch in enumerate(chars):
-        g = glyphs[idx]
-        per_glyph_bytes = bytes_per_row(g["width"]) * g["height"]
+        g = out_glyphs[idx]
+        per_glyph_bytes = g["bitmapBytes"]
         start = g["bitmapOffset"]
         end = start + per_glyph_bytes
-        chunk = bitmap_all[start:end]
-        chunk_lsb = bitmap_lsb_all[start:end]
-        chunk_msb = bitmap_msb_all[start:end]
+        chunk = out_bitmap[start:end]
+        chunk_lsb = out_lsb[start:end]
+        chunk_msb = out_msb[start:end]
         display = chr(ch)
         comment = f"// 0x{ch:X} '{display}'"
         chunk_c = format_c_byte_list(chunk)
@@ -178,7 +299,7 @@ def write_header_from_data(
     bmp_msb_c = ",\n".join(bmp_msb_lines)
 
     glyph_lines = []
-    for idx, g in enumerate(glyphs):
+    for idx, g in enumerate(out_glyphs):
         ch = chars[idx]
         glyph_lines.append(
             f"    {{{g['bitmapOffset']}, 0x{ch:X}, {g['width']}, {g['height']}, {g['xAdvance']}, {g['xOffset']}, {g['yOffset']}}}"
@@ -199,7 +320,7 @@ const uint8_t {font_name}Bitmaps[] PROGMEM = {{
 }};
 
 """
-    if grayscale:
+    if grayscale and not compress:
         header += f"\nconst uint8_t {font_name}Bitmaps_lsb[] PROGMEM = {{\n{bmp_lsb_c}\n}};\n\n"
         header += f"\nconst uint8_t {font_name}Bitmaps_msb[] PROGMEM = {{\n{bmp_msb_c}\n}};\n\n"
 
@@ -208,15 +329,104 @@ const uint8_t {font_name}Bitmaps[] PROGMEM = {{
         f"\nconst SimpleGFXglyph {font_name}Glyphs[] PROGMEM = {{\n{glyphs_c}\n}};\n\n"
     )
 
-    if grayscale:
-        header += f"\nconst SimpleGFXfont {font_name} PROGMEM = {{{font_name}Bitmaps, {font_name}Bitmaps_lsb, {font_name}Bitmaps_msb, {font_name}Glyphs,\n    {count}, {yadvance}}};\n"
-    else:
-        header += (
-            f"\nconst SimpleGFXfont {font_name} PROGMEM = {{{font_name}Bitmaps, nullptr, nullptr, {font_name}Glyphs,\n"
-            f"    {count}, {yadvance}}};\n"
-        )
+    header += font_initializer(font_name, count, yadvance, grayscale, column_major, compress)
 
     os.makedirs(os.path.dirname(out_path), exist_ok=True)
     with open(out_path, "w", encoding="utf-8", newline="\n") as f:
         f.write(header)
     print(f"Wrote {out_path}")
+
+
+PACK_MAGIC = b"MRFP"
+PACK_VERSION = 1
+PACK_FLAG_COLUMN_MAJOR = 0x01
+PACK_FLAG_COMPRESSED = 0x02
+PACK_FLAG_GRAYSCALE = 0x80
+PACK_BLOCK_SHIFT = 7
+PACK_NAME_SIZE = 16
+PACK_STYLES = {"regular": 0, "bold": 1, "italic": 2, "bold-italic": 3}
+
+
+def write_font_pack(
+    font_name: str,
+    out_path: str,
+    chars: List[int],
+    glyphs: List[dict],
+    bitmap_all: List[int],
+    bitmap_lsb_all: List[int],
+    bitmap_msb_all: List[int],
+    yadvance: int,
+    size: int,
+    style: str = "regular",
+    grayscale: bool = True,
+    column_major: bool = False,
+    compress: bool = False,
+):
+    """Write a binary font pack (.mfp) for FontPack (src/rendering/FontPack.h).
+
+    Glyphs are grouped into blocks of 128 codepoints; each block stores its
+    glyph bitmaps as one plane per bitmap type (or one plane of compressed
+    streams) so the reader can load the planes a page needs on demand. All
+    integers are little endian.
+    """
+    out_glyphs, out_bitmap, out_lsb, out_msb = emitted_planes(
+        glyphs, bitmap_all, bitmap_lsb_all, bitmap_msb_all, grayscale, column_major, compress
+    )
+    # Compressed streams hold all planes
+    planes = [out_bitmap, out_lsb, out_msb] if grayscale and not compress else [out_bitmap]
+    order = sorted(range(len(chars)), key=lambda i: chars[i])
+
+    # Group glyphs by block and rebase their bitmaps onto the block's planes
+    blocks = []  # [number, first glyph, glyph count, plane byte lists]
+    glyph_records = []
+    for i in order:
+        ch = chars[i]
+        g = out_glyphs[i]
+        number = ch >> PACK_BLOCK_SHIFT
+        if not blocks or blocks[-1][0] != number:
+            blocks.append([number, len(glyph_records), 0, [[] for _ in planes]])
+        block = blocks[-1]
+        start = g["bitmapOffset"]
+        end = start + g["bitmapBytes"]
+        offset = len(block[3][0])
+        for plane, data in zip(block[3], planes):
+            plane.extend(data[start:end])
+        block[2] += 1
+        glyph_records.append(
+            struct.pack(
+                "<IHBBBbb", ch, offset, g["width"], g["height"], g["xAdvance"], g["xOffset"], g["yOffset"]
+            )
+        )
+
+    for number, _, _, block_planes in blocks:
+        if len(block_planes[0]) > 0xFFFF:
+            raise ValueError(f"block U+{number << PACK_BLOCK_SHIFT:04X} needs more than 64 KB per plane")
+
+    flags = (
+        (PACK_FLAG_COLUMN_MAJOR if column_major else 0)
+        | (PACK_FLAG_COMPRESSED if compress else 0)
+        | (PACK_FLAG_GRAYSCALE if grayscale else 0)
+    )
+    name = font_name.encode("utf-8")[:PACK_NAME_SIZE].ljust(PACK_NAME_SIZE, b"\0")
+    header = PACK_MAGIC + struct.pack(
+        "<BBBBBBHHH", PACK_VERSION, flags, yadvance, size, PACK_STYLES[style], 0, len(glyph_records), len(blocks), 0
+    ) + name
+
+    data_offset = len(header) + 12 * len(blocks) + 11 * len(glyph_records)
+    block_records = []
+    data = bytearray()
+    for number, first, count, block_planes in blocks:
+        plane_bytes = len(block_planes[0])
+        block_records.append(struct.pack("<HHHHI", number, first, count, plane_bytes, data_offset + len(data)))
+        for plane in block_planes:
+            data.extend(plane)
+
+    dirname = os.path.dirname(out_path)
+    if dirname:
+        os.makedirs(dirname, exist_ok=True)
+    with open(out_path, "wb") as f:
+        f.write(header)
+        f.write(b"".join(block_records))
+        f.write(b"".join(glyph_records))
+        f.write(data)
+    print(f"Wrote {out_path} ({len(glyph_records)} glyphs in {len(blocks)} blocks)")
@@ -8,8 +8,8 @@
 
 // #define EPUB_DEBUG_CLEAN_CACHE
 
-EpubWordProvider::EpubWordProvider(const char* path, size_t bufSize)
-    : bufSize_(bufSize), fileSize_(0), currentChapter_(0) {
+EpubWordProvider::EpubWordProvider(const char* path, size_t bufSize, uint8_t* cacheBuffer)
+    : bufSize_(bufSize), cacheBuffer_(cacheBuffer), fileSize_(0), currentChapter_(0) {
   epubPath_ = String(path);
   valid_ = false;
   isEpub_ = false;
@@ -33,7 +33,7 @@ EpubWordProvider::EpubWordProvider(const char* path, size_t bufSize)
     }
 
     // Create the underlying FileWordProvider and validate it
-    fileProvider_ = new FileWordProvider(txtPath.c_str(), bufSize_);
+    fileProvider_ = new FileWordProvider(txtPath.c_str(), bufSize_, cacheBuffer_);
     if (!fileProvider_ || !fileProvider_->isValid()) {
       if (fileProvider_) {
         delete fileProvider_;
@@ -41,6 +41,8 @@ EpubWordProvider::EpubWordProvider(const char* path, size_t bufSize)
       }
       return;
     }
+    // Paragraph/style index makes backward navigation and seeks cheap
+    fileProvider_->loadOrBuildIndex();
 
     // Cache sizes and initialize position
     File f = SD.open(txtPath.c_str());
@@ -184,6 +186,7 @@ bool EpubWordProvider::convertXhtmlToTxt(const String& srcPath, String& outTxtPa
     timings->parserOpen = parserOpenMs;
 
   t0 = millis();
+  FileWordProvider::removeIndex(dest.c_str());
   File out = SD.open(dest.c_str(), FILE_WRITE);
   unsigned long outOpenMs = millis() - t0;
   if (!out) {
@@ -862,6 +865,7 @@ bool EpubWordProvider::convertXhtmlStreamToTxt(const char* epubFilename, String&
   if (SD.exists(dest.c_str())) {
     SD.remove(dest.c_str());
   }
+  FileWordProvider::removeIndex(dest.c_str());
   File out = SD.open(dest.c_str(), FILE_WRITE);
   unsigned long outOpenMs = millis() - t0;
   if (!out) {
@@ -1003,7 +1007,7 @@ bool EpubWordProvider::openChapter(int chapterIndex) {
     fileProvider_ = nullptr;
   }
   unsigned long fileProvStart = millis();
-  fileProvider_ = new FileWordProvider(txtPath.c_str(), bufSize_);
+  fileProvider_ = new FileWordProvider(txtPath.c_str(), bufSize_, cacheBuffer_);
   unsigned long fileProvMs = millis() - fileProvStart;
   Serial.printf("    FileWordProvider init took  %lu ms\n", fileProvMs);
   if (!fileProvider_ || !fileProvider_->isValid()) {
@@ -1013,6 +1017,7 @@ bool EpubWordProvider::openChapter(int chapterIndex) {
     }
     return false;
   }
+  fileProvider_->loadOrBuildIndex();
 
   xhtmlPath_ = newXhtmlPath;
   currentChapter_ = chapterIndex;
@@ -1084,6 +1089,22 @@ StyledWord EpubWordProvider::getPrevWord() {
   return fileProvider_->getPrevWord();
 }
 
+void EpubWordProvider::getNextToken(WordToken& out) {
+  if (!fileProvider_) {
+    out = WordToken();
+    return;
+  }
+  fileProvider_->getNextToken(out);
+}
+
+void EpubWordProvider::getPrevToken(WordToken& out) {
+  if (!fileProvider_) {
+    out = WordToken();
+    return;
+  }
+  fileProvider_->getPrevToken(out);
+}
+
 float EpubWordProvider::getPercentage() {
   if (!fileProvider_)
     return 1.0f;
@@ -16,7 +16,9 @@ class EpubWordProvider : public WordProvider {
  public:
   // path: SD path to epub file or direct xhtml file
   // bufSize: decompressed text buffer size (default 4096)
-  EpubWordProvider(const char* path, size_t bufSize = 4096);
+  // cacheBuffer: memory for the chapter read cache (bufSize bytes, must
+  //          outlive the provider); see FileWordProvider
+  EpubWordProvider(const char* path, size_t bufSize = 4096, uint8_t* cacheBuffer = nullptr);
   ~EpubWordProvider() override;
   bool isValid() const {
     return valid_;
@@ -26,6 +28,8 @@ class EpubWordProvider : public WordProvider {
   bool hasPrevWord() override;
   StyledWord getNextWord() override;
   StyledWord getPrevWord() override;
+  void getNextToken(WordToken& out) override;
+  void getPrevToken(WordToken& out) override;
 
   float getPercentage() override;
   float getPercentage(int index) override;
@@ -166,6 +170,7 @@ class EpubWordProvider : public WordProvider {
   bool isEpub_ = false;                 // True if source is EPUB, false if direct XHTML
   bool useStreamingConversion_ = true;  // True = stream from EPUB to memory, false = extract XHTML file first
   size_t bufSize_ = 0;
+  uint8_t* cacheBuffer_ = nullptr;
 
   String epubPath_;
   String xhtmlPath_;                  // Path to current extracted XHTML file
@@ -0,0 +1,211 @@
+#include "FileWordIndex.h"
+
+#include <Arduino.h>
+
+#include <cstring>
+
+namespace {
+
+const char INDEX_MAGIC[4] = {'M', 'R', 'W', 'I'};
+const uint16_t INDEX_VERSION = 3;
+const size_t HEADER_SIZE = 22;
+const size_t ENTRY_SIZE = 5;
+
+const uint8_t STATE_STYLE_MASK = 0x03;
+const uint8_t STATE_ALIGN_SHIFT = 2;
+const uint8_t STATE_ALIGN_MASK = 0x07;
+const uint8_t STATE_PARAGRAPH_START = 0x80;
+
+uint32_t readU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void writeU32(uint8_t* p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  p[2] = static_cast<uint8_t>(v >> 16);
+  p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+}  // namespace
+
+FileWordIndex::FileWordIndex() {}
+
+void FileWordIndex::clear(size_t fileSize, uint32_t modified, uint32_t fingerprint) {
+  offsets_.clear();
+  states_.clear();
+  fileSize_ = fileSize;
+  modified_ = modified;
+  fingerprint_ = fingerprint;
+}
+
+uint32_t FileWordIndex::fingerprint(File& file, size_t fileSize) {
+  // The head, and the tail unless it overlaps the head
+  const size_t head = fileSize < FINGERPRINT_BYTES ? fileSize : FINGERPRINT_BYTES;
+  const size_t tailStart = fileSize - head > head ? fileSize - head : head;
+  uint32_t hash = 2166136261u;
+  uint8_t chunk[64];
+  const size_t ranges[2][2] = {{0, head}, {tailStart, fileSize}};
+  for (const auto& range : ranges) {
+    if (range[0] >= range[1])
+      continue;
+    if (!file.seek(range[0]))
+      return 0;
+    for (size_t pos = range[0]; pos < range[1];) {
+      size_t n = range[1] - pos < sizeof(chunk) ? range[1] - pos : sizeof(chunk);
+      if (file.read(chunk, n) != n)
+        return 0;
+      for (size_t i = 0; i < n; ++i)
+        hash = (hash ^ chunk[i]) * 16777619u;
+      pos += n;
+    }
+  }
+  // 0 is reserved for "could not read"
+  return hash ? hash : 1;
+}
+
+void FileWordIndex::append(size_t offset, FontStyle style, TextAlign alignment, bool paragraphStart) {
+  uint8_t state = static_cast<uint8_t>(static_cast<uint8_t>(style) & STATE_STYLE_MASK);
+  state |= static_cast<uint8_t>((static_cast<uint8_t>(alignment) & STATE_ALIGN_MASK) << STATE_ALIGN_SHIFT);
+  if (paragraphStart)
+    state |= STATE_PARAGRAPH_START;
+  offsets_.push_back(static_cast<uint32_t>(offset));
+  states_.push_back(state);
+}
+
+bool FileWordIndex::load(const char* path, size_t fileSize, uint32_t modified, uint32_t fingerprint,
+                         size_t maxBytes, bool* tooLarge) {
+  clear(fileSize, modified, fingerprint);
+  if (tooLarge)
+    *tooLarge = false;
+  if (!SD.exists(path))
+    return false;
+  File f = SD.open(path);
+  if (!f)
+    return false;
+
+  uint8_t header[HEADER_SIZE];
+  if (f.read(header, HEADER_SIZE) != HEADER_SIZE || memcmp(header, INDEX_MAGIC, 4) != 0 ||
+      (header[4] | (header[5] << 8)) != INDEX_VERSION || readU32(header + 6) != fileSize ||
+      readU32(header + 10) != modified || readU32(header + 14) != fingerprint) {
+    f.close();
+    return false;
+  }
+  uint32_t count = readU32(header + 18);
+  if (count == 0 || f.size() != HEADER_SIZE + static_cast<size_t>(count) * ENTRY_SIZE) {
+    f.close();
+    return false;
+  }
+  if (count * (sizeof(uint32_t) + sizeof(uint8_t)) > maxBytes) {
+    if (tooLarge)
+      *tooLarge = true;
+    f.close();
+    return false;
+  }
+
+  offsets_.reserve(count);
+  states_.reserve(count);
+  // Read entries in small chunks to keep stack use low
+  uint8_t chunk[ENTRY_SIZE * 64];
+  uint32_t remaining = count;
+  while (remaining > 0) {
+    uint32_t n = remaining < 64 ? remaining : 64;
+    if (f.read(chunk, n * ENTRY_SIZE) != n * ENTRY_SIZE) {
+      f.close();
+      clear(fileSize, modified, fingerprint);
+      return false;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+      offsets_.push_back(readU32(chunk + i * ENTRY_SIZE));
+      states_.push_back(chunk[i * ENTRY_SIZE + 4]);
+    }
+    remaining -= n;
+  }
+  f.close();
+  return offsets_[0] == 0;
+}
+
+bool FileWordIndex::save(const char* path) const {
+  if (SD.exists(path))
+    SD.remove(path);
+  File f = SD.open(path, FILE_WRITE);
+  if (!f)
+    return false;
+
+  uint8_t header[HEADER_SIZE];
+  memcpy(header, INDEX_MAGIC, 4);
+  header[4] = static_cast<uint8_t>(INDEX_VERSION);
+  header[5] = static_cast<uint8_t>(INDEX_VERSION >> 8);
+  writeU32(header + 6, static_cast<uint32_t>(fileSize_));
+  writeU32(header + 10, modified_);
+  writeU32(header + 14, fingerprint_);
+  writeU32(header + 18, static_cast<uint32_t>(offsets_.size()));
+  bool ok = f.write(header, HEADER_SIZE) == HEADER_SIZE;
+
+  uint8_t chunk[ENTRY_SIZE * 64];
+  size_t i = 0;
+  while (ok && i < offsets_.size()) {
+    size_t n = 0;
+    for (; n < 64 && i < offsets_.size(); ++n, ++i) {
+      writeU32(chunk + n * ENTRY_SIZE, offsets_[i]);
+      chunk[n * ENTRY_SIZE + 4] = states_[i];
+    }
+    ok = f.write(chunk, n * ENTRY_SIZE) == n * ENTRY_SIZE;
+  }
+  f.close();
+  return ok;
+}
+
+size_t FileWordIndex::lowerEntry(size_t pos) const {
+  // Binary search for the last offset <= pos
+  size_t lo = 0, hi = offsets_.size();
+  while (hi - lo > 1) {
+    size_t mid = (lo + hi) / 2;
+    if (offsets_[mid] <= pos)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+bool FileWordIndex::findEntry(size_t pos, Entry& out) const {
+  if (offsets_.empty())
+    return false;
+  size_t i = lowerEntry(pos);
+  uint8_t state = states_[i];
+  out.offset = offsets_[i];
+  out.style = static_cast<FontStyle>(state & STATE_STYLE_MASK);
+  out.alignment = static_cast<TextAlign>((state >> STATE_ALIGN_SHIFT) & STATE_ALIGN_MASK);
+  out.paragraphStart = (state & STATE_PARAGRAPH_START) != 0;
+  return true;
+}
+
+size_t FileWordIndex::findParagraphStart(size_t pos) const {
+  if (offsets_.empty())
+    return 0;
+  size_t i = lowerEntry(pos);
+  while (i > 0 && !(states_[i] & STATE_PARAGRAPH_START))
+    --i;
+  return offsets_[i];
+}
+
+size_t FileWordIndex::findNextParagraphStart(size_t pos) const {
+  if (offsets_.empty())
+    return fileSize_;
+  for (size_t i = lowerEntry(pos) + 1; i < offsets_.size(); ++i) {
+    if ((states_[i] & STATE_PARAGRAPH_START) && offsets_[i] > pos)
+      return offsets_[i];
+  }
+  return fileSize_;
+}
+
+size_t FileWordIndex::getParagraphCount() const {
+  size_t count = 0;
+  for (uint8_t state : states_) {
+    if (state & STATE_PARAGRAPH_START)
+      ++count;
+  }
+  return count;
+}
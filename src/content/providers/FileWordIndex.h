@@ -0,0 +1,102 @@
+#ifndef FILE_WORD_INDEX_H
+#define FILE_WORD_INDEX_H
+
+#include <SD.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "../css/CssStyle.h"
+#include "rendering/SimpleFont.h"
+
+/**
+ * FileWordIndex - Sparse position index for FileWordProvider text files.
+ *
+ * Built by FileWordProvider in one forward pass over its ESC-token text file
+ * and stored as a sidecar next to it (`<file>.idx`). Each entry records a file
+ * offset together with the inline style and paragraph alignment that are in
+ * effect at that offset:
+ *
+ * - one entry at every paragraph start (offset 0 and after every '\n')
+ * - sparse checkpoints at word starts inside long paragraphs
+ *
+ * Checkpoints are only placed on offsets the style scan of
+ * FileWordProvider::restoreStyleContext() visits (never on the command byte of
+ * an ESC token), so resuming that scan from an entry gives exactly the same
+ * result as scanning from the paragraph start.
+ *
+ * Sidecar format (little endian):
+ *   "MRWI" | u16 version | u32 fileSize | u32 modified | u32 fingerprint |
+ *   u32 entryCount | entries (u32 offset, u8 state)
+ *
+ * A sidecar is only reused for a file of the same size, last write time and
+ * fingerprint (a hash of its first and last block, see fingerprint()). The
+ * write time catches edits anywhere in the file; the fingerprint covers
+ * files whose write time is not set (written without a clock). Code that
+ * rewrites a text file on the device removes its sidecar
+ * (FileWordProvider::removeIndex()).
+ */
+class FileWordIndex {
+ public:
+  struct Entry {
+    uint32_t offset;
+    FontStyle style;      // style in effect at `offset`
+    TextAlign alignment;  // last alignment start token in the paragraph before `offset`
+    bool paragraphStart;  // `offset` is the first byte of a paragraph
+  };
+
+  FileWordIndex();
+
+  // Start a new index for a file of `fileSize` bytes last written at
+  // `modified` with the given fingerprint
+  void clear(size_t fileSize, uint32_t modified, uint32_t fingerprint);
+  // Append an entry; offsets must be strictly increasing
+  void append(size_t offset, FontStyle style, TextAlign alignment, bool paragraphStart);
+
+  // Load from / save to a sidecar. load() fails if the file is missing, corrupt,
+  // written for a different file size, write time or fingerprint or larger
+  // than `maxBytes` in RAM. In the last case `tooLarge` (if given) is set so
+  // callers don't rebuild it.
+  bool load(const char* path, size_t fileSize, uint32_t modified, uint32_t fingerprint, size_t maxBytes,
+            bool* tooLarge = nullptr);
+  bool save(const char* path) const;
+
+  // Last entry at or before `pos`. Returns false only for an empty index
+  // (a built index always has an entry at offset 0).
+  bool findEntry(size_t pos, Entry& out) const;
+  // Start of the paragraph containing `pos`
+  size_t findParagraphStart(size_t pos) const;
+  // Start of the paragraph following the one containing `pos` (fileSize if none)
+  size_t findNextParagraphStart(size_t pos) const;
+
+  size_t getEntryCount() const {
+    return offsets_.size();
+  }
+  size_t getParagraphCount() const;
+  // Approximate RAM used by the loaded entries
+  size_t getMemoryUsage() const {
+    return offsets_.size() * (sizeof(uint32_t) + sizeof(uint8_t));
+  }
+
+  // Checkpoint spacing used while building (bytes)
+  static const size_t CHECKPOINT_INTERVAL = 512;
+  // Bytes hashed at each end of the file for the fingerprint
+  static const size_t FINGERPRINT_BYTES = 512;
+
+  // Fingerprint of an open file of `fileSize` bytes: FNV-1a of its first and
+  // last FINGERPRINT_BYTES (moves the file position). 0 if it cannot be read.
+  static uint32_t fingerprint(File& file, size_t fileSize);
+
+ private:
+  // Index of the last entry with offset <= pos
+  size_t lowerEntry(size_t pos) const;
+
+  // Struct-of-arrays keeps each entry at 5 bytes
+  std::vector<uint32_t> offsets_;
+  std::vector<uint8_t> states_;  // bits 0-1 style, bits 2-4 alignment, bit 7 paragraph start
+  size_t fileSize_ = 0;
+  uint32_t modified_ = 0;
+  uint32_t fingerprint_ = 0;
+};
+
+#endif
@@ -2,6 +2,8 @@
 
 #include <Arduino.h>
 
+#include <cstring>
+
 #include "WString.h"
 
 // ESC-based format constants:
@@ -121,7 +123,8 @@ static bool isEscCommandChar(char cmd) {
   return tryGetAlignmentStart(cmd, nullptr) || tryGetAlignmentEnd(cmd, nullptr) || tryGetStyleForward(cmd, nullptr);
 }
 
-FileWordProvider::FileWordProvider(const char* path, size_t bufSize) : bufSize_(bufSize) {
+FileWordProvider::FileWordProvider(const char* path, size_t bufSize, uint8_t* cacheBuffer)
+    : path_(path), bufSize_(bufSize) {
   file_ = SD.open(path);
   if (!file_) {
     fileSize_ = 0;
@@ -131,9 +134,22 @@ FileWordProvider::FileWordProvider(const char* path, size_t bufSize) : bufSize_(
   fileSize_ = file_.size();
   index_ = 0;
   prevIndex_ = 0;
-  buf_ = (uint8_t*)malloc(bufSize_);
-  bufStart_ = 0;
-  bufLen_ = 0;
+  // Sector-sized blocks when the buffer allows at least two of them,
+  // otherwise split small buffers in two so both directions stay cached
+  if (bufSize_ >= 2 * BLOCK_SIZE) {
+    blockSize_ = BLOCK_SIZE;
+    blockCount_ = bufSize_ / BLOCK_SIZE;
+  } else {
+    blockCount_ = 2;
+    blockSize_ = bufSize_ / 2 > 0 ? bufSize_ / 2 : 1;
+  }
+  if (cacheBuffer) {
+    buf_ = cacheBuffer;
+    ownsBuf_ = false;
+  } else {
+    buf_ = (uint8_t*)malloc(blockSize_ * blockCount_);
+  }
+  blocks_ = new CacheBlock[blockCount_];
   // Skip UTF-8 BOM at start of file if present so it doesn't appear as a word
   skipUtf8BomIfPresent();
   // Compute paragraph alignment for initial position
@@ -143,8 +159,144 @@ FileWordProvider::FileWordProvider(const char* path, size_t bufSize) : bufSize_(
 FileWordProvider::~FileWordProvider() {
   if (file_)
     file_.close();
-  if (buf_)
+  if (buf_ && ownsBuf_)
     free(buf_);
+  delete[] blocks_;
+  free(tokenBuf_);
+  delete wordIndex_;
+}
+
+bool FileWordProvider::loadOrBuildIndex(size_t maxBytes) {
+  if (!file_ || !buf_)
+    return false;
+  if (wordIndex_)
+    return true;
+
+  String idxPath = indexPath(path_.c_str());
+  // The sidecar must have been built from this very file, not just one of
+  // the same size
+  const uint32_t modified = static_cast<uint32_t>(file_.getLastWrite());
+  const uint32_t fingerprint = FileWordIndex::fingerprint(file_, fileSize_);
+  if (fingerprint == 0)
+    return false;
+  FileWordIndex* index = new FileWordIndex();
+  bool tooLarge = false;
+  if (!index->load(idxPath.c_str(), fileSize_, modified, fingerprint, maxBytes, &tooLarge)) {
+    if (tooLarge) {
+      delete index;
+      return false;
+    }
+    unsigned long start = millis();
+    if (!buildIndex(*index, modified, fingerprint)) {
+      delete index;
+      return false;
+    }
+    if (!index->save(idxPath.c_str())) {
+      Serial.printf("FileWordProvider: failed to save %s\n", idxPath.c_str());
+    }
+    Serial.printf("FileWordProvider: indexed %u paragraphs (%u entries) in %lu ms\n",
+                  (unsigned)index->getParagraphCount(), (unsigned)index->getEntryCount(), millis() - start);
+    if (index->getMemoryUsage() > maxBytes) {
+      delete index;
+      return false;
+    }
+  }
+  wordIndex_ = index;
+  return true;
+}
+
+String FileWordProvider::indexPath(const char* path) {
+  return String(path) + String(".idx");
+}
+
+void FileWordProvider::removeIndex(const char* path) {
+  String idxPath = indexPath(path);
+  if (SD.exists(idxPath.c_str()))
+    SD.remove(idxPath.c_str());
+}
+
+bool FileWordProvider::buildIndex(FileWordIndex& index, uint32_t modified, uint32_t fingerprint) {
+  index.clear(fileSize_, modified, fingerprint);
+  if (fileSize_ == 0) {
+    index.append(0, FontStyle::REGULAR, TextAlign::None, true);
+    return true;
+  }
+
+  // Mirrors restoreStyleContext() (style scan from the paragraph start that
+  // skips both bytes of every ESC token) and computeParagraphAlignmentForPosition()
+  // (any alignment start token earlier in the paragraph) in a single pass.
+  size_t paraStart = 0;
+  size_t nextVisit = 0;  // next offset the style scan looks at
+  size_t lastEntry = 0;
+  FontStyle style = FontStyle::REGULAR;
+  TextAlign align = TextAlign::None;
+  uint8_t prevByte = 0;
+
+  auto step = [&](size_t i, uint8_t cur, uint8_t next, bool hasNext) {
+    if (i == paraStart) {
+      index.append(i, FontStyle::REGULAR, TextAlign::None, true);
+      lastEntry = i;
+    } else if (i == nextVisit && i >= lastEntry + FileWordIndex::CHECKPOINT_INTERVAL &&
+               (prevByte == ' ' || prevByte == '\t') && cur != ' ' && cur != '\n') {
+      // Sparse checkpoint at a word start inside a long paragraph
+      index.append(i, style, align, false);
+      lastEntry = i;
+    }
+
+    TextAlign tokenAlign;
+    if (cur == ESC_CHAR && hasNext && tryGetAlignmentStart((char)next, &tokenAlign))
+      align = tokenAlign;
+
+    if (i == nextVisit) {
+      if (cur == ESC_CHAR && hasNext) {
+        FontStyle tokenStyle;
+        if (tryGetStyleForward((char)next, &tokenStyle))
+          style = tokenStyle;
+        nextVisit = i + 2;
+      } else {
+        nextVisit = i + 1;
+      }
+    }
+
+    if (cur == '\n') {
+      paraStart = i + 1;
+      nextVisit = i + 1;
+      style = FontStyle::REGULAR;
+      align = TextAlign::None;
+    }
+    prevByte = cur;
+  };
+
+  // Stream the file through the cache buffer; each byte is processed once the
+  // following byte is known.
+  bool havePending = false;
+  uint8_t pending = 0;
+  size_t pendingPos = 0;
+  size_t pos = 0;
+  if (!file_.seek(0))
+    return false;
+  while (pos < fileSize_) {
+    size_t r = file_.read(buf_, blockSize_ * blockCount_);
+    if (r == 0)
+      break;
+    for (size_t j = 0; j < r; ++j) {
+      if (havePending)
+        step(pendingPos, pending, buf_[j], true);
+      pending = buf_[j];
+      pendingPos = pos + j;
+      havePending = true;
+    }
+    pos += r;
+  }
+  // The cache buffer was used as scratch space
+  invalidateCache();
+  if (pos != fileSize_)
+    return false;
+  if (havePending)
+    step(pendingPos, pending, 0, false);
+  if (paraStart == fileSize_)
+    index.append(paraStart, FontStyle::REGULAR, TextAlign::None, true);
+  return true;
 }
 
 bool FileWordProvider::hasNextWord() {
@@ -158,34 +310,98 @@ bool FileWordProvider::hasPrevWord() {
 char FileWordProvider::charAt(size_t pos) {
   if (pos >= fileSize_)
     return '\0';
-  if (!ensureBufferForPos(pos))
+  int slot = ensureBlockForPos(pos);
+  if (slot < 0)
     return '\0';
-  return (char)buf_[pos - bufStart_];
+  return (char)buf_[slot * blockSize_ + (pos - blocks_[slot].start)];
+}
+
+void FileWordProvider::fillToken(size_t start, size_t end, WordToken& out) {
+  out.text = "";
+  out.length = 0;
+  if (end <= start)
+    return;
+  size_t len = end - start;
+
+  // Zero-copy when the word lies inside one cached block and has no '\r' to drop
+  int slot = ensureBlockForPos(start);
+  if (slot >= 0 && end <= blocks_[slot].start + blocks_[slot].len) {
+    const char* p = reinterpret_cast<const char*>(buf_ + slot * blockSize_ + (start - blocks_[slot].start));
+    if (!memchr(p, '\r', len)) {
+      out.text = p;
+      out.length = static_cast<uint16_t>(len);
+      return;
+    }
+  }
+
+  // Otherwise assemble it in the reusable scratch buffer
+  if (len > tokenBufSize_) {
+    char* grown = static_cast<char*>(realloc(tokenBuf_, len));
+    if (!grown)
+      return;
+    tokenBuf_ = grown;
+    tokenBufSize_ = len;
+  }
+  uint16_t n = 0;
+  for (size_t i = start; i < end; ++i) {
+    char cc = charAt(i);
+    if (cc != '\r')
+      tokenBuf_[n++] = cc;
+  }
+  out.text = tokenBuf_;
+  out.length = n;
 }
 
-bool FileWordProvider::ensureBufferForPos(size_t pos) {
+void FileWordProvider::invalidateCache() {
+  for (size_t i = 0; i < blockCount_; ++i) {
+    blocks_[i].start = SIZE_MAX;
+    blocks_[i].len = 0;
+    blocks_[i].lastUse = 0;
+  }
+  lastBlock_ = -1;
+}
+
+int FileWordProvider::ensureBlockForPos(size_t pos) {
   if (!file_ || !buf_)
-    return false;
-  if (pos >= bufStart_ && pos < bufStart_ + bufLen_)
-    return true;
+    return -1;
+  // Most accesses are sequential and stay within the last block
+  if (lastBlock_ >= 0) {
+    const CacheBlock& b = blocks_[lastBlock_];
+    if (pos >= b.start && pos < b.start + b.len) {
+      ++cacheHits_;
+      return lastBlock_;
+    }
+  }
 
-  // Center buffer around pos when possible
-  size_t start = (pos > bufSize_ / 2) ? (pos - bufSize_ / 2) : 0;
-  if (start + bufSize_ > fileSize_) {
-    if (fileSize_ > bufSize_)
-      start = fileSize_ - bufSize_;
-    else
-      start = 0;
+  size_t start = pos - pos % blockSize_;
+  int victim = 0;
+  for (size_t i = 0; i < blockCount_; ++i) {
+    const CacheBlock& b = blocks_[i];
+    if (b.start == start && b.len > 0) {
+      blocks_[i].lastUse = ++useTick_;
+      lastBlock_ = (int)i;
+      ++cacheHits_;
+      return lastBlock_;
+    }
+    if (b.lastUse < blocks_[victim].lastUse)
+      victim = (int)i;
   }
 
+  ++cacheMisses_;
+  CacheBlock& b = blocks_[victim];
+  b.start = SIZE_MAX;
+  b.len = 0;
+  lastBlock_ = -1;
   if (!file_.seek(start))
-    return false;
-  size_t r = file_.read(buf_, bufSize_);
+    return -1;
+  size_t r = file_.read(buf_ + victim * blockSize_, blockSize_);
   if (r == 0)
-    return false;
-  bufStart_ = start;
-  bufLen_ = r;
-  return true;
+    return -1;
+  b.start = start;
+  b.len = r;
+  b.lastUse = ++useTick_;
+  lastBlock_ = victim;
+  return victim;
 }
 
 // Check if position has an ESC token (ESC + command byte = 2 bytes)
@@ -284,10 +500,17 @@ bool FileWordProvider::isAtEscTokenEnd(size_t pos, size_t& tokenStart) {
 }
 
 StyledWord FileWordProvider::getNextWord() {
+  WordToken token;
+  getNextToken(token);
+  return tokenToStyledWord(token);
+}
+
+void FileWordProvider::getNextToken(WordToken& out) {
+  out = WordToken();
   prevIndex_ = index_;
 
   if (index_ >= fileSize_) {
-    return StyledWord();
+    return;
   }
 
   // Skip any ESC tokens at current position first
@@ -299,7 +522,7 @@ StyledWord FileWordProvider::getNextWord() {
   }
 
   if (index_ >= fileSize_) {
-    return StyledWord();
+    return;
   }
 
   // Skip carriage returns
@@ -308,7 +531,7 @@ StyledWord FileWordProvider::getNextWord() {
   }
 
   if (index_ >= fileSize_) {
-    return StyledWord();
+    return;
   }
 
   // Capture style BEFORE reading the word content
@@ -317,16 +540,14 @@ StyledWord FileWordProvider::getNextWord() {
   FontStyle styleForWord = currentInlineStyle_;
 
   char c = charAt(index_);
-  String token;
+  size_t tokenStart = index_;
 
   // Case 1: Space - read just the space and stop
   if (c == ' ') {
-    token += c;
     index_++;
   }
   // Case 2: Single character tokens (newline, tab) - read just that character
   else if (c == '\n' || c == '\t') {
-    token += c;
     index_++;
     // Newline resets paragraph alignment
     if (c == '\n') {
@@ -354,7 +575,6 @@ StyledWord FileWordProvider::getNextWord() {
       if (cc == ' ' || cc == '\n' || cc == '\t') {
         break;
       }
-      token += cc;
       index_++;
     }
   }
@@ -363,17 +583,25 @@ StyledWord FileWordProvider::getNextWord() {
   // {
   //   // Alignment is updated by parseEscTokenAtPos while skipping ESC tokens.
   //   TextAlign align = getParagraphAlignment();
-  //   printf("getNextWord returning pos=%d token='%s' style=%d align=%d\n", getCurrentIndex(), token.c_str(),
-  //          (int)styleForWord, (int)align);
+  //   printf("getNextWord returning pos=%d token='%.*s' style=%d align=%d\n", getCurrentIndex(), out.length,
+  //          out.text, (int)styleForWord, (int)align);
   // }
-  return StyledWord(token, styleForWord);
+  fillToken(tokenStart, index_, out);
+  out.style = styleForWord;
 }
 
 StyledWord FileWordProvider::getPrevWord() {
+  WordToken token;
+  getPrevToken(token);
+  return tokenToStyledWord(token);
+}
+
+void FileWordProvider::getPrevToken(WordToken& out) {
+  out = WordToken();
   prevIndex_ = index_;
 
   if (index_ == 0) {
-    return StyledWord();
+    return;
   }
 
   // Move to just before current position
@@ -392,7 +620,7 @@ StyledWord FileWordProvider::getPrevWord() {
         if (tokenStart == 0) {
           // ESC token starts at position 0, nothing before it
           index_ = 0;
-          return StyledWord();
+          return;
         }
         index_ = tokenStart - 1;
         continue;
@@ -408,7 +636,7 @@ StyledWord FileWordProvider::getPrevWord() {
         parseEscTokenBackward(index_);
         if (index_ == 0) {
           // At start of file, nothing before this token
-          return StyledWord();
+          return;
         }
         index_--;
         continue;
@@ -430,32 +658,25 @@ StyledWord FileWordProvider::getPrevWord() {
       // Process the token backward before returning
       parseEscTokenBackward(index_);
       index_ = 0;
-      return StyledWord();
+      return;
     }
   }
 
   if (index_ >= fileSize_) {
     index_ = 0;
-    return StyledWord();
+    return;
   }
 
   char c = charAt(index_);
-  String token;
   size_t tokenStart = index_;
+  size_t tokenEnd = index_ + 1;
 
-  // Case 1: Space
-  if (c == ' ') {
-    token += c;
-  }
-  // Case 2: Single character tokens
-  else if (c == '\n' || c == '\t') {
-    token += c;
-    if (c == '\n') {
-      currentParagraphAlignment_ = TextAlign::None;
-    }
+  // Case 1 and 2: space, newline and tab are single-character tokens
+  if (c == '\n') {
+    currentParagraphAlignment_ = TextAlign::None;
   }
   // Case 3: Regular word - find start
-  else {
+  else if (c != ' ' && c != '\t') {
     // Find word start by scanning backward
     while (tokenStart > 0) {
       char prevChar = charAt(tokenStart - 1);
@@ -483,13 +704,6 @@ StyledWord FileWordProvider::getPrevWord() {
       tokenStart = 3;
     }
 
-    for (size_t i = tokenStart; i <= index_; i++) {
-      char cc = charAt(i);
-      if (cc != '\r') {
-        token += cc;
-      }
-    }
-
     index_ = tokenStart;
   }
 
@@ -503,10 +717,12 @@ StyledWord FileWordProvider::getPrevWord() {
   // {
   //   // For prevWord, index_ is the start of word; alignment is updated by parseEscTokenBackward
   //   TextAlign align = getParagraphAlignment();
-  //   printf("getPrevWord returning pos=%d token='%s' style=%d align=%d\n", getCurrentIndex(), token.c_str(),
-  //          (int)styleForWord, (int)align);
+  //   printf("getPrevWord returning pos=%d token='%.*s' style=%d align=%d\n", getCurrentIndex(), out.length,
+  //          out.text, (int)styleForWord, (int)align);
   // }
-  return StyledWord(token, styleForWord);
+  // Build the view last: restoreStyleContext() may have evicted the word's block
+  fillToken(tokenStart, tokenEnd, out);
+  out.style = styleForWord;
 }
 
 StyledWord FileWordProvider::scanWord(int direction) {
@@ -625,6 +841,12 @@ TextAlign FileWordProvider::getParagraphAlignment() {
 }
 
 void FileWordProvider::findParagraphBoundaries(size_t pos, size_t& outStart, size_t& outEnd) {
+  if (wordIndex_) {
+    outStart = wordIndex_->findParagraphStart(pos);
+    outEnd = wordIndex_->findNextParagraphStart(pos);
+    return;
+  }
+
   // Paragraphs are delimited by newlines
   // Find start: scan backwards to find newline or beginning of file
   outStart = 0;
@@ -657,6 +879,22 @@ void FileWordProvider::computeParagraphAlignmentForPosition(size_t pos) {
   if (pos >= fileSize_)
     pos = fileSize_ - 1;
 
+  if (wordIndex_) {
+    // Same result as the walk below: the nearest alignment start token in
+    // [paragraph start, pos], or None at a paragraph start.
+    if (pos == 0 || charAt(pos - 1) == '\n')
+      return;
+    FileWordIndex::Entry entry;
+    wordIndex_->findEntry(pos, entry);
+    currentParagraphAlignment_ = entry.alignment;
+    for (size_t q = entry.offset; q <= pos; ++q) {
+      TextAlign align;
+      if (charAt(q) == ESC_CHAR && q + 1 < fileSize_ && tryGetAlignmentStart(charAt(q + 1), &align))
+        currentParagraphAlignment_ = align;
+    }
+    return;
+  }
+
   // Walk left from current position until we find an ESC alignment token or newline
   size_t p = pos;
   while (true) {
@@ -716,12 +954,20 @@ void FileWordProvider::restoreStyleContext() {
   if (index_ == 0 || fileSize_ == 0)
     return;
 
-  // Find paragraph start (newline boundary)
+  // Find paragraph start (newline boundary), or the nearest index checkpoint
+  // in the same paragraph together with the style in effect there
   size_t paraStart = 0;
-  for (size_t i = index_; i > 0; --i) {
-    if (charAt(i - 1) == '\n') {
-      paraStart = i;
-      break;
+  if (wordIndex_) {
+    FileWordIndex::Entry entry;
+    wordIndex_->findEntry(index_, entry);
+    paraStart = entry.offset;
+    currentInlineStyle_ = entry.style;
+  } else {
+    for (size_t i = index_; i > 0; --i) {
+      if (charAt(i - 1) == '\n') {
+        paraStart = i;
+        break;
+      }
     }
   }
 
@@ -744,10 +990,7 @@ void FileWordProvider::restoreStyleContext() {
 bool FileWordProvider::hasUtf8BomAtStart() {
   if (fileSize_ < 3 || !file_)
     return false;
-  // Make sure we have bytes in buffer
-  if (!ensureBufferForPos(0))
-    return false;
-  return (bufLen_ >= 3 && buf_[0] == 0xEF && buf_[1] == 0xBB && buf_[2] == 0xBF);
+  return ((uint8_t)charAt(0) == 0xEF && (uint8_t)charAt(1) == 0xBB && (uint8_t)charAt(2) == 0xBF);
 }
 
 void FileWordProvider::skipUtf8BomIfPresent() {
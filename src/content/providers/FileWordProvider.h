@@ -5,13 +5,17 @@
 
 #include <cstdint>
 
+#include "FileWordIndex.h"
 #include "WordProvider.h"
 
 class FileWordProvider : public WordProvider {
  public:
   // path: SD path to text file
-  // bufSize: internal sliding window buffer size in bytes (default 2048)
-  FileWordProvider(const char* path, size_t bufSize = 2048);
+  // bufSize: total read cache size in bytes (default 2048), split into
+  //          BLOCK_SIZE blocks (or two smaller blocks for tiny buffers)
+  // cacheBuffer: memory for the read cache (bufSize bytes, must outlive the
+  //          provider); allocated by the provider when nullptr
+  FileWordProvider(const char* path, size_t bufSize = 2048, uint8_t* cacheBuffer = nullptr);
   ~FileWordProvider() override;
   bool isValid() const {
     return file_;
@@ -21,6 +25,8 @@ class FileWordProvider : public WordProvider {
   bool hasPrevWord() override;
   StyledWord getNextWord() override;
   StyledWord getPrevWord() override;
+  void getNextToken(WordToken& out) override;
+  void getPrevToken(WordToken& out) override;
 
   float getPercentage() override;
   float getPercentage(int index) override;
@@ -35,21 +41,76 @@ class FileWordProvider : public WordProvider {
   // Paragraph alignment support
   TextAlign getParagraphAlignment() override;
 
+  // Load the `<path>.idx` sidecar, building and saving it first if it is
+  // missing or stale. The index is only kept in RAM if it fits in `maxBytes`.
+  // Without an index all lookups fall back to scanning the file.
+  bool loadOrBuildIndex(size_t maxBytes = DEFAULT_INDEX_BUDGET);
+  // Delete the sidecar of the text file at `path`; call before rewriting it
+  static void removeIndex(const char* path);
+  bool hasIndex() const {
+    return wordIndex_ != nullptr;
+  }
+  const FileWordIndex* getIndex() const {
+    return wordIndex_;
+  }
+
+  static const size_t DEFAULT_INDEX_BUDGET = 16 * 1024;
+
+  // Read cache statistics (one lookup per byte access)
+  uint32_t getCacheHits() const {
+    return cacheHits_;
+  }
+  uint32_t getCacheMisses() const {
+    return cacheMisses_;
+  }
+  size_t getCacheBlockCount() const {
+    return blockCount_;
+  }
+  void resetCacheStats() {
+    cacheHits_ = 0;
+    cacheMisses_ = 0;
+  }
+
+  // Cache block size: one SD sector
+  static const size_t BLOCK_SIZE = 512;
+
  private:
   StyledWord scanWord(int direction);
 
-  bool ensureBufferForPos(size_t pos);
+  // Make the block containing `pos` resident; returns the block slot or -1
+  int ensureBlockForPos(size_t pos);
   char charAt(size_t pos);
+  void invalidateCache();
+  // Point `out` at the bytes [start, end) without '\r' (cache view or scratch copy)
+  void fillToken(size_t start, size_t end, WordToken& out);
 
   File file_;
+  String path_;
   size_t fileSize_ = 0;
   size_t index_ = 0;
   size_t prevIndex_ = 0;
 
+  // Read cache: buf_ holds blockCount_ blocks of blockSize_ bytes each,
+  // aligned to blockSize_ in the file and replaced least recently used first.
+  struct CacheBlock {
+    size_t start = SIZE_MAX;  // file offset of the block (SIZE_MAX = empty)
+    size_t len = 0;           // valid bytes
+    uint32_t lastUse = 0;
+  };
   uint8_t* buf_ = nullptr;
+  bool ownsBuf_ = true;
   size_t bufSize_ = 0;
-  size_t bufStart_ = 0;  // file offset of buf_[0]
-  size_t bufLen_ = 0;    // valid bytes in buf_
+  size_t blockSize_ = 0;
+  size_t blockCount_ = 0;
+  CacheBlock* blocks_ = nullptr;
+  int lastBlock_ = -1;  // most recently hit slot, checked first
+  uint32_t useTick_ = 0;
+  uint32_t cacheHits_ = 0;
+  uint32_t cacheMisses_ = 0;
+
+  // Scratch for tokens that straddle blocks or contain '\r'
+  char* tokenBuf_ = nullptr;
+  size_t tokenBufSize_ = 0;
 
   // Current paragraph alignment (computed on position change). 'None' means no alignment.
   TextAlign currentParagraphAlignment_ = TextAlign::None;
@@ -57,6 +118,13 @@ class FileWordProvider : public WordProvider {
   // Current inline font style (updated when parsing [style=...] tokens)
   FontStyle currentInlineStyle_ = FontStyle::REGULAR;
 
+  // Optional paragraph/checkpoint index (see loadOrBuildIndex)
+  FileWordIndex* wordIndex_ = nullptr;
+  // Build `index` with one forward pass over the file
+  bool buildIndex(FileWordIndex& index, uint32_t modified, uint32_t fingerprint);
+  // Path of the sidecar of the text file at `path`
+  static String indexPath(const char* path);
+
   // Find paragraph boundaries containing the given position
   void findParagraphBoundaries(size_t pos, size_t& outStart, size_t& outEnd);
   // Update the paragraph alignment cache for current position
@@ -13,71 +13,83 @@ bool StringWordProvider::hasPrevWord() {
 }
 
 StyledWord StringWordProvider::getNextWord() {
-  return scanWord(+1);
+  WordToken token;
+  scanWord(+1, token);
+  return tokenToStyledWord(token);
 }
 
 StyledWord StringWordProvider::getPrevWord() {
-  return scanWord(-1);
+  WordToken token;
+  scanWord(-1, token);
+  return tokenToStyledWord(token);
 }
 
-StyledWord StringWordProvider::scanWord(int direction) {
-  // Save prevIndex_ when scanning
-  prevIndex_ = index_;
-
-  int currentPos = (direction == 1) ? index_ : index_ - 1;
-  if ((direction == 1 && currentPos >= text_.length()) || (direction == -1 && currentPos < 0)) {
-    return StyledWord();
-  }
+void StringWordProvider::getNextToken(WordToken& out) {
+  scanWord(+1, out);
+}
 
-  char c = text_[currentPos];
+void StringWordProvider::getPrevToken(WordToken& out) {
+  scanWord(-1, out);
+}
 
-  if (c == ' ') {
-    String token;
-    int start = currentPos;
-    if (direction == 1) {
-      int end = currentPos;
-      while (end < text_.length() && text_[end] == ' ')
-        end++;
-      token = text_.substring(start, end);
-      index_ = end;
-    } else {
-      while (start > 0 && text_[start - 1] == ' ')
-        start--;
-      token = text_.substring(start, index_);
-      index_ = start;
+void StringWordProvider::scanWord(int direction, WordToken& out) {
+  const char* text = text_.c_str();
+  const int length = text_.length();
+  out = WordToken();
+
+  while (true) {
+    // Save prevIndex_ when scanning
+    prevIndex_ = index_;
+    int currentPos = (direction == 1) ? index_ : index_ - 1;
+    if ((direction == 1 && currentPos >= length) || (direction == -1 && currentPos < 0)) {
+      return;
     }
-    return StyledWord(token);
-  } else if (c == '\r') {
-    if (direction == 1) {
-      index_++;
-    } else {
-      index_ = currentPos;
-    }
-    // Ignore carriage return
-    return scanWord(direction);
-  } else if (c == '\n' || c == '\t') {
-    if (direction == 1) {
-      index_++;
-    } else {
-      index_ = currentPos;
-    }
-    return StyledWord(String(c));
-  } else {
-    String token;
+
+    char c = text[currentPos];
     int start = currentPos;
-    if (direction == 1) {
-      int end = currentPos;
-      while (end < text_.length() && text_[end] != ' ' && text_[end] != '\n' && text_[end] != '\t')
-        end++;
-      token = text_.substring(start, end);
-      index_ = end;
+    int end = currentPos + 1;
+
+    if (c == ' ') {
+      if (direction == 1) {
+        while (end < length && text[end] == ' ')
+          end++;
+        index_ = end;
+      } else {
+        end = index_;
+        while (start > 0 && text[start - 1] == ' ')
+          start--;
+        index_ = start;
+      }
+    } else if (c == '\r') {
+      if (direction == 1) {
+        index_++;
+      } else {
+        index_ = currentPos;
+      }
+      // Ignore carriage return
+      continue;
+    } else if (c == '\n' || c == '\t') {
+      if (direction == 1) {
+        index_++;
+      } else {
+        index_ = currentPos;
+      }
     } else {
-      while (start > 0 && text_[start - 1] != ' ' && text_[start - 1] != '\n' && text_[start - 1] != '\t')
-        start--;
-      token = text_.substring(start, index_);
-      index_ = start;
+      if (direction == 1) {
+        while (end < length && text[end] != ' ' && text[end] != '\n' && text[end] != '\t')
+          end++;
+        index_ = end;
+      } else {
+        end = index_;
+        while (start > 0 && text[start - 1] != ' ' && text[start - 1] != '\n' && text[start - 1] != '\t')
+          start--;
+        index_ = start;
+      }
     }
-    return StyledWord(token);
+
+    out.text = text + start;
+    out.length = static_cast<uint16_t>(end - start);
+    return;
   }
 }
 
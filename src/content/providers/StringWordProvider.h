@@ -14,6 +14,8 @@ class StringWordProvider : public WordProvider {
 
   StyledWord getNextWord() override;
   StyledWord getPrevWord() override;
+  void getNextToken(WordToken& out) override;
+  void getPrevToken(WordToken& out) override;
 
   float getPercentage() override;
   float getPercentage(int index) override;
@@ -26,8 +28,9 @@ class StringWordProvider : public WordProvider {
   void reset() override;
 
  private:
-  // Unified scanner: `direction` should be +1 for forward scanning and -1 for backward scanning
-  StyledWord scanWord(int direction);
+  // Unified scanner: `direction` should be +1 for forward scanning and -1 for backward scanning.
+  // The token is a view into text_.
+  void scanWord(int direction, WordToken& out);
 
   String text_;
   int index_;
@@ -1,6 +1,8 @@
 #ifndef WORD_PROVIDER_H
 #define WORD_PROVIDER_H
 
+#include <cstdint>
+
 #include "../css/CssStyle.h"       // For TextAlign and CssStyle
 #include "WString.h"               // For Arduino `String`
 #include "rendering/SimpleFont.h"  // For FontStyle
@@ -26,6 +28,27 @@ struct StyledWord {
   }
 };
 
+/**
+ * WordToken - A word as a view into provider-owned memory
+ *
+ * Returned by getNextToken/getPrevToken. `text` is NOT NUL-terminated and is
+ * only valid until the next call on the provider, so callers must measure or
+ * copy it right away. Unlike StyledWord, producing a token does not allocate.
+ */
+struct WordToken {
+  const char* text = "";
+  uint16_t length = 0;
+  FontStyle style = FontStyle::REGULAR;
+
+  bool isEmpty() const {
+    return length == 0;
+  }
+  // True for the single-character break tokens ("\n", "\t", " ")
+  bool is(char c) const {
+    return length == 1 && text[0] == c;
+  }
+};
+
 class WordProvider {
  public:
   virtual ~WordProvider() = default;
@@ -42,6 +65,22 @@ class WordProvider {
   // Gets the previous word as a StyledWord and moves index backwards
   virtual StyledWord getPrevWord() = 0;
 
+  // Allocation-free variants of getNextWord/getPrevWord used by layout. The
+  // default implementations go through the String versions; providers that
+  // own their text override them to return views into their buffers.
+  virtual void getNextToken(WordToken& out) {
+    StyledWord word = getNextWord();
+    tokenScratch_ = word.text;
+    fillTokenFromScratch(out);
+    out.style = word.style;
+  }
+  virtual void getPrevToken(WordToken& out) {
+    StyledWord word = getPrevWord();
+    tokenScratch_ = word.text;
+    fillTokenFromScratch(out);
+    out.style = word.style;
+  }
+
   // Returns the current reading progress as a percentage (0.0 to 1.0)
   virtual float getPercentage() = 0;
   virtual float getPercentage(int index) = 0;
@@ -117,6 +156,25 @@ class WordProvider {
   virtual TextAlign getParagraphAlignment() {
     return TextAlign::Left;
   }
+
+ protected:
+  // Build the String returned by getNextWord/getPrevWord from a token
+  static StyledWord tokenToStyledWord(const WordToken& token) {
+    String text;
+    text.reserve(token.length);
+    for (uint16_t i = 0; i < token.length; ++i)
+      text += token.text[i];
+    return StyledWord(text, token.style);
+  }
+
+ private:
+  void fillTokenFromScratch(WordToken& out) {
+    out.text = tokenScratch_.c_str();
+    out.length = static_cast<uint16_t>(tokenScratch_.length());
+  }
+
+  // Backing store for the default token implementation
+  String tokenScratch_;
 };
 
 #endif
\ No newline at end of file
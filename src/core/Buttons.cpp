@@ -126,3 +126,7 @@ unsigned long Buttons::getHoldDuration(uint8_t buttonIndex) {
   }
   return millis() - lastDebounceTime[buttonIndex];
 }
+
+bool Buttons::isAnyDown() {
+  return currentState != 0;
+}
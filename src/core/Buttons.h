@@ -16,6 +16,7 @@ class Buttons {
   bool wasDown(uint8_t buttonIndex);                   // Was button down in previous frame?
   bool wasReleased(uint8_t buttonIndex);               // Was button just released this frame?
   unsigned long getHoldDuration(uint8_t buttonIndex);  // How long button has been held (ms)
+  bool isAnyDown();                                    // Is any button currently held down?
 
   // Button indices
   static const uint8_t BACK = 0;
@@ -1,5 +1,6 @@
 #include "EInkDisplay.h"
 
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <vector>
@@ -40,6 +41,16 @@
 // Power management
 #define CMD_DEEP_SLEEP 0x10  // Deep sleep
 
+namespace {
+// Bytes of a 16-bit command parameter
+inline uint8_t low8(uint16_t value) {
+  return value & 0xFF;
+}
+inline uint8_t high8(uint16_t value) {
+  return value >> 8;
+}
+}  // namespace
+
 // Custom LUT for fast refresh
 const unsigned char lut_grayscale[] PROGMEM = {
     // 00 black/white
@@ -122,12 +133,22 @@ EInkDisplay::EInkDisplay(int8_t sclk, int8_t mosi, int8_t cs, int8_t dc, int8_t
 }
 
 EInkDisplay::~EInkDisplay() {
-  // No dynamic memory to clean up (buffers are statically allocated)
+  free(frameBuffer0);
+  free(frameBuffer1);
 }
 
 void EInkDisplay::begin() {
   Serial.printf("[%lu] EInkDisplay: begin() called\n", millis());
 
+  // Allocated first thing, while the heap is still in one piece
+  if (!frameBuffer0)
+    frameBuffer0 = static_cast<uint8_t*>(malloc(BUFFER_SIZE));
+  if (!frameBuffer1)
+    frameBuffer1 = static_cast<uint8_t*>(malloc(BUFFER_SIZE));
+  if (!frameBuffer0 || !frameBuffer1) {
+    Serial.printf("[%lu]   ERROR: Failed to allocate frame buffers\n", millis());
+    return;
+  }
   frameBuffer = frameBuffer0;
   frameBufferActive = frameBuffer1;
 
@@ -135,7 +156,8 @@ void EInkDisplay::begin() {
   memset(frameBuffer0, 0xFF, BUFFER_SIZE);
   memset(frameBuffer1, 0xFF, BUFFER_SIZE);
 
-  Serial.printf("[%lu]   Static frame buffers (2 x %lu bytes = 96KB)\n", millis(), BUFFER_SIZE);
+  Serial.printf("[%lu]   Frame buffers (2 x %lu bytes = 96KB), band buffer %lu bytes\n", millis(),
+                (unsigned long)BUFFER_SIZE, (unsigned long)sizeof(bandBuffer));
   Serial.printf("[%lu]   Initializing e-ink display driver...\n", millis());
 
   // Initialize SPI with custom pins
@@ -178,31 +200,37 @@ void EInkDisplay::resetDisplay() {
   Serial.printf("[%lu]   Display reset complete\n", millis());
 }
 
-void EInkDisplay::sendCommand(uint8_t command) {
+void EInkDisplay::beginTransfer() {
+  // The controller takes no commands while it drives the panel
+  if (refreshing) {
+    waitForRefresh();
+  }
   SPI.beginTransaction(spiSettings);
-  digitalWrite(_dc, LOW);  // Command mode
   digitalWrite(_cs, LOW);  // Select chip
-  SPI.transfer(command);
+}
+
+void EInkDisplay::endTransfer() {
   digitalWrite(_cs, HIGH);  // Deselect chip
   SPI.endTransaction();
 }
 
-void EInkDisplay::sendData(uint8_t data) {
-  SPI.beginTransaction(spiSettings);
+void EInkDisplay::transferCommand(uint8_t command) {
+  digitalWrite(_dc, LOW);  // Command mode
+  SPI.transfer(command);
   digitalWrite(_dc, HIGH);  // Data mode
-  digitalWrite(_cs, LOW);   // Select chip
-  SPI.transfer(data);
-  digitalWrite(_cs, HIGH);  // Deselect chip
-  SPI.endTransaction();
 }
 
-void EInkDisplay::sendData(const uint8_t* data, uint16_t length) {
-  SPI.beginTransaction(spiSettings);
-  digitalWrite(_dc, HIGH);       // Data mode
-  digitalWrite(_cs, LOW);        // Select chip
-  SPI.writeBytes(data, length);  // Transfer all bytes
-  digitalWrite(_cs, HIGH);       // Deselect chip
-  SPI.endTransaction();
+void EInkDisplay::sendCommands(const uint8_t* sequence, uint16_t length) {
+  beginTransfer();
+  uint16_t i = 0;
+  while (i + 1 < length) {
+    transferCommand(sequence[i]);
+    const uint16_t end = i + 2 + sequence[i + 1];
+    for (i += 2; i < end && i < length; i++) {
+      SPI.transfer(sequence[i]);
+    }
+  }
+  endTransfer();
 }
 
 void EInkDisplay::waitWhileBusy(const char* comment) {
@@ -219,48 +247,68 @@ void EInkDisplay::waitWhileBusy(const char* comment) {
   }
 }
 
+void EInkDisplay::waitForRefresh() {
+  if (!refreshing)
+    return;
+  refreshing = false;
+  waitWhileBusy();
+  Serial.printf("[%lu]   Waited for %s refresh (%lu ms since start)\n", millis(), refreshName, millis() - refreshStart);
+}
+
+bool EInkDisplay::pollRefresh() {
+  if (refreshing) {
+    if (digitalRead(_busy) == HIGH) {
+      if (millis() - refreshStart <= 10000)
+        return false;
+      Serial.printf("[%lu]   Timeout waiting for busy %s\n", millis(), refreshName);
+    }
+    refreshing = false;
+    Serial.printf("[%lu]   Refresh complete: %s (%lu ms)\n", millis(), refreshName, millis() - refreshStart);
+  }
+  if (refreshUnreported) {
+    refreshUnreported = false;
+    if (refreshCallback) {
+      refreshCallback(refreshContext);
+    }
+  }
+  return true;
+}
+
 void EInkDisplay::initDisplayController() {
   Serial.printf("[%lu]   Initializing SSD1677 controller...\n", millis());
 
   const uint8_t TEMP_SENSOR_INTERNAL = 0x80;
 
   // Soft reset
-  sendCommand(CMD_SOFT_RESET);
+  const uint8_t reset[] = {CMD_SOFT_RESET, 0};
+  sendCommands(reset, sizeof(reset));
   waitWhileBusy(" CMD_SOFT_RESET");
 
-  // Temperature sensor control (internal)
-  sendCommand(CMD_TEMP_SENSOR_CONTROL);
-  sendData(TEMP_SENSOR_INTERNAL);
-
-  // Booster soft-start control (GDEQ0426T82 specific values)
-  sendCommand(CMD_BOOSTER_SOFT_START);
-  sendData(0xAE);
-  sendData(0xC7);
-  sendData(0xC3);
-  sendData(0xC0);
-  sendData(0x40);
-
-  // Driver output control: set display height (480) and scan direction
   const uint16_t HEIGHT = 480;
-  sendCommand(CMD_DRIVER_OUTPUT_CONTROL);
-  sendData((HEIGHT - 1) % 256);  // gates A0..A7 (low byte)
-  sendData((HEIGHT - 1) / 256);  // gates A8..A9 (high byte)
-  sendData(0x02);                // SM=1 (interlaced), TB=0
-
-  // Border waveform control
-  sendCommand(CMD_BORDER_WAVEFORM);
-  sendData(0x01);
+  const uint8_t setup[] = {
+      // Temperature sensor control (internal)
+      CMD_TEMP_SENSOR_CONTROL, 1, TEMP_SENSOR_INTERNAL,
+      // Booster soft-start control (GDEQ0426T82 specific values)
+      CMD_BOOSTER_SOFT_START, 5, 0xAE, 0xC7, 0xC3, 0xC0, 0x40,
+      // Driver output control: set display height (480) and scan direction
+      CMD_DRIVER_OUTPUT_CONTROL, 3,
+      (HEIGHT - 1) % 256,  // gates A0..A7 (low byte)
+      (HEIGHT - 1) / 256,  // gates A8..A9 (high byte)
+      0x02,                // SM=1 (interlaced), TB=0
+      // Border waveform control
+      CMD_BORDER_WAVEFORM, 1, 0x01};
+  sendCommands(setup, sizeof(setup));
 
   // Set up full screen RAM area
   setRamArea(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
 
   Serial.printf("[%lu]   Clearing RAM buffers...\n", millis());
-  sendCommand(CMD_AUTO_WRITE_BW_RAM);  // Auto write BW RAM
-  sendData(0xF7);
+  const uint8_t clearBw[] = {CMD_AUTO_WRITE_BW_RAM, 1, 0xF7};  // Auto write BW RAM
+  sendCommands(clearBw, sizeof(clearBw));
   waitWhileBusy(" CMD_AUTO_WRITE_BW_RAM");
 
-  sendCommand(CMD_AUTO_WRITE_RED_RAM);  // Auto write RED RAM
-  sendData(0xF7);                       // Fill with white pattern
+  const uint8_t clearRed[] = {CMD_AUTO_WRITE_RED_RAM, 1, 0xF7};  // Fill with white pattern
+  sendCommands(clearRed, sizeof(clearRed));
   waitWhileBusy(" CMD_AUTO_WRITE_RED_RAM");
 
   Serial.printf("[%lu]   SSD1677 controller initialized\n", millis());
@@ -274,36 +322,25 @@ void EInkDisplay::setRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
   // Reverse Y coordinate (gates are reversed on this display)
   y = HEIGHT - y - h;
 
-  // Set data entry mode (X increment, Y decrement for reversed gates)
-  sendCommand(CMD_DATA_ENTRY_MODE);
-  sendData(DATA_ENTRY_X_INC_Y_DEC);
-
-  // Set RAM X address range (start, end) - X is in PIXELS
-  sendCommand(CMD_SET_RAM_X_RANGE);
-  sendData(x % 256);            // start low byte
-  sendData(x / 256);            // start high byte
-  sendData((x + w - 1) % 256);  // end low byte
-  sendData((x + w - 1) / 256);  // end high byte
-
-  // Set RAM Y address range (start, end) - Y is in PIXELS
-  sendCommand(CMD_SET_RAM_Y_RANGE);
-  sendData((y + h - 1) % 256);  // start low byte
-  sendData((y + h - 1) / 256);  // start high byte
-  sendData(y % 256);            // end low byte
-  sendData(y / 256);            // end high byte
-
-  // Set RAM X address counter - X is in PIXELS
-  sendCommand(CMD_SET_RAM_X_COUNTER);
-  sendData(x % 256);  // low byte
-  sendData(x / 256);  // high byte
-
-  // Set RAM Y address counter - Y is in PIXELS
-  sendCommand(CMD_SET_RAM_Y_COUNTER);
-  sendData((y + h - 1) % 256);  // low byte
-  sendData((y + h - 1) / 256);  // high byte
+  const uint16_t xEnd = x + w - 1;
+  const uint16_t yStart = y + h - 1;
+  const uint8_t sequence[] = {
+      // Set data entry mode (X increment, Y decrement for reversed gates)
+      CMD_DATA_ENTRY_MODE, 1, DATA_ENTRY_X_INC_Y_DEC,
+      // Set RAM X address range (start, end) - X is in PIXELS
+      CMD_SET_RAM_X_RANGE, 4, low8(x), high8(x), low8(xEnd), high8(xEnd),
+      // Set RAM Y address range (start, end) - Y is in PIXELS
+      CMD_SET_RAM_Y_RANGE, 4, low8(yStart), high8(yStart), low8(y), high8(y),
+      // Set RAM X address counter - X is in PIXELS
+      CMD_SET_RAM_X_COUNTER, 2, low8(x), high8(x),
+      // Set RAM Y address counter - Y is in PIXELS
+      CMD_SET_RAM_Y_COUNTER, 2, low8(yStart), high8(yStart)};
+  sendCommands(sequence, sizeof(sequence));
 }
 
 void EInkDisplay::clearScreen(uint8_t color) {
+  if (!frameBuffer)
+    return;
   memset(frameBuffer, color, BUFFER_SIZE);
 }
 
@@ -346,14 +383,194 @@ void EInkDisplay::writeRamBuffer(uint8_t ramBuffer, const uint8_t* data, uint32_
   unsigned long startTime = millis();
   Serial.printf("[%lu]   Writing frame buffer to %s RAM (%lu bytes)...\n", startTime, bufferName, size);
 
-  sendCommand(ramBuffer);
-  sendData(data, size);
+  writeRam(ramBuffer, data, size);
 
   unsigned long duration = millis() - startTime;
   Serial.printf("[%lu]   %s RAM write complete (%lu ms)\n", millis(), bufferName, duration);
 }
 
+void EInkDisplay::writeRam(uint8_t ramBuffer, const uint8_t* data, uint32_t size) {
+  beginTransfer();
+  transferCommand(ramBuffer);
+  SPI.writeBytes(data, size);
+  endTransfer();
+}
+
+void EInkDisplay::writeRamWindow(uint8_t ramBuffer, const uint8_t* frame, const RamWindow& window) {
+  setRamArea(window.x, window.y, window.w, window.h);
+
+  // One transfer for the whole window, a row of the framebuffer at a time
+  const uint8_t* row = frame + window.y * DISPLAY_WIDTH_BYTES + window.x / 8;
+  beginTransfer();
+  transferCommand(ramBuffer);
+  for (uint16_t i = 0; i < window.h; i++, row += DISPLAY_WIDTH_BYTES) {
+    SPI.writeBytes(row, window.w / 8);
+  }
+  endTransfer();
+}
+
+EInkDisplay::RamWindow EInkDisplay::unionOf(const RamWindow& a, const RamWindow& b) {
+  uint16_t x0 = a.x < b.x ? a.x : b.x;
+  uint16_t y0 = a.y < b.y ? a.y : b.y;
+  uint16_t x1 = a.x + a.w > b.x + b.w ? a.x + a.w : b.x + b.w;
+  uint16_t y1 = a.y + a.h > b.y + b.h ? a.y + a.h : b.y + b.h;
+  return {x0, y0, static_cast<uint16_t>(x1 - x0), static_cast<uint16_t>(y1 - y0)};
+}
+
+void EInkDisplay::markDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+  // Clip to the portrait page (480 x 800)
+  int16_t left = x < 0 ? 0 : x;
+  int16_t top = y < 0 ? 0 : y;
+  int16_t right = x + w > DISPLAY_HEIGHT ? DISPLAY_HEIGHT : x + w;
+  int16_t bottom = y + h > DISPLAY_WIDTH ? DISPLAY_WIDTH : y + h;
+  if (left >= right || top >= bottom)
+    return;
+
+  // Portrait rows are RAM columns (whole bytes), portrait columns are RAM
+  // rows counted from the right edge
+  RamWindow window;
+  window.x = top & ~7;
+  window.w = ((bottom + 7) & ~7) - window.x;
+  window.y = DISPLAY_HEIGHT - right;
+  window.h = right - left;
+
+  // Fold in every window it touches; when all slots are taken, merge with the
+  // one that grows the least
+  for (;;) {
+    int8_t other = -1;
+    for (uint8_t i = 0; i < dirtyCount && other < 0; i++) {
+      if (dirty[i].x <= window.x + window.w && window.x <= dirty[i].x + dirty[i].w &&
+          dirty[i].y <= window.y + window.h && window.y <= dirty[i].y + dirty[i].h)
+        other = i;
+    }
+    if (other < 0 && dirtyCount == MAX_DIRTY_WINDOWS) {
+      uint32_t leastGrowth = UINT32_MAX;
+      for (uint8_t i = 0; i < dirtyCount; i++) {
+        RamWindow both = unionOf(dirty[i], window);
+        uint32_t growth = static_cast<uint32_t>(both.w) * both.h - static_cast<uint32_t>(dirty[i].w) * dirty[i].h;
+        if (growth < leastGrowth) {
+          leastGrowth = growth;
+          other = i;
+        }
+      }
+    }
+    if (other < 0)
+      break;
+    window = unionOf(dirty[other], window);
+    dirty[other] = dirty[--dirtyCount];
+  }
+  dirty[dirtyCount++] = window;
+}
+
+// Marked windows become the stale RED windows of the next update
+static_assert(EInkDisplay::MAX_DIRTY_WINDOWS <= EInkDisplay::MAX_DIFF_WINDOWS, "staleRed holds the marked windows");
+
+uint8_t EInkDisplay::findChangedWindows(RamWindow* windows) const {
+  uint8_t count = 0;
+  bool inRun = false;
+  for (uint16_t row = 0; row < DISPLAY_HEIGHT; row++) {
+    const uint8_t* now = frameBuffer + row * DISPLAY_WIDTH_BYTES;
+    const uint8_t* shown = frameBufferActive + row * DISPLAY_WIDTH_BYTES;
+    if (memcmp(now, shown, DISPLAY_WIDTH_BYTES) == 0) {
+      inRun = false;
+      continue;
+    }
+    uint16_t first = 0;
+    while (now[first] == shown[first])
+      first++;
+    uint16_t last = DISPLAY_WIDTH_BYTES - 1;
+    while (now[last] == shown[last])
+      last--;
+    RamWindow span = {static_cast<uint16_t>(first * 8), row, static_cast<uint16_t>((last - first + 1) * 8), 1};
+
+    if (inRun) {
+      windows[count - 1] = unionOf(windows[count - 1], span);
+      continue;
+    }
+    // A new run of changed rows; when all windows are taken, merge the two
+    // neighbours that cost the fewest extra bytes together
+    if (count == MAX_DIFF_WINDOWS) {
+      uint8_t best = 0;
+      uint32_t leastExtra = UINT32_MAX;
+      for (uint8_t i = 0; i + 1 < count; i++) {
+        RamWindow both = unionOf(windows[i], windows[i + 1]);
+        uint32_t extra = static_cast<uint32_t>(both.w) * both.h - static_cast<uint32_t>(windows[i].w) * windows[i].h -
+                         static_cast<uint32_t>(windows[i + 1].w) * windows[i + 1].h;
+        if (extra < leastExtra) {
+          leastExtra = extra;
+          best = i;
+        }
+      }
+      windows[best] = unionOf(windows[best], windows[best + 1]);
+      for (uint8_t i = best + 1; i + 1 < count; i++)
+        windows[i] = windows[i + 1];
+      count--;
+    }
+    windows[count++] = span;
+    inRun = true;
+  }
+  return count;
+}
+
+uint32_t EInkDisplay::syncStaleRed(const RamWindow& stale, const RamWindow* windows, uint8_t count, bool write) {
+  // Rows the new windows cover get their RED RAM anyway; send the others in
+  // runs of whole rows
+  uint32_t bytes = 0;
+  uint16_t runStart = 0;
+  bool inRun = false;
+  for (uint16_t row = stale.y; row <= stale.y + stale.h; row++) {
+    bool covered = row == stale.y + stale.h;  // ends the last run
+    for (uint8_t i = 0; i < count && !covered; i++) {
+      covered = windows[i].y <= row && row < windows[i].y + windows[i].h && windows[i].x <= stale.x &&
+                stale.x + stale.w <= windows[i].x + windows[i].w;
+    }
+    if (!covered && !inRun) {
+      runStart = row;
+      inRun = true;
+    } else if (covered && inRun) {
+      RamWindow run = {stale.x, runStart, stale.w, static_cast<uint16_t>(row - runStart)};
+      bytes += (run.w / 8) * run.h;
+      if (write)
+        writeRamWindow(CMD_WRITE_RAM_RED, frameBufferActive, run);
+      inRun = false;
+    }
+  }
+  return bytes;
+}
+
+bool EInkDisplay::uploadWindows(const RamWindow* windows, uint8_t count) {
+  uint32_t bytes = 0;
+  for (uint8_t i = 0; i < count; i++)
+    bytes += 2 * (windows[i].w / 8) * windows[i].h;
+  for (uint8_t i = 0; i < staleRedCount; i++)
+    bytes += syncStaleRed(staleRed[i], windows, count, false);
+  if (bytes >= 2 * BUFFER_SIZE)
+    return false;
+
+  unsigned long startTime = millis();
+  // BW RAM gets the new frame in the windows. RED RAM must hold the
+  // displayed frame wherever the refresh compares: in the windows and in
+  // those of the last fast update, which still hold the frame before it.
+  // Everywhere else both already match the panel.
+  for (uint8_t i = 0; i < count; i++)
+    writeRamWindow(CMD_WRITE_RAM_BW, frameBuffer, windows[i]);
+  for (uint8_t i = 0; i < staleRedCount; i++)
+    syncStaleRed(staleRed[i], windows, count, true);
+  for (uint8_t i = 0; i < count; i++) {
+    writeRamWindow(CMD_WRITE_RAM_RED, frameBufferActive, windows[i]);
+    staleRed[i] = windows[i];
+  }
+  staleRedCount = count;
+  lastUploadBytes = bytes;
+
+  Serial.printf("[%lu]   Wrote %u RAM windows (%lu bytes, %lu ms)\n", millis(), count, (unsigned long)bytes,
+                millis() - startTime);
+  return true;
+}
+
 void EInkDisplay::setFramebuffer(const uint8_t* bwBuffer) {
+  if (!frameBuffer)
+    return;
   memcpy(frameBuffer, bwBuffer, BUFFER_SIZE);
 }
 
@@ -373,22 +590,43 @@ void EInkDisplay::grayscaleRevert() {
 }
 
 void EInkDisplay::copyGrayscaleLsbBuffers(const uint8_t* lsbBuffer) {
+  ramHoldsFrame = false;
+  redHoldsShown = false;
   setRamArea(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
   writeRamBuffer(CMD_WRITE_RAM_BW, lsbBuffer, BUFFER_SIZE);
 }
 
 void EInkDisplay::copyGrayscaleMsbBuffers(const uint8_t* msbBuffer) {
+  ramHoldsFrame = false;
+  redHoldsShown = false;
   setRamArea(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
   writeRamBuffer(CMD_WRITE_RAM_RED, msbBuffer, BUFFER_SIZE);
 }
 
+void EInkDisplay::writeGrayscaleStrip(uint16_t top, uint16_t height, const uint8_t* lsbStrip,
+                                      const uint8_t* msbStrip) {
+  ramHoldsFrame = false;
+  redHoldsShown = false;
+  // Portrait rows are landscape columns: the strip is a band of RAM columns
+  setRamArea(top, 0, height, DISPLAY_HEIGHT);
+  writeRamBuffer(CMD_WRITE_RAM_BW, lsbStrip, (height / 8) * DISPLAY_HEIGHT);
+  writeRamBuffer(CMD_WRITE_RAM_RED, msbStrip, (height / 8) * DISPLAY_HEIGHT);
+}
+
 void EInkDisplay::copyGrayscaleBuffers(const uint8_t* lsbBuffer, const uint8_t* msbBuffer) {
+  ramHoldsFrame = false;
+  redHoldsShown = false;
   setRamArea(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
   writeRamBuffer(CMD_WRITE_RAM_BW, lsbBuffer, BUFFER_SIZE);
   writeRamBuffer(CMD_WRITE_RAM_RED, msbBuffer, BUFFER_SIZE);
 }
 
 void EInkDisplay::displayBuffer(RefreshMode mode) {
+  if (banded) {
+    Serial.printf("[%lu]   ERROR: displayBuffer in banded mode\n", millis());
+    return;
+  }
+
   if (!isScreenOn) {
     // Force half refresh if screen is off
     mode = HALF_REFRESH;
@@ -400,19 +638,53 @@ void EInkDisplay::displayBuffer(RefreshMode mode) {
     grayscaleRevert();
   }
 
-  // Set up full screen RAM area
-  setRamArea(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+  // Nothing to compare with: the framebuffers came back from banded mode and
+  // the controller lost the frame on the panel
+  if (mode == FAST_REFRESH && !activeHoldsShown && !redHoldsShown) {
+    mode = HALF_REFRESH;
+  }
 
-  if (mode != FAST_REFRESH) {
-    // For full refresh, write to both buffers before refresh
-    writeRamBuffer(CMD_WRITE_RAM_BW, frameBuffer, BUFFER_SIZE);
-    writeRamBuffer(CMD_WRITE_RAM_RED, frameBuffer, BUFFER_SIZE);
-  } else {
-    // For fast refresh, write to BW buffer only
-    writeRamBuffer(CMD_WRITE_RAM_BW, frameBuffer, BUFFER_SIZE);
-    writeRamBuffer(CMD_WRITE_RAM_RED, frameBufferActive, BUFFER_SIZE);
+  // A fast refresh only needs what changed: the marked windows, or else the
+  // rows that differ from the frame on the panel
+  bool sent = false;
+  if (mode == FAST_REFRESH && ramHoldsFrame && activeHoldsShown) {
+    if (dirtyCount > 0) {
+      sent = uploadWindows(dirty, dirtyCount);
+    } else {
+      RamWindow changed[MAX_DIFF_WINDOWS];
+      uint8_t changedCount = findChangedWindows(changed);
+      sent = uploadWindows(changed, changedCount);
+    }
   }
 
+  if (!sent) {
+    // Set up full screen RAM area
+    setRamArea(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+
+    if (mode != FAST_REFRESH) {
+      // For full refresh, write to both buffers before refresh
+      writeRamBuffer(CMD_WRITE_RAM_BW, frameBuffer, BUFFER_SIZE);
+      writeRamBuffer(CMD_WRITE_RAM_RED, frameBuffer, BUFFER_SIZE);
+      staleRedCount = 0;
+      lastUploadBytes = 2 * BUFFER_SIZE;
+    } else {
+      // For fast refresh, write to BW buffer only; RED RAM gets the frame on
+      // the panel unless it already holds it
+      writeRamBuffer(CMD_WRITE_RAM_BW, frameBuffer, BUFFER_SIZE);
+      lastUploadBytes = BUFFER_SIZE;
+      if (!redHoldsShown) {
+        writeRamBuffer(CMD_WRITE_RAM_RED, frameBufferActive, BUFFER_SIZE);
+        lastUploadBytes += BUFFER_SIZE;
+      }
+      staleRed[0] = {0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT};
+      staleRedCount = 1;
+    }
+  }
+  dirtyCount = 0;
+  ramHoldsFrame = true;
+  redHoldsShown = staleRedCount == 0;
+  activeHoldsShown = true;
+
   // swap active buffer for next time
   swapBuffers();
 
@@ -420,6 +692,100 @@ void EInkDisplay::displayBuffer(RefreshMode mode) {
   refreshDisplay(mode, false);
 }
 
+void EInkDisplay::beginBanded() {
+  if (banded)
+    return;
+
+  // The frame on the panel only survives in the controller: get it into
+  // RED RAM while frameBufferActive still has it
+  if (inGrayscaleMode) {
+    inGrayscaleMode = false;
+    grayscaleRevert();
+  }
+  if (!redHoldsShown && activeHoldsShown) {
+    setRamArea(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    writeRamBuffer(CMD_WRITE_RAM_RED, frameBufferActive, BUFFER_SIZE);
+    staleRedCount = 0;
+    redHoldsShown = true;
+  }
+
+  banded = true;
+  frameBuffer = nullptr;
+  frameBufferActive = nullptr;
+  activeHoldsShown = false;
+  dirtyCount = 0;
+  Serial.printf("[%lu]   Banded mode: %lu bytes of frame buffers lent out\n", millis(), 2 * (unsigned long)BUFFER_SIZE);
+}
+
+void EInkDisplay::endBanded() {
+  if (!banded)
+    return;
+  banded = false;
+  frameBuffer = frameBuffer0;
+  frameBufferActive = frameBuffer1;
+  memset(frameBuffer0, 0xFF, BUFFER_SIZE);
+  memset(frameBuffer1, 0xFF, BUFFER_SIZE);
+  // Neither buffer holds the frame on the panel; RED RAM may
+  activeHoldsShown = false;
+}
+
+void EInkDisplay::beginBands(BandTarget target, RefreshMode mode) {
+  if (target == NEXT_FRAME && !isScreenOn) {
+    // Force half refresh if screen is off
+    mode = HALF_REFRESH;
+  }
+  if (inGrayscaleMode) {
+    inGrayscaleMode = false;
+    grayscaleRevert();
+  }
+  // Nothing to compare a fast refresh with
+  if (target == NEXT_FRAME && mode == FAST_REFRESH && !redHoldsShown) {
+    mode = HALF_REFRESH;
+  }
+  bandTarget = target;
+  bandMode = mode;
+  lastUploadBytes = 0;
+}
+
+void EInkDisplay::writeBand(int16_t top, int16_t height, const uint8_t* band) {
+  const uint32_t size = static_cast<uint32_t>(height / 8) * DISPLAY_HEIGHT;
+  // Portrait rows are landscape columns: the band is a band of RAM columns
+  setRamArea(top, 0, height, DISPLAY_HEIGHT);
+  if (bandTarget == SHOWN_FRAME) {
+    writeRam(CMD_WRITE_RAM_RED, band, size);
+    lastUploadBytes += size;
+    return;
+  }
+  // The RED RAM of a fast refresh keeps the frame on the panel
+  writeRam(CMD_WRITE_RAM_BW, band, size);
+  lastUploadBytes += size;
+  if (bandMode != FAST_REFRESH) {
+    writeRam(CMD_WRITE_RAM_RED, band, size);
+    lastUploadBytes += size;
+  }
+}
+
+void EInkDisplay::endBands() {
+  Serial.printf("[%lu]   Wrote %s in bands (%lu bytes)\n", millis(),
+                bandTarget == SHOWN_FRAME ? "shown frame to RED RAM" : "frame", (unsigned long)lastUploadBytes);
+  if (bandTarget == SHOWN_FRAME) {
+    staleRedCount = 0;
+    redHoldsShown = true;
+    return;
+  }
+
+  ramHoldsFrame = true;
+  dirtyCount = 0;
+  if (bandMode == FAST_REFRESH) {
+    staleRed[0] = {0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT};
+    staleRedCount = 1;
+  } else {
+    staleRedCount = 0;
+  }
+  redHoldsShown = staleRedCount == 0;
+  refreshDisplay(bandMode, false);
+}
+
 void EInkDisplay::displayGrayBuffer(bool turnOffScreen) {
   drawGrayscale = false;
   inGrayscaleMode = true;
@@ -431,9 +797,14 @@ void EInkDisplay::displayGrayBuffer(bool turnOffScreen) {
 }
 
 void EInkDisplay::refreshDisplay(RefreshMode mode, bool turnOffScreen) {
+  // The update control commands and the activation go out in one transfer
+  uint8_t sequence[11];
+  uint8_t length = 0;
+
   // Configure Display Update Control 1
-  sendCommand(CMD_DISPLAY_UPDATE_CTRL1);
-  sendData((mode == FAST_REFRESH) ? CTRL1_NORMAL : CTRL1_BYPASS_RED);  // Configure buffer comparison mode
+  sequence[length++] = CMD_DISPLAY_UPDATE_CTRL1;
+  sequence[length++] = 1;
+  sequence[length++] = (mode == FAST_REFRESH) ? CTRL1_NORMAL : CTRL1_BYPASS_RED;  // Configure buffer comparison mode
 
   // best guess at display mode bits:
   // bit | hex | name                    | effect
@@ -466,8 +837,9 @@ void EInkDisplay::refreshDisplay(RefreshMode mode, bool turnOffScreen) {
     displayMode |= 0x34;
   } else if (mode == HALF_REFRESH) {
     // Write high temp to the register for a faster refresh
-    sendCommand(CMD_WRITE_TEMP);
-    sendData(0x5A);
+    sequence[length++] = CMD_WRITE_TEMP;
+    sequence[length++] = 1;
+    sequence[length++] = 0x5A;
     displayMode |= 0xD4;
   } else {  // FAST_REFRESH
     displayMode |= customLutActive ? 0x0C : 0x1C;
@@ -476,10 +848,22 @@ void EInkDisplay::refreshDisplay(RefreshMode mode, bool turnOffScreen) {
   // Power on and refresh display
   const char* refreshType = (mode == FULL_REFRESH) ? "full" : (mode == HALF_REFRESH) ? "half" : "fast";
   Serial.printf("[%lu]   Powering on display 0x%02X (%s refresh)...\n", millis(), displayMode, refreshType);
-  sendCommand(CMD_DISPLAY_UPDATE_CTRL2);
-  sendData(displayMode);
-
-  sendCommand(CMD_MASTER_ACTIVATION);
+  sequence[length++] = CMD_DISPLAY_UPDATE_CTRL2;
+  sequence[length++] = 1;
+  sequence[length++] = displayMode;
+  sequence[length++] = CMD_MASTER_ACTIVATION;
+  sequence[length++] = 0;
+  sendCommands(sequence, length);
+
+  if (asyncRefresh) {
+    // Let the caller go on while the panel updates (see pollRefresh())
+    refreshing = true;
+    refreshUnreported = true;
+    refreshStart = millis();
+    refreshName = refreshType;
+    Serial.printf("[%lu]   Display refresh started\n", millis());
+    return;
+  }
 
   // Wait for display to finish updating
   Serial.printf("[%lu]   Waiting for display refresh...\n", millis());
@@ -490,23 +874,27 @@ void EInkDisplay::setCustomLUT(bool enabled, const unsigned char* lutData) {
   if (enabled) {
     Serial.printf("[%lu]   Loading custom LUT...\n", millis());
 
-    // Load custom LUT (first 105 bytes: VS + TP/RP + frame rate)
-    sendCommand(CMD_WRITE_LUT);
+    // One transfer: the custom LUT (first 105 bytes: VS + TP/RP + frame
+    // rate), then the voltage values from bytes 105-109
+    uint8_t sequence[2 + 105 + 2 + 1 + 2 + 3 + 2 + 1];
+    uint8_t* out = sequence;
+    *out++ = CMD_WRITE_LUT;
+    *out++ = 105;
     for (uint16_t i = 0; i < 105; i++) {
-      sendData(pgm_read_byte(&lutData[i]));
+      *out++ = pgm_read_byte(&lutData[i]);
     }
-
-    // Set voltage values from bytes 105-109
-    sendCommand(CMD_GATE_VOLTAGE);  // VGH
-    sendData(pgm_read_byte(&lutData[105]));
-
-    sendCommand(CMD_SOURCE_VOLTAGE);         // VSH1, VSH2, VSL
-    sendData(pgm_read_byte(&lutData[106]));  // VSH1
-    sendData(pgm_read_byte(&lutData[107]));  // VSH2
-    sendData(pgm_read_byte(&lutData[108]));  // VSL
-
-    sendCommand(CMD_WRITE_VCOM);  // VCOM
-    sendData(pgm_read_byte(&lutData[109]));
+    *out++ = CMD_GATE_VOLTAGE;  // VGH
+    *out++ = 1;
+    *out++ = pgm_read_byte(&lutData[105]);
+    *out++ = CMD_SOURCE_VOLTAGE;  // VSH1, VSH2, VSL
+    *out++ = 3;
+    *out++ = pgm_read_byte(&lutData[106]);  // VSH1
+    *out++ = pgm_read_byte(&lutData[107]);  // VSH2
+    *out++ = pgm_read_byte(&lutData[108]);  // VSL
+    *out++ = CMD_WRITE_VCOM;                // VCOM
+    *out++ = 1;
+    *out++ = pgm_read_byte(&lutData[109]);
+    sendCommands(sequence, sizeof(sequence));
 
     customLutActive = true;
     Serial.printf("[%lu]   Custom LUT loaded\n", millis());
@@ -517,15 +905,21 @@ void EInkDisplay::setCustomLUT(bool enabled, const unsigned char* lutData) {
 }
 
 void EInkDisplay::deepSleep() {
+  ramHoldsFrame = false;
+  redHoldsShown = false;
   // Enter deep sleep mode
   Serial.printf("[%lu]   Entering deep sleep mode...\n", millis());
-  sendCommand(CMD_DEEP_SLEEP);
-  sendData(0x01);  // Enter deep sleep
+  const uint8_t sleep[] = {CMD_DEEP_SLEEP, 1, 0x01};  // Enter deep sleep
+  sendCommands(sleep, sizeof(sleep));
 }
 
 void EInkDisplay::saveFrameBufferAsPBM(const char* filename) {
 #ifndef ARDUINO
   const uint8_t* buffer = getFrameBuffer();
+  if (!buffer) {
+    Serial.printf("No frame buffer to save to %s (banded mode)\n", filename);
+    return;
+  }
 
   std::ofstream file(filename, std::ios::binary);
   if (!file) {
@@ -42,12 +42,101 @@ class EInkDisplay {
   void copyGrayscaleBuffers(const uint8_t* lsbBuffer, const uint8_t* msbBuffer);
   void copyGrayscaleLsbBuffers(const uint8_t* lsbBuffer);
   void copyGrayscaleMsbBuffers(const uint8_t* msbBuffer);
+  // Write portrait rows [top, top + height) of both grayscale planes (strips
+  // of height / 8 bytes per landscape row, see TextRenderer::setFrameStrip)
+  void writeGrayscaleStrip(uint16_t top, uint16_t height, const uint8_t* lsbStrip, const uint8_t* msbStrip);
+
+  // Partial updates: mark the portrait rectangles that differ from the frame
+  // on the panel before displayBuffer(). A fast refresh then uploads only
+  // their windows (RAM columns rounded out to whole bytes) instead of the
+  // whole frame; the rest of the framebuffer must still hold what is shown.
+  // Without marks, a fast refresh compares the frame with the one on the
+  // panel and sends only the rows that changed. Other modes, or a controller
+  // RAM that does not hold the last frame (after grayscale or at start),
+  // ignore both and send everything.
+  static const uint8_t MAX_DIRTY_WINDOWS = 4;
+  // Windows of changed rows kept by the comparison (nearby runs are merged)
+  static const uint8_t MAX_DIFF_WINDOWS = 8;
+  void markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+  void clearDirty() {
+    dirtyCount = 0;
+  }
+  uint8_t getDirtyWindowCount() const {
+    return dirtyCount;
+  }
 
   void displayBuffer(RefreshMode mode = FAST_REFRESH);
+
+  // Banded mode: frames are drawn a band of portrait rows at a time into a
+  // small buffer and streamed to the controller RAM, so the two framebuffers
+  // are free for other use. Between beginBanded() and endBanded(),
+  // getFrameBuffer() returns nullptr and getSpareBuffer(0 or 1) the
+  // framebuffer memory (BUFFER_SIZE bytes each); displayBuffer() does
+  // nothing. The frames on the panel are kept in the controller's RED RAM
+  // for fast refreshes instead of in frameBufferActive.
+  static const int16_t BAND_ROWS = 80;
+  static const uint32_t BAND_BYTES = BAND_ROWS / 8 * DISPLAY_HEIGHT;
+  void beginBanded();
+  void endBanded();
+  bool isBanded() const {
+    return banded;
+  }
+  uint8_t* getSpareBuffer(uint8_t index) {
+    return banded ? (index == 0 ? frameBuffer0 : frameBuffer1) : nullptr;
+  }
+  // Room for a band (or a BAND_ROWS strip of each grayscale plane): two
+  // buffers of BAND_BYTES
+  uint8_t* getBandBuffer() {
+    return bandBuffer;
+  }
+
+  // Send a frame band by band: beginBands(), then writeBand() for each band
+  // of portrait rows [top, top + height) (height / 8 bytes per landscape row,
+  // see TextRenderer::setFrameStrip) top to bottom, then endBands().
+  // NEXT_FRAME displays the frame with `mode` (a fast refresh becomes a half
+  // one if the controller does not hold the frame on the panel);
+  // SHOWN_FRAME puts the frame already on the panel back into RED RAM
+  // (after grayscale, which overwrites it) without a refresh.
+  enum BandTarget { NEXT_FRAME, SHOWN_FRAME };
+  void beginBands(BandTarget target, RefreshMode mode = FAST_REFRESH);
+  void writeBand(int16_t top, int16_t height, const uint8_t* band);
+  void endBands();
+  // RED RAM holds the frame on the panel, so a fast refresh needs only the
+  // new frame
+  bool holdsShownFrame() const {
+    return redHoldsShown;
+  }
+
   void displayGrayBuffer(bool turnOffScreen = false);
 
   void refreshDisplay(RefreshMode mode = FAST_REFRESH, bool turnOffScreen = false);
 
+  // Asynchronous refreshes: while enabled, a refresh (of displayBuffer(),
+  // endBands(), displayGrayBuffer() ...) starts the waveform and returns
+  // instead of waiting the 0.4-1.7 s it takes. Anything that talks to the
+  // controller before it is done waits for it first, so calls keep their
+  // order. pollRefresh(), called from the main loop, reads the BUSY line and
+  // calls the completion callback once the panel is idle after the last
+  // refresh started (a refresh that was waited for and followed by another
+  // one is not reported on its own). The callback is only called from
+  // pollRefresh(), never from inside another display call.
+  typedef void (*RefreshCallback)(void* context);
+  void setAsyncRefresh(bool enabled) {
+    asyncRefresh = enabled;
+  }
+  void setRefreshCallback(RefreshCallback callback, void* context) {
+    refreshCallback = callback;
+    refreshContext = context;
+  }
+  // A refresh is running (as of the last look at the BUSY line)
+  bool isRefreshing() const {
+    return refreshing;
+  }
+  // True when no refresh is running; reports a finished one to the callback
+  bool pollRefresh();
+  // Wait until the running refresh (if any) is done
+  void waitForRefresh();
+
   // debug function
   void grayscaleRevert();
 
@@ -62,6 +151,12 @@ class EInkDisplay {
     return frameBuffer;
   }
 
+  // Bytes written to controller RAM by the last displayBuffer() or banded
+  // frame
+  uint32_t getLastUploadBytes() const {
+    return lastUploadBytes;
+  }
+
   // Save the current framebuffer to a PBM file (desktop/test builds only)
   void saveFrameBufferAsPBM(const char* filename);
 
@@ -69,33 +164,87 @@ class EInkDisplay {
   // Pin configuration
   int8_t _sclk, _mosi, _cs, _dc, _rst, _busy;
 
-  // Frame buffer (statically allocated)
-  uint8_t frameBuffer0[BUFFER_SIZE];
-  uint8_t frameBuffer1[BUFFER_SIZE];
+  // Frame buffers (allocated in begin(), lent out in banded mode)
+  uint8_t* frameBuffer0 = nullptr;
+  uint8_t* frameBuffer1 = nullptr;
+  uint8_t bandBuffer[2 * BAND_BYTES];
+  bool banded = false;
+  BandTarget bandTarget = NEXT_FRAME;
+  RefreshMode bandMode = FAST_REFRESH;
 
   uint8_t* frameBuffer;
   uint8_t* frameBufferActive;
 
+  // Rectangle of controller RAM in landscape pixels (x and w multiples of 8)
+  struct RamWindow {
+    uint16_t x, y, w, h;
+  };
+
+  // Windows marked since the last displayBuffer()
+  RamWindow dirty[MAX_DIRTY_WINDOWS];
+  uint8_t dirtyCount = 0;
+  // Where RED RAM may differ from BW RAM: the windows of the last fast
+  // update, which still hold the frame before it
+  RamWindow staleRed[MAX_DIFF_WINDOWS];
+  uint8_t staleRedCount = 0;
+  // BW RAM holds the displayed frame (false after grayscale writes)
+  bool ramHoldsFrame = false;
+  // RED RAM holds the displayed frame everywhere
+  bool redHoldsShown = false;
+  // frameBufferActive holds the displayed frame (not after banded mode)
+  bool activeHoldsShown = false;
+  uint32_t lastUploadBytes = 0;
+
+  // Asynchronous refresh state: the running refresh, since when, and
+  // whether the callback still has to hear about the panel going idle
+  bool asyncRefresh = false;
+  bool refreshing = false;
+  bool refreshUnreported = false;
+  unsigned long refreshStart = 0;
+  const char* refreshName = "";
+  RefreshCallback refreshCallback = nullptr;
+  void* refreshContext = nullptr;
+
   // SPI settings
   SPISettings spiSettings;
 
   // State
-  bool isScreenOn;
+  bool isScreenOn = false;
   bool customLutActive;
-  bool inGrayscaleMode;
+  bool inGrayscaleMode = false;
   bool drawGrayscale;
 
   // Low-level display control
   void resetDisplay();
-  void sendCommand(uint8_t command);
-  void sendData(uint8_t data);
-  void sendData(const uint8_t* data, uint16_t length);
+  // Each transfer is one SPI transaction with the chip selected throughout;
+  // the controller reads D/C per byte, so commands, their parameters and RAM
+  // data share it instead of costing a transaction each
+  void beginTransfer();
+  void endTransfer();
+  void transferCommand(uint8_t command);
+  // Send commands with their parameters in one transfer: `sequence` is
+  // {command, parameter count, parameters...} repeated
+  void sendCommands(const uint8_t* sequence, uint16_t length);
+  // Write `size` bytes to BW or RED RAM (at the RAM area set) in one transfer
+  void writeRam(uint8_t ramBuffer, const uint8_t* data, uint32_t size);
   void waitWhileBusy(const char* comment = nullptr);
   void initDisplayController();
 
   // Low-level display operations
   void setRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
   void writeRamBuffer(uint8_t ramBuffer, const uint8_t* data, uint32_t size);
+  static RamWindow unionOf(const RamWindow& a, const RamWindow& b);
+  // Set the RAM area to `window` and write its part of `frame` row by row
+  void writeRamWindow(uint8_t ramBuffer, const uint8_t* frame, const RamWindow& window);
+  // Windows around the rows where frameBuffer differs from frameBufferActive
+  // (at most MAX_DIFF_WINDOWS); returns their number
+  uint8_t findChangedWindows(RamWindow* windows) const;
+  // Bring the RED RAM of `stale` up to the displayed frame where `windows`
+  // will not (only counting if !write); returns the bytes
+  uint32_t syncStaleRed(const RamWindow& stale, const RamWindow* windows, uint8_t count, bool write);
+  // Upload `windows` of the frame for a fast refresh; false if sending the
+  // whole frame is cheaper
+  bool uploadWindows(const RamWindow* windows, uint8_t count);
 };
 
 #endif
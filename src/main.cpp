@@ -185,6 +185,9 @@ void loop() {
     lastMemPrint = millis();
   }
 
+  // Report a finished display refresh to whoever waits for it
+  einkDisplay.pollRefresh();
+
   // Button state is updated by background task
   uiManager.handleButtons(buttons);
 
@@ -193,6 +196,11 @@ void loop() {
     enterDeepSleep();
   }
 
+  // Background work (e.g. pagination) only while no button is held
+  if (!buttons.isAnyDown()) {
+    uiManager.idle(buttons);
+  }
+
   // Small delay to avoid busy loop
   delay(10);
 }
@@ -0,0 +1,252 @@
+#include "FontPack.h"
+
+#include <cstring>
+#include <new>
+
+#include "SyntheticFont.h"
+
+static uint16_t readU16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t readU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+FontPack::FontPack(const char* path, size_t cacheBytes) {
+  memset(&font_, 0, sizeof(font_));
+  name_[0] = '\0';
+  file_ = SD.open(path);
+  if (!file_) {
+    return;
+  }
+  valid_ = load(cacheBytes);
+  if (!valid_) {
+    file_.close();
+  }
+}
+
+FontPack::~FontPack() {
+  // The glyph table and synthetic font caches are keyed by font address
+  releaseSyntheticFonts(&font_);
+  releaseGlyphTable(&font_);
+  if (file_) {
+    file_.close();
+  }
+  delete[] glyphs_;
+  delete[] blocks_;
+  delete[] slots_;
+  delete[] cache_;
+}
+
+bool FontPack::readAt(uint32_t offset, uint8_t* out, size_t length) {
+  return file_.seek(offset) && file_.read(out, length) == length;
+}
+
+bool FontPack::load(size_t cacheBytes) {
+  uint8_t header[HEADER_SIZE];
+  if (!readAt(0, header, HEADER_SIZE) || memcmp(header, "MRFP", 4) != 0 || header[4] != VERSION) {
+    return false;
+  }
+  const uint8_t flags = header[5];
+  const uint16_t glyphCount = readU16(header + 10);
+  blockCount_ = readU16(header + 12);
+  if (glyphCount == 0 || blockCount_ == 0 || header[8] > static_cast<uint8_t>(FontStyle::BOLD_ITALIC)) {
+    return false;
+  }
+  memcpy(name_, header + 16, NAME_SIZE);
+  name_[NAME_SIZE] = '\0';
+  const bool compressed = (flags & FONT_FLAG_COMPRESSED) != 0;
+  if (compressed && (flags & FONT_FLAG_COLUMN_MAJOR)) {
+    return false;
+  }
+  grayscale_ = (flags & FLAG_GRAYSCALE) != 0;
+  planeCount_ = grayscale_ && !compressed ? 3 : 1;
+
+  glyphs_ = new (std::nothrow) SimpleGFXglyph[glyphCount];
+  blocks_ = new (std::nothrow) Block[blockCount_];
+  if (!glyphs_ || !blocks_) {
+    return false;
+  }
+
+  // Tables are read a few records at a time
+  const size_t fileSize = file_.size();
+  uint8_t records[16 * BLOCK_RECORD_SIZE];
+  uint32_t offset = HEADER_SIZE;
+  uint16_t nextGlyph = 0;
+  for (size_t i = 0; i < blockCount_; i++) {
+    if (i % 16 == 0) {
+      size_t count = blockCount_ - i < 16 ? blockCount_ - i : 16;
+      if (!readAt(offset, records, count * BLOCK_RECORD_SIZE)) {
+        return false;
+      }
+      offset += count * BLOCK_RECORD_SIZE;
+    }
+    const uint8_t* r = records + (i % 16) * BLOCK_RECORD_SIZE;
+    Block& block = blocks_[i];
+    block.number = readU16(r);
+    block.firstGlyph = readU16(r + 2);
+    block.glyphCount = readU16(r + 4);
+    block.planeBytes = readU16(r + 6);
+    block.dataOffset = readU32(r + 8);
+    block.slot[0] = block.slot[1] = block.slot[2] = -1;
+    // Blocks cover the glyph table in order and their data lies in the file
+    if (block.firstGlyph != nextGlyph || block.glyphCount == 0 || (i > 0 && block.number <= blocks_[i - 1].number) ||
+        static_cast<uint64_t>(block.dataOffset) + block.planeBytes * planeCount_ > fileSize) {
+      return false;
+    }
+    nextGlyph += block.glyphCount;
+    if (block.planeBytes > slotBytes_) {
+      slotBytes_ = block.planeBytes;
+    }
+  }
+  if (nextGlyph != glyphCount) {
+    return false;
+  }
+
+  size_t blockIndex = 0;
+  for (uint16_t i = 0; i < glyphCount; i++) {
+    if (i % 16 == 0) {
+      size_t count = glyphCount - i < 16 ? glyphCount - i : 16;
+      if (!readAt(offset, records, count * GLYPH_RECORD_SIZE)) {
+        return false;
+      }
+      offset += count * GLYPH_RECORD_SIZE;
+    }
+    const uint8_t* r = records + (i % 16) * GLYPH_RECORD_SIZE;
+    SimpleGFXglyph& glyph = glyphs_[i];
+    glyph.codepoint = readU32(r);
+    glyph.bitmapOffset = readU16(r + 4);
+    glyph.width = r[6];
+    glyph.height = r[7];
+    glyph.xAdvance = r[8];
+    glyph.xOffset = static_cast<int8_t>(r[9]);
+    glyph.yOffset = static_cast<int8_t>(r[10]);
+
+    // Each glyph belongs to the block of its codepoint and fits in its plane
+    while (i >= blocks_[blockIndex].firstGlyph + blocks_[blockIndex].glyphCount) {
+      blockIndex++;
+    }
+    const Block& block = blocks_[blockIndex];
+    // A stream's length is only known once it is read (see checkStreams())
+    size_t bytes = compressed                         ? 0
+                   : (flags & FONT_FLAG_COLUMN_MAJOR) ? glyph.width * ((glyph.height + 7) / 8)
+                                                      : ((glyph.width + 7) / 8) * glyph.height;
+    if ((glyph.codepoint >> BLOCK_SHIFT) != block.number || (i > 0 && glyph.codepoint <= glyphs_[i - 1].codepoint) ||
+        glyph.bitmapOffset + bytes > block.planeBytes) {
+      return false;
+    }
+  }
+
+  slotCount_ = slotBytes_ ? cacheBytes / slotBytes_ : 0;
+  if (slotCount_ < MIN_CACHE_SLOTS) {
+    slotCount_ = MIN_CACHE_SLOTS;
+  }
+  cache_ = new (std::nothrow) uint8_t[slotCount_ * slotBytes_];
+  slots_ = new (std::nothrow) Slot[slotCount_];
+  if (!cache_ || !slots_) {
+    return false;
+  }
+  for (size_t i = 0; i < slotCount_; i++) {
+    slots_[i].used = false;
+    slots_[i].lastUse = 0;
+  }
+
+  // Bitmap pointers stay null: TextRenderer reads the planes through getPlane()
+  font_.glyph = glyphs_;
+  font_.glyphCount = glyphCount;
+  font_.yAdvance = header[6];
+  font_.name = name_;
+  font_.size = header[7];
+  font_.style = static_cast<FontStyle>(header[8]);
+  font_.flags = flags & (FONT_FLAG_COLUMN_MAJOR | FONT_FLAG_COMPRESSED);
+  font_.pack = this;
+  return true;
+}
+
+int FontPack::findBlock(uint16_t glyphIndex) {
+  // Consecutive glyphs are mostly from the same block
+  if (lastBlock_ >= 0) {
+    const Block& last = blocks_[lastBlock_];
+    if (glyphIndex >= last.firstGlyph && glyphIndex < last.firstGlyph + last.glyphCount) {
+      return lastBlock_;
+    }
+  }
+  size_t low = 0;
+  size_t high = blockCount_;
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    if (blocks_[mid].firstGlyph + blocks_[mid].glyphCount <= glyphIndex) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == blockCount_) {
+    return -1;
+  }
+  lastBlock_ = static_cast<int>(low);
+  return lastBlock_;
+}
+
+const uint8_t* FontPack::getPlane(uint16_t glyphIndex, Plane plane) {
+  if (!valid_ || plane >= planeCount_) {
+    return nullptr;
+  }
+  int blockIndex = findBlock(glyphIndex);
+  if (blockIndex < 0) {
+    return nullptr;
+  }
+  Block& block = blocks_[blockIndex];
+  if (block.slot[plane] >= 0) {
+    ++cacheHits_;
+    slots_[block.slot[plane]].lastUse = ++useTick_;
+    return cache_ + block.slot[plane] * slotBytes_;
+  }
+
+  ++cacheMisses_;
+  size_t victim = 0;
+  for (size_t i = 0; i < slotCount_; i++) {
+    if (!slots_[i].used) {
+      victim = i;
+      break;
+    }
+    if (slots_[i].lastUse < slots_[victim].lastUse) {
+      victim = i;
+    }
+  }
+  Slot& slot = slots_[victim];
+  if (slot.used) {
+    blocks_[slot.block].slot[slot.plane] = -1;
+    slot.used = false;
+  }
+  uint8_t* data = cache_ + victim * slotBytes_;
+  if (!readAt(block.dataOffset + static_cast<uint32_t>(plane) * block.planeBytes, data, block.planeBytes) ||
+      ((font_.flags & FONT_FLAG_COMPRESSED) && !checkStreams(block, data))) {
+    return nullptr;
+  }
+  slot.block = static_cast<uint16_t>(blockIndex);
+  slot.plane = static_cast<uint8_t>(plane);
+  slot.used = true;
+  slot.lastUse = ++useTick_;
+  block.slot[plane] = static_cast<int16_t>(victim);
+  return data;
+}
+
+bool FontPack::checkStreams(const Block& block, const uint8_t* data) const {
+  for (uint16_t i = block.firstGlyph; i < block.firstGlyph + block.glyphCount; i++) {
+    const SimpleGFXglyph& glyph = glyphs_[i];
+    size_t bytes;
+    if (!GlyphDecoder::measure(data + glyph.bitmapOffset, block.planeBytes - glyph.bitmapOffset,
+                               static_cast<uint32_t>(glyph.width) * glyph.height, bytes)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t FontPack::getMemoryBytes() const {
+  return sizeof(FontPack) + font_.glyphCount * sizeof(SimpleGFXglyph) + blockCount_ * sizeof(Block) +
+         slotCount_ * (slotBytes_ + sizeof(Slot));
+}
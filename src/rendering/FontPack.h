@@ -0,0 +1,140 @@
+#ifndef FONT_PACK_H
+#define FONT_PACK_H
+
+#include <SD.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SimpleFont.h"
+
+/**
+ * FontPack - One font variant loaded from a binary font pack (.mfp) on SD.
+ *
+ * Glyph metrics are read once when the pack is opened, so getFont() works for
+ * measuring and layout like a compiled-in font. Bitmaps stay on SD and are
+ * read one plane of one 128-codepoint block (Basic Latin, Latin-1 Supplement,
+ * Latin Extended-A, ...) at a time into a fixed-size cache, replaced least
+ * recently used first. TextRenderer fetches them through getPlane() for fonts
+ * whose `pack` field is set.
+ *
+ * File layout (little endian), written by generate_simplefont --pack:
+ *   header   32 bytes: "MRFP", version, flags (FONT_FLAG_* | FLAG_GRAYSCALE),
+ *            yAdvance, size, style, 0, glyphCount (u16), blockCount (u16),
+ *            0 (u16), name (16 bytes, NUL padded)
+ *   blocks   12 bytes each, sorted: number (codepoint >> BLOCK_SHIFT),
+ *            firstGlyph, glyphCount, planeBytes (u16 each), dataOffset (u32)
+ *   glyphs   11 bytes each, sorted by codepoint: codepoint (u32),
+ *            bitmapOffset (u16, within its block's plane), width, height,
+ *            xAdvance, xOffset, yOffset
+ *   data     per block the BW plane, then the LSB and MSB planes if grayscale;
+ *            with FONT_FLAG_COMPRESSED one plane of GlyphDecoder streams
+ *            (bitmapOffset is the glyph's stream), checked when it is loaded
+ */
+class FontPack {
+ public:
+  enum Plane { PLANE_BW = 0, PLANE_GRAY_LSB, PLANE_GRAY_MSB };
+
+  static const uint8_t VERSION = 1;
+  static const uint8_t FLAG_GRAYSCALE = 0x80;
+  static const uint8_t BLOCK_SHIFT = 7;
+  static const size_t HEADER_SIZE = 32;
+  static const size_t BLOCK_RECORD_SIZE = 12;
+  static const size_t GLYPH_RECORD_SIZE = 11;
+  static const size_t NAME_SIZE = 16;
+  // Enough for the planes of the few blocks a page of Latin text uses
+  static const size_t DEFAULT_CACHE_BYTES = 32 * 1024;
+  // BITMAP_GRAY needs both gray planes of a glyph at the same time
+  static const size_t MIN_CACHE_SLOTS = 2;
+
+  // path: SD path of the .mfp file
+  // cacheBytes: bitmap cache size, split into slots of the largest block plane
+  FontPack(const char* path, size_t cacheBytes = DEFAULT_CACHE_BYTES);
+  ~FontPack();
+  FontPack(const FontPack&) = delete;
+  FontPack& operator=(const FontPack&) = delete;
+
+  // False if the file is missing, malformed or memory ran out
+  bool isValid() const {
+    return valid_;
+  }
+  // The font to select in TextRenderer (nullptr if not valid)
+  const SimpleGFXfont* getFont() const {
+    return valid_ ? &font_ : nullptr;
+  }
+  // True if the glyphs have gray levels (in gray planes or compressed streams)
+  bool hasGrayscale() const {
+    return grayscale_;
+  }
+
+  // Plane of the block holding glyph `glyphIndex` (bitmapOffset is relative to
+  // it), read from SD on a cache miss. nullptr if the pack has no such plane
+  // or it cannot be read. Being the most recently used slot, the plane stays
+  // valid through the next call, but not longer.
+  const uint8_t* getPlane(uint16_t glyphIndex, Plane plane);
+
+  // Cache statistics (one lookup per drawn glyph)
+  uint32_t getCacheHits() const {
+    return cacheHits_;
+  }
+  uint32_t getCacheMisses() const {
+    return cacheMisses_;
+  }
+  float getHitRate() const {
+    uint32_t total = cacheHits_ + cacheMisses_;
+    return total ? static_cast<float>(cacheHits_) / total : 0.0f;
+  }
+  void resetCacheStats() {
+    cacheHits_ = 0;
+    cacheMisses_ = 0;
+  }
+  size_t getCacheSlotCount() const {
+    return slotCount_;
+  }
+  // RAM held: glyph metrics, block table and bitmap cache
+  size_t getMemoryBytes() const;
+
+ private:
+  struct Block {
+    uint16_t number;
+    uint16_t firstGlyph;
+    uint16_t glyphCount;
+    uint16_t planeBytes;
+    uint32_t dataOffset;
+    int16_t slot[3];  // cache slot holding each plane, -1 if not loaded
+  };
+  struct Slot {
+    uint16_t block;
+    uint8_t plane;
+    bool used;
+    uint32_t lastUse;
+  };
+
+  bool load(size_t cacheBytes);
+  bool readAt(uint32_t offset, uint8_t* out, size_t length);
+  int findBlock(uint16_t glyphIndex);
+  // Compressed packs: every glyph stream of the block lies in its plane
+  bool checkStreams(const Block& block, const uint8_t* data) const;
+
+  File file_;
+  bool valid_ = false;
+  SimpleGFXfont font_;
+  char name_[NAME_SIZE + 1];
+  uint8_t planeCount_ = 0;
+  bool grayscale_ = false;
+  SimpleGFXglyph* glyphs_ = nullptr;
+  Block* blocks_ = nullptr;
+  size_t blockCount_ = 0;
+  int lastBlock_ = -1;
+
+  // Bitmap cache: slotCount_ slots of slotBytes_ bytes each in cache_
+  uint8_t* cache_ = nullptr;
+  Slot* slots_ = nullptr;
+  size_t slotCount_ = 0;
+  size_t slotBytes_ = 0;
+  uint32_t useTick_ = 0;
+  uint32_t cacheHits_ = 0;
+  uint32_t cacheMisses_ = 0;
+};
+
+#endif
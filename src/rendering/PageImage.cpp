@@ -0,0 +1,129 @@
+#include "PageImage.h"
+
+#include <cstring>
+
+#include "../core/EInkDisplay.h"
+
+namespace {
+// Bands are coded one byte column (8 portrait rows) at a time, down all 480
+// landscape rows, so the blank rows between text lines become long runs.
+// Gives the band offset of each byte in that order.
+struct ColumnOrder {
+  size_t bytes;
+  size_t rows;
+  size_t step;  // bytes per landscape row
+  size_t offset = 0;
+  explicit ColumnOrder(size_t bytes)
+      : bytes(bytes),
+        rows(bytes % EInkDisplay::DISPLAY_HEIGHT == 0 ? EInkDisplay::DISPLAY_HEIGHT : 1),
+        step(bytes / rows) {}
+  // Offset of byte `k`
+  size_t operator()(size_t k) const {
+    return (k % rows) * step + k / rows;
+  }
+  // Offset of the next byte, walking from byte 0
+  size_t next() {
+    const size_t at = offset;
+    offset += step;
+    if (offset >= bytes)
+      offset -= bytes - 1;
+    return at;
+  }
+};
+}  // namespace
+
+void PageImage::attach(uint8_t* buffer, size_t capacity) {
+  buffer_ = buffer;
+  capacity_ = buffer ? capacity : 0;
+  clear();
+}
+
+void PageImage::clear() {
+  used_ = 0;
+  for (uint8_t plane = 0; plane < PLANE_COUNT; plane++) {
+    bandCount_[plane] = 0;
+    complete_[plane] = false;
+    full_[plane] = false;
+  }
+}
+
+bool PageImage::addBand(Plane plane, const uint8_t* band, size_t bytes) {
+  if (!buffer_ || full_[plane] || bandCount_[plane] >= BAND_COUNT)
+    return false;
+
+  const ColumnOrder order(bytes);
+  auto at = [&](size_t k) { return band[order(k)]; };
+  size_t out = used_;
+  size_t in = 0;
+  while (in < bytes) {
+    // Length of the run starting at `in`
+    const uint8_t value = at(in);
+    size_t run = 1;
+    while (in + run < bytes && run < 128 && at(in + run) == value)
+      run++;
+    if (run >= 2) {
+      if (out + 2 > capacity_)
+        break;
+      buffer_[out++] = static_cast<uint8_t>(257 - run);
+      buffer_[out++] = value;
+      in += run;
+      continue;
+    }
+    // Literal bytes up to the next run of three or more
+    size_t count = 1;
+    while (in + count < bytes && count < 128) {
+      const size_t next = in + count;
+      if (next + 2 < bytes && at(next) == at(next + 1) && at(next) == at(next + 2))
+        break;
+      count++;
+    }
+    if (out + 1 + count > capacity_)
+      break;
+    buffer_[out++] = static_cast<uint8_t>(count - 1);
+    for (size_t i = 0; i < count; i++)
+      buffer_[out++] = at(in + i);
+    in += count;
+  }
+  if (in < bytes) {
+    // Out of room: the plane stays incomplete
+    full_[plane] = true;
+    return false;
+  }
+
+  const uint8_t index = bandCount_[plane]++;
+  start_[plane][index] = used_;
+  end_[plane][index] = out;
+  used_ = out;
+  complete_[plane] = bandCount_[plane] == BAND_COUNT;
+  return true;
+}
+
+bool PageImage::getBand(Plane plane, uint8_t index, uint8_t* out, size_t bytes) const {
+  if (!complete_[plane] || index >= BAND_COUNT)
+    return false;
+
+  ColumnOrder order(bytes);
+  size_t in = start_[plane][index];
+  const size_t end = end_[plane][index];
+  size_t written = 0;
+  while (in < end) {
+    const uint8_t control = buffer_[in++];
+    if (control < 128) {
+      const size_t count = control + 1;
+      if (written + count > bytes || in + count > end)
+        return false;
+      for (size_t i = 0; i < count; i++)
+        out[order.next()] = buffer_[in++];
+      written += count;
+    } else if (control > 128) {
+      const size_t count = 257 - control;
+      if (written + count > bytes || in >= end)
+        return false;
+      const uint8_t value = buffer_[in++];
+      for (size_t i = 0; i < count; i++)
+        out[order.next()] = value;
+      written += count;
+    }
+  }
+  return written == bytes;
+}
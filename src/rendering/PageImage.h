@@ -0,0 +1,70 @@
+#ifndef PAGE_IMAGE_H
+#define PAGE_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * PageImage - A rendered page kept as compressed bands.
+ *
+ * Holds planes of a page (black & white, grayscale LSB and MSB) in memory it
+ * is given, each as the bands of EInkDisplay::BAND_ROWS portrait rows that
+ * LayoutStrategy::renderPageBands() and renderPageGrayscale() produce. A band
+ * is PackBits coded (a control byte n: n + 1 literal bytes for n < 128, the
+ * next byte repeated 257 - n times for n > 128) one byte column at a time,
+ * down all 480 landscape rows, so margins and the gaps between text lines
+ * become long runs. A text page's planes shrink to about half.
+ *
+ * Bands of a plane are added top to bottom; the plane is usable once all of
+ * them are in. A band that does not fit leaves the plane incomplete, and
+ * later bands of it are ignored.
+ */
+class PageImage {
+ public:
+  enum Plane : uint8_t { BW, GRAY_LSB, GRAY_MSB };
+  static const uint8_t PLANE_COUNT = 3;
+  static const uint8_t BAND_COUNT = 10;  // EInkDisplay::DISPLAY_WIDTH / BAND_ROWS
+
+  // Use `capacity` bytes at `buffer` for the coded bands (nullptr to detach);
+  // the image is emptied
+  void attach(uint8_t* buffer, size_t capacity);
+  bool isAttached() const {
+    return buffer_ != nullptr;
+  }
+  // Drop all planes (keeps the memory)
+  void clear();
+
+  // Code the next band of `plane` (`bytes` bytes); false if it does not fit
+  bool addBand(Plane plane, const uint8_t* band, size_t bytes);
+  // All bands of `plane` are stored
+  bool hasPlane(Plane plane) const {
+    return complete_[plane];
+  }
+  // No band of `plane` was added (or tried) since clear()
+  bool isEmpty(Plane plane) const {
+    return bandCount_[plane] == 0 && !full_[plane];
+  }
+  // Decode band `index` of a complete `plane` into `out` (`bytes` bytes)
+  bool getBand(Plane plane, uint8_t index, uint8_t* out, size_t bytes) const;
+
+  // Coded bytes in use
+  size_t getUsedBytes() const {
+    return used_;
+  }
+  size_t getCapacity() const {
+    return capacity_;
+  }
+
+ private:
+  uint8_t* buffer_ = nullptr;
+  size_t capacity_ = 0;
+  size_t used_ = 0;
+  // Band `i` of a plane is coded at [start_[plane][i], end_[plane][i])
+  size_t start_[PLANE_COUNT][BAND_COUNT] = {};
+  size_t end_[PLANE_COUNT][BAND_COUNT] = {};
+  uint8_t bandCount_[PLANE_COUNT] = {};
+  bool complete_[PLANE_COUNT] = {};
+  bool full_[PLANE_COUNT] = {};
+};
+
+#endif
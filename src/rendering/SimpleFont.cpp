@@ -1,8 +1,207 @@
 #include "SimpleFont.h"
 
+#include <new>
+
+#include "SyntheticFont.h"
+
+GlyphTable::GlyphTable(const SimpleGFXfont* font) : font_(font) {
+  for (uint32_t cp = 0; cp < FLAT_LIMIT; cp++) {
+    flatIndex_[cp] = NO_GLYPH;
+    flatAdvance_[cp] = MISSING_GLYPH_ADVANCE;
+  }
+
+  // Count the pages above the flat range (glyphs are sorted by codepoint)
+  size_t pageCount = 0;
+  for (uint16_t i = 0; i < font->glyphCount; i++) {
+    const SimpleGFXglyph& glyph = font->glyph[i];
+    if (glyph.yOffset < top_) {
+      top_ = glyph.yOffset;
+    }
+    if (glyph.yOffset + glyph.height > bottom_) {
+      bottom_ = glyph.yOffset + glyph.height;
+    }
+    uint32_t cp = glyph.codepoint;
+    if (cp < FLAT_LIMIT) {
+      flatIndex_[cp] = i;
+      flatAdvance_[cp] = glyph.xAdvance;
+    } else if (pageCount == 0 || (cp >> 8) != (font->glyph[i - 1].codepoint >> 8)) {
+      pageCount++;
+    }
+  }
+  if (pageCount == 0) {
+    return;
+  }
+  pages_ = new (std::nothrow) Page[pageCount];
+  if (!pages_) {
+    complete_ = false;
+    return;
+  }
+
+  // Record each page's run of glyphs
+  Page* page = nullptr;
+  for (uint16_t i = 0; i < font->glyphCount; i++) {
+    uint32_t cp = font->glyph[i].codepoint;
+    if (cp < FLAT_LIMIT) {
+      continue;
+    }
+    if (!page || page->number != (cp >> 8)) {
+      page = page ? page + 1 : pages_;
+      page->number = cp >> 8;
+      page->firstGlyph = i;
+      page->glyphCount = 0;
+      page->offsets = nullptr;
+    }
+    page->glyphCount++;
+  }
+  pageCount_ = pageCount;
+
+  // Dense pages get a direct offset table
+  for (size_t p = 0; p < pageCount_; p++) {
+    Page& dense = pages_[p];
+    if (dense.glyphCount < DENSE_PAGE_GLYPHS || dense.glyphCount >= 0xFF) {
+      continue;
+    }
+    dense.offsets = new (std::nothrow) uint8_t[256];
+    if (!dense.offsets) {
+      complete_ = false;
+      return;
+    }
+    for (int k = 0; k < 256; k++) {
+      dense.offsets[k] = 0xFF;
+    }
+    for (uint16_t k = 0; k < dense.glyphCount; k++) {
+      dense.offsets[font->glyph[dense.firstGlyph + k].codepoint & 0xFF] = static_cast<uint8_t>(k);
+    }
+  }
+}
+
+GlyphTable::~GlyphTable() {
+  for (size_t p = 0; p < pageCount_; p++) {
+    delete[] pages_[p].offsets;
+  }
+  delete[] pages_;
+}
+
+uint16_t GlyphTable::pageIndex(uint32_t codepoint) const {
+  // Find the page
+  uint32_t number = codepoint >> 8;
+  size_t low = 0;
+  size_t high = pageCount_;
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    if (pages_[mid].number < number) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == pageCount_ || pages_[low].number != number) {
+    return NO_GLYPH;
+  }
+
+  const Page& page = pages_[low];
+  if (page.offsets) {
+    uint8_t offset = page.offsets[codepoint & 0xFF];
+    return offset == 0xFF ? NO_GLYPH : page.firstGlyph + offset;
+  }
+
+  // Sparse page: search its run of glyphs
+  uint16_t first = page.firstGlyph;
+  uint16_t last = page.firstGlyph + page.glyphCount;
+  while (first < last) {
+    uint16_t mid = first + (last - first) / 2;
+    if (font_->glyph[mid].codepoint < codepoint) {
+      first = mid + 1;
+    } else {
+      last = mid;
+    }
+  }
+  return (first < page.firstGlyph + page.glyphCount && font_->glyph[first].codepoint == codepoint) ? first : NO_GLYPH;
+}
+
+size_t GlyphTable::getMemoryBytes() const {
+  size_t bytes = sizeof(GlyphTable) + pageCount_ * sizeof(Page);
+  for (size_t p = 0; p < pageCount_; p++) {
+    if (pages_[p].offsets) {
+      bytes += 256;
+    }
+  }
+  return bytes;
+}
+
+namespace {
+GlyphTable* glyphTables[MAX_GLYPH_TABLES] = {};
+size_t nextGlyphTable = 0;  // slot replaced when all are in use
+GlyphTable* lastGlyphTable = nullptr;
+}  // namespace
+
+const GlyphTable* getGlyphTable(const SimpleGFXfont* font) {
+  if (lastGlyphTable && lastGlyphTable->getFont() == font) {
+    return lastGlyphTable;
+  }
+  if (!font || !font->glyph || font->glyphCount == 0) {
+    return nullptr;
+  }
+
+  for (size_t i = 0; i < MAX_GLYPH_TABLES; i++) {
+    if (glyphTables[i] && glyphTables[i]->getFont() == font) {
+      lastGlyphTable = glyphTables[i];
+      return lastGlyphTable;
+    }
+  }
+
+  // Build it in a free slot, or in place of the oldest table
+  size_t slot = MAX_GLYPH_TABLES;
+  for (size_t i = 0; i < MAX_GLYPH_TABLES; i++) {
+    if (!glyphTables[i]) {
+      slot = i;
+      break;
+    }
+  }
+  if (slot == MAX_GLYPH_TABLES) {
+    slot = nextGlyphTable;
+    nextGlyphTable = (nextGlyphTable + 1) % MAX_GLYPH_TABLES;
+    delete glyphTables[slot];
+    glyphTables[slot] = nullptr;
+  }
+  glyphTables[slot] = new (std::nothrow) GlyphTable(font);
+  if (glyphTables[slot] && !glyphTables[slot]->isComplete()) {
+    delete glyphTables[slot];
+    glyphTables[slot] = nullptr;
+  }
+  lastGlyphTable = glyphTables[slot];
+  return lastGlyphTable;
+}
+
+void releaseGlyphTable(const SimpleGFXfont* font) {
+  for (size_t i = 0; i < MAX_GLYPH_TABLES; i++) {
+    if (glyphTables[i] && glyphTables[i]->getFont() == font) {
+      if (lastGlyphTable == glyphTables[i]) {
+        lastGlyphTable = nullptr;
+      }
+      delete glyphTables[i];
+      glyphTables[i] = nullptr;
+    }
+  }
+}
+
+int findGlyphIndex(const SimpleGFXfont* font, uint32_t codepoint) {
+  const GlyphTable* table = getGlyphTable(font);
+  if (table) {
+    return table->indexOf(codepoint);
+  }
+  return findGlyphIndexBinary(font, codepoint);
+}
+
+static uint32_t glyphSearchProbes = 0;
+
+uint32_t getGlyphSearchProbes() {
+  return glyphSearchProbes;
+}
+
 // Helper to find a glyph index by codepoint using binary search
 // The glyph array must be sorted by codepoint
-int findGlyphIndex(const SimpleGFXfont* font, uint32_t codepoint) {
+int findGlyphIndexBinary(const SimpleGFXfont* font, uint32_t codepoint) {
   if (!font || !font->glyph || font->glyphCount == 0) {
     return -1;
   }
@@ -13,6 +212,7 @@ int findGlyphIndex(const SimpleGFXfont* font, uint32_t codepoint) {
   while (low <= high) {
     int mid = low + (high - low) / 2;
     uint32_t midCodepoint = font->glyph[mid].codepoint;
+    glyphSearchProbes++;
 
     if (midCodepoint == codepoint) {
       return mid;
@@ -32,16 +232,152 @@ const SimpleGFXfont* getFontVariant(const FontFamily* family, FontStyle style) {
     return nullptr;
   }
 
+  const SimpleGFXfont* synthetic = nullptr;
   switch (style) {
     case FontStyle::REGULAR:
       return family->regular;
     case FontStyle::BOLD:
-      return family->bold ? family->bold : family->regular;  // Fallback to regular
+      if (family->bold) {
+        return family->bold;
+      }
+      if (family->synthesize & SYNTHESIZE_BOLD) {
+        synthetic = getSyntheticFont(family->regular, FontStyle::BOLD);
+      }
+      return synthetic ? synthetic : family->regular;  // Fallback to regular
     case FontStyle::ITALIC:
-      return family->italic ? family->italic : family->regular;
+      if (family->italic) {
+        return family->italic;
+      }
+      if (family->synthesize & SYNTHESIZE_ITALIC) {
+        synthetic = getSyntheticFont(family->regular, FontStyle::ITALIC);
+      }
+      return synthetic ? synthetic : family->regular;
     case FontStyle::BOLD_ITALIC:
-      return family->boldItalic ? family->boldItalic : (family->bold ? family->bold : family->regular);
+      if (family->boldItalic) {
+        return family->boldItalic;
+      }
+      // Transform the closest real variant: slant the bold, embolden the italic
+      if (family->bold && (family->synthesize & SYNTHESIZE_ITALIC)) {
+        synthetic = getSyntheticFont(family->bold, FontStyle::ITALIC);
+      } else if (family->italic && (family->synthesize & SYNTHESIZE_BOLD)) {
+        synthetic = getSyntheticFont(family->italic, FontStyle::BOLD);
+      } else if ((family->synthesize & (SYNTHESIZE_BOLD | SYNTHESIZE_ITALIC)) ==
+                 (SYNTHESIZE_BOLD | SYNTHESIZE_ITALIC)) {
+        synthetic = getSyntheticFont(family->regular, FontStyle::BOLD_ITALIC);
+      }
+      return synthetic ? synthetic : getFontVariant(family, FontStyle::BOLD);
     default:
       return family->regular;
   }
-}
\ No newline at end of file
+}
+
+// Set or clear bits [x, x + n) of a row, MSB first
+static void fillRowBits(uint8_t* row, uint8_t x, uint8_t n, bool set) {
+  while (n > 0) {
+    const uint8_t bit = x & 7;
+    const uint8_t count = n < 8 - bit ? n : 8 - bit;
+    const uint8_t mask = static_cast<uint8_t>((0xFF >> bit) & (0xFF << (8 - bit - count)));
+    row[x >> 3] = set ? row[x >> 3] | mask : row[x >> 3] & ~mask;
+    x += count;
+    n -= count;
+  }
+}
+
+void GlyphDecoder::nextRun() {
+  const uint8_t code = nextNibble();
+  if (code < 6) {
+    runLevel_ = 0;
+    runLeft_ = code + 1;
+  } else if (code < 12) {
+    runLevel_ = 4;
+    runLeft_ = code - 5;
+  } else if (code < 15) {
+    runLevel_ = code - 11;
+    runLeft_ = 1;
+  } else {
+    uint8_t value = nextNibble() << 4;
+    value |= nextNibble();
+    runLevel_ = (value & 0x80) ? 4 : 0;
+    runLeft_ = (value & 0x7F) + 7;
+  }
+}
+
+void GlyphDecoder::decodeRow(uint8_t width, uint8_t* bw, uint8_t* lsb, uint8_t* msb) {
+  // Start from white and paint the other levels' bits
+  const uint8_t bytes = (width + 7) / 8;
+  for (uint8_t i = 0; i < bytes; i++) {
+    bw[i] = 0xFF;
+    lsb[i] = 0;
+    msb[i] = 0;
+  }
+  uint8_t x = 0;
+  while (x < width) {
+    if (runLeft_ == 0) {
+      nextRun();
+    }
+    const uint8_t n = runLeft_ < width - x ? runLeft_ : width - x;
+    switch (runLevel_) {
+      case 1:
+        fillRowBits(lsb, x, n, true);
+        break;
+      case 2:
+        fillRowBits(bw, x, n, false);
+        fillRowBits(msb, x, n, true);
+        break;
+      case 3:
+        fillRowBits(bw, x, n, false);
+        fillRowBits(lsb, x, n, true);
+        fillRowBits(msb, x, n, true);
+        break;
+      case 4:
+        fillRowBits(bw, x, n, false);
+        break;
+    }
+    x += n;
+    runLeft_ -= n;
+  }
+}
+
+void GlyphDecoder::skip(uint32_t pixels) {
+  while (pixels > 0) {
+    if (runLeft_ == 0) {
+      nextRun();
+    }
+    const uint8_t n = runLeft_ < pixels ? runLeft_ : static_cast<uint8_t>(pixels);
+    pixels -= n;
+    runLeft_ -= n;
+  }
+}
+
+bool GlyphDecoder::measure(const uint8_t* data, size_t available, uint32_t pixels, size_t& bytes) {
+  // Same walk as skip(), bounded by `available`
+  size_t nibbles = 0;
+  const size_t limit = available * 2;
+  while (pixels > 0) {
+    if (nibbles >= limit) {
+      return false;
+    }
+    const uint8_t code = (nibbles & 1) ? data[nibbles / 2] & 0x0F : data[nibbles / 2] >> 4;
+    nibbles++;
+    uint32_t run;
+    if (code < 6) {
+      run = code + 1;
+    } else if (code < 12) {
+      run = code - 5;
+    } else if (code < 15) {
+      run = 1;
+    } else {
+      if (nibbles + 2 > limit) {
+        return false;
+      }
+      uint8_t value = ((nibbles & 1) ? data[nibbles / 2] & 0x0F : data[nibbles / 2] >> 4) << 4;
+      nibbles++;
+      value |= (nibbles & 1) ? data[nibbles / 2] & 0x0F : data[nibbles / 2] >> 4;
+      nibbles++;
+      run = (value & 0x7F) + 7;
+    }
+    pixels = run < pixels ? pixels - run : 0;
+  }
+  bytes = (nibbles + 1) / 2;
+  return true;
+}
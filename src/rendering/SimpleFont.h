@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 // Enum for font styles (expandable for future styles)
@@ -16,6 +17,19 @@ typedef struct {
   int8_t yOffset;    ///< Y dist from cursor pos to UL corner
 } SimpleGFXglyph;
 
+// SimpleGFXfont::flags
+// Glyph bitmaps (all planes) are stored column by column: each glyph column is
+// (height + 7) / 8 bytes, top row in the MSB, so a byte holds the 8 pixels one
+// byte of the landscape framebuffer holds. Without it rows are packed.
+static constexpr uint8_t FONT_FLAG_COLUMN_MAJOR = 0x01;
+// Glyph bitmaps are GlyphDecoder streams (row-major, not with COLUMN_MAJOR):
+// `bitmap` holds them, and the gray plane pointers are the same stream if the
+// font has grayscale, nullptr otherwise.
+static constexpr uint8_t FONT_FLAG_COMPRESSED = 0x02;
+
+class FontPack;
+class SyntheticFont;
+
 typedef struct {
   const uint8_t* bitmap;           ///< Glyph bitmaps, concatenated
   const uint8_t* bitmap_gray_lsb;  ///< Glyph bitmaps, concatenated
@@ -23,12 +37,70 @@ typedef struct {
   const SimpleGFXglyph* glyph;     ///< Glyph array (sorted by codepoint for binary search)
   uint16_t glyphCount;             ///< Number of entries in `glyph`.
   uint8_t yAdvance;                ///< Newline distance (y axis)
-  // Optional metadata for better font management
+  // Optional metadata for better font management. No default member
+  // initializers here or in FontFamily: both must stay aggregates under C++11,
+  // so every initializer writes all fields out.
   const char* name;  ///< Font name (e.g., "NotoSans")
   uint8_t size;      ///< Font size in points (for reference)
   FontStyle style;   ///< Style of this font variant
+  uint8_t flags;     ///< FONT_FLAG_* (bitmap layout)
+  FontPack* pack;    ///< Bitmaps are read on demand from this font pack (nullptr: in memory)
+  SyntheticFont* synthetic;  ///< Bitmaps are made on demand from another font (nullptr: none)
 } SimpleGFXfont;
 
+/**
+ * Decoder for FONT_FLAG_COMPRESSED glyph bitmaps.
+ *
+ * A glyph pixel is one of five levels, from white to black, each standing for
+ * a combination of the three planes (BW, gray LSB, gray MSB):
+ *   0 white (1, 0, 0), 1 light gray (1, 1, 0), 2 gray (0, 0, 1),
+ *   3 dark gray (0, 1, 1), 4 black (0, 0, 0)
+ * Pixels are run-length coded in row-major order (runs continue across rows)
+ * with 4-bit codes, high nibble first; a glyph's stream is padded to a byte:
+ *   0x0-0x5  white run of 1-6 pixels
+ *   0x6-0xB  black run of 1-6 pixels
+ *   0xC-0xE  one pixel of level 1-3
+ *   0xF v v  run of 7-134 pixels: two more nibbles, bit 7 black (else white),
+ *            bits 0-6 the length - 7
+ */
+class GlyphDecoder {
+ public:
+  static const uint8_t MAX_ROW_BYTES = 32;  // 255-pixel rows
+
+  explicit GlyphDecoder(const uint8_t* data) : data_(data) {}
+
+  // Decode the next `width` pixels into one row of each plane, packed like
+  // uncompressed glyph rows (MSB first; padding bits are unspecified)
+  void decodeRow(uint8_t width, uint8_t* bw, uint8_t* lsb, uint8_t* msb);
+  // Skip `pixels` pixels
+  void skip(uint32_t pixels);
+
+  // Bytes taken by the stream of a glyph with `pixels` pixels at `data`;
+  // false if it runs past `available` bytes
+  static bool measure(const uint8_t* data, size_t available, uint32_t pixels, size_t& bytes);
+
+ private:
+  uint8_t nextNibble() {
+    if (high_) {
+      high_ = false;
+      return *data_ >> 4;
+    }
+    high_ = true;
+    return *data_++ & 0x0F;
+  }
+  void nextRun();
+
+  const uint8_t* data_;
+  bool high_ = true;
+  uint8_t runLevel_ = 0;
+  uint8_t runLeft_ = 0;
+};
+
+// FontFamily::synthesize: styles to make with SyntheticFont when the family
+// has no variant for them (instead of falling back to regular)
+static constexpr uint8_t SYNTHESIZE_BOLD = 0x01;
+static constexpr uint8_t SYNTHESIZE_ITALIC = 0x02;
+
 // New: Font family struct to group style variants
 typedef struct {
   const char* familyName;           ///< Name of the font family (e.g., "NotoSans")
@@ -36,11 +108,110 @@ typedef struct {
   const SimpleGFXfont* bold;        ///< Bold variant (optional, nullptr if not loaded)
   const SimpleGFXfont* italic;      ///< Italic variant (optional)
   const SimpleGFXfont* boldItalic;  ///< Bold-italic variant (optional)
+  uint8_t synthesize;               ///< SYNTHESIZE_* for missing variants (0: use regular)
 } FontFamily;
 
-// Helper to find a glyph index by codepoint using binary search
+// Advance used for codepoints the font has no glyph for
+static constexpr uint8_t MISSING_GLYPH_ADVANCE = 6;
+
+/**
+ * Direct-indexed glyph lookup for one font, built in RAM on first use.
+ *
+ * The glyph arrays live in flash and are only sorted by codepoint, so finding
+ * a glyph used to be a binary search per character. The table maps
+ * U+0000-U+024F (Latin, Latin-1 and Latin Extended-A/B) straight to the glyph
+ * index and xAdvance. Higher codepoints go through a sorted list of the
+ * 256-codepoint pages the font has glyphs in; pages with at least
+ * DENSE_PAGE_GLYPHS glyphs get a direct offset table, sparser ones are
+ * searched within their (short) run of glyphs.
+ */
+class GlyphTable {
+ public:
+  static const uint32_t FLAT_LIMIT = 0x250;  // codepoints below this use the flat table
+  static const uint16_t NO_GLYPH = 0xFFFF;
+  static const uint16_t DENSE_PAGE_GLYPHS = 16;
+
+  explicit GlyphTable(const SimpleGFXfont* font);
+  ~GlyphTable();
+  GlyphTable(const GlyphTable&) = delete;
+  GlyphTable& operator=(const GlyphTable&) = delete;
+
+  // Glyph index for a codepoint, or -1 if the font has none
+  int indexOf(uint32_t codepoint) const {
+    uint16_t index = codepoint < FLAT_LIMIT ? flatIndex_[codepoint] : pageIndex(codepoint);
+    return index == NO_GLYPH ? -1 : index;
+  }
+  // xAdvance of the codepoint's glyph (MISSING_GLYPH_ADVANCE if there is none)
+  uint8_t advanceOf(uint32_t codepoint) const {
+    if (codepoint < FLAT_LIMIT) {
+      return flatAdvance_[codepoint];
+    }
+    uint16_t index = pageIndex(codepoint);
+    return index == NO_GLYPH ? MISSING_GLYPH_ADVANCE : font_->glyph[index].xAdvance;
+  }
+  // Advances of U+0000-U+024F, for loops that handle ASCII inline
+  const uint8_t* getFlatAdvances() const {
+    return flatAdvance_;
+  }
+
+  const SimpleGFXfont* getFont() const {
+    return font_;
+  }
+  size_t getPageCount() const {
+    return pageCount_;
+  }
+  // Rows covered by the font's glyphs relative to the baseline: [top, bottom)
+  int16_t getTop() const {
+    return top_;
+  }
+  int16_t getBottom() const {
+    return bottom_;
+  }
+  // False if memory ran out while building (the table must not be used)
+  bool isComplete() const {
+    return complete_;
+  }
+  size_t getMemoryBytes() const;
+
+ private:
+  struct Page {
+    uint32_t number;      // codepoint >> 8
+    uint16_t firstGlyph;  // the page's glyphs are glyph[firstGlyph, firstGlyph + glyphCount)
+    uint16_t glyphCount;
+    uint8_t* offsets;  // 256 offsets from firstGlyph (0xFF: none); nullptr for sparse pages
+  };
+
+  uint16_t pageIndex(uint32_t codepoint) const;
+
+  const SimpleGFXfont* font_;
+  uint16_t flatIndex_[FLAT_LIMIT];
+  uint8_t flatAdvance_[FLAT_LIMIT];
+  Page* pages_ = nullptr;  // sorted by number
+  size_t pageCount_ = 0;
+  int16_t top_ = 0;
+  int16_t bottom_ = 0;
+  bool complete_ = true;
+};
+
+// Glyph table of a font, built on first use. Tables of up to MAX_GLYPH_TABLES
+// fonts are kept; beyond that the oldest one is replaced, so callers must not
+// keep the pointer across calls. Returns nullptr if the font has no glyphs or
+// memory runs out.
+static const size_t MAX_GLYPH_TABLES = 8;
+const GlyphTable* getGlyphTable(const SimpleGFXfont* font);
+// Drop the font's glyph table, if built (before the font's memory is reused)
+void releaseGlyphTable(const SimpleGFXfont* font);
+
+// Helper to find a glyph index by codepoint (through the font's glyph table)
 // Returns -1 if the glyph is not found
 int findGlyphIndex(const SimpleGFXfont* font, uint32_t codepoint);
+// Same result by binary search over the glyph array (no table)
+int findGlyphIndexBinary(const SimpleGFXfont* font, uint32_t codepoint);
+// Glyph entries compared by findGlyphIndexBinary() so far; a
+// machine-independent measure of lookup work
+uint32_t getGlyphSearchProbes();
 
-// Helper to get a font variant from a family (returns nullptr if not available)
+// Helper to get a font variant from a family (returns nullptr if not available).
+// A missing variant is synthesized if the family asks for it, else it falls
+// back to regular (bold-italic to bold first).
 const SimpleGFXfont* getFontVariant(const FontFamily* family, FontStyle style);
@@ -0,0 +1,319 @@
+#include "SyntheticFont.h"
+
+#include <cstring>
+#include <new>
+
+#include "FontPack.h"
+
+// Gray level of a pixel by its (BW, LSB, MSB) bits, indexed bw << 2 | lsb << 1
+// | msb. The generator only produces the five combinations of GlyphDecoder's
+// levels; the others count as white if the BW bit is, black otherwise.
+static const uint8_t COMBO_LEVEL[8] = {4, 2, 4, 3, 0, 0, 1, 0};
+// (BW, LSB, MSB) bits of each level, in the same order
+static const uint8_t LEVEL_COMBO[5] = {4, 6, 1, 3, 0};
+
+static inline int16_t floorDiv(int16_t value, int16_t divisor) {
+  return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+SyntheticFont::SyntheticFont(const SimpleGFXfont* base, FontStyle transform, size_t cacheBytes)
+    : base_(base), transform_(transform) {
+  memset(&font_, 0, sizeof(font_));
+  valid_ = build(cacheBytes);
+}
+
+SyntheticFont::~SyntheticFont() {
+  // The glyph table cache is keyed by font address
+  releaseGlyphTable(&font_);
+  delete[] glyphs_;
+  delete[] levels_;
+  delete[] cache_;
+  delete[] offsetOf_;
+  delete[] queue_;
+}
+
+int16_t SyntheticFont::shearOf(const SimpleGFXglyph& glyph, int16_t row) const {
+  // Height of the row above the baseline (the baseline row itself is 0)
+  return slant_ ? floorDiv(-(glyph.yOffset + row), SLANT_ROWS) : 0;
+}
+
+bool SyntheticFont::build(size_t cacheBytes) {
+  if (!base_ || !base_->glyph || base_->glyphCount == 0 || transform_ == FontStyle::REGULAR) {
+    return false;
+  }
+  grayscale_ = base_->pack ? base_->pack->hasGrayscale() : base_->bitmap_gray_lsb && base_->bitmap_gray_msb;
+  planeCount_ = grayscale_ ? 3 : 1;
+  const bool bold = transform_ == FontStyle::BOLD || transform_ == FontStyle::BOLD_ITALIC;
+  slant_ = transform_ == FontStyle::ITALIC || transform_ == FontStyle::BOLD_ITALIC;
+  // One pixel for text sizes, more for large fonts
+  boldPixels_ = bold ? 1 + base_->yAdvance / 40 : 0;
+
+  glyphs_ = new (std::nothrow) SimpleGFXglyph[base_->glyphCount];
+  if (!glyphs_) {
+    return false;
+  }
+  levelBytes_ = 1;
+  size_t largest = 1;
+  for (uint16_t i = 0; i < base_->glyphCount; i++) {
+    const SimpleGFXglyph& source = base_->glyph[i];
+    SimpleGFXglyph& glyph = glyphs_[i];
+    glyph = source;
+    glyph.bitmapOffset = 0;
+    glyph.xAdvance = source.xAdvance + boldPixels_;
+    if (glyph.xAdvance < source.xAdvance) {
+      return false;
+    }
+    if (source.width == 0 || source.height == 0) {
+      continue;
+    }
+    // The bottom row moves furthest left (or least right)
+    const int16_t top = shearOf(source, 0);
+    const int16_t bottom = shearOf(source, source.height - 1);
+    const int16_t width = source.width + boldPixels_ + (top - bottom);
+    const int16_t xOffset = source.xOffset + bottom;
+    if (width > 255 || xOffset < -128 || xOffset > 127) {
+      return false;
+    }
+    glyph.width = static_cast<uint8_t>(width);
+    glyph.xOffset = static_cast<int8_t>(xOffset);
+
+    const size_t pixels = static_cast<size_t>(source.width) * source.height;
+    if (pixels > levelBytes_) {
+      levelBytes_ = pixels;
+    }
+    const size_t bytes = planeBytesOf(i) * planeCount_;
+    if (bytes > largest) {
+      largest = bytes;
+    }
+  }
+
+  cacheBytes_ = cacheBytes < largest ? largest : cacheBytes;
+  if (cacheBytes_ > MAX_CACHE_BYTES) {
+    return false;
+  }
+  levels_ = new (std::nothrow) uint8_t[levelBytes_];
+  cache_ = new (std::nothrow) uint8_t[cacheBytes_];
+  offsetOf_ = new (std::nothrow) uint16_t[base_->glyphCount];
+  queue_ = new (std::nothrow) uint16_t[base_->glyphCount];
+  if (!levels_ || !cache_ || !offsetOf_ || !queue_) {
+    return false;
+  }
+  for (uint16_t i = 0; i < base_->glyphCount; i++) {
+    offsetOf_[i] = NOT_CACHED;
+  }
+
+  // Bitmap pointers stay null: TextRenderer reads the planes through getGlyph()
+  font_ = *base_;
+  font_.bitmap = nullptr;
+  font_.bitmap_gray_lsb = nullptr;
+  font_.bitmap_gray_msb = nullptr;
+  font_.glyph = glyphs_;
+  font_.style = static_cast<FontStyle>(static_cast<uint8_t>(base_->style) | static_cast<uint8_t>(transform_));
+  font_.flags = 0;
+  font_.pack = nullptr;
+  font_.synthetic = this;
+  return true;
+}
+
+bool SyntheticFont::readLevels(uint16_t glyphIndex, uint8_t* levels) {
+  const SimpleGFXglyph& glyph = base_->glyph[glyphIndex];
+  const uint16_t width = glyph.width;
+  const uint16_t height = glyph.height;
+  memset(levels, 0, static_cast<size_t>(width) * height);
+
+  // Collect each pixel's plane bits (bw << 2 | lsb << 1 | msb), then map them
+  if (base_->flags & FONT_FLAG_COMPRESSED) {
+    const uint8_t* stream = base_->pack ? base_->pack->getPlane(glyphIndex, FontPack::PLANE_BW) : base_->bitmap;
+    if (!stream) {
+      return false;
+    }
+    GlyphDecoder decoder(stream + glyph.bitmapOffset);
+    uint8_t rows[3][GlyphDecoder::MAX_ROW_BYTES];
+    for (uint16_t r = 0; r < height; r++) {
+      decoder.decodeRow(glyph.width, rows[0], rows[1], rows[2]);
+      for (uint16_t x = 0; x < width; x++) {
+        const uint8_t mask = 0x80 >> (x & 7);
+        uint8_t& combo = levels[r * width + x];
+        combo = ((rows[0][x >> 3] & mask) ? 4 : 0) | ((rows[1][x >> 3] & mask) ? 2 : 0) |
+                ((rows[2][x >> 3] & mask) ? 1 : 0);
+      }
+    }
+  } else {
+    const bool columnMajor = (base_->flags & FONT_FLAG_COLUMN_MAJOR) != 0;
+    const uint8_t rowStride = (width + 7) / 8;
+    const uint8_t colStride = (height + 7) / 8;
+    const uint8_t* const memoryPlanes[3] = {base_->bitmap, base_->bitmap_gray_lsb, base_->bitmap_gray_msb};
+    // Pack planes are fetched one at a time (only the last one is sure to stay cached)
+    for (uint8_t p = 0; p < planeCount_; p++) {
+      const uint8_t* data =
+          base_->pack ? base_->pack->getPlane(glyphIndex, static_cast<FontPack::Plane>(p)) : memoryPlanes[p];
+      if (!data) {
+        return false;
+      }
+      data += glyph.bitmapOffset;
+      const uint8_t bit = 4 >> p;
+      for (uint16_t r = 0; r < height; r++) {
+        for (uint16_t x = 0; x < width; x++) {
+          const bool set = columnMajor ? data[x * colStride + (r >> 3)] & (0x80 >> (r & 7))
+                                       : data[r * rowStride + (x >> 3)] & (0x80 >> (x & 7));
+          if (set) {
+            levels[r * width + x] |= bit;
+          }
+        }
+      }
+    }
+  }
+
+  const size_t pixels = static_cast<size_t>(width) * height;
+  for (size_t i = 0; i < pixels; i++) {
+    levels[i] = grayscale_ ? COMBO_LEVEL[levels[i]] : (levels[i] & 4) ? 0 : 4;
+  }
+  return true;
+}
+
+void SyntheticFont::render(uint16_t glyphIndex, const uint8_t* levels, uint8_t* out) const {
+  const SimpleGFXglyph& source = base_->glyph[glyphIndex];
+  const SimpleGFXglyph& glyph = glyphs_[glyphIndex];
+  const uint8_t rowStride = (glyph.width + 7) / 8;
+  const size_t bytes = planeBytesOf(glyphIndex);
+  uint8_t* bw = out;
+  uint8_t* lsb = out + bytes;
+  uint8_t* msb = out + 2 * bytes;
+  // White: BW set, gray planes clear
+  memset(bw, 0xFF, bytes);
+  if (grayscale_) {
+    memset(lsb, 0, bytes);
+    memset(msb, 0, bytes);
+  }
+
+  const int16_t bottom = shearOf(source, source.height - 1);
+  for (int16_t r = 0; r < glyph.height; r++) {
+    const uint8_t* sourceRow = levels + r * source.width;
+    const int16_t shift = shearOf(source, r) - bottom;
+    for (int16_t x = 0; x < glyph.width; x++) {
+      // Darkest of the source pixel and the boldPixels_ to its left
+      uint8_t level = 0;
+      for (int16_t sx = x - shift - boldPixels_; sx <= x - shift; sx++) {
+        if (sx >= 0 && sx < source.width && sourceRow[sx] > level) {
+          level = sourceRow[sx];
+        }
+      }
+      if (level == 0) {
+        continue;
+      }
+      const uint16_t index = r * rowStride + (x >> 3);
+      const uint8_t mask = 0x80 >> (x & 7);
+      const uint8_t combo = LEVEL_COMBO[level];
+      if (!(combo & 4)) {
+        bw[index] &= ~mask;
+      }
+      if (grayscale_) {
+        if (combo & 2) {
+          lsb[index] |= mask;
+        }
+        if (combo & 1) {
+          msb[index] |= mask;
+        }
+      }
+    }
+  }
+}
+
+void SyntheticFont::evictOldest() {
+  offsetOf_[queue_[queueHead_]] = NOT_CACHED;
+  queueHead_ = (queueHead_ + 1) % font_.glyphCount;
+  --queueCount_;
+}
+
+bool SyntheticFont::getGlyph(uint16_t glyphIndex, const uint8_t* planes[3]) {
+  if (!valid_ || glyphIndex >= font_.glyphCount) {
+    return false;
+  }
+  const size_t planeBytes = planeBytesOf(glyphIndex);
+  uint8_t* data;
+  if (offsetOf_[glyphIndex] != NOT_CACHED || planeBytes == 0) {
+    ++cacheHits_;
+    data = cache_ + (planeBytes ? offsetOf_[glyphIndex] : 0);
+  } else {
+    ++cacheMisses_;
+    const size_t bytes = planeBytes * planeCount_;
+    if (writePos_ + bytes > cacheBytes_) {
+      // Wrap: the glyphs after writePos_ are the oldest ones
+      while (queueCount_ > 0 && offsetOf_[queue_[queueHead_]] >= writePos_) {
+        evictOldest();
+      }
+      writePos_ = 0;
+    }
+    // Drop the oldest glyphs until the new one's space is free
+    while (queueCount_ > 0 && offsetOf_[queue_[queueHead_]] >= writePos_ &&
+           offsetOf_[queue_[queueHead_]] < writePos_ + bytes) {
+      evictOldest();
+    }
+    if (!readLevels(glyphIndex, levels_)) {
+      return false;
+    }
+    data = cache_ + writePos_;
+    render(glyphIndex, levels_, data);
+    offsetOf_[glyphIndex] = static_cast<uint16_t>(writePos_);
+    queue_[(queueHead_ + queueCount_) % font_.glyphCount] = glyphIndex;
+    ++queueCount_;
+    writePos_ += bytes;
+  }
+  planes[0] = data;
+  planes[1] = grayscale_ ? data + planeBytes : nullptr;
+  planes[2] = grayscale_ ? data + 2 * planeBytes : nullptr;
+  return true;
+}
+
+size_t SyntheticFont::getMemoryBytes() const {
+  return sizeof(SyntheticFont) + font_.glyphCount * (sizeof(SimpleGFXglyph) + 2 * sizeof(uint16_t)) + levelBytes_ +
+         cacheBytes_;
+}
+
+namespace {
+
+struct SyntheticEntry {
+  const SimpleGFXfont* base;
+  FontStyle transform;
+  SyntheticFont* font;  // nullptr: the variant could not be made
+};
+
+SyntheticEntry syntheticFonts[MAX_SYNTHETIC_FONTS];
+size_t syntheticFontCount = 0;
+
+}  // namespace
+
+const SimpleGFXfont* getSyntheticFont(const SimpleGFXfont* base, FontStyle transform) {
+  if (!base) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < syntheticFontCount; i++) {
+    if (syntheticFonts[i].base == base && syntheticFonts[i].transform == transform) {
+      return syntheticFonts[i].font ? syntheticFonts[i].font->getFont() : nullptr;
+    }
+  }
+  // Fonts cannot be replaced while layouts may still point at them
+  if (syntheticFontCount == MAX_SYNTHETIC_FONTS) {
+    return nullptr;
+  }
+  SyntheticFont* font = new (std::nothrow) SyntheticFont(base, transform);
+  if (font && !font->isValid()) {
+    delete font;
+    font = nullptr;
+  }
+  // Failures are remembered too, so they are not retried on every style change
+  syntheticFonts[syntheticFontCount++] = {base, transform, font};
+  return font ? font->getFont() : nullptr;
+}
+
+void releaseSyntheticFonts(const SimpleGFXfont* base) {
+  size_t kept = 0;
+  for (size_t i = 0; i < syntheticFontCount; i++) {
+    if (syntheticFonts[i].base == base) {
+      delete syntheticFonts[i].font;
+    } else {
+      syntheticFonts[kept++] = syntheticFonts[i];
+    }
+  }
+  syntheticFontCount = kept;
+}
@@ -0,0 +1,137 @@
+#ifndef SYNTHETIC_FONT_H
+#define SYNTHETIC_FONT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SimpleFont.h"
+
+/**
+ * SyntheticFont - A bold and/or italic variant made from another font.
+ *
+ * Emboldening dilates every glyph row to the right by getBoldPixels() (a pixel
+ * takes the darkest gray level of itself and its left neighbours), widening the
+ * glyph and its advance by as much. Slanting shears the glyph: a row `y` pixels
+ * above the baseline moves floor(y / SLANT_ROWS) pixels to the right (rows
+ * below it move left), and the advance is kept, so the glyph overhangs like a
+ * real italic. Both work on the gray level of each pixel (see GlyphDecoder), so
+ * the result is a valid grayscale glyph.
+ *
+ * Glyph metrics are computed up front, so getFont() measures and lays out like
+ * any other font. Bitmaps are made on first draw from the base font (in memory
+ * or a FontPack, any bitmap layout) as plain row-major planes, and kept in a
+ * fixed-size ring buffer: glyphs take only their own size and are replaced
+ * oldest first, so a page's worth fits even though glyph sizes vary a lot.
+ * TextRenderer fetches them through getGlyph() for fonts whose `synthetic`
+ * field is set. Use getSyntheticFont() rather than constructing one.
+ */
+class SyntheticFont {
+ public:
+  // Rows per pixel of slant (about 11 degrees)
+  static const uint8_t SLANT_ROWS = 5;
+  // Enough for the glyphs of a page's bold or italic words
+  static const size_t DEFAULT_CACHE_BYTES = 16 * 1024;
+  // Glyph positions in the cache are 16 bits
+  static const size_t MAX_CACHE_BYTES = 0xFFFF;
+
+  // base: font to transform (must outlive this one)
+  // transform: BOLD, ITALIC or BOLD_ITALIC (both)
+  // cacheBytes: glyph cache size, raised to fit the largest glyph
+  SyntheticFont(const SimpleGFXfont* base, FontStyle transform, size_t cacheBytes = DEFAULT_CACHE_BYTES);
+  ~SyntheticFont();
+  SyntheticFont(const SyntheticFont&) = delete;
+  SyntheticFont& operator=(const SyntheticFont&) = delete;
+
+  // False if the transform is not possible or memory ran out
+  bool isValid() const {
+    return valid_;
+  }
+  // The font to select in TextRenderer (nullptr if not valid)
+  const SimpleGFXfont* getFont() const {
+    return valid_ ? &font_ : nullptr;
+  }
+  const SimpleGFXfont* getBase() const {
+    return base_;
+  }
+  FontStyle getTransform() const {
+    return transform_;
+  }
+  // Pixels added to each glyph by emboldening (0 if not bold)
+  uint8_t getBoldPixels() const {
+    return boldPixels_;
+  }
+
+  // Bitmap planes of glyph `glyphIndex`: BW, then gray LSB and MSB (nullptr
+  // if the base font has no grayscale), row-major at offset 0. Made on a cache
+  // miss; false if the base glyph cannot be read. The planes stay valid
+  // through the next call, but not longer.
+  bool getGlyph(uint16_t glyphIndex, const uint8_t* planes[3]);
+
+  // Cache statistics (one lookup per drawn glyph)
+  uint32_t getCacheHits() const {
+    return cacheHits_;
+  }
+  uint32_t getCacheMisses() const {
+    return cacheMisses_;
+  }
+  void resetCacheStats() {
+    cacheHits_ = 0;
+    cacheMisses_ = 0;
+  }
+  size_t getCacheBytes() const {
+    return cacheBytes_;
+  }
+  // RAM held: glyph metrics, bitmap cache and scratch buffer
+  size_t getMemoryBytes() const;
+
+ private:
+  static const uint16_t NOT_CACHED = 0xFFFF;
+
+  bool build(size_t cacheBytes);
+  // Slant of base glyph row `row`, in pixels to the right
+  int16_t shearOf(const SimpleGFXglyph& glyph, int16_t row) const;
+  // Bytes of one plane of a synthetic glyph
+  size_t planeBytesOf(uint16_t glyphIndex) const {
+    return static_cast<size_t>((glyphs_[glyphIndex].width + 7) / 8) * glyphs_[glyphIndex].height;
+  }
+  // Drop the oldest cached glyph
+  void evictOldest();
+  // Gray level (0 white .. 4 black) of every pixel of a base glyph, row by row
+  bool readLevels(uint16_t glyphIndex, uint8_t* levels);
+  void render(uint16_t glyphIndex, const uint8_t* levels, uint8_t* out) const;
+
+  const SimpleGFXfont* base_;
+  FontStyle transform_;
+  bool valid_ = false;
+  bool grayscale_ = false;
+  uint8_t planeCount_ = 1;
+  uint8_t boldPixels_ = 0;
+  bool slant_ = false;
+  SimpleGFXfont font_;
+  SimpleGFXglyph* glyphs_ = nullptr;
+  uint8_t* levels_ = nullptr;  // scratch: levels of the largest base glyph
+  size_t levelBytes_ = 0;
+
+  // Glyph cache: a glyph's planes lie back to back at offsetOf_[glyph]
+  // (NOT_CACHED if absent); glyphs are written at writePos_, wrapping to the
+  // start, and queue_ lists the cached ones oldest first
+  uint8_t* cache_ = nullptr;
+  size_t cacheBytes_ = 0;
+  size_t writePos_ = 0;
+  uint16_t* offsetOf_ = nullptr;
+  uint16_t* queue_ = nullptr;
+  uint16_t queueHead_ = 0;
+  uint16_t queueCount_ = 0;
+  uint32_t cacheHits_ = 0;
+  uint32_t cacheMisses_ = 0;
+};
+
+// Synthetic variant of `base`, built on first use and kept until
+// releaseSyntheticFonts(base). Up to MAX_SYNTHETIC_FONTS variants exist at a
+// time; returns nullptr beyond that or if the variant cannot be made.
+static const size_t MAX_SYNTHETIC_FONTS = 6;
+const SimpleGFXfont* getSyntheticFont(const SimpleGFXfont* base, FontStyle transform);
+// Drop the synthetic variants of `base` (before the base font goes away)
+void releaseSyntheticFonts(const SimpleGFXfont* base);
+
+#endif
@@ -3,20 +3,39 @@
 #include <cstring>
 
 #include "../core/EInkDisplay.h"
+#include "FontPack.h"
 #include "SimpleFont.h"
+#include "SyntheticFont.h"
 
 static constexpr int GLYPH_PADDING = 0;
 static constexpr uint32_t UTF8_REPLACEMENT_CHAR = 0xFFFD;
-static constexpr uint16_t FALLBACK_GLYPH_WIDTH = 6;
+static constexpr uint16_t FALLBACK_GLYPH_WIDTH = MISSING_GLYPH_ADVANCE;
+// Glyph tables store the plain xAdvance
+static_assert(GLYPH_PADDING == 0, "width fast path assumes no glyph padding");
+
+// Transpose an 8x8 bit matrix stored MSB-first, one row per byte with row 0 in
+// the most significant byte (Hacker's Delight, transpose8rS64)
+static inline uint64_t transpose8x8(uint64_t x) {
+  uint64_t t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+  x = x ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+  x = x ^ t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+  return x ^ t ^ (t << 28);
+}
 
 // Helper function to decode a single UTF-8 codepoint from a byte sequence
-// Returns the decoded codepoint and advances the pointer
-static uint32_t decodeUtf8Codepoint(const unsigned char*& p) {
-  if (!p || !*p) {
+// Returns the decoded codepoint and advances the pointer. If `end` is given the
+// sequence is bounded by it instead of a terminating NUL.
+static uint32_t decodeUtf8Codepoint(const unsigned char*& p, const unsigned char* end = nullptr) {
+  if (!p || (end ? p >= end : !*p)) {
     return 0;
   }
 
   unsigned char c = *p;
+  // Number of bytes available from p (continuation bytes are never NUL, so
+  // the NUL-terminated case needs no explicit bound)
+  size_t avail = end ? static_cast<size_t>(end - p) : 4;
 
   // 1-byte ASCII
   if (c < 0x80) {
@@ -26,7 +45,7 @@ static uint32_t decodeUtf8Codepoint(const unsigned char*& p) {
 
   // 2-byte sequence
   if ((c & 0xE0) == 0xC0) {
-    if (p[1] && (p[1] & 0xC0) == 0x80) {
+    if (avail >= 2 && p[1] && (p[1] & 0xC0) == 0x80) {
       uint32_t cp = ((c & 0x1F) << 6) | (p[1] & 0x3F);
       p += 2;
       return cp;
@@ -37,7 +56,7 @@ static uint32_t decodeUtf8Codepoint(const unsigned char*& p) {
 
   // 3-byte sequence
   if ((c & 0xF0) == 0xE0) {
-    if (p[1] && p[2] && (p[1] & 0xC0) == 0x80 && (p[2] & 0xC0) == 0x80) {
+    if (avail >= 3 && p[1] && p[2] && (p[1] & 0xC0) == 0x80 && (p[2] & 0xC0) == 0x80) {
       uint32_t cp = ((c & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F);
       p += 3;
       return cp;
@@ -48,7 +67,8 @@ static uint32_t decodeUtf8Codepoint(const unsigned char*& p) {
 
   // 4-byte sequence
   if ((c & 0xF8) == 0xF0) {
-    if (p[1] && p[2] && p[3] && (p[1] & 0xC0) == 0x80 && (p[2] & 0xC0) == 0x80 && (p[3] & 0xC0) == 0x80) {
+    if (avail >= 4 && p[1] && p[2] && p[3] && (p[1] & 0xC0) == 0x80 && (p[2] & 0xC0) == 0x80 &&
+        (p[3] & 0xC0) == 0x80) {
       uint32_t cp = ((c & 0x07) << 18) | ((p[1] & 0x3F) << 12) | ((p[2] & 0x3F) << 6) | (p[3] & 0x3F);
       p += 4;
       return cp;
@@ -62,7 +82,8 @@ static uint32_t decodeUtf8Codepoint(const unsigned char*& p) {
   return UTF8_REPLACEMENT_CHAR;
 }
 
-TextRenderer::TextRenderer(EInkDisplay& display) : display(display) {
+TextRenderer::TextRenderer(EInkDisplay& display)
+    : display(display), bufferHeight(EInkDisplay::DISPLAY_WIDTH), bufferStride(EInkDisplay::DISPLAY_WIDTH_BYTES) {
   Serial.printf("[%lu] TextRenderer: Constructor called\n", millis());
 }
 
@@ -72,19 +93,20 @@ void TextRenderer::drawPixel(int16_t x, int16_t y, bool state) {
     return;
   }
 
-  // Bounds checking (portrait: 480x800)
-  if (x < 0 || x >= EInkDisplay::DISPLAY_HEIGHT || y < 0 || y >= EInkDisplay::DISPLAY_WIDTH) {
+  // Bounds checking (portrait: 480x800, or the rows of the current strip)
+  if (x < 0 || x >= EInkDisplay::DISPLAY_HEIGHT || y < bufferTop || y >= bufferTop + bufferHeight) {
     return;
   }
 
   // Rotate coordinates: portrait (480x800) -> landscape (800x480)
   // Rotation: 90 degrees clockwise
-  int16_t rotatedX = y;
+  int16_t rotatedX = y - bufferTop;
   int16_t rotatedY = EInkDisplay::DISPLAY_HEIGHT - 1 - x;
 
   // Calculate byte position and bit position
-  uint16_t byteIndex = rotatedY * EInkDisplay::DISPLAY_WIDTH_BYTES + (rotatedX / 8);
+  uint16_t byteIndex = rotatedY * bufferStride + (rotatedX / 8);
   uint8_t bitPosition = 7 - (rotatedX % 8);  // MSB first
+  frameBufferWrites++;
 
   // Set or clear the bit
   if (state) {
@@ -95,7 +117,19 @@ void TextRenderer::drawPixel(int16_t x, int16_t y, bool state) {
 }
 
 void TextRenderer::setFrameBuffer(uint8_t* buffer) {
+  setFrameStrip(buffer, 0, EInkDisplay::DISPLAY_WIDTH);
+}
+
+void TextRenderer::setFrameStrip(uint8_t* buffer, int16_t top, int16_t height) {
   frameBuffer = buffer;
+  bufferTop = top;
+  bufferHeight = height;
+  bufferStride = height / 8;
+}
+
+void TextRenderer::setGrayscaleStrips(uint8_t* lsbBuffer, uint8_t* msbBuffer, int16_t top, int16_t height) {
+  setFrameStrip(lsbBuffer, top, height);
+  msbFrameBuffer = msbBuffer;
 }
 
 void TextRenderer::setBitmapType(BitmapType type) {
@@ -103,6 +137,9 @@ void TextRenderer::setBitmapType(BitmapType type) {
 }
 
 void TextRenderer::setFont(const SimpleGFXfont* f) {
+  // Selecting the same font again keeps cached measurements
+  if (f != currentFont || currentFamily)
+    ++fontGeneration;
   currentFont = f;
   // Reset family and style when setting a single font directly
   currentFamily = nullptr;
@@ -110,6 +147,8 @@ void TextRenderer::setFont(const SimpleGFXfont* f) {
 }
 
 void TextRenderer::setFontFamily(FontFamily* family) {
+  if (family != currentFamily)
+    ++fontGeneration;
   currentFamily = family;
   // Automatically set to the current style's variant
   currentFont = getFontVariant(family, currentStyle);
@@ -122,6 +161,10 @@ void TextRenderer::setFontStyle(FontStyle style) {
   }
 }
 
+const SimpleGFXfont* TextRenderer::getFontForStyle(FontStyle style) const {
+  return currentFamily ? getFontVariant(currentFamily, style) : currentFont;
+}
+
 void TextRenderer::setTextColor(uint16_t c) {
   textColor = c;
 }
@@ -173,22 +216,7 @@ void TextRenderer::getTextBounds(const char* str, int16_t x, int16_t y, int16_t*
 
   if (currentFont) {
     const SimpleGFXfont* f = currentFont;
-    uint16_t totalWidth = 0;
-    const unsigned char* p = reinterpret_cast<const unsigned char*>(str);
-
-    while (*p) {
-      uint32_t codepoint = decodeUtf8Codepoint(p);
-      int glyphIndex = findGlyphIndex(f, codepoint);
-
-      if (glyphIndex >= 0) {
-        const SimpleGFXglyph* glyph = &f->glyph[glyphIndex];
-        totalWidth += glyph->xAdvance + GLYPH_PADDING;
-      } else {
-        totalWidth += FALLBACK_GLYPH_WIDTH;
-      }
-    }
-
-    width = totalWidth;
+    width = getTextWidth(str, strlen(str));
     height = (f->yAdvance > 0) ? f->yAdvance : 10;
   }
 
@@ -202,6 +230,63 @@ void TextRenderer::getTextBounds(const char* str, int16_t x, int16_t y, int16_t*
     *h = height;
 }
 
+uint16_t TextRenderer::getTextWidth(const char* text, size_t length) {
+  if (!text || !currentFont) {
+    return 0;
+  }
+
+  const SimpleGFXfont* f = currentFont;
+  uint16_t totalWidth = 0;
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(text);
+  const unsigned char* end = p + length;
+
+  const GlyphTable* table = getGlyphTable(f);
+  if (table) {
+    // Width only: ASCII is summed straight from the flat advance table, other
+    // characters are decoded and looked up
+    const uint8_t* flatAdvance = table->getFlatAdvances();
+    while (p < end) {
+      if (*p < 0x80) {
+        totalWidth += flatAdvance[*p++];
+      } else {
+        totalWidth += table->advanceOf(decodeUtf8Codepoint(p, end));
+      }
+    }
+    return totalWidth;
+  }
+
+  while (p < end) {
+    uint32_t codepoint = decodeUtf8Codepoint(p, end);
+    int glyphIndex = findGlyphIndex(f, codepoint);
+    if (glyphIndex >= 0) {
+      totalWidth += f->glyph[glyphIndex].xAdvance + GLYPH_PADDING;
+    } else {
+      totalWidth += FALLBACK_GLYPH_WIDTH;
+    }
+  }
+  return totalWidth;
+}
+
+void TextRenderer::getFontExtent(int16_t& top, int16_t& bottom) {
+  top = 0;
+  bottom = 0;
+  const GlyphTable* table = currentFont ? getGlyphTable(currentFont) : nullptr;
+  if (table) {
+    top = table->getTop();
+    bottom = table->getBottom();
+    return;
+  }
+  for (uint16_t i = 0; currentFont && i < currentFont->glyphCount; i++) {
+    const SimpleGFXglyph& glyph = currentFont->glyph[i];
+    if (glyph.yOffset < top) {
+      top = glyph.yOffset;
+    }
+    if (glyph.yOffset + glyph.height > bottom) {
+      bottom = glyph.yOffset + glyph.height;
+    }
+  }
+}
+
 void TextRenderer::drawChar(uint32_t codepoint) {
   if (!currentFont) {
     return;
@@ -218,64 +303,358 @@ void TextRenderer::drawChar(uint32_t codepoint) {
 
   const SimpleGFXglyph* glyph = &f->glyph[glyphIndex];
 
-  // Select the appropriate bitmap based on bitmapType
-  const uint8_t* bitmap = nullptr;
+  // Font pack and synthetic bitmaps come from their caches
+  SimpleGFXfont packed;
+  if (f->pack) {
+    f = frameBuffer && loadPackedGlyph(f, glyphIndex, packed) ? &packed : nullptr;
+  } else if (f->synthetic) {
+    f = frameBuffer && loadSyntheticGlyph(f, glyphIndex, packed) ? &packed : nullptr;
+  }
+
+  // If the selected bitmap doesn't exist, skip rendering
+  const uint8_t* bitmap = f ? selectBitmap(f) : nullptr;
+  if (!bitmap) {
+    cursorX += glyph->xAdvance + GLYPH_PADDING;
+    return;
+  }
+
+  blitGlyph(*f, *glyph, bitmap, cursorX + glyph->xOffset, cursorY + glyph->yOffset);
+
+  // Advance cursor by xAdvance
+  cursorX += glyph->xAdvance + GLYPH_PADDING;
+}
+
+const uint8_t* TextRenderer::selectBitmap(const SimpleGFXfont* font) const {
   switch (bitmapType) {
     case BITMAP_BW:
-      bitmap = f->bitmap;
-      break;
+      return font->bitmap;
     case BITMAP_GRAY_LSB:
-      bitmap = f->bitmap_gray_lsb;
-      break;
+      return font->bitmap_gray_lsb;
     case BITMAP_GRAY_MSB:
-      bitmap = f->bitmap_gray_msb;
-      break;
+      return font->bitmap_gray_msb;
+    case BITMAP_GRAY:
+      return font->bitmap_gray_msb && msbFrameBuffer ? font->bitmap_gray_lsb : nullptr;
   }
+  return nullptr;
+}
 
-  // If the selected bitmap doesn't exist, skip rendering
-  if (!bitmap) {
-    cursorX += glyph->xAdvance + GLYPH_PADDING;
+size_t TextRenderer::shapeText(const SimpleGFXfont* font, const char* text, size_t length, uint16_t* glyphs,
+                               uint8_t* advances) {
+  if (!font || !text) {
+    return 0;
+  }
+
+  const GlyphTable* table = getGlyphTable(font);
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(text);
+  const unsigned char* end = p + length;
+  size_t count = 0;
+  while (p < end && *p) {
+    uint32_t codepoint = decodeUtf8Codepoint(p, end);
+    int glyphIndex = table ? table->indexOf(codepoint) : findGlyphIndex(font, codepoint);
+    if (glyphIndex < 0) {
+      glyphs[count] = GlyphTable::NO_GLYPH;
+      advances[count] = FALLBACK_GLYPH_WIDTH;
+    } else {
+      glyphs[count] = static_cast<uint16_t>(glyphIndex);
+      advances[count] = font->glyph[glyphIndex].xAdvance + GLYPH_PADDING;
+    }
+    ++count;
+  }
+  return count;
+}
+
+void TextRenderer::drawGlyphRun(const SimpleGFXfont* font, const uint16_t* glyphs, const uint8_t* advances,
+                                size_t count) {
+  if (!font) {
     return;
   }
 
-  uint16_t bitmapOffset = glyph->bitmapOffset;
-  uint8_t w = glyph->width;
-  uint8_t h = glyph->height;
-  int8_t xOffset = glyph->xOffset;
-  int8_t yOffset = glyph->yOffset;
+  SimpleGFXfont packed;
+  const SimpleGFXfont* source = font;
+  const uint8_t* bitmap = frameBuffer ? selectBitmap(font) : nullptr;
+  for (size_t i = 0; i < count; i++) {
+    if (frameBuffer && glyphs[i] != GlyphTable::NO_GLYPH) {
+      // Font pack and synthetic bitmaps come from their caches, glyph by glyph
+      if (font->pack || font->synthetic) {
+        bool loaded =
+            font->pack ? loadPackedGlyph(font, glyphs[i], packed) : loadSyntheticGlyph(font, glyphs[i], packed);
+        source = loaded ? &packed : nullptr;
+        bitmap = source ? selectBitmap(source) : nullptr;
+      }
+      if (bitmap) {
+        const SimpleGFXglyph& glyph = font->glyph[glyphs[i]];
+        blitGlyph(*source, glyph, bitmap, cursorX + glyph.xOffset, cursorY + glyph.yOffset);
+      }
+    }
+    cursorX += advances[i];
+  }
+}
+
+bool TextRenderer::loadPackedGlyph(const SimpleGFXfont* font, uint16_t glyphIndex, SimpleGFXfont& packed) {
+  packed = *font;
+  packed.pack = nullptr;
+  if (font->flags & FONT_FLAG_COMPRESSED) {
+    // One stream holds all planes
+    packed.bitmap = font->pack->getPlane(glyphIndex, FontPack::PLANE_BW);
+    packed.bitmap_gray_lsb = font->pack->hasGrayscale() ? packed.bitmap : nullptr;
+    packed.bitmap_gray_msb = packed.bitmap_gray_lsb;
+    return packed.bitmap != nullptr;
+  }
+  if (bitmapType == BITMAP_BW) {
+    packed.bitmap = font->pack->getPlane(glyphIndex, FontPack::PLANE_BW);
+    return packed.bitmap != nullptr;
+  }
+  // The grayscale blits read both gray planes
+  packed.bitmap_gray_lsb = font->pack->getPlane(glyphIndex, FontPack::PLANE_GRAY_LSB);
+  if (!packed.bitmap_gray_lsb) {
+    return false;
+  }
+  packed.bitmap_gray_msb = font->pack->getPlane(glyphIndex, FontPack::PLANE_GRAY_MSB);
+  return packed.bitmap_gray_msb != nullptr;
+}
+
+bool TextRenderer::loadSyntheticGlyph(const SimpleGFXfont* font, uint16_t glyphIndex, SimpleGFXfont& synthetic) {
+  const uint8_t* planes[3];
+  if (!font->synthetic->getGlyph(glyphIndex, planes)) {
+    return false;
+  }
+  // The glyph's bitmapOffset is 0: the planes hold just this glyph
+  synthetic = *font;
+  synthetic.synthetic = nullptr;
+  synthetic.bitmap = planes[0];
+  synthetic.bitmap_gray_lsb = planes[1];
+  synthetic.bitmap_gray_msb = planes[2];
+  return true;
+}
+
+void TextRenderer::blitGlyph(const SimpleGFXfont& font, const SimpleGFXglyph& glyph, const uint8_t* bitmap, int16_t x0,
+                             int16_t y0) {
+  if (!frameBuffer) {
+    return;
+  }
+
+  // Clip the glyph once against the portrait page (480x800) or the strip
+  int16_t colStart = x0 < 0 ? -x0 : 0;
+  int16_t colEnd = glyph.width;
+  if (x0 + colEnd > EInkDisplay::DISPLAY_HEIGHT) {
+    colEnd = EInkDisplay::DISPLAY_HEIGHT - x0;
+  }
+  int16_t rowStart = y0 < bufferTop ? bufferTop - y0 : 0;
+  int16_t rowEnd = glyph.height;
+  if (y0 + rowEnd > bufferTop + bufferHeight) {
+    rowEnd = bufferTop + bufferHeight - y0;
+  }
+  if (colStart >= colEnd || rowStart >= rowEnd) {
+    return;
+  }
+
+  if ((font.flags & (FONT_FLAG_COLUMN_MAJOR | FONT_FLAG_COMPRESSED)) == FONT_FLAG_COLUMN_MAJOR) {
+    blitGlyphColumns(font, glyph, bitmap, x0, y0, colStart, colEnd, rowStart, rowEnd);
+    return;
+  }
 
-  // Calculate row stride in bytes (width rounded up to byte boundary)
-  uint8_t rowStride = (w + 7) / 8;
+  const uint8_t rowStride = (glyph.width + 7) / 8;
+  const bool isGrayscale = (bitmapType != BITMAP_BW);
+  // BITMAP_GRAY: `glyphBits` is the LSB plane, the MSB plane goes to msbFrameBuffer
+  const bool bothPlanes = (bitmapType == BITMAP_GRAY);
+  const bool compressed = (font.flags & FONT_FLAG_COMPRESSED) != 0;
+  const uint8_t* glyphBits = compressed ? nullptr : bitmap + glyph.bitmapOffset;
+  const uint8_t* lsbBits = isGrayscale && !compressed ? font.bitmap_gray_lsb + glyph.bitmapOffset : nullptr;
+  const uint8_t* msbBits = isGrayscale && !compressed ? font.bitmap_gray_msb + glyph.bitmapOffset : nullptr;
+
+  // Compressed glyphs are decoded one band of rows at a time into these
+  // (row r of the band at (r - row) * rowStride); rows above the visible
+  // ones are skipped
+  uint8_t bandBits[3][8 * GlyphDecoder::MAX_ROW_BYTES];
+  GlyphDecoder decoder(bitmap + glyph.bitmapOffset);
+  if (compressed) {
+    decoder.skip(static_cast<uint32_t>(rowStart) * glyph.width);
+  }
 
-  // Cache the grayscale bitmap pointers outside the loop for better performance
-  const uint8_t* bitmap_lsb = f->bitmap_gray_lsb;
-  const uint8_t* bitmap_msb = f->bitmap_gray_msb;
-  bool isGrayscale = (bitmapType != BITMAP_BW);
+  // The framebuffer is landscape: portrait pixel (px, py) is bit 7 - py % 8 of
+  // byte (479 - px) * 100 + py / 8. A glyph row therefore lands in one bit
+  // position, stepping back one framebuffer row per pixel, and the up to 8
+  // consecutive glyph rows that share a destination byte form a band. Each
+  // band is processed in 8x8 pixel blocks: the block's source bytes are
+  // transposed so every glyph column becomes one destination byte, written
+  // with a single read-modify-write (empty blocks and columns are skipped).
+  // Strips use the same layout with their own row length and first row.
+  const uint8_t firstByte = colStart >> 3;
+  const uint8_t lastByte = (colEnd - 1) >> 3;
+  const uint8_t firstMask = 0xFF >> (colStart & 7);
+  const uint8_t lastMask = 0xFF << (7 - ((colEnd - 1) & 7));
+
+  int16_t row = rowStart;
+  while (row < rowEnd) {
+    const int16_t py = y0 + row;
+    const uint8_t firstBit = py & 7;  // destination bit index (from the MSB) of the band's first row
+    int16_t bandEnd = row + (8 - firstBit);
+    if (bandEnd > rowEnd) {
+      bandEnd = rowEnd;
+    }
+    // Offset of the destination byte for glyph column 0 (may lie outside the
+    // buffer when that column is clipped; it is only used for visible columns)
+    const int32_t bandOffset =
+        static_cast<int32_t>(EInkDisplay::DISPLAY_HEIGHT - 1 - x0) * bufferStride + (py - bufferTop) / 8;
+
+    // The band's rows of the selected plane and the gray planes
+    const uint8_t* bandGlyph;
+    const uint8_t* bandLsb;
+    const uint8_t* bandMsb;
+    if (compressed) {
+      for (int16_t r = row; r < bandEnd; r++) {
+        const uint16_t start = (r - row) * rowStride;
+        decoder.decodeRow(glyph.width, bandBits[0] + start, bandBits[1] + start, bandBits[2] + start);
+      }
+      bandLsb = bandBits[1];
+      bandMsb = bandBits[2];
+      bandGlyph = bitmapType == BITMAP_BW ? bandBits[0] : bitmapType == BITMAP_GRAY_MSB ? bandMsb : bandLsb;
+    } else {
+      bandGlyph = glyphBits + row * rowStride;
+      bandLsb = isGrayscale ? lsbBits + row * rowStride : nullptr;
+      bandMsb = isGrayscale ? msbBits + row * rowStride : nullptr;
+    }
 
-  // Render each pixel in the glyph
-  for (uint8_t yy = 0; yy < h; yy++) {
-    for (uint8_t xx = 0; xx < w; xx++) {
-      int16_t px = cursorX + xOffset + xx;
-      int16_t py = cursorY + yOffset + yy;
+    for (uint8_t b = firstByte; b <= lastByte; b++) {
+      const uint8_t clip = (b == firstByte ? firstMask : 0xFF) & (b == lastByte ? lastMask : 0xFF);
+
+      // Rows of the block, MSB-first (row for destination bit 0x80 in the top
+      // byte); `clearBits` are the pixels written, `setBits` (and `setMsbBits`
+      // for the second plane) those written white
+      uint64_t clearBits = 0;
+      uint64_t setBits = 0;
+      uint64_t setMsbBits = 0;
+      for (int16_t r = row; r < bandEnd; r++) {
+        const uint16_t index = (r - row) * rowStride + b;
+        const int shift = 56 - 8 * (firstBit + (r - row));
+        // 0 = pixel on in our bitmap format
+        if (isGrayscale) {
+          // skip writing over black/white pixels
+          uint8_t write = ~(bandLsb[index] & bandMsb[index]) & clip;
+          clearBits |= static_cast<uint64_t>(write) << shift;
+          setBits |= static_cast<uint64_t>(write & bandGlyph[index]) << shift;
+          if (bothPlanes) {
+            setMsbBits |= static_cast<uint64_t>(write & bandMsb[index]) << shift;
+          }
+        } else {
+          clearBits |= static_cast<uint64_t>(static_cast<uint8_t>(~bandGlyph[index] & clip)) << shift;
+        }
+      }
+      if (!clearBits) {
+        continue;
+      }
 
-      // Calculate bitmap byte and bit positions for current pixel
-      uint16_t byteIndex = bitmapOffset + (yy * rowStride) + (xx / 8);
-      uint8_t bitMask = 1 << (7 - (xx % 8));
+      clearBits = transpose8x8(clearBits);
+      if (isGrayscale) {
+        setBits = transpose8x8(setBits);
+      }
+      if (bothPlanes) {
+        setMsbBits = transpose8x8(setMsbBits);
+      }
+      // Byte k (from the top) is now glyph column 8 * b + k
+      int32_t offset = bandOffset - (8 * b) * bufferStride;
+      for (int k = 0; k < 8; k++, offset -= bufferStride) {
+        const int shift = 56 - 8 * k;
+        const uint8_t clear = static_cast<uint8_t>(clearBits >> shift);
+        if (clear) {
+          frameBufferWrites += bothPlanes ? 2 : 1;
+          uint8_t* dst = frameBuffer + offset;
+          *dst = isGrayscale ? (*dst & ~clear) | static_cast<uint8_t>(setBits >> shift) : *dst & ~clear;
+          if (bothPlanes) {
+            uint8_t* msbDst = msbFrameBuffer + offset;
+            *msbDst = (*msbDst & ~clear) | static_cast<uint8_t>(setMsbBits >> shift);
+          }
+        }
+      }
+    }
+    row = bandEnd;
+  }
+}
 
+void TextRenderer::blitGlyphColumns(const SimpleGFXfont& font, const SimpleGFXglyph& glyph, const uint8_t* bitmap,
+                                    int16_t x0, int16_t y0, int16_t colStart, int16_t colEnd, int16_t rowStart,
+                                    int16_t rowEnd) {
+  // Column-major glyphs are already in framebuffer orientation: glyph column x
+  // is framebuffer row 479 - (x0 + x), and its bytes hold 8 rows each, MSB
+  // first, like the framebuffer bytes along that row. A column is loaded into
+  // a 64-bit word, shifted to the bit position of its first row and written
+  // out byte by byte; columns taller than COLUMN_WORD_ROWS are split.
+  const uint8_t colStride = (glyph.height + 7) / 8;
+  const bool isGrayscale = (bitmapType != BITMAP_BW);
+  const bool bothPlanes = (bitmapType == BITMAP_GRAY);
+  const uint8_t* glyphBits = bitmap + glyph.bitmapOffset;
+  const uint8_t* lsbBits = isGrayscale ? font.bitmap_gray_lsb + glyph.bitmapOffset : nullptr;
+  const uint8_t* msbBits = isGrayscale ? font.bitmap_gray_msb + glyph.bitmapOffset : nullptr;
+
+  static constexpr int16_t COLUMN_WORD_ROWS = 56;  // 7 source bytes plus up to 7 bits of shift
+  for (int16_t segStart = rowStart & ~7; segStart < rowEnd; segStart += COLUMN_WORD_ROWS) {
+    int16_t segEnd = segStart + COLUMN_WORD_ROWS;
+    if (segEnd > rowEnd) {
+      segEnd = rowEnd;
+    }
+    const int16_t visibleStart = segStart > rowStart ? segStart : rowStart;
+    const uint8_t firstSrc = segStart >> 3;
+    const uint8_t srcCount = ((segEnd + 7) >> 3) - firstSrc;
+    // Destination bytes covering rows [visibleStart, segEnd); bit 63 of a
+    // word is the top row of the first of them
+    const int16_t firstDst = (y0 + visibleStart) >> 3;
+    const uint8_t dstCount = ((y0 + segEnd - 1) >> 3) - firstDst + 1;
+    const int8_t shift = (y0 + segStart) - 8 * firstDst;  // -7..7 rows
+    const uint8_t srcShift = 64 - 8 * srcCount;
+    const uint8_t visibleRows = segEnd - visibleStart;
+    const uint64_t clip = (~0ULL << (64 - visibleRows)) >> ((y0 + visibleStart) & 7);
+
+    int32_t offset = static_cast<int32_t>(EInkDisplay::DISPLAY_HEIGHT - 1 - x0 - colStart) * bufferStride +
+                     firstDst - (bufferTop >> 3);
+    uint16_t index = colStart * colStride + firstSrc;
+    for (int16_t col = colStart; col < colEnd; col++, offset -= bufferStride, index += colStride) {
+      uint64_t clear = 0;
+      uint64_t set = 0;
+      uint64_t setMsb = 0;
+      for (uint8_t j = 0; j < srcCount; j++) {
+        clear = (clear << 8) | static_cast<uint8_t>(~glyphBits[index + j]);
+        if (isGrayscale) {
+          set = (set << 8) | (lsbBits[index + j] & msbBits[index + j]);
+        }
+        if (bothPlanes) {
+          setMsb = (setMsb << 8) | msbBits[index + j];
+        }
+      }
+      clear <<= srcShift;
       if (isGrayscale) {
-        // skip writing over black/white pixels
-        if ((bitmap_lsb[byteIndex] & bitMask) == 0 || (bitmap_msb[byteIndex] & bitMask) == 0) {
-          drawPixel(px, py, (bitmap[byteIndex] & bitMask) == 0);
+        // skip writing over black/white pixels; `clear` becomes the pixels
+        // written and `set` (and `setMsb`) those written white
+        uint64_t write = ~(set << srcShift);
+        set = ~clear & write;
+        setMsb = (setMsb << srcShift) & write;
+        clear = write;
+      }
+      clear = shift >= 0 ? clear >> shift : clear << -shift;
+      clear &= clip;
+      if (!clear) {
+        continue;
+      }
+      frameBufferWrites += bothPlanes ? 2 * dstCount : dstCount;
+      uint8_t* dst = frameBuffer + offset;
+      if (isGrayscale) {
+        set = (shift >= 0 ? set >> shift : set << -shift) & clip;
+        for (uint8_t k = 0; k < dstCount; k++) {
+          const uint8_t c = static_cast<uint8_t>(clear >> (56 - 8 * k));
+          dst[k] = (dst[k] & ~c) | static_cast<uint8_t>(set >> (56 - 8 * k));
+        }
+        if (bothPlanes) {
+          uint8_t* msbDst = msbFrameBuffer + offset;
+          setMsb = (shift >= 0 ? setMsb >> shift : setMsb << -shift) & clip;
+          for (uint8_t k = 0; k < dstCount; k++) {
+            const uint8_t c = static_cast<uint8_t>(clear >> (56 - 8 * k));
+            msbDst[k] = (msbDst[k] & ~c) | static_cast<uint8_t>(setMsb >> (56 - 8 * k));
+          }
         }
       } else {
-        // Check if pixel is set (0 = pixel on in our bitmap format)
-        if ((bitmap[byteIndex] & bitMask) == 0) {
-          drawPixel(px, py, true);
+        for (uint8_t k = 0; k < dstCount; k++) {
+          dst[k] &= ~static_cast<uint8_t>(clear >> (56 - 8 * k));
         }
       }
     }
   }
-
-  // Advance cursor by xAdvance
-  cursorX += glyph->xAdvance + GLYPH_PADDING;
 }
@@ -20,7 +20,8 @@ class TextRenderer {
   enum BitmapType {
     BITMAP_BW,        // Use the main black & white bitmap
     BITMAP_GRAY_LSB,  // Use the grayscale LSB bitmap
-    BITMAP_GRAY_MSB   // Use the grayscale MSB bitmap
+    BITMAP_GRAY_MSB,  // Use the grayscale MSB bitmap
+    BITMAP_GRAY       // Both grayscale bitmaps in one pass (see setGrayscaleStrips)
   };
 
   // Constructor
@@ -28,9 +29,20 @@ class TextRenderer {
 
   // Low-level pixel draw used by font blitting
   void drawPixel(int16_t x, int16_t y, bool state);
+  // Framebuffer bytes updated by drawPixel() and the glyph blitter so far
+  // (each plane counts); a machine-independent measure of drawing work
+  uint32_t getFrameBufferWrites() const {
+    return frameBufferWrites;
+  }
 
-  // Set which framebuffer to write to
+  // Set which framebuffer to write to (the whole page)
   void setFrameBuffer(uint8_t* buffer);
+  // Write to a buffer holding only portrait rows [top, top + height) of the
+  // page (both multiples of 8): framebuffer layout with height / 8 bytes per
+  // landscape row. Pixels outside the strip are not drawn.
+  void setFrameStrip(uint8_t* buffer, int16_t top, int16_t height);
+  // Targets for BITMAP_GRAY: the LSB and MSB planes of the same strip
+  void setGrayscaleStrips(uint8_t* lsbBuffer, uint8_t* msbBuffer, int16_t top, int16_t height);
 
   // Select which bitmap data to use from the font
   void setBitmapType(BitmapType type);
@@ -40,12 +52,42 @@ class TextRenderer {
   void setFontFamily(FontFamily* family);
   void setFontStyle(FontStyle style);
   void setTextColor(uint16_t c);
+  const SimpleGFXfont* getFont() const {
+    return currentFont;
+  }
+  FontStyle getFontStyle() const {
+    return currentStyle;
+  }
+  // Font setFontStyle(style) would select (the current font without a family)
+  const SimpleGFXfont* getFontForStyle(FontStyle style) const;
+  // Incremented when setFont()/setFontFamily() select a different font or
+  // family; cached measurements taken with an older generation are stale
+  uint32_t getFontGeneration() const {
+    return fontGeneration;
+  }
   void setCursor(int16_t x, int16_t y);
   size_t print(const char* s);
   size_t print(const String& s);
 
+  // Shape `length` bytes of UTF-8 text (stops early at a NUL) in `font`: one
+  // glyph index per character (GlyphTable::NO_GLYPH if the font has none) and
+  // the cursor advance print() would apply. Writes at most `length` entries
+  // and returns the number written.
+  static size_t shapeText(const SimpleGFXfont* font, const char* text, size_t length, uint16_t* glyphs,
+                          uint8_t* advances);
+  // Draw a run from shapeText() at the cursor; same pixels and cursor movement
+  // as print() of the shaped text with `font` selected
+  void drawGlyphRun(const SimpleGFXfont* font, const uint16_t* glyphs, const uint8_t* advances, size_t count);
+
+  // Rows the current font's glyphs can cover, relative to the baseline:
+  // [top, bottom) with top <= 0 for anything above it
+  void getFontExtent(int16_t& top, int16_t& bottom);
+
   // Measure text bounds for layout
   void getTextBounds(const char* str, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h);
+  // Advance width of `length` bytes of UTF-8 text (need not be NUL-terminated).
+  // Same result as the width from getTextBounds() for the same characters.
+  uint16_t getTextWidth(const char* text, size_t length);
 
   // Color constants (0 = black, 1 = white for 1-bit display)
   static const uint16_t COLOR_BLACK = 0;
@@ -56,15 +98,39 @@ class TextRenderer {
   const SimpleGFXfont* currentFont = nullptr;
   FontFamily* currentFamily = nullptr;
   FontStyle currentStyle = FontStyle::REGULAR;
+  uint32_t fontGeneration = 0;
   uint8_t* frameBuffer = nullptr;
+  uint8_t* msbFrameBuffer = nullptr;  // MSB plane for BITMAP_GRAY
+  int16_t bufferTop = 0;              // first portrait row held by the buffers
+  int16_t bufferHeight;               // portrait rows held by the buffers
+  uint8_t bufferStride;               // bytes per landscape row
   BitmapType bitmapType = BITMAP_BW;
   int16_t cursorX = 0;
   int16_t cursorY = 0;
   uint16_t textColor = COLOR_BLACK;
+  uint32_t frameBufferWrites = 0;
 
   // Draw a single Unicode codepoint. Accepts a full Unicode codepoint
   // (decoded from UTF-8) so the renderer can support multi-byte UTF-8 input.
   void drawChar(uint32_t codepoint);
+  // Bitmap of `font` selected by bitmapType, or nullptr if there is none
+  const uint8_t* selectBitmap(const SimpleGFXfont* font) const;
+  // Font pack glyphs: `packed` becomes `font` with the bitmap planes of the
+  // glyph's block that bitmapType needs; false if they cannot be loaded
+  bool loadPackedGlyph(const SimpleGFXfont* font, uint16_t glyphIndex, SimpleGFXfont& packed);
+  // Synthetic glyphs: `synthetic` becomes `font` with the glyph's planes from
+  // the SyntheticFont cache; false if the base glyph cannot be read
+  bool loadSyntheticGlyph(const SimpleGFXfont* font, uint16_t glyphIndex, SimpleGFXfont& synthetic);
+  // Copy a glyph's bitmap with its top-left corner at portrait (x0, y0),
+  // clipped to the page; same pixels as drawPixel() for each glyph pixel.
+  // `font` supplies the bitmap layout and the gray planes; compressed glyphs
+  // are decoded a band of up to 8 rows at a time.
+  void blitGlyph(const SimpleGFXfont& font, const SimpleGFXglyph& glyph, const uint8_t* bitmap, int16_t x0,
+                 int16_t y0);
+  // blitGlyph() for fonts with FONT_FLAG_COLUMN_MAJOR, given the visible
+  // glyph columns [colStart, colEnd) and rows [rowStart, rowEnd)
+  void blitGlyphColumns(const SimpleGFXfont& font, const SimpleGFXglyph& glyph, const uint8_t* bitmap, int16_t x0,
+                        int16_t y0, int16_t colStart, int16_t colEnd, int16_t rowStart, int16_t rowEnd);
 };
 
 #endif
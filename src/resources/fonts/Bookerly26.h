@@ -5071,4 +5071,4 @@ const SimpleGFXglyph Bookerly26Glyphs[] PROGMEM = {
 
 
 const SimpleGFXfont Bookerly26 PROGMEM = {Bookerly26Bitmaps, Bookerly26Bitmaps_lsb, Bookerly26Bitmaps_msb, Bookerly26Glyphs,
-    310, 28};
+    310, 28, nullptr, 0, FontStyle::REGULAR, 0, nullptr, nullptr};
@@ -5251,4 +5251,4 @@ const SimpleGFXglyph Bookerly26BoldGlyphs[] PROGMEM = {
 
 
 const SimpleGFXfont Bookerly26Bold PROGMEM = {Bookerly26BoldBitmaps, Bookerly26BoldBitmaps_lsb, Bookerly26BoldBitmaps_msb, Bookerly26BoldGlyphs,
-    310, 28};
+    310, 28, nullptr, 0, FontStyle::REGULAR, 0, nullptr, nullptr};
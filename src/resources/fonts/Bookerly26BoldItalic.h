@@ -5332,4 +5332,4 @@ const SimpleGFXglyph Bookerly26BoldItalicGlyphs[] PROGMEM = {
 
 
 const SimpleGFXfont Bookerly26BoldItalic PROGMEM = {Bookerly26BoldItalicBitmaps, Bookerly26BoldItalicBitmaps_lsb, Bookerly26BoldItalicBitmaps_msb, Bookerly26BoldItalicGlyphs,
-    310, 28};
+    310, 28, nullptr, 0, FontStyle::REGULAR, 0, nullptr, nullptr};
@@ -5125,4 +5125,4 @@ const SimpleGFXglyph Bookerly26ItalicGlyphs[] PROGMEM = {
 
 
 const SimpleGFXfont Bookerly26Italic PROGMEM = {Bookerly26ItalicBitmaps, Bookerly26ItalicBitmaps_lsb, Bookerly26ItalicBitmaps_msb, Bookerly26ItalicGlyphs,
-    310, 28};
+    310, 28, nullptr, 0, FontStyle::REGULAR, 0, nullptr, nullptr};
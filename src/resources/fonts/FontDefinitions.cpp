@@ -1,39 +1,53 @@
 #include <Arduino.h>
 
 #include "Bookerly26.h"
-#include "Bookerly26Bold.h"
-#include "Bookerly26BoldItalic.h"
-#include "Bookerly26Italic.h"
 #include "Font14.h"
 #include "Font27.h"
 #include "NotoSans26.h"
+#ifndef SYNTHETIC_FONT_STYLES
+#include "Bookerly26Bold.h"
+#include "Bookerly26BoldItalic.h"
+#include "Bookerly26Italic.h"
 #include "NotoSans26Bold.h"
 #include "NotoSans26BoldItalic.h"
 #include "NotoSans26Italic.h"
+#endif
 
 // Font definitions
-const SimpleGFXfont Font14 = {Font14Bitmaps, nullptr, nullptr, Font14Glyphs, 305, 16, "Font14", 14, FontStyle::REGULAR};
-const SimpleGFXfont Font27 = {Font27Bitmaps, nullptr, nullptr, Font27Glyphs, 305, 29, "Font27", 27, FontStyle::REGULAR};
+const SimpleGFXfont Font14 = {Font14Bitmaps, nullptr, nullptr, Font14Glyphs, 305, 16, "Font14", 14, FontStyle::REGULAR,
+                              0, nullptr, nullptr};
+const SimpleGFXfont Font27 = {Font27Bitmaps, nullptr, nullptr, Font27Glyphs, 305, 29, "Font27", 27, FontStyle::REGULAR,
+                              0, nullptr, nullptr};
 
 // Font families (group variants together)
+#ifdef SYNTHETIC_FONT_STYLES
+// Only the regular faces are compiled in; bold and italic are made from them
+// at run time (see SyntheticFont), saving the flash of six variants
+FontFamily notoSansFamily = {"NotoSans", &NotoSans26, nullptr, nullptr, nullptr, SYNTHESIZE_BOLD | SYNTHESIZE_ITALIC};
+
+FontFamily bookerlyFamily = {"Bookerly", &Bookerly26, nullptr, nullptr, nullptr, SYNTHESIZE_BOLD | SYNTHESIZE_ITALIC};
+#else
 FontFamily notoSansFamily = {
     "NotoSans",
-    &NotoSans26,           // regular
-    &NotoSans26Bold,       // bold
-    &NotoSans26Italic,     // italic
-    &NotoSans26BoldItalic  // boldItalic
+    &NotoSans26,            // regular
+    &NotoSans26Bold,        // bold
+    &NotoSans26Italic,      // italic
+    &NotoSans26BoldItalic,  // boldItalic
+    0                       // synthesize
 };
 
 FontFamily bookerlyFamily = {
     "Bookerly",
-    &Bookerly26,           // regular
-    &Bookerly26Bold,       // bold
-    &Bookerly26Italic,     // italic
-    &Bookerly26BoldItalic  // boldItalic
+    &Bookerly26,            // regular
+    &Bookerly26Bold,        // bold
+    &Bookerly26Italic,      // italic
+    &Bookerly26BoldItalic,  // boldItalic
+    0                       // synthesize
 };
+#endif
 
 // Example: Font14 family
-FontFamily font14Family = {"Font14", &Font14, nullptr, nullptr, nullptr};
+FontFamily font14Family = {"Font14", &Font14, nullptr, nullptr, nullptr, 0};
 
 // Example: Font27 family
-FontFamily font27Family = {"Font27", &Font27, nullptr, nullptr, nullptr};
+FontFamily font27Family = {"Font27", &Font27, nullptr, nullptr, nullptr, 0};
@@ -4,9 +4,11 @@
 
 // Font extern declarations
 extern const SimpleGFXfont NotoSans26;
+#ifndef SYNTHETIC_FONT_STYLES
 extern const SimpleGFXfont NotoSans26Bold;
 extern const SimpleGFXfont NotoSans26Italic;
 extern const SimpleGFXfont NotoSans26BoldItalic;
+#endif
 extern const SimpleGFXfont Font14;
 extern const SimpleGFXfont Font27;
 
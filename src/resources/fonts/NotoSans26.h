@@ -3523,4 +3523,4 @@ const SimpleGFXglyph NotoSans26Glyphs[] PROGMEM = {
 };
 
 inline const SimpleGFXfont NotoSans26 PROGMEM = {
-    NotoSans26Bitmaps, NotoSans26Bitmaps_lsb, NotoSans26Bitmaps_msb, NotoSans26Glyphs, 308, 28};
+    NotoSans26Bitmaps, NotoSans26Bitmaps_lsb, NotoSans26Bitmaps_msb, NotoSans26Glyphs, 308, 28, nullptr, 0, FontStyle::REGULAR, 0, nullptr, nullptr};
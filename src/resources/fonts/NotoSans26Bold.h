@@ -4862,4 +4862,4 @@ const SimpleGFXglyph NotoSans26BoldGlyphs[] PROGMEM = {
 
 
 inline const SimpleGFXfont NotoSans26Bold PROGMEM = {NotoSans26BoldBitmaps, NotoSans26BoldBitmaps_lsb, NotoSans26BoldBitmaps_msb, NotoSans26BoldGlyphs,
-    308, 28};
+    308, 28, nullptr, 0, FontStyle::REGULAR, 0, nullptr, nullptr};
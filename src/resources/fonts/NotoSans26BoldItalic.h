@@ -3755,4 +3755,4 @@ inline const SimpleGFXfont NotoSans26BoldItalic PROGMEM = {NotoSans26BoldItalicB
                                                            NotoSans26BoldItalicBitmaps_msb,
                                                            NotoSans26BoldItalicGlyphs,
                                                            308,
-                                                           28};
+                                                           28, nullptr, 0, FontStyle::REGULAR, 0, nullptr, nullptr};
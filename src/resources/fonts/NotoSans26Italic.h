@@ -3577,4 +3577,4 @@ const SimpleGFXglyph NotoSans26ItalicGlyphs[] PROGMEM = {
 };
 
 inline const SimpleGFXfont NotoSans26Italic PROGMEM = {
-    NotoSans26ItalicBitmaps, NotoSans26ItalicBitmaps_lsb, NotoSans26ItalicBitmaps_msb, NotoSans26ItalicGlyphs, 308, 28};
+    NotoSans26ItalicBitmaps, NotoSans26ItalicBitmaps_lsb, NotoSans26ItalicBitmaps_msb, NotoSans26ItalicGlyphs, 308, 28, nullptr, 0, FontStyle::REGULAR, 0, nullptr, nullptr};
@@ -52,103 +52,107 @@ bool isConsonant(char32_t c) {
   return isLetter(c) && !isVowel(c);
 }
 
-bool isAllowedOnset(const std::u32string& onset) {
-  static const std::vector<std::u32string> allowed = {
-      U"b",  U"c",    U"d",    U"f",    U"g",    U"h",    U"j",   U"k",   U"l",   U"m",  U"n",   U"p",  U"q",
-      U"r",  U"s",    U"t",    U"v",    U"w",    U"z",    U"ch",  U"pf",  U"ph",  U"qu", U"sch", U"sp", U"st",
-      U"sk", U"kl",   U"kn",   U"kr",   U"pl",   U"pr",   U"tr",  U"dr",  U"gr",  U"gl", U"br",  U"bl", U"fr",
-      U"fl", U"schl", U"schm", U"schn", U"schr", U"schw", U"spr", U"spl", U"str", U"th"};
-
-  return std::find(allowed.begin(), allowed.end(), onset) != allowed.end();
-}
-
-bool matchesCluster(const std::u32string& text, size_t start, const std::u32string& cluster) {
-  if (start + cluster.size() > text.size()) {
-    return false;
+// Words up to this many characters are hyphenated without heap allocations
+const size_t MAX_WORD_CHARS = 64;
+
+// True if text[0, length) is exactly the ASCII string `ascii`
+bool equalsAscii(const char32_t* text, size_t length, const char* ascii) {
+  size_t i = 0;
+  for (; i < length && ascii[i] != '\0'; ++i) {
+    if (text[i] != static_cast<unsigned char>(ascii[i])) {
+      return false;
+    }
   }
-  return std::equal(cluster.begin(), cluster.end(), text.begin() + start);
+  return i == length && ascii[i] == '\0';
 }
 
-std::u32string toLower(const std::u32string& input) {
-  std::u32string result;
-  result.reserve(input.size());
-  for (char32_t c : input) {
-    result.push_back(toLowerGerman(c));
+bool isAllowedOnset(const char32_t* onset, size_t length) {
+  static const char* const allowed[] = {
+      "b",  "c",    "d",    "f",    "g",    "h",    "j",   "k",   "l",   "m",  "n",   "p",  "q",
+      "r",  "s",    "t",    "v",    "w",    "z",    "ch",  "pf",  "ph",  "qu", "sch", "sp", "st",
+      "sk", "kl",   "kn",   "kr",   "pl",   "pr",   "tr",  "dr",  "gr",  "gl", "br",  "bl", "fr",
+      "fl", "schl", "schm", "schn", "schr", "schw", "spr", "spl", "str", "th"};
+
+  for (const char* candidate : allowed) {
+    if (equalsAscii(onset, length, candidate)) {
+      return true;
+    }
   }
-  return result;
+  return false;
 }
 
-}  // namespace
-
-namespace GermanHyphenation {
-
-std::vector<size_t> hyphenate(const std::string& word) {
-  std::u32string wide = converter.from_bytes(word);
-  std::u32string lower = toLower(wide);
-
-  std::vector<size_t> positions;
-  std::vector<size_t> vowelIndices;
-  for (size_t i = 0; i < lower.size(); ++i) {
-    if (isVowel(lower[i])) {
-      vowelIndices.push_back(i);
+bool isInseparablePair(const char32_t* pair, size_t length) {
+  static const char* const pairs[] = {"ch", "ck", "ph", "qu", "tz", "st"};
+  for (const char* candidate : pairs) {
+    if (equalsAscii(pair, length, candidate)) {
+      return true;
     }
   }
+  return false;
+}
 
-  if (vowelIndices.size() < 2) {
-    return positions;
+// Decode the UTF-8 sequence at text[i] and advance i past it. Malformed bytes
+// decode as themselves so a bad word still gets a character per byte.
+char32_t decodeUtf8(const char* text, size_t length, size_t& i) {
+  const unsigned char lead = static_cast<unsigned char>(text[i]);
+  const size_t extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+  if (extra == 0 || i + extra >= length) {
+    ++i;
+    return lead;
   }
-
-  auto isInseparablePair = [](const std::u32string& pair) {
-    static const std::vector<std::u32string> pairs = {U"ch", U"ck", U"ph", U"qu", U"tz", U"st"};
-    for (const auto& p : pairs) {
-      if (pair == p) {
-        return true;
-      }
+  char32_t c = lead & (0x3F >> extra);
+  for (size_t k = 1; k <= extra; ++k) {
+    const unsigned char next = static_cast<unsigned char>(text[i + k]);
+    if ((next & 0xC0) != 0x80) {
+      ++i;
+      return lead;
     }
-    return false;
-  };
-
-  auto isDoubleConsonant = [](const std::u32string& pair) {
-    return pair.size() == 2 && pair[0] == pair[1] && isConsonant(pair[0]);
-  };
-
-  for (size_t i = 0; i + 1 < vowelIndices.size(); ++i) {
-    size_t leftVowel = vowelIndices[i];
-    size_t rightVowel = vowelIndices[i + 1];
+    c = (c << 6) | (next & 0x3F);
+  }
+  i += extra + 1;
+  return c;
+}
 
-    if (rightVowel <= leftVowel + 1) {
-      continue;  // Diphthong or adjacent vowels
+// Syllable boundaries of a lower-case word as character indices, ascending.
+// Each pair of vowels separated by consonants gets at most one boundary.
+size_t findBoundaries(const char32_t* lower, size_t count, uint16_t* boundaries) {
+  size_t found = 0;
+  size_t leftVowel = count;  // none yet
+  for (size_t rightVowel = 0; rightVowel < count; ++rightVowel) {
+    if (!isVowel(lower[rightVowel])) {
+      continue;
+    }
+    const size_t previous = leftVowel;
+    leftVowel = rightVowel;
+    if (previous == count || rightVowel <= previous + 1) {
+      continue;  // First vowel, diphthong or adjacent vowels
     }
 
-    size_t consonantCount = rightVowel - leftVowel - 1;
-    size_t clusterStart = leftVowel + 1;
-    size_t clusterEnd = rightVowel;  // exclusive
+    const size_t consonantCount = rightVowel - previous - 1;
+    const size_t clusterStart = previous + 1;
+    const size_t clusterEnd = rightVowel;  // exclusive
+    const char32_t* cluster = lower + clusterStart;
     size_t boundary = 0;
 
-    std::u32string cluster(lower.begin() + clusterStart, lower.begin() + clusterEnd);
-
     // Special handling for "sch" cluster - keep it together with following consonant
-    if (cluster.size() >= 3 && matchesCluster(cluster, 0, U"sch")) {
+    if (consonantCount >= 3 && equalsAscii(cluster, 3, "sch")) {
       boundary = clusterStart;  // Keep "sch" together on right side
     }
 
     // Check for inseparable pairs
-    if (boundary == 0 && consonantCount == 2) {
-      if (isInseparablePair(cluster)) {
-        boundary = clusterStart;  // Keep pair on right side
-      }
+    if (boundary == 0 && consonantCount == 2 && isInseparablePair(cluster, 2)) {
+      boundary = clusterStart;  // Keep pair on right side
     }
 
     // Try to find a valid onset by checking if entire cluster is allowed
-    if (boundary == 0 && isAllowedOnset(cluster)) {
+    if (boundary == 0 && isAllowedOnset(cluster, consonantCount)) {
       boundary = clusterStart;
     }
 
     // Try to find the largest valid onset from the right
     if (boundary == 0 && consonantCount >= 2) {
-      for (size_t split = 1; split < cluster.size(); ++split) {
-        std::u32string onset(cluster.begin() + split, cluster.end());
-        if (isAllowedOnset(onset)) {
+      for (size_t split = 1; split < consonantCount; ++split) {
+        if (isAllowedOnset(cluster + split, consonantCount - split)) {
           boundary = clusterStart + split;
           break;
         }
@@ -160,51 +164,65 @@ std::vector<size_t> hyphenate(const std::string& word) {
       if (consonantCount == 1) {
         boundary = clusterStart;
       } else if (consonantCount == 2) {
-        std::u32string pair = cluster;
-        if (isInseparablePair(pair)) {
-          boundary = clusterStart;  // Keep pair on right
-        } else {
-          boundary = clusterStart + 1;  // Split in the middle
-        }
+        // Keep an inseparable pair on the right, otherwise split in the middle
+        boundary = isInseparablePair(cluster, 2) ? clusterStart : clusterStart + 1;
       } else {  // consonantCount >= 3
-        std::u32string lastTwo(lower.begin() + clusterEnd - 2, lower.begin() + clusterEnd);
-        if (isInseparablePair(lastTwo)) {
-          boundary = clusterEnd - 2;
-        } else {
-          boundary = clusterEnd - 1;  // Keep last consonant with right syllable
-        }
+        // Keep the last consonant (or inseparable pair) with the right syllable
+        boundary = isInseparablePair(lower + clusterEnd - 2, 2) ? clusterEnd - 2 : clusterEnd - 1;
       }
     }
 
-    if (boundary > 0 && boundary < wide.size()) {
-      positions.push_back(boundary);
+    if (boundary > 0 && boundary < count) {
+      boundaries[found++] = static_cast<uint16_t>(boundary);
     }
   }
+  return found;
+}
 
-  // Convert character positions to byte positions in UTF-8
-  std::vector<size_t> bytePositions;
-  bytePositions.reserve(positions.size());
-
-  for (size_t charPos : positions) {
-    // Count bytes up to the character position
-    size_t bytePos = 0;
-    size_t currentChar = 0;
-    const char* str = word.c_str();
-
-    // Count through UTF-8 characters
-    while (currentChar < charPos && str[bytePos] != '\0') {
-      // Skip to the next UTF-8 character by advancing past continuation bytes
-      bytePos++;
-      // Skip continuation bytes (10xxxxxx pattern)
-      while (str[bytePos] != '\0' && (str[bytePos] & 0xC0) == 0x80) {
-        bytePos++;
-      }
-      currentChar++;
-    }
+}  // namespace
+
+namespace GermanHyphenation {
 
-    bytePositions.push_back(bytePos);
+void hyphenate(const char* word, size_t length, std::vector<uint16_t>& positions) {
+  positions.clear();
+
+  // Lower-case characters and the byte offset each one starts at; words too
+  // long for the stack buffers (rare) fall back to the heap
+  char32_t lowerBuffer[MAX_WORD_CHARS];
+  uint16_t offsetBuffer[MAX_WORD_CHARS];
+  uint16_t boundaryBuffer[MAX_WORD_CHARS];
+  std::vector<char32_t> lowerHeap;
+  std::vector<uint16_t> offsetHeap;
+  std::vector<uint16_t> boundaryHeap;
+  char32_t* lower = lowerBuffer;
+  uint16_t* offsets = offsetBuffer;
+  uint16_t* boundaries = boundaryBuffer;
+  if (length > MAX_WORD_CHARS) {
+    lowerHeap.resize(length);
+    offsetHeap.resize(length);
+    boundaryHeap.resize(length);
+    lower = lowerHeap.data();
+    offsets = offsetHeap.data();
+    boundaries = boundaryHeap.data();
   }
-  return bytePositions;
+
+  size_t count = 0;
+  for (size_t i = 0; i < length && word[i] != '\0';) {
+    offsets[count] = static_cast<uint16_t>(i);
+    lower[count++] = toLowerGerman(decodeUtf8(word, length, i));
+  }
+
+  // Convert character positions to byte positions in UTF-8
+  const size_t found = findBoundaries(lower, count, boundaries);
+  for (size_t i = 0; i < found; ++i) {
+    positions.push_back(offsets[boundaries[i]]);
+  }
+}
+
+std::vector<size_t> hyphenate(const std::string& word) {
+  std::vector<uint16_t> positions;
+  hyphenate(word.c_str(), word.size(), positions);
+  return std::vector<size_t>(positions.begin(), positions.end());
 }
 
 std::string insertHyphens(const std::string& word, const std::vector<size_t>& positions) {
@@ -1,6 +1,8 @@
 #ifndef GERMAN_HYPHENATION_H
 #define GERMAN_HYPHENATION_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -12,6 +14,12 @@ namespace GermanHyphenation {
  */
 std::vector<size_t> hyphenate(const std::string& word);
 
+/**
+ * Same, for `length` bytes at `word`, into `positions` (cleared first).
+ * Does not allocate beyond `positions` for words of up to 64 characters.
+ */
+void hyphenate(const char* word, size_t length, std::vector<uint16_t>& positions);
+
 /**
  * Insert hyphens at specified positions in a word.
  */
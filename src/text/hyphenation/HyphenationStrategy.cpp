@@ -1,5 +1,7 @@
 #include "HyphenationStrategy.h"
 
+#include <algorithm>
+
 #include "GermanHyphenation.h"
 
 // Implementation of the base class method
@@ -36,23 +38,25 @@ class GermanHyphenationStrategy : public HyphenationStrategy {
  public:
   std::vector<size_t> hyphenate(const std::string& word, size_t minWordLength = 6,
                                 size_t minFragmentLength = 3) override {
+    std::vector<uint16_t> positions;
+    hyphenate(word.c_str(), word.length(), positions, minWordLength, minFragmentLength);
+    return std::vector<size_t>(positions.begin(), positions.end());
+  }
+
+  void hyphenate(const char* word, size_t length, std::vector<uint16_t>& positions, size_t minWordLength = 6,
+                 size_t minFragmentLength = 3) override {
+    positions.clear();
     // Only hyphenate words that meet minimum length requirement
-    if (word.length() < minWordLength) {
-      return std::vector<size_t>();
+    if (length < minWordLength || length < 2 * minFragmentLength) {
+      return;
     }
 
     // Get hyphenation positions from German algorithm
-    std::vector<size_t> positions = GermanHyphenation::hyphenate(word);
+    GermanHyphenation::hyphenate(word, length, positions);
 
     // Filter out positions that would create fragments that are too short
-    std::vector<size_t> filtered;
-    for (size_t pos : positions) {
-      if (pos >= minFragmentLength && pos <= word.length() - minFragmentLength) {
-        filtered.push_back(pos);
-      }
-    }
-
-    return filtered;
+    auto tooShort = [&](uint16_t pos) { return pos < minFragmentLength || pos > length - minFragmentLength; };
+    positions.erase(std::remove_if(positions.begin(), positions.end(), tooShort), positions.end());
   }
 
   Language getLanguage() const override {
@@ -1,6 +1,8 @@
 #ifndef HYPHENATION_STRATEGY_H
 #define HYPHENATION_STRATEGY_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -36,6 +38,14 @@ class HyphenationStrategy {
   virtual std::vector<size_t> hyphenate(const std::string& word, size_t minWordLength = 6,
                                         size_t minFragmentLength = 3) = 0;
 
+  /**
+   * Same as hyphenate() above for `length` bytes at `word`, writing the byte
+   * positions into `positions` (cleared first, ascending). Meant for the
+   * layout hot path: it does not allocate once `positions` has grown.
+   */
+  virtual void hyphenate(const char* word, size_t length, std::vector<uint16_t>& positions, size_t minWordLength = 6,
+                         size_t minFragmentLength = 3) = 0;
+
   /**
    * Find all hyphen positions in a word (both existing and algorithmic).
    * Existing hyphens are returned as positive positions.
@@ -65,6 +75,11 @@ class NoHyphenation : public HyphenationStrategy {
     return std::vector<size_t>();  // No algorithmic hyphenation points
   }
 
+  void hyphenate(const char* /*word*/, size_t /*length*/, std::vector<uint16_t>& positions,
+                 size_t /*minWordLength*/ = 6, size_t /*minFragmentLength*/ = 3) override {
+    positions.clear();
+  }
+
   // Override to prevent splitting even on existing hyphens
   std::vector<int> findHyphenPositions(const std::string& word, size_t minWordLength = 6,
                                        size_t minFragmentLength = 3) {
@@ -87,6 +102,11 @@ class BasicHyphenation : public HyphenationStrategy {
     return std::vector<size_t>();  // No algorithmic hyphenation, only existing hyphens
   }
 
+  void hyphenate(const char* /*word*/, size_t /*length*/, std::vector<uint16_t>& positions,
+                 size_t /*minWordLength*/ = 6, size_t /*minFragmentLength*/ = 3) override {
+    positions.clear();
+  }
+
   Language getLanguage() const override {
     return Language::BASIC;
   }
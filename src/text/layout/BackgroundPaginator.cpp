@@ -0,0 +1,99 @@
+#include "BackgroundPaginator.h"
+
+#include <Arduino.h>
+
+#include "../../content/providers/WordProvider.h"
+
+BackgroundPaginator::BackgroundPaginator(LayoutStrategy& layout, PageMap& pageMap)
+    : layout_(layout), pageMap_(pageMap) {}
+
+BackgroundPaginator::~BackgroundPaginator() {
+  end();
+}
+
+void BackgroundPaginator::begin(WordProvider* provider, const LayoutStrategy::LayoutConfig& config) {
+  end();
+  provider_ = provider;
+  config_ = config;
+  currentChapter_ = -1;
+  currentChapterStart_ = 0;
+  skipped_.assign(pageMap_.getChapterCount(), false);
+  chaptersCompleted_ = 0;
+  pagesLaidOut_ = 0;
+}
+
+void BackgroundPaginator::end() {
+  delete provider_;
+  provider_ = nullptr;
+  currentChapter_ = -1;
+}
+
+bool BackgroundPaginator::hasWork() {
+  return provider_ && findNextChapter() >= 0;
+}
+
+int BackgroundPaginator::findNextChapter() {
+  int count = pageMap_.getChapterCount();
+  // Prefer the chapter we are already in to avoid reopening chapter files
+  if (currentChapter_ >= 0 && currentChapter_ < count && !pageMap_.isChapterComplete(currentChapter_) &&
+      !skipped_[currentChapter_])
+    return currentChapter_;
+  for (int c = 0; c < count; ++c) {
+    if (!pageMap_.isChapterComplete(c) && !skipped_[c])
+      return c;
+  }
+  return -1;
+}
+
+int BackgroundPaginator::chapterStart(int chapter) {
+  if (chapter != currentChapter_) {
+    if (!provider_->setChapter(chapter)) {
+      skipped_[chapter] = true;
+      return -1;
+    }
+    // Providers may skip leading bytes (e.g. a UTF-8 BOM) at position 0
+    provider_->setPosition(0);
+    currentChapterStart_ = provider_->getCurrentIndex();
+    currentChapter_ = chapter;
+  }
+  return currentChapterStart_;
+}
+
+int BackgroundPaginator::step(TextRenderer& renderer, int maxPages, YieldCallback shouldYield, void* context) {
+  if (!provider_)
+    return 0;
+
+  int pages = 0;
+  while (pages < maxPages) {
+    if (shouldYield && shouldYield(context))
+      break;
+
+    int chapter = findNextChapter();
+    if (chapter < 0)
+      break;
+    int start = chapterStart(chapter);
+    if (start < 0)
+      continue;
+
+    // Resume from the end of the known chain (the reader may have extended it)
+    if (pageMap_.getPageCount(chapter) > 0)
+      start = pageMap_.getKnownEnd(chapter);
+
+    provider_->setPosition(start);
+    layout_.layoutText(*provider_, renderer, config_, page_);
+    bool atChapterEnd = provider_->getChapterPercentage(page_.endPosition) >= 1.0f;
+    pageMap_.recordPage(chapter, currentChapterStart_, start, page_.endPosition, atChapterEnd);
+    ++pages;
+    ++pagesLaidOut_;
+
+    if (pageMap_.isChapterComplete(chapter)) {
+      ++chaptersCompleted_;
+      Serial.printf("BackgroundPaginator: chapter %d has %d pages\n", chapter, pageMap_.getPageCount(chapter));
+    } else if (page_.endPosition <= start) {
+      // No progress possible (should not happen); don't spin on this chapter
+      Serial.printf("BackgroundPaginator: no progress in chapter %d at %d, skipping\n", chapter, start);
+      skipped_[chapter] = true;
+    }
+  }
+  return pages;
+}
@@ -0,0 +1,73 @@
+#ifndef BACKGROUND_PAGINATOR_H
+#define BACKGROUND_PAGINATOR_H
+
+#include <vector>
+
+#include "LayoutStrategy.h"
+#include "PageMap.h"
+
+/**
+ * BackgroundPaginator - Cooperative job that fills a PageMap during idle time.
+ *
+ * The paginator owns a dedicated WordProvider for the book so it never moves the
+ * reader's position. Each call to step() lays out at most a few pages with the
+ * reader's LayoutStrategy and returns as soon as the yield callback reports
+ * pending input. Work always resumes from the end of each chapter's known page
+ * chain, so progress saved with the PageMap carries over between sessions.
+ */
+class BackgroundPaginator {
+ public:
+  // Returns true when the paginator should stop and give the CPU back
+  typedef bool (*YieldCallback)(void* context);
+
+  BackgroundPaginator(LayoutStrategy& layout, PageMap& pageMap);
+  ~BackgroundPaginator();
+
+  // Start paginating with `provider` (ownership is taken) and `config`
+  void begin(WordProvider* provider, const LayoutStrategy::LayoutConfig& config);
+  // Stop and release the provider
+  void end();
+
+  bool isActive() const {
+    return provider_ != nullptr;
+  }
+  // True while there is an incomplete chapter left to paginate
+  bool hasWork();
+
+  // Lay out up to `maxPages` pages, checking `shouldYield` before each one.
+  // The renderer must already have the layout font family selected.
+  // Returns the number of pages laid out.
+  int step(TextRenderer& renderer, int maxPages, YieldCallback shouldYield = nullptr, void* context = nullptr);
+
+  // Number of chapters finished by this paginator since begin()
+  int getChaptersCompleted() const {
+    return chaptersCompleted_;
+  }
+  // Number of pages laid out since begin()
+  int getPagesLaidOut() const {
+    return pagesLaidOut_;
+  }
+
+ private:
+  // Find the next chapter that still needs pages; -1 if none
+  int findNextChapter();
+  // First valid provider index of `chapter` (switches the provider to it)
+  int chapterStart(int chapter);
+
+  LayoutStrategy& layout_;
+  PageMap& pageMap_;
+  WordProvider* provider_ = nullptr;
+  LayoutStrategy::LayoutConfig config_;
+  // Reused for every page so idle pagination doesn't churn the heap
+  LayoutStrategy::PageLayout page_;
+
+  int currentChapter_ = -1;
+  int currentChapterStart_ = 0;
+  // Chapters that stopped making progress; skipped for the rest of the session
+  std::vector<bool> skipped_;
+
+  int chaptersCompleted_ = 0;
+  int pagesLaidOut_ = 0;
+};
+
+#endif
@@ -16,8 +16,8 @@ GreedyLayoutStrategy::GreedyLayoutStrategy() {}
 
 GreedyLayoutStrategy::~GreedyLayoutStrategy() {}
 
-LayoutStrategy::PageLayout GreedyLayoutStrategy::layoutText(WordProvider& provider, TextRenderer& renderer,
-                                                            const LayoutConfig& config) {
+void GreedyLayoutStrategy::layoutText(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config,
+                                      PageLayout& result) {
   const int16_t maxWidth = config.pageWidth - config.marginLeft - config.marginRight;
   const int16_t x = config.marginLeft;
   int16_t y = config.marginTop;
@@ -27,13 +27,18 @@ LayoutStrategy::PageLayout GreedyLayoutStrategy::layoutText(WordProvider& provid
   renderer.setFontStyle(FontStyle::REGULAR);
   renderer.getTextBounds(" ", 0, 0, nullptr, nullptr, &spaceWidth_, nullptr);
 
-  PageLayout result;
+  // Word text of the previous page is no longer referenced
+  textSlab_.reset();
+
+  result.reset();
   int startIndex = provider.getCurrentIndex();
 
   while (y < maxY) {
     bool isParagraphEnd = false;
     // getNextLine uses config.alignment as default, CSS overrides if present
-    Line line = getNextLine(provider, renderer, maxWidth, isParagraphEnd, config.alignment);
+    Line& line = lineScratch_;
+    const int lineStartIndex = provider.getCurrentIndex();
+    getNextLine(provider, renderer, maxWidth, isParagraphEnd, config.alignment, line);
 
     // Calculate positions for each word in the line
     if (!line.words.empty()) {
@@ -64,25 +69,23 @@ LayoutStrategy::PageLayout GreedyLayoutStrategy::layoutText(WordProvider& provid
       }
     }
 
-    result.lines.push_back(line);
+    // Out of memory for the page: it ends after the last complete line
+    const size_t lineIndex = result.getLineCount();
+    bool stored = result.beginLine(line.alignment);
+    for (size_t i = 0; stored && i < line.words.size(); i++) {
+      stored = result.addWord(line.words[i], renderer.getFontForStyle(line.words[i].style));
+    }
+    if (!stored) {
+      result.truncate(lineIndex);
+      provider.setPosition(lineStartIndex);
+      break;
+    }
     y += config.lineHeight;
   }
 
   result.endPosition = provider.getCurrentIndex();
   // reset the provider to the start index
   provider.setPosition(startIndex);
-
-  return result;
-}
-
-void GreedyLayoutStrategy::renderPage(const PageLayout& layout, TextRenderer& renderer, const LayoutConfig& config) {
-  for (const auto& line : layout.lines) {
-    for (const auto& word : line.words) {
-      renderer.setFontStyle(word.style);
-      renderer.setCursor(word.x, word.y);
-      renderer.print(word.text);
-    }
-  }
 }
 
 LayoutStrategy::Line GreedyLayoutStrategy::test_getNextLine(WordProvider& provider, TextRenderer& renderer,
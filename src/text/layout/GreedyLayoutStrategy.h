@@ -15,8 +15,9 @@ class GreedyLayoutStrategy : public LayoutStrategy {
   }
 
   // Main interface implementation
-  PageLayout layoutText(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config) override;
-  void renderPage(const PageLayout& layout, TextRenderer& renderer, const LayoutConfig& config) override;
+  using LayoutStrategy::layoutText;
+  void layoutText(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config,
+                  PageLayout& out) override;
 
  public:
   // Test-only public wrapper to exercise internal line layout helpers from unit tests.
@@ -2,6 +2,7 @@
 
 #include "../../content/providers/WordProvider.h"
 #include "../../rendering/TextRenderer.h"
+#include "../hyphenation/HyphenationStrategy.h"
 #include "WString.h"
 #ifdef ARDUINO
 #include <Arduino.h>
@@ -20,8 +21,13 @@ KnuthPlassLayoutStrategy::KnuthPlassLayoutStrategy() {}
 
 KnuthPlassLayoutStrategy::~KnuthPlassLayoutStrategy() {}
 
-LayoutStrategy::PageLayout KnuthPlassLayoutStrategy::layoutText(WordProvider& provider, TextRenderer& renderer,
-                                                                const LayoutConfig& config) {
+void KnuthPlassLayoutStrategy::layoutText(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config,
+                                          PageLayout& result) {
+  result.endPosition = layoutPage(provider, renderer, config, &result);
+}
+
+int KnuthPlassLayoutStrategy::layoutPage(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config,
+                                         PageLayout* out) {
   const int16_t maxWidth = config.pageWidth - config.marginLeft - config.marginRight;
   int16_t y = config.marginTop;
   const int16_t maxY = config.pageHeight - config.marginBottom;
@@ -30,251 +36,552 @@ LayoutStrategy::PageLayout KnuthPlassLayoutStrategy::layoutText(WordProvider& pr
   renderer.setFontStyle(FontStyle::REGULAR);
   renderer.getTextBounds(" ", 0, 0, nullptr, nullptr, &spaceWidth_, nullptr);
 
-  PageLayout result;
-  std::vector<ParagraphLayoutInfo> paragraphs;
-  std::vector<LayoutStrategy::Word> words;
+  // Word text of the previous page is no longer referenced
+  textSlab_.reset();
+
+  if (out) {
+    out->reset();
+  }
 
+  // Words are read once: each paragraph (or the part of it that can reach this
+  // page) is collected into items, broken, and only the lines that fit are
+  // placed. If the page fills up the provider is moved back to the first item
+  // that was not placed.
   int startIndex = provider.getCurrentIndex();
+  int endIndex = startIndex;
   while (y < maxY) {
-    int16_t yStart = y;
-    int16_t lineCount = 0;
-    bool isParagraphEnd = false;
-    TextAlignment paragraphAlignment = config.alignment;  // Will be set by first line
-
-    // Collect words for the paragraph
-    while (y < maxY && !isParagraphEnd) {
-      Line lineResult = getNextLine(provider, renderer, maxWidth, isParagraphEnd, config.alignment);
-      y += config.lineHeight;
+    int linesLeft = (maxY - y + config.lineHeight - 1) / config.lineHeight;
+    TextAlignment paragraphAlignment = config.alignment;
+    ChunkEnd chunkEnd = collectParagraph(provider, renderer, maxWidth, linesLeft, config.alignment, paragraphAlignment);
 
-      // Capture alignment from first line of paragraph
-      if (lineCount == 0 && !lineResult.words.empty()) {
-        paragraphAlignment = lineResult.alignment;
+    if (items_.empty()) {
+      endIndex = provider.getCurrentIndex();
+      if (chunkEnd == CHUNK_TEXT_END) {
+        break;
       }
+      // Empty line
+      y += config.lineHeight;
+      continue;
+    }
 
-      // Only count lines that have actual content
-      if (!lineResult.words.empty()) {
-        lineCount++;
-      }
+    // Calculate line breaks using Knuth-Plass algorithm
+    std::vector<size_t>& breaks = breaks_;
+    calculateBreaks(items_, maxWidth, breaks);
+    size_t lineCount = breaks.size() + 1;
+
+    // The last line of a truncated paragraph is broken again together with the
+    // text that follows it
+    bool complete = chunkEnd != CHUNK_TRUNCATED;
+    size_t placeCount = lineCount;
+    if (!complete && placeCount > 1) {
+      placeCount--;
+    }
+    if (placeCount > static_cast<size_t>(linesLeft)) {
+      placeCount = linesLeft;
+    }
 
-      // iterate line by line until paragraph end
-      for (size_t i = 0; i < lineResult.words.size(); i++) {
-        words.push_back(lineResult.words[i]);
+    size_t lineStart = 0;
+    const size_t linesBefore = out ? out->getLineCount() : 0;
+    bool stored = true;
+    for (size_t line = 0; line < placeCount; line++) {
+      size_t lineEnd = (line < breaks.size()) ? breaks[line] : items_.size();
+      if (out && lineEnd > lineStart) {
+        bool isLastLine = complete && line == lineCount - 1;
+        stored = placeLine(lineStart, lineEnd, y, paragraphAlignment, !isLastLine, config, renderer, *out);
+        if (!stored) {
+          break;
+        }
       }
+      lineStart = lineEnd;
+      y += config.lineHeight;
     }
 
-    if (!words.empty()) {
-      // Calculate line breaks using Knuth-Plass algorithm
-      std::vector<size_t> breaks = calculateBreaks(words, maxWidth);
+    if (!stored) {
+      // Out of memory for the page: it ends after the last line stored
+      seekToItem(provider, lineStart);
+      endIndex = provider.getCurrentIndex();
+      break;
+    }
 
-      if (lineCount != breaks.size() + 1) {
-        lineCountMismatch_ = true;
-        expectedLineCount_ = lineCount;
-        actualLineCount_ = breaks.size() + 1;
-      }
+    // Every line the break pass chose for this page must have been placed
+    if (out && out->getLineCount() - linesBefore != placeCount) {
+      lineCountMismatch_ = true;
+      expectedLineCount_ = static_cast<int>(placeCount);
+      actualLineCount_ = static_cast<int>(out->getLineCount() - linesBefore);
+    }
 
-      // Convert breaks into lines and calculate positions
-      const int16_t x = config.marginLeft;
-      int16_t currentY = yStart;
+    if (placeCount < lineCount) {
+      seekToItem(provider, lineStart);
+    }
+    endIndex = provider.getCurrentIndex();
+  }
 
-      size_t lineStart = 0;
-      for (size_t breakIdx = 0; breakIdx <= breaks.size(); breakIdx++) {
-        size_t lineEnd = (breakIdx < breaks.size()) ? breaks[breakIdx] : words.size();
-        if (lineStart >= lineEnd)
-          break;
+  // reset the provider to the start index
+  provider.setPosition(startIndex);
+  return endIndex;
+}
 
-        std::vector<Word> lineWords;
-        for (size_t i = lineStart; i < lineEnd; i++) {
-          lineWords.push_back(words[i]);
-        }
+KnuthPlassLayoutStrategy::ChunkEnd KnuthPlassLayoutStrategy::collectParagraph(WordProvider& provider,
+                                                                              TextRenderer& renderer,
+                                                                              int16_t maxWidth, int maxLines,
+                                                                              TextAlignment defaultAlignment,
+                                                                              TextAlignment& alignment) {
+  items_.clear();
+  alignment = defaultAlignment;
+  bool alignmentCaptured = false;
+
+  // Natural width of the text read so far, compared against the page's
+  // remaining lines plus the lookahead
+  const int32_t widthLimit = static_cast<int32_t>(maxLines + LOOKAHEAD_LINES) * maxWidth;
+  int32_t naturalWidth = 0;
+
+  WordToken token;
+  while (provider.hasNextWord()) {
+    int wordStartIndex = provider.getCurrentIndex();
+    provider.getNextToken(token);
+
+    // CSS alignment overrides the default
+    if (!alignmentCaptured) {
+      alignmentCaptured = true;
+      alignment = getParagraphAlignment(provider, defaultAlignment);
+    }
 
-        // Calculate positions for words in this line
-        bool isLastLine = (breakIdx == breaks.size()) && isParagraphEnd;
-        size_t numWords = lineWords.size();
-        size_t numSpaces = (numWords > 1) ? numWords - 1 : 0;
-
-        if (isLastLine || numSpaces == 0) {
-          // Last line: use alignment, no justification
-          int16_t lineWidth = 0;
-          for (size_t i = 0; i < lineWords.size(); i++) {
-            lineWidth += lineWords[i].width;
-            if (i < lineWords.size() - 1) {
-              lineWidth += spaceWidth_;
-            }
-          }
-
-          int16_t xPos = x;
-          if (paragraphAlignment == ALIGN_CENTER) {
-            xPos = x + (maxWidth - lineWidth) / 2;
-          } else if (paragraphAlignment == ALIGN_RIGHT) {
-            xPos = x + maxWidth - lineWidth;
-          }
-
-          int16_t currentX = xPos;
-          for (size_t i = 0; i < lineWords.size(); i++) {
-            lineWords[i].x = currentX;
-            lineWords[i].y = currentY;
-            currentX += lineWords[i].width;
-            if (i < lineWords.size() - 1) {
-              currentX += spaceWidth_;
-            }
-          }
-        } else {
-          // Non-last line: justify by distributing space evenly
-          int16_t totalWordWidth = 0;
-          for (size_t i = 0; i < lineWords.size(); i++) {
-            totalWordWidth += lineWords[i].width;
-          }
-
-          // Calculate space to distribute between words
-          int16_t totalSpaceWidth = maxWidth - totalWordWidth;
-          float spacePerGap = (float)totalSpaceWidth / (float)numSpaces;
-
-          if (spacePerGap > 16 * spaceWidth_) {
-            // Limit maximum space stretch to avoid extreme gaps
-            spacePerGap = std::max(spacePerGap * 0.25f, (float)spaceWidth_);
-          }
-
-          int16_t currentX = x;
-          float accumulatedSpace = 0.0f;
-
-          for (size_t i = 0; i < lineWords.size(); i++) {
-            lineWords[i].x = currentX;
-            lineWords[i].y = currentY;
-            currentX += lineWords[i].width;
-
-            if (i < lineWords.size() - 1) {
-              accumulatedSpace += spacePerGap;
-              int16_t spaceToAdd = (int16_t)accumulatedSpace;
-              currentX += spaceToAdd;
-              accumulatedSpace -= spaceToAdd;
-            }
-          }
-        }
+    if (token.is('\n')) {
+      return CHUNK_NEWLINE;
+    }
+    if (token.length > 0 && token.text[0] == ' ') {
+      continue;
+    }
+
+    naturalWidth += addWordItems(token, wordStartIndex, renderer) + spaceWidth_;
+    if (naturalWidth > widthLimit) {
+      return CHUNK_TRUNCATED;
+    }
+  }
+  return CHUNK_TEXT_END;
+}
+
+int16_t KnuthPlassLayoutStrategy::addWordItems(const WordToken& token, int wordStart, TextRenderer& renderer) {
+  // The token is only valid until the next provider call: keep a copy in the
+  // page's text slab and measure it
+  WordText word = textSlab_.store(token.text, token.length);
+  const uint16_t length = static_cast<uint16_t>(word.length());
+  renderer.setFontStyle(token.style);
+  int16_t width = measureText(renderer, word.c_str(), length);
+
+  // Possible breaks inside the word: after existing hyphens, otherwise at the
+  // positions the language's hyphenation allows (a '-' is inserted there)
+  std::vector<uint16_t>& positions = hyphenPositions_;
+  positions.clear();
+  for (uint16_t i = 0; i + 1 < length; i++) {
+    if (word[i] == '-') {
+      positions.push_back(i + 1);
+    }
+  }
+  bool insertHyphen = false;
+  if (positions.empty() && hyphenationStrategy_) {
+    hyphenationStrategy_->hyphenate(word.c_str(), length, positions, 6, 3);
+    positions.erase(std::remove_if(positions.begin(), positions.end(),
+                                   [length](uint16_t pos) { return pos == 0 || pos >= length; }),
+                    positions.end());
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    insertHyphen = !positions.empty();
+  }
+  int16_t hyphenWidth = insertHyphen ? measureText(renderer, "-", 1) : 0;
+
+  // One item per fragment; fragment widths are differences of prefix widths so
+  // the items of a word always add up to the word's width
+  uint16_t fragmentStart = 0;
+  int16_t prefixWidth = 0;
+  for (size_t i = 0; i <= positions.size(); i++) {
+    bool wordEnd = i == positions.size();
+    uint16_t fragmentEnd = wordEnd ? length : positions[i];
+    int16_t endWidth = wordEnd ? width : measureText(renderer, word.c_str(), fragmentEnd);
+
+    BreakItem item;
+    item.text = WordText(word.c_str() + fragmentStart, fragmentEnd - fragmentStart);
+    item.wordStart = wordStart;
+    item.width = endWidth - prefixWidth;
+    item.hyphenWidth = wordEnd ? 0 : hyphenWidth;
+    item.offset = fragmentStart;
+    item.style = token.style;
+    item.flags = wordEnd ? ITEM_WORD_END : (insertHyphen ? ITEM_ADD_HYPHEN : 0);
+    items_.push_back(item);
+
+    fragmentStart = fragmentEnd;
+    prefixWidth = endWidth;
+  }
+  return width;
+}
 
-        Line lineStruct;
-        lineStruct.words = lineWords;
-        lineStruct.alignment = paragraphAlignment;
-        result.lines.push_back(lineStruct);
-        lineStart = lineEnd;
-        currentY += config.lineHeight;
+bool KnuthPlassLayoutStrategy::placeLine(size_t from, size_t to, int16_t y, TextAlignment alignment, bool justify,
+                                         const LayoutConfig& config, const TextRenderer& renderer, PageLayout& out) {
+  const int16_t maxWidth = config.pageWidth - config.marginLeft - config.marginRight;
+  const int16_t x = config.marginLeft;
+
+  // Join the fragments of each word back together
+  std::vector<Word>& lineWords = lineScratch_.words;
+  lineWords.clear();
+  for (size_t k = from; k < to; k++) {
+    const BreakItem& item = items_[k];
+    if (k > from && !(items_[k - 1].flags & ITEM_WORD_END)) {
+      Word& word = lineWords.back();
+      word.text = WordText(word.text.c_str(), static_cast<uint16_t>(word.text.length() + item.text.length()));
+      word.width += item.width;
+    } else {
+      lineWords.push_back(Word(item.text, item.width, 0, y, false, item.style));
+    }
+  }
+
+  // A line that ends inside a word gets its hyphen
+  const BreakItem& last = items_[to - 1];
+  if (!(last.flags & ITEM_WORD_END)) {
+    Word& word = lineWords.back();
+    word.wasSplit = true;
+    if (last.flags & ITEM_ADD_HYPHEN) {
+      word.text = textSlab_.store(word.text.c_str(), word.text.length(), '-');
+      word.width += last.hyphenWidth;
+    }
+  }
+
+  size_t numWords = lineWords.size();
+  size_t numSpaces = (numWords > 1) ? numWords - 1 : 0;
+
+  if (!justify || numSpaces == 0) {
+    // Last line: use alignment, no justification
+    int16_t lineWidth = 0;
+    for (size_t i = 0; i < numWords; i++) {
+      lineWidth += lineWords[i].width;
+      if (i < numWords - 1) {
+        lineWidth += spaceWidth_;
       }
+    }
 
-      words.clear();
+    int16_t xPos = x;
+    if (alignment == ALIGN_CENTER) {
+      xPos = x + (maxWidth - lineWidth) / 2;
+    } else if (alignment == ALIGN_RIGHT) {
+      xPos = x + maxWidth - lineWidth;
+    }
+
+    int16_t currentX = xPos;
+    for (size_t i = 0; i < numWords; i++) {
+      lineWords[i].x = currentX;
+      currentX += lineWords[i].width;
+      if (i < numWords - 1) {
+        currentX += spaceWidth_;
+      }
+    }
+  } else {
+    // Non-last line: justify by distributing space evenly
+    int16_t totalWordWidth = 0;
+    for (size_t i = 0; i < numWords; i++) {
+      totalWordWidth += lineWords[i].width;
+    }
+
+    // Calculate space to distribute between words. Each gap gets
+    // gapWidth / gapDivisor pixels; the remainder is carried to the next
+    // gap so the rounding error never accumulates.
+    int32_t totalSpaceWidth = maxWidth - totalWordWidth;
+    int32_t gapWidth = totalSpaceWidth;
+    int32_t gapDivisor = static_cast<int32_t>(numSpaces);
+
+    if (totalSpaceWidth > 16 * spaceWidth_ * gapDivisor) {
+      // Limit maximum space stretch to avoid extreme gaps: a quarter of
+      // the even share, but never less than a normal space
+      gapDivisor *= 4;
+      if (totalSpaceWidth < spaceWidth_ * gapDivisor) {
+        gapWidth = spaceWidth_;
+        gapDivisor = 1;
+      }
+    }
+
+    int16_t currentX = x;
+    int32_t accumulatedSpace = 0;
+
+    for (size_t i = 0; i < numWords; i++) {
+      lineWords[i].x = currentX;
+      currentX += lineWords[i].width;
+
+      if (i < numWords - 1) {
+        accumulatedSpace += gapWidth;
+        int32_t spaceToAdd = accumulatedSpace / gapDivisor;
+        currentX += spaceToAdd;
+        accumulatedSpace -= spaceToAdd * gapDivisor;
+      }
     }
   }
 
-  result.endPosition = provider.getCurrentIndex();
-  // reset the provider to the start index
-  provider.setPosition(startIndex);
+  const size_t lineIndex = out.getLineCount();
+  bool stored = out.beginLine(alignment);
+  for (size_t i = 0; stored && i < numWords; i++) {
+    stored = out.addWord(lineWords[i], renderer.getFontForStyle(lineWords[i].style));
+  }
+  if (!stored) {
+    out.truncate(lineIndex);
+  }
+  return stored;
+}
 
-  return result;
+void KnuthPlassLayoutStrategy::seekToItem(WordProvider& provider, size_t index) {
+  const BreakItem& item = items_[index];
+  provider.setPosition(item.wordStart);
+  if (item.offset > 0) {
+    provider.consumeChars(item.offset);
+  }
 }
 
-void KnuthPlassLayoutStrategy::renderPage(const PageLayout& layout, TextRenderer& renderer,
-                                          const LayoutConfig& config) {
-  for (const auto& line : layout.lines) {
-    for (const auto& word : line.words) {
-      renderer.setFontStyle(word.style);
-      renderer.setCursor(word.x, word.y);
-      renderer.print(word.text);
+int KnuthPlassLayoutStrategy::getPreviousPageStart(WordProvider& provider, TextRenderer& renderer,
+                                                   const LayoutConfig& config, int currentStartPosition) {
+  // Save current provider state
+  int savedPosition = provider.getCurrentIndex();
+
+  const int16_t maxWidth = config.pageWidth - config.marginLeft - config.marginRight;
+  renderer.setFontStyle(FontStyle::REGULAR);
+  renderer.getTextBounds(" ", 0, 0, nullptr, nullptr, &spaceWidth_, nullptr);
+
+  const int16_t availableHeight = config.pageHeight - config.marginTop - config.marginBottom;
+  const int maxLines = ceil(availableHeight / (double)config.lineHeight);
+
+  // Page breaks depend on how whole paragraphs are broken, so go back to a
+  // paragraph start more than a page earlier and lay out pages forward from
+  // there until one reaches currentStartPosition
+  provider.setPosition(currentStartPosition);
+  seekBackToParagraph(provider, renderer, maxWidth, config.alignment, maxLines * 1.25);
+
+  int pageStart = provider.getCurrentIndex();
+  int previousPageStart = pageStart;
+  while (pageStart < currentStartPosition) {
+    provider.setPosition(pageStart);
+    int pageEnd = layoutPage(provider, renderer, config, nullptr);
+    previousPageStart = pageStart;
+    if (pageEnd <= pageStart) {
+      break;
     }
+    pageStart = pageEnd;
   }
-}
 
-std::vector<size_t> KnuthPlassLayoutStrategy::calculateBreaks(const std::vector<Word>& words, int16_t maxWidth) {
-  std::vector<size_t> breaks;
+  // Restore provider state
+  provider.setPosition(savedPosition);
 
-  if (words.empty()) {
-    return breaks;
+  return previousPageStart;
+}
+
+void KnuthPlassLayoutStrategy::test_calculateBreaks(const std::vector<Word>& words, int16_t maxWidth,
+                                                    std::vector<size_t>& breaks) {
+  std::vector<BreakItem> items(words.size());
+  for (size_t i = 0; i < words.size(); i++) {
+    items[i].text = words[i].text;
+    items[i].wordStart = static_cast<int32_t>(i);
+    items[i].width = words[i].width;
+    items[i].hyphenWidth = 0;
+    items[i].offset = 0;
+    items[i].style = words[i].style;
+    items[i].flags = ITEM_WORD_END | (words[i].wasSplit ? ITEM_FORCED_BREAK : 0);
   }
+  calculateBreaks(items, maxWidth, breaks);
+}
 
-  size_t n = words.size();
+void KnuthPlassLayoutStrategy::calculateBreaks(const std::vector<BreakItem>& items, int16_t maxWidth,
+                                               std::vector<size_t>& breaks) {
+  breaks.clear();
 
-  // Dynamic programming array: minimum demerits to reach each word
-  std::vector<float> minDemerits(n + 1, INFINITY_PENALTY);
-  std::vector<int> prevBreak(n + 1, -1);
+  if (items.empty()) {
+    return;
+  }
 
-  // Base case: starting position has 0 demerits
-  minDemerits[0] = 0.0f;
+  size_t n = items.size();
 
-  // For each possible starting position
-  for (size_t i = 0; i < n; i++) {
-    if (minDemerits[i] >= INFINITY_PENALTY) {
-      continue;  // This position is unreachable
+  // Demerits of a (non-last) line only depend on its slack; tabulate them
+  // once per line width so the inner loop is a lookup
+  if (maxWidth != lineDemeritsWidth_ && maxWidth >= 0) {
+    lineDemerits_.resize(maxWidth + 1);
+    for (int16_t slack = 0; slack <= maxWidth; slack++) {
+      lineDemerits_[slack] = calculateDemerits(calculateBadness(maxWidth - slack, maxWidth), false);
     }
+    lineDemeritsWidth_ = maxWidth;
+  }
 
-    // Try to fit words [i, j) on one line
-    int16_t lineWidth = 0;
-    for (size_t j = i; j < n; j++) {
-      // Add word width
-      if (j > i) {
-        lineWidth += spaceWidth_;  // Add space before word (except first word)
-      }
-      lineWidth += words[j].width;
-
-      // Check if line is too wide
-      if (lineWidth > maxWidth) {
-        // Special case: if this is the first word on the line and it's too wide,
-        // we must still place it on its own line to make progress
-        if (j == i) {
-          // Force this oversized word onto its own line with a high but not infinite penalty
-          // Use a large fixed penalty (100) rather than INFINITY_PENALTY to allow progress
-          float demerits = 100.0f;
-
-          // Add a constant penalty per line to favor fewer lines
-          demerits += 50.0f;
-
-          float totalDemerits = minDemerits[i] + demerits;
-          if (totalDemerits < minDemerits[j + 1]) {
-            minDemerits[j + 1] = totalDemerits;
-            prevBreak[j + 1] = i;
-          }
+  // Breakpoints in position order; node 0 is the paragraph start. A line from
+  // an earlier breakpoint is always wider, so the active breakpoints (those a
+  // line can still start from) are always the newest ones: nodes[firstActive_..]
+  std::vector<BreakNode>& nodes = breakNodes_;
+  nodes.clear();
+  nodes.push_back({0, -1, 0, 0});
+  firstActive_ = 0;
+
+  for (size_t j = 0; j < n; j++) {
+    // Find the cheapest way to break after item j. Active nodes are visited in
+    // position order and only a strictly better total replaces the best, so
+    // ties go to the earliest line start.
+    int32_t bestTotal = INFINITY_PENALTY;
+    int32_t bestNode = -1;
+    bool isLastLine = (j == n - 1);
+    const BreakItem& item = items[j];
+    const bool wordEnd = (item.flags & ITEM_WORD_END) != 0;
+    // Items of the same word are not separated by a space
+    const int16_t itemAdvance = (j > 0 && (items[j - 1].flags & ITEM_WORD_END)) ? spaceWidth_ + item.width : item.width;
+    // Ending the line inside a word adds the hyphen
+    const int16_t breakExtra = wordEnd ? 0 : item.hyphenWidth;
+
+    nodeVisits_ += nodes.size() - firstActive_;
+    for (size_t a = firstActive_; a < nodes.size(); a++) {
+      BreakNode& node = nodes[a];
+      bool firstWord = (node.position == static_cast<int32_t>(j));
+
+      // Add item width and the space before it (except for the first item)
+      node.lineWidth += firstWord ? item.width : itemAdvance;
+      int16_t breakWidth = node.lineWidth + breakExtra;
+
+      int32_t demerits;
+      if (node.lineWidth > maxWidth) {
+        // Line is too wide: this node (and every older one) can't start any
+        // more lines. If this is the first item on the line it still gets a
+        // line of its own so the paragraph makes progress (high but not
+        // infinite penalty)
+        firstActive_ = a + 1;
+        if (!firstWord) {
+          continue;
+        }
+        demerits = OVERSIZED_WORD_DEMERITS;
+      } else if (breakWidth > maxWidth) {
+        // The line fits, but not with a hyphen here
+        if (!firstWord) {
+          continue;
+        }
+        demerits = OVERSIZED_WORD_DEMERITS;
+      } else {
+        demerits = isLastLine ? 0 : lineDemerits_[maxWidth - breakWidth];
+        if (!wordEnd) {
+          demerits += HYPHEN_PENALTY;
+        }
+        // Cap the lookahead: drop starts more than MAX_LINE_WORDS words back
+        if (static_cast<int32_t>(j) - node.position >= MAX_LINE_WORDS - 1) {
+          firstActive_ = a + 1;
         }
-        break;  // Can't fit any more words on this line
       }
 
-      // Calculate badness and demerits for this line
-      bool isLastLine = (j == n - 1);
-      float badness = calculateBadness(lineWidth, maxWidth);
-      float demerits = calculateDemerits(badness, isLastLine);
-
       // Add a constant penalty per line to favor fewer lines
       // This makes layouts with fewer lines always preferable
-      demerits += 50.0f;
+      demerits += LINE_PENALTY;
 
-      // Update minimum demerits to reach position j+1
-      float totalDemerits = minDemerits[i] + demerits;
-      if (totalDemerits < minDemerits[j + 1]) {
-        minDemerits[j + 1] = totalDemerits;
-        prevBreak[j + 1] = i;
+      int32_t totalDemerits = node.totalDemerits + demerits;
+      if (totalDemerits < bestTotal) {
+        bestTotal = totalDemerits;
+        bestNode = static_cast<int32_t>(a);
       }
+    }
 
-      // If this word was split (hyphenated), we must break the line here
-      if (words[j].wasSplit) {
-        break;
+    // A forced break (e.g. a word that was already split) ends every line here
+    if (item.flags & ITEM_FORCED_BREAK) {
+      firstActive_ = nodes.size();
+    }
+
+    if (bestNode >= 0) {
+      if (nodes.size() >= MAX_BREAK_NODES) {
+        bestNode = commitLines(bestNode, breaks);
       }
+      nodes.push_back({static_cast<int32_t>(j + 1), bestNode, bestTotal, 0});
+      peakNodeCount_ = std::max(peakNodeCount_, nodes.size());
+
+      // Only differences between totals matter; keep them far from overflow
+      if (bestTotal > INFINITY_PENALTY / 2) {
+        int32_t minTotal = bestTotal;
+        for (size_t a = firstActive_; a < nodes.size(); a++) {
+          minTotal = std::min(minTotal, nodes[a].totalDemerits);
+        }
+        for (size_t a = firstActive_; a < nodes.size(); a++) {
+          nodes[a].totalDemerits -= minTotal;
+        }
+      }
+    } else if (firstActive_ == nodes.size() && j + 1 < n) {
+      // Nothing can reach the next word (should not happen); restart from it
+      int32_t last = static_cast<int32_t>(nodes.size() - 1);
+      if (nodes.size() >= MAX_BREAK_NODES) {
+        last = commitLines(last, breaks);
+      }
+      nodes.push_back({static_cast<int32_t>(j + 1), last, 0, 0});
     }
   }
 
-  // Reconstruct breaks by backtracking
-  int pos = n;
-  while (pos > 0 && prevBreak[pos] >= 0) {
-    breaks.push_back(pos);
-    pos = prevBreak[pos];
+  // Reconstruct the remaining breaks by backtracking from the paragraph end
+  // (or from the last reachable breakpoint if the end is unreachable)
+  size_t committed = breaks.size();
+  for (int32_t node = static_cast<int32_t>(nodes.size() - 1); node >= 0 && nodes[node].prevNode >= 0;
+       node = nodes[node].prevNode) {
+    breaks.push_back(nodes[node].position);
   }
 
   // Reverse to get breaks in forward order
-  std::reverse(breaks.begin(), breaks.end());
+  std::reverse(breaks.begin() + committed, breaks.end());
 
   // Remove the last break (end of text)
   if (!breaks.empty() && breaks.back() == n) {
     breaks.pop_back();
   }
+}
+
+int32_t KnuthPlassLayoutStrategy::commitLines(int32_t bestNode, std::vector<size_t>& breaks) {
+  std::vector<BreakNode>& nodes = breakNodes_;
+
+  // Commit the lines of the best path so far up to its last breakpoint in the
+  // older half of the pool, keeping the newer half as lookahead. Everything
+  // that does not continue from there is dropped; if that frees too little,
+  // commit up to the best node.
+  int32_t limit = nodes[nodes.size() / 2].position;
+  int32_t commitNode = bestNode;
+  while (nodes[commitNode].prevNode >= 0 && nodes[commitNode].position > limit) {
+    commitNode = nodes[commitNode].prevNode;
+  }
 
-  return breaks;
+  // Number the descendants of commitNode (parents always precede children)
+  std::vector<int32_t>& remap = nodeRemap_;
+  size_t count = 0;
+  for (int attempt = 0; attempt < 2; attempt++) {
+    remap.assign(nodes.size(), -1);
+    nodeVisits_ += nodes.size();
+    remap[commitNode] = 0;
+    count = 1;
+    for (size_t k = commitNode + 1; k < nodes.size(); k++) {
+      if (nodes[k].prevNode >= 0 && remap[nodes[k].prevNode] >= 0) {
+        remap[k] = static_cast<int32_t>(count++);
+      }
+    }
+    if (count < MAX_BREAK_NODES) {
+      break;
+    }
+    commitNode = bestNode;
+  }
+
+  // Emit the committed breaks in forward order
+  size_t first = breaks.size();
+  for (int32_t node = commitNode; nodes[node].prevNode >= 0; node = nodes[node].prevNode) {
+    breaks.push_back(nodes[node].position);
+  }
+  std::reverse(breaks.begin() + first, breaks.end());
+
+  // Compact the pool; the committed node becomes the new root. Survivors keep
+  // their order, so the active ones are still the newest.
+  size_t newFirstActive = 0;
+  nodeVisits_ += nodes.size() - commitNode;
+  for (size_t k = commitNode; k < nodes.size(); k++) {
+    if (remap[k] < 0) {
+      continue;
+    }
+    BreakNode node = nodes[k];
+    node.prevNode = (k == static_cast<size_t>(commitNode)) ? -1 : remap[node.prevNode];
+    nodes[remap[k]] = node;
+    if (k < firstActive_) {
+      newFirstActive = remap[k] + 1;
+    }
+  }
+  nodes.resize(count);
+  firstActive_ = newFirstActive;
+  return remap[bestNode];
 }
 
-float KnuthPlassLayoutStrategy::calculateBadness(int16_t actualWidth, int16_t targetWidth) {
+int32_t KnuthPlassLayoutStrategy::calculateBadness(int16_t actualWidth, int16_t targetWidth) {
   if (actualWidth > targetWidth) {
     // Line is too wide - very bad
     return INFINITY_PENALTY;
@@ -282,31 +589,35 @@ float KnuthPlassLayoutStrategy::calculateBadness(int16_t actualWidth, int16_t ta
 
   if (actualWidth == targetWidth) {
     // Perfect fit
-    return 0.0f;
+    return 0;
   }
 
-  // Calculate adjustment ratio (how much space needs to be stretched)
-  float ratio = (float)(targetWidth - actualWidth) / (float)targetWidth;
-
-  // Badness is cube of ratio (Knuth-Plass formula)
-  // This penalizes very loose lines more heavily
-  float badness = ratio * ratio * ratio * 100.0f;
-
-  return badness;
+  // Badness is 100 * ratio^3 (Knuth-Plass formula), where ratio is how much
+  // space needs to be stretched. Evaluated exactly in 64 bits and rounded to
+  // fixed point; this penalizes very loose lines more heavily.
+  uint64_t slack = static_cast<uint64_t>(targetWidth - actualWidth);
+  uint64_t target = static_cast<uint64_t>(targetWidth);
+  // Keep 100 * slack^3 * FIXED_ONE within 64 bits for very wide lines
+  while (target > 4096) {
+    slack >>= 1;
+    target >>= 1;
+  }
+  uint64_t target3 = target * target * target;
+  uint64_t scaled = 100 * slack * slack * slack * FIXED_ONE;
+  return static_cast<int32_t>((scaled + target3 / 2) / target3);
 }
 
-float KnuthPlassLayoutStrategy::calculateDemerits(float badness, bool isLastLine) {
+int32_t KnuthPlassLayoutStrategy::calculateDemerits(int32_t badness, bool isLastLine) {
   if (badness >= INFINITY_PENALTY) {
     return INFINITY_PENALTY;
   }
 
   // Last line is allowed to be loose without penalty
   if (isLastLine) {
-    return 0.0f;
+    return 0;
   }
 
   // Demerits is square of (1 + badness)
-  float demerits = (1.0f + badness) * (1.0f + badness);
-
-  return demerits;
+  int64_t base = FIXED_ONE + badness;
+  return static_cast<int32_t>((base * base + FIXED_ONE / 2) >> FIXED_SHIFT);
 }
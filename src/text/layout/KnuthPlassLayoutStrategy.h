@@ -1,16 +1,20 @@
 #ifndef KNUTH_PLASS_LAYOUT_STRATEGY_H
 #define KNUTH_PLASS_LAYOUT_STRATEGY_H
 
+#include <string>
 #include <vector>
 
 #include "LayoutStrategy.h"
 
+struct WordToken;
+
 class KnuthPlassLayoutStrategy : public LayoutStrategy {
  public:
   KnuthPlassLayoutStrategy();
   ~KnuthPlassLayoutStrategy();
 
-  // Test support: check if line count mismatch occurred
+  // Test support: a page got fewer (or more) lines than the break pass chose
+  // for it; expected = lines chosen, actual = lines placed
   bool hasLineCountMismatch() const {
     return lineCountMismatch_;
   }
@@ -31,37 +35,114 @@ class KnuthPlassLayoutStrategy : public LayoutStrategy {
   }
 
   // Main interface implementation
-  PageLayout layoutText(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config) override;
-  void renderPage(const PageLayout& layout, TextRenderer& renderer, const LayoutConfig& config) override;
+  using LayoutStrategy::layoutText;
+  void layoutText(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config,
+                  PageLayout& out) override;
+
+  // Start of the page before the one starting at currentStartPosition, found by
+  // laying out pages forward from an earlier paragraph start
+  int getPreviousPageStart(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config,
+                           int currentStartPosition) override;
+
+  // Test support: break a paragraph of measured words (uses the current space
+  // width). Each word is one item; split words force a break after them.
+  void test_calculateBreaks(const std::vector<Word>& words, int16_t maxWidth, std::vector<size_t>& breaks);
+  // Largest number of breakpoints held at once (bounded by MAX_BREAK_NODES)
+  size_t getPeakBreakNodes() const {
+    return peakNodeCount_;
+  }
+  // Breakpoints visited (scanned or compacted) by all calculateBreaks() calls;
+  // the line breaker's work, independent of the machine it runs on
+  size_t getBreakNodeVisits() const {
+    return nodeVisits_;
+  }
+
+  // Breakpoints kept in memory while breaking a paragraph. Paragraphs with
+  // fewer words are broken optimally; longer ones are committed in windows.
+  static constexpr size_t MAX_BREAK_NODES = 512;
+  // Most words considered for a single line
+  static constexpr int32_t MAX_LINE_WORDS = 128;
+
+  // Demerits are fixed point with FIXED_SHIFT fractional bits. The ESP32-C3
+  // has no FPU, so the line breaker uses integer math only.
+  static constexpr int FIXED_SHIFT = 16;
+  static constexpr int32_t FIXED_ONE = 1 << FIXED_SHIFT;
 
  private:
   // spaceWidth_ is defined in base class
 
-  struct ParagraphLayoutInfo {
-    std::vector<Word> words;
-    std::vector<size_t> breaks;
-    bool paragraphEnd;
-    int16_t yStart;
+  // Knuth-Plass parameters (fixed point). Total demerits stay below
+  // INFINITY_PENALTY, so a total plus one line's demerits fits in int32_t.
+  static constexpr int32_t INFINITY_PENALTY = 10000 * FIXED_ONE;
+  static constexpr int32_t LINE_PENALTY = 50 * FIXED_ONE;
+  static constexpr int32_t OVERSIZED_WORD_DEMERITS = 100 * FIXED_ONE;
+  // Extra demerits for ending a line inside a word
+  static constexpr int32_t HYPHEN_PENALTY = 50 * FIXED_ONE;
+  // Lines of text read beyond the end of the page so the page's last lines are
+  // broken with knowledge of what follows
+  static constexpr int LOOKAHEAD_LINES = 2;
+
+  // Box of the paragraph being broken: a word, or the part of a word up to the
+  // next hyphenation point. Items of one word are contiguous.
+  struct BreakItem {
+    WordText text;      // Fragment text (points into the word stored in textSlab_)
+    int32_t wordStart;  // Provider index of the word
+    int16_t width;
+    int16_t hyphenWidth;  // Added to the line when it ends after this item (inside the word)
+    uint16_t offset;      // Byte offset of the fragment within the word
+    FontStyle style;
+    uint8_t flags;  // ITEM_*
   };
+  static const uint8_t ITEM_WORD_END = 0x01;      // Glue follows; the line may end here without a hyphen
+  static const uint8_t ITEM_ADD_HYPHEN = 0x02;    // A line ending here needs an inserted '-'
+  static const uint8_t ITEM_FORCED_BREAK = 0x04;  // The line must end here
+
+  // Why collectParagraph() stopped
+  enum ChunkEnd { CHUNK_NEWLINE, CHUNK_TEXT_END, CHUNK_TRUNCATED };
 
-  // Knuth-Plass parameters
-  static constexpr float INFINITY_PENALTY = 10000.0f;
-  static constexpr float HYPHEN_PENALTY = 50.0f;
-  static constexpr float FITNESS_DEMERITS = 100.0f;
-
-  // Node for dynamic programming
-  struct Node {
-    size_t position;      // Word index
-    size_t line;          // Line number
-    float totalDemerits;  // Total demerits up to this point
-    int16_t totalWidth;   // Width accumulated up to this position
-    int prevBreak;        // Previous break point index (-1 if none)
+  // Feasible breakpoint: a line can end before word `position`
+  struct BreakNode {
+    int32_t position;       // Word index
+    int32_t prevNode;       // Previous breakpoint on the best path (-1 for the root)
+    int32_t totalDemerits;  // Best total demerits up to this point (fixed point)
+    int16_t lineWidth;      // While active: width of the line from here up to the current word
   };
 
-  // Helper methods
-  std::vector<size_t> calculateBreaks(const std::vector<Word>& words, int16_t maxWidth);
-  float calculateBadness(int16_t actualWidth, int16_t targetWidth);
-  float calculateDemerits(float badness, bool isLastLine);
+  // Lay out one page from the provider's position into `out` (nullptr: only
+  // find the page end) and return the provider index where the page ends
+  int layoutPage(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config, PageLayout* out);
+  // Read the rest of the current paragraph into items_, stopping early once it
+  // holds more than maxLines + LOOKAHEAD_LINES lines of text
+  ChunkEnd collectParagraph(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth, int maxLines,
+                            TextAlignment defaultAlignment, TextAlignment& alignment);
+  // Store a word and append its items (one per hyphenation point); returns its width
+  int16_t addWordItems(const WordToken& token, int wordStart, TextRenderer& renderer);
+  // Position items_[from, to) as one line and append it to `out`, shaped in
+  // the renderer's fonts; false (and nothing appended) if `out` is full
+  bool placeLine(size_t from, size_t to, int16_t y, TextAlignment alignment, bool justify, const LayoutConfig& config,
+                 const TextRenderer& renderer, PageLayout& out);
+  // Move the provider to the start of items_[index]
+  void seekToItem(WordProvider& provider, size_t index);
+
+  void calculateBreaks(const std::vector<BreakItem>& items, int16_t maxWidth, std::vector<size_t>& breaks);
+  // Commit the settled lines of the best path to `breaks` and drop breakpoints
+  // that can no longer be used; returns the new index of `bestNode`
+  int32_t commitLines(int32_t bestNode, std::vector<size_t>& breaks);
+  static int32_t calculateBadness(int16_t actualWidth, int16_t targetWidth);
+  static int32_t calculateDemerits(int32_t badness, bool isLastLine);
+
+  // Buffers for the paragraph being broken (reused across paragraphs and pages)
+  std::vector<BreakItem> items_;
+  std::vector<uint16_t> hyphenPositions_;
+  std::vector<size_t> breaks_;
+  std::vector<BreakNode> breakNodes_;
+  size_t firstActive_ = 0;  // breakNodes_[firstActive_..] are active
+  std::vector<int32_t> nodeRemap_;
+  size_t peakNodeCount_ = 0;
+  size_t nodeVisits_ = 0;
+  // Demerits of a non-last line indexed by slack, for lineDemeritsWidth_
+  std::vector<int32_t> lineDemerits_;
+  int16_t lineDemeritsWidth_ = -1;
 
   // Line count mismatch tracking for testing
   bool lineCountMismatch_ = false;
@@ -2,6 +2,7 @@
 
 #include "../../content/css/CssStyle.h"
 #include "../../content/providers/WordProvider.h"
+#include "../../core/EInkDisplay.h"
 #include "../../rendering/TextRenderer.h"
 #include "../hyphenation/GermanHyphenation.h"
 #include "../hyphenation/HyphenationStrategy.h"
@@ -12,6 +13,7 @@
 #endif
 
 #include <cmath>
+#include <cstring>
 
 LayoutStrategy::LayoutStrategy() : hyphenationStrategy_(new NoHyphenation()) {}
 
@@ -26,58 +28,174 @@ void LayoutStrategy::setLanguage(Language language) {
   hyphenationStrategy_ = createHyphenationStrategy(language);
 }
 
+LayoutStrategy::PageLayout LayoutStrategy::layoutText(WordProvider& provider, TextRenderer& renderer,
+                                                      const LayoutConfig& config) {
+  PageLayout result;
+  layoutText(provider, renderer, config, result);
+  return result;
+}
+
+// Draw word `index` of a page from its glyph run (or its text if it has none)
+static void drawWord(const LayoutStrategy::PageLayout& layout, size_t index, TextRenderer& renderer) {
+  const LayoutStrategy::PageLayout::WordRecord& word = layout.getWord(index);
+  renderer.setCursor(word.x, word.y);
+  const LayoutStrategy::PageLayout::GlyphRun run = layout.getGlyphRun(index);
+  if (run.font) {
+    renderer.drawGlyphRun(run.font, run.glyphs, run.advances, run.count);
+  } else {
+    renderer.setFontStyle(static_cast<FontStyle>(word.style));
+    renderer.print(layout.getText(word));
+  }
+}
+
+void LayoutStrategy::renderPage(const PageLayout& layout, TextRenderer& renderer, const LayoutConfig& config) {
+  for (size_t i = 0; i < layout.getWordCount(); i++) {
+    drawWord(layout, i, renderer);
+  }
+}
+
+// Draw a page top to bottom in strips of `stripHeight` portrait rows (a
+// multiple of 8; the last strip may be shorter) in a single walk over its
+// lines: `beginStrip(top, height)` clears and selects the strip, then the
+// lines reaching into it are drawn (lines crossing a strip boundary are drawn
+// into both strips) and `endStrip(top, height)` hands it on.
+template <typename BeginStrip, typename EndStrip>
+static void renderStrips(const LayoutStrategy::PageLayout& layout, TextRenderer& renderer, int16_t stripHeight,
+                         BeginStrip beginStrip, EndStrip endStrip) {
+  const size_t lineCount = layout.getLineCount();
+
+  // Rows each style's glyphs can cover around the baseline
+  int16_t styleTop[4];
+  int16_t styleBottom[4];
+  for (int style = 0; style < 4; style++) {
+    renderer.setFontStyle(static_cast<FontStyle>(style));
+    renderer.getFontExtent(styleTop[style], styleBottom[style]);
+  }
+  // Vertical extent [top, bottom) of a line's glyphs
+  struct Extent {
+    int16_t top;
+    int16_t bottom;
+  };
+  auto lineExtent = [&](size_t line) {
+    const LayoutStrategy::PageLayout::LineRecord& record = layout.getLine(line);
+    Extent extent = {INT16_MAX, INT16_MIN};
+    for (uint16_t i = 0; i < record.wordCount; i++) {
+      const LayoutStrategy::PageLayout::WordRecord& word = layout.getWord(record.firstWord + i);
+      const uint8_t style = word.style & 3;
+      if (word.y + styleTop[style] < extent.top) {
+        extent.top = word.y + styleTop[style];
+      }
+      if (word.y + styleBottom[style] > extent.bottom) {
+        extent.bottom = word.y + styleBottom[style];
+      }
+    }
+    return extent;
+  };
+  auto drawLine = [&](size_t line) {
+    const LayoutStrategy::PageLayout::LineRecord& record = layout.getLine(line);
+    for (uint16_t i = 0; i < record.wordCount; i++) {
+      drawWord(layout, record.firstWord + i, renderer);
+    }
+  };
+
+  size_t nextLine = 0;   // first line not drawn yet
+  size_t firstOpen = 0;  // first drawn line that may reach into the next strip
+  for (int16_t top = 0; top < EInkDisplay::DISPLAY_WIDTH; top += stripHeight) {
+    // The last strip may be shorter
+    const int16_t height = top + stripHeight <= EInkDisplay::DISPLAY_WIDTH ? stripHeight
+                                                                           : EInkDisplay::DISPLAY_WIDTH - top;
+    const int16_t bottom = top + height;
+    beginStrip(top, height);
+
+    // Lines drawn into the previous strip that continue into this one
+    for (size_t line = firstOpen; line < nextLine; line++) {
+      if (lineExtent(line).bottom > top) {
+        drawLine(line);
+      }
+    }
+    // Lines starting in this strip
+    while (nextLine < lineCount && lineExtent(nextLine).top < bottom) {
+      drawLine(nextLine++);
+    }
+    while (firstOpen < nextLine && lineExtent(firstOpen).bottom <= bottom) {
+      firstOpen++;
+    }
+
+    endStrip(top, height);
+  }
+}
+
+void LayoutStrategy::renderPageGrayscale(const PageLayout& layout, TextRenderer& renderer,
+                                         const LayoutConfig& config, uint8_t* lsbStrip, uint8_t* msbStrip,
+                                         int16_t stripHeight, StripCallback emit, void* context) {
+  renderer.setBitmapType(TextRenderer::BITMAP_GRAY);
+  renderStrips(
+      layout, renderer, stripHeight,
+      [&](int16_t top, int16_t height) {
+        const size_t stripBytes = static_cast<size_t>(height / 8) * EInkDisplay::DISPLAY_HEIGHT;
+        memset(lsbStrip, 0x00, stripBytes);
+        memset(msbStrip, 0x00, stripBytes);
+        renderer.setGrayscaleStrips(lsbStrip, msbStrip, top, height);
+      },
+      [&](int16_t top, int16_t height) { emit(top, height, lsbStrip, msbStrip, context); });
+}
+
+void LayoutStrategy::renderPageBands(const PageLayout& layout, TextRenderer& renderer, const LayoutConfig& config,
+                                     uint8_t* band, int16_t bandHeight, BandCallback emit, void* context) {
+  renderer.setBitmapType(TextRenderer::BITMAP_BW);
+  renderStrips(
+      layout, renderer, bandHeight,
+      [&](int16_t top, int16_t height) {
+        memset(band, 0xFF, static_cast<size_t>(height / 8) * EInkDisplay::DISPLAY_HEIGHT);
+        renderer.setFrameStrip(band, top, height);
+      },
+      [&](int16_t top, int16_t height) { emit(top, height, band, context); });
+}
+
 LayoutStrategy::Line LayoutStrategy::getNextLine(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth,
                                                  bool& isParagraphEnd, TextAlignment defaultAlignment) {
+  Line result;
+  getNextLine(provider, renderer, maxWidth, isParagraphEnd, defaultAlignment, result);
+  return result;
+}
+
+void LayoutStrategy::getNextLine(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth,
+                                 bool& isParagraphEnd, TextAlignment defaultAlignment, Line& result) {
   isParagraphEnd = false;
 
-  Line result;
+  result.words.clear();
   result.alignment = defaultAlignment;  // Use config default
   bool alignmentCaptured = false;
 
   int16_t currentWidth = 0;
 
+  WordToken token;
   while (provider.hasNextWord()) {
     int wordStartIndex = provider.getCurrentIndex();
-    StyledWord styledWord = provider.getNextWord();
-    String text = styledWord.text;
+    provider.getNextToken(token);
 
     // Capture alignment when we see one in the paragraph
     // CSS alignment overrides the default
     if (!alignmentCaptured) {
-      // Prefer the provider's paragraph alignment if available (providers report Left by default)
-      TextAlign pAlign = provider.getParagraphAlignment();
       alignmentCaptured = true;
-      switch (pAlign) {
-        case TextAlign::Center:
-          result.alignment = ALIGN_CENTER;
-          break;
-        case TextAlign::Right:
-          result.alignment = ALIGN_RIGHT;
-          break;
-        case TextAlign::Left:
-          result.alignment = ALIGN_LEFT;
-          break;
-        default:
-          // Keep defaultAlignment for Justify or unknown
-          break;
-      }
+      result.alignment = getParagraphAlignment(provider, defaultAlignment);
     }
 
-    int16_t bx = 0, by = 0;
-    uint16_t bw = 0, bh = 0;
-    renderer.setFontStyle(styledWord.style);
-    renderer.getTextBounds(text.c_str(), 0, 0, &bx, &by, &bw, &bh);
-    Word currentWord(text, static_cast<int16_t>(bw), 0, 0, false, styledWord.style);
-
     // Check for breaks - breaks are returned as special words
-    if (currentWord.text == String("\n")) {
+    if (token.is('\n')) {
       isParagraphEnd = true;
       break;
     }
-    if (currentWord.text[0] == ' ') {
+    if (token.length > 0 && token.text[0] == ' ') {
       continue;
     }
 
+    // The token is only valid until the next provider call: measure it and
+    // keep a copy in the page's text slab
+    renderer.setFontStyle(token.style);
+    int16_t width = measureText(renderer, token.text, token.length);
+    Word currentWord(textSlab_.store(token.text, token.length), width, 0, 0, false, token.style);
+
     // Calculate space needed for this word
     int16_t spaceNeeded = currentWidth > 0 ? spaceWidth_ + currentWord.width : currentWord.width;
 
@@ -90,21 +208,18 @@ LayoutStrategy::Line LayoutStrategy::getNextLine(WordProvider& provider, TextRen
       { split = findBestHyphenSplitForward(currentWord, availableWidth, renderer); }
       if (split.found) {
         // Successfully found a split position
-        String firstPart;
+        WordText firstPart;
         if (split.isAlgorithmic) {
           // Add hyphen for algorithmic split
-          firstPart = currentWord.text.substring(0, split.position) + "-";
+          firstPart = textSlab_.store(currentWord.text.c_str(), split.position, '-');
         } else {
           // Include existing hyphen
-          firstPart = currentWord.text.substring(0, split.position + 1);
+          firstPart = textSlab_.store(currentWord.text.c_str(), split.position + 1);
         }
 
-        int16_t bx2 = 0, by2 = 0;
-        uint16_t bw2 = 0, bh2 = 0;
-        renderer.setFontStyle(styledWord.style);
-        renderer.getTextBounds(firstPart.c_str(), 0, 0, &bx2, &by2, &bw2, &bh2);
-        result.words.push_back(
-            Word(firstPart, static_cast<int16_t>(bw2), 0, 0, true, currentWord.style));  // wasSplit = true
+        renderer.setFontStyle(currentWord.style);
+        int16_t firstWidth = measureText(renderer, firstPart.c_str(), firstPart.length());
+        result.words.push_back(Word(firstPart, firstWidth, 0, 0, true, currentWord.style));  // wasSplit = true
 
         // Move provider position: consume characters up to the split point
         // For existing hyphens, include the hyphen character (+1)
@@ -123,39 +238,54 @@ LayoutStrategy::Line LayoutStrategy::getNextLine(WordProvider& provider, TextRen
     }
   }
 
-  return result;
+}
+
+LayoutStrategy::TextAlignment LayoutStrategy::getParagraphAlignment(WordProvider& provider,
+                                                                    TextAlignment defaultAlignment) {
+  // Prefer the provider's paragraph alignment if available (providers report Left by default)
+  switch (provider.getParagraphAlignment()) {
+    case TextAlign::Center:
+      return ALIGN_CENTER;
+    case TextAlign::Right:
+      return ALIGN_RIGHT;
+    case TextAlign::Left:
+      return ALIGN_LEFT;
+    default:
+      // Keep defaultAlignment for Justify or unknown
+      return defaultAlignment;
+  }
 }
 
 LayoutStrategy::Line LayoutStrategy::getPrevLine(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth,
                                                  bool& isParagraphEnd, TextAlignment defaultAlignment) {
-  isParagraphEnd = false;
   Line result;
+  getPrevLine(provider, renderer, maxWidth, isParagraphEnd, defaultAlignment, result);
+  return result;
+}
+
+void LayoutStrategy::getPrevLine(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth,
+                                 bool& isParagraphEnd, TextAlignment defaultAlignment, Line& result) {
+  isParagraphEnd = false;
+  result.words.clear();
   result.alignment = defaultAlignment;  // Use config default for backward navigation
   int16_t currentWidth = 0;
   bool firstWord = true;
 
+  WordToken token;
   while (provider.getCurrentIndex() > 0) {
-    int wordEndIndex = provider.getCurrentIndex();
-    StyledWord styledWord = provider.getPrevWord();
-    String text = styledWord.text;
+    provider.getPrevToken(token);
     int wordStartIndex = provider.getCurrentIndex();
     bool isFirstWord = firstWord;
     firstWord = false;
 
-    // Measure the rendered width using the renderer
-    int16_t bx = 0, by = 0;
-    uint16_t bw = 0, bh = 0;
-    renderer.setFontStyle(styledWord.style);
-    renderer.getTextBounds(text.c_str(), 0, 0, &bx, &by, &bw, &bh);
-    Word currentWord(text, static_cast<int16_t>(bw), 0, 0, false, styledWord.style);
-
     // Check for breaks - breaks are returned as special words
-    if (currentWord.text == String("\n")) {
+    if (token.is('\n')) {
       // check if we are at an empty line or at the start of a paragraph
       if (isFirstWord) {
-        StyledWord prevStyledWord = provider.getPrevWord();
+        provider.getPrevToken(token);
+        bool emptyLine = token.is('\n');
         provider.ungetWord();
-        if (prevStyledWord.text == String("\n")) {
+        if (emptyLine) {
           isParagraphEnd = true;
           break;
         }
@@ -168,10 +298,15 @@ LayoutStrategy::Line LayoutStrategy::getPrevLine(WordProvider& provider, TextRen
       }
     }
 
-    if (currentWord.text[0] == ' ') {
+    if (token.length > 0 && token.text[0] == ' ') {
       continue;
     }
 
+    // Measure the rendered width and keep a copy of the text
+    renderer.setFontStyle(token.style);
+    int16_t width = measureText(renderer, token.text, token.length);
+    Word currentWord(textSlab_.store(token.text, token.length), width, 0, 0, false, token.style);
+
     // Try to add word to the beginning of the line
     int16_t spaceNeeded = currentWidth > 0 ? spaceWidth_ + currentWord.width : currentWord.width;
     if (currentWidth + spaceNeeded > maxWidth) {
@@ -184,13 +319,12 @@ LayoutStrategy::Line LayoutStrategy::getPrevLine(WordProvider& provider, TextRen
       if (split.found) {
         // Successfully found a split position - add second part (after the split)
         // Take text after the split point
-        String secondPart = currentWord.text.substring(split.position, currentWord.text.length());
-        int16_t bx2 = 0, by2 = 0;
-        uint16_t bw2 = 0, bh2 = 0;
-        renderer.setFontStyle(styledWord.style);
-        renderer.getTextBounds(secondPart.c_str(), 0, 0, &bx2, &by2, &bw2, &bh2);
-        result.words.insert(result.words.begin(),
-                            Word(secondPart, static_cast<int16_t>(bw2), 0, 0, false, currentWord.style));
+        // (a suffix of a slab string is itself NUL-terminated)
+        WordText secondPart(currentWord.text.c_str() + split.position,
+                            static_cast<uint16_t>(currentWord.text.length() - split.position));
+        renderer.setFontStyle(currentWord.style);
+        int16_t secondWidth = measureText(renderer, secondPart.c_str(), secondPart.length());
+        result.words.insert(result.words.begin(), Word(secondPart, secondWidth, 0, 0, false, currentWord.style));
 
         // Move provider position to the split point by consuming characters from word start
         provider.setPosition(wordStartIndex);
@@ -206,8 +340,6 @@ LayoutStrategy::Line LayoutStrategy::getPrevLine(WordProvider& provider, TextRen
       currentWidth += spaceNeeded;
     }
   }
-
-  return result;
 }
 
 int LayoutStrategy::getPreviousPageStart(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config,
@@ -225,19 +357,7 @@ int LayoutStrategy::getPreviousPageStart(WordProvider& provider, TextRenderer& r
 
   // Go backwards more than one page to the end of the paragraph and then move forward to find the start
   provider.setPosition(currentStartPosition);
-  int linesBack = 0;
-
-  while (provider.getCurrentIndex() > 0) {
-    linesBack++;
-
-    bool isParagraphEnd;
-    Line line = getPrevLine(provider, renderer, maxWidth, isParagraphEnd, config.alignment);
-
-    // Stop if we hit a paragraph break and have gone back enough
-    if (isParagraphEnd && linesBack >= maxLines * 1.25) {
-      break;
-    }
-  }
+  seekBackToParagraph(provider, renderer, maxWidth, config.alignment, maxLines * 1.25);
 
   // Now we're positioned far enough back. Move forward, storing the start position of each line
   // until we reach currentStartPosition
@@ -246,10 +366,9 @@ int LayoutStrategy::getPreviousPageStart(WordProvider& provider, TextRenderer& r
 
   while (provider.getCurrentIndex() < currentStartPosition && provider.hasNextWord()) {
     int lineStart = provider.getCurrentIndex();
+    textSlab_.reset();
     bool isParagraphEnd;
-    Line line = getNextLine(provider, renderer, maxWidth, isParagraphEnd, config.alignment);
-
-    linesBack--;
+    getNextLine(provider, renderer, maxWidth, isParagraphEnd, config.alignment, lineScratch_);
 
     if (provider.getCurrentIndex() > lineStart) {
       lineStartPositions.push_back(provider.getCurrentIndex());
@@ -294,36 +413,63 @@ int LayoutStrategy::getPreviousPageStart(WordProvider& provider, TextRenderer& r
   return previousPageStart;
 }
 
+void LayoutStrategy::seekBackToParagraph(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth,
+                                         TextAlignment defaultAlignment, double minLines) {
+  int linesBack = 0;
+
+  while (provider.getCurrentIndex() > 0) {
+    linesBack++;
+
+    // Only line boundaries are needed here, so the text can be dropped per line
+    textSlab_.reset();
+    bool isParagraphEnd;
+    getPrevLine(provider, renderer, maxWidth, isParagraphEnd, defaultAlignment, lineScratch_);
+
+    // Stop if we hit a paragraph break and have gone back enough
+    if (isParagraphEnd && linesBack >= minLines) {
+      break;
+    }
+  }
+}
+
+bool LayoutStrategy::findHyphenPositions(const Word& word) {
+  hyphenScratch_.clear();
+  if (!hyphenationStrategy_) {
+    return false;
+  }
+  const size_t length = word.text.length();
+  for (size_t i = 0; i < length; i++) {
+    if (word.text[i] == '-') {
+      hyphenScratch_.push_back(static_cast<uint16_t>(i));
+    }
+  }
+  if (!hyphenScratch_.empty()) {
+    return false;
+  }
+  hyphenationStrategy_->hyphenate(word.text.c_str(), length, hyphenScratch_, 6, 3);
+  return true;
+}
+
 LayoutStrategy::HyphenSplit LayoutStrategy::findBestHyphenSplitForward(const Word& word, int16_t availableWidth,
                                                                        TextRenderer& renderer) {
   // Find the last (rightmost) hyphen position where the first part fits
-  std::vector<int> hyphenPositions;
-  if (hyphenationStrategy_) {
-    std::string stdWord = word.text.c_str();
-    hyphenPositions = hyphenationStrategy_->findHyphenPositions(stdWord, 6, 3);
-  }
+  const bool isAlgorithmic = findHyphenPositions(word);
   HyphenSplit result = {-1, false, false};
 
-  for (int i = 0; i < hyphenPositions.size(); i++) {
-    int pos = hyphenPositions[i];
-    bool isAlgorithmic = pos < 0;
-    int actualPos = isAlgorithmic ? -(pos + 1) : pos;
+  for (size_t i = 0; i < hyphenScratch_.size(); i++) {
+    int actualPos = hyphenScratch_[i];
 
     // For algorithmic positions, we need to add a hyphen
     // For existing hyphens, include the hyphen character
-    String candidate;
+    // Apply the font style of the original word to the renderer before measuring
+    renderer.setFontStyle(word.style);
+    uint16_t bw;
     if (isAlgorithmic) {
-      candidate = word.text.substring(0, actualPos) + "-";
+      bw = measureText(renderer, word.text.c_str(), actualPos) + measureText(renderer, "-", 1);
     } else {
-      candidate = word.text.substring(0, actualPos + 1);
+      bw = measureText(renderer, word.text.c_str(), actualPos + 1);
     }
 
-    int16_t bx = 0, by = 0;
-    uint16_t bw = 0, bh = 0;
-    // Apply the font style of the original word to the renderer before measuring
-    renderer.setFontStyle(word.style);
-    renderer.getTextBounds(candidate.c_str(), 0, 0, &bx, &by, &bw, &bh);
-
     if (bw <= availableWidth) {
       result = {actualPos, isAlgorithmic, true};  // This hyphen works, keep looking for a later one
     } else {
@@ -337,25 +483,16 @@ LayoutStrategy::HyphenSplit LayoutStrategy::findBestHyphenSplitForward(const Wor
 LayoutStrategy::HyphenSplit LayoutStrategy::findBestHyphenSplitBackward(const Word& word, int16_t availableWidth,
                                                                         TextRenderer& renderer) {
   // Find the earliest (leftmost) hyphen position where the second part fits
-  std::vector<int> hyphenPositions;
-  if (hyphenationStrategy_) {
-    std::string stdWord = word.text.c_str();
-    hyphenPositions = hyphenationStrategy_->findHyphenPositions(stdWord, 6, 3);
-  }
+  const bool isAlgorithmic = findHyphenPositions(word);
   HyphenSplit result = {-1, false, false};
 
-  for (int i = hyphenPositions.size() - 1; i >= 0; i--) {
-    int pos = hyphenPositions[i];
-    bool isAlgorithmic = pos < 0;
-    int actualPos = isAlgorithmic ? -(pos + 1) : pos;
+  for (int i = static_cast<int>(hyphenScratch_.size()) - 1; i >= 0; i--) {
+    int actualPos = hyphenScratch_[i];
 
     // For both algorithmic and existing hyphens, take text after the split point
-    String candidate = word.text.substring(actualPos, word.text.length());
-    int16_t bx = 0, by = 0;
-    uint16_t bw = 0, bh = 0;
     // Apply the font style of the original word to the renderer before measuring
     renderer.setFontStyle(word.style);
-    renderer.getTextBounds(candidate.c_str(), 0, 0, &bx, &by, &bw, &bh);
+    uint16_t bw = measureText(renderer, word.text.c_str() + actualPos, word.text.length() - actualPos);
 
     if (bw <= availableWidth) {
       result = {actualPos, isAlgorithmic, true};  // This hyphen works, keep looking for an earlier one
@@ -7,6 +7,8 @@
 #include <cstdint>
 #include <vector>
 
+#include "TextSlab.h"
+#include "WordWidthCache.h"
 #include "rendering/SimpleFont.h"  // For FontStyle
 
 // Forward declarations
@@ -27,7 +29,7 @@ class LayoutStrategy {
   enum TextAlignment { ALIGN_LEFT, ALIGN_CENTER, ALIGN_RIGHT };
 
   struct Word {
-    String text;
+    WordText text;  // Points into the strategy's page-scoped TextSlab
     int16_t width;
     int16_t x;
     int16_t y;
@@ -38,7 +40,7 @@ class LayoutStrategy {
     Word() : text(), width(0), x(0), y(0), wasSplit(false), style(FontStyle::REGULAR) {}
 
     // Constructor for brace initialization (needed for older C++ standards)
-    Word(const String& t, int16_t w, int16_t xPos, int16_t yPos, bool split, FontStyle s = FontStyle::REGULAR)
+    Word(const WordText& t, int16_t w, int16_t xPos, int16_t yPos, bool split, FontStyle s = FontStyle::REGULAR)
         : text(t), width(w), x(xPos), y(yPos), wasSplit(split), style(s) {}
   };
 
@@ -66,9 +68,124 @@ class LayoutStrategy {
     std::vector<int> lineEndPositions;  // provider index after each line
   };
 
-  struct PageLayout {
-    std::vector<Line> lines;
-    int endPosition;  // provider index at end of page
+  /**
+   * PageLayout - Result of laying out one page, stored in a single arena.
+   *
+   * One heap block holds a line table, compact word records, the text bytes
+   * of every word and, for words added with their font, the word's glyph run
+   * (glyph indices and advances from TextRenderer::shapeText) so rendering
+   * does not decode and look up the characters again. reset() rewinds it for
+   * the next page without freeing, so a PageLayout that is reused across pages
+   * does not touch the heap once it is large enough. Copying is disabled;
+   * layouts are moved or reused.
+   */
+  class PageLayout {
+   public:
+    struct LineRecord {
+      uint16_t firstWord;  // index of the line's first word record
+      uint16_t wordCount;
+      uint8_t alignment;  // TextAlignment
+    };
+
+    struct WordRecord {
+      uint16_t textOffset;  // NUL-terminated text at getText(word)
+      uint16_t textLength;
+      int16_t x;
+      int16_t y;
+      int16_t width;
+      uint8_t style;  // FontStyle
+      uint8_t flags;  // FLAG_SPLIT, FLAG_SHAPED
+    };
+
+    // Pre-shaped glyphs of one word, drawn with TextRenderer::drawGlyphRun()
+    struct GlyphRun {
+      const SimpleGFXfont* font;  // nullptr if the word has no run
+      const uint16_t* glyphs;
+      const uint8_t* advances;
+      uint16_t count;
+    };
+
+    static const uint8_t FLAG_SPLIT = 0x01;
+    static const uint8_t FLAG_SHAPED = 0x02;  // has a glyph run in its style's font
+
+    // Initial capacities; the arena grows (and stays grown) if a page needs more
+    static const size_t DEFAULT_MAX_LINES = 48;
+    static const size_t DEFAULT_MAX_WORDS = 512;
+    static const size_t DEFAULT_TEXT_BYTES = 4096;
+    static const size_t DEFAULT_MAX_GLYPHS = 2048;
+
+    PageLayout();
+    ~PageLayout();
+    PageLayout(PageLayout&& other) noexcept;
+    PageLayout& operator=(PageLayout&& other) noexcept;
+    PageLayout(const PageLayout&) = delete;
+    PageLayout& operator=(const PageLayout&) = delete;
+
+    // Forget all lines and words (keeps the arena)
+    void reset();
+    // Start a new line; following addWord() calls append to it. False if the
+    // arena could not grow (nothing is stored).
+    bool beginLine(TextAlignment alignment);
+    // Append a positioned word (its text is copied into the arena) to the
+    // current line. With `font` (the variant the word's style resolves to)
+    // its glyph run is shaped and stored as well; all shaped words of a style
+    // share one font, a word in a different one is stored unshaped. False if
+    // there is no line or the arena could not grow (the word is not stored).
+    bool addWord(const Word& word, const SimpleGFXfont* font = nullptr);
+    // Drop line `line` and the lines after it, with their words
+    void truncate(size_t line);
+
+    size_t getLineCount() const {
+      return lineCount_;
+    }
+    size_t getWordCount() const {
+      return wordCount_;
+    }
+    const LineRecord& getLine(size_t index) const {
+      return lines_[index];
+    }
+    TextAlignment getLineAlignment(size_t index) const {
+      return static_cast<TextAlignment>(lines_[index].alignment);
+    }
+    const WordRecord& getWord(size_t index) const {
+      return words_[index];
+    }
+    const char* getText(const WordRecord& word) const {
+      return text_ + word.textOffset;
+    }
+    // Glyph run of word `index` (font is nullptr for unshaped words)
+    GlyphRun getGlyphRun(size_t index) const;
+    // Word `i` of line `line` as a Word (text points into the arena)
+    Word getLineWord(size_t line, size_t i) const;
+
+    // Bytes reserved by the arena and number of times it had to grow
+    size_t getCapacityBytes() const;
+    uint32_t getGrowCount() const {
+      return growCount_;
+    }
+
+    int endPosition = 0;  // provider index at end of page
+
+   private:
+    bool reserve(size_t lines, size_t words, size_t textBytes, size_t glyphs);
+
+    uint8_t* block_ = nullptr;
+    LineRecord* lines_ = nullptr;
+    WordRecord* words_ = nullptr;
+    uint16_t* runStarts_ = nullptr;  // first glyph of each word's run
+    uint16_t* glyphs_ = nullptr;
+    uint8_t* advances_ = nullptr;
+    char* text_ = nullptr;
+    size_t maxLines_ = 0;
+    size_t maxWords_ = 0;
+    size_t textCapacity_ = 0;
+    size_t glyphCapacity_ = 0;
+    size_t lineCount_ = 0;
+    size_t wordCount_ = 0;
+    size_t textUsed_ = 0;
+    size_t glyphsUsed_ = 0;
+    const SimpleGFXfont* styleFonts_[4];  // font of the shaped words of each FontStyle
+    uint32_t growCount_ = 0;
   };
 
   LayoutStrategy();
@@ -78,12 +195,41 @@ class LayoutStrategy {
   // Set the language for hyphenation (updates hyphenation strategy)
   void setLanguage(Language language);
 
-  // Main layout method: takes words from a provider and computes layout
-  // Returns page layout with lines and end position
-  virtual PageLayout layoutText(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config) = 0;
+  // Main layout method: takes words from a provider and lays out one page into
+  // `out` (which is reset first). Reuse the same PageLayout across pages to
+  // avoid heap allocations.
+  virtual void layoutText(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config,
+                          PageLayout& out) = 0;
+  // Convenience overload returning a freshly allocated page layout
+  PageLayout layoutText(WordProvider& provider, TextRenderer& renderer, const LayoutConfig& config);
 
   // Render a previously computed page layout
-  virtual void renderPage(const PageLayout& layout, TextRenderer& renderer, const LayoutConfig& config) = 0;
+  virtual void renderPage(const PageLayout& layout, TextRenderer& renderer, const LayoutConfig& config);
+
+  // Receives each finished strip of renderPageGrayscale(): portrait rows
+  // [top, top + height) of the LSB and MSB planes
+  typedef void (*StripCallback)(int16_t top, int16_t height, const uint8_t* lsb, const uint8_t* msb, void* context);
+
+  // Render both grayscale planes of a page in a single walk over its lines.
+  // The page is covered top to bottom by strips of `stripHeight` rows (a
+  // multiple of 8); each strip is cleared, drawn into `lsbStrip`/`msbStrip`
+  // (stripHeight / 8 * 480 bytes each) and handed to `emit` before the next
+  // one starts (the last strip may be shorter). Lines that cross a strip
+  // boundary are drawn into both strips.
+  void renderPageGrayscale(const PageLayout& layout, TextRenderer& renderer, const LayoutConfig& config,
+                           uint8_t* lsbStrip, uint8_t* msbStrip, int16_t stripHeight, StripCallback emit,
+                           void* context);
+
+  // Receives each finished band of renderPageBands(): portrait rows
+  // [top, top + height) of the black & white page
+  typedef void (*BandCallback)(int16_t top, int16_t height, uint8_t* band, void* context);
+
+  // Render the black & white page like renderPage(), but band by band into
+  // `band` (bandHeight / 8 * 480 bytes), which is cleared to white and handed
+  // to `emit` for each band in turn, the same way as renderPageGrayscale().
+  // `emit` may draw more into the band before sending it on.
+  void renderPageBands(const PageLayout& layout, TextRenderer& renderer, const LayoutConfig& config, uint8_t* band,
+                       int16_t bandHeight, BandCallback emit, void* context);
 
   // Calculate the start position of the previous page given current position
   // Calculate the start position of the previous page. A default implementation is
@@ -101,6 +247,14 @@ class LayoutStrategy {
     return y;
   }
 
+  // Memoized word widths used by layout and navigation (exposes hit statistics)
+  const WordWidthCache& getWidthCache() const {
+    return widthCache_;
+  }
+  WordWidthCache& getWidthCache() {
+    return widthCache_;
+  }
+
   // Test wrappers for common navigation helpers. Tests should use these instead
   // of dependent-strategy-specific functions.
   Line test_getPrevLine(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth, bool& isParagraphEnd);
@@ -119,14 +273,44 @@ class LayoutStrategy {
                    TextAlignment defaultAlignment);
   Line getPrevLine(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth, bool& isParagraphEnd,
                    TextAlignment defaultAlignment);
+  // Same as above, filling `out` so its word storage can be reused between lines
+  void getNextLine(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth, bool& isParagraphEnd,
+                   TextAlignment defaultAlignment, Line& out);
+  void getPrevLine(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth, bool& isParagraphEnd,
+                   TextAlignment defaultAlignment, Line& out);
+
+  // Alignment of the paragraph the provider is in (CSS overrides the default)
+  static TextAlignment getParagraphAlignment(WordProvider& provider, TextAlignment defaultAlignment);
+  // Move the provider back by at least `minLines` lines, stopping at a paragraph
+  // boundary (or the start of the text)
+  void seekBackToParagraph(WordProvider& provider, TextRenderer& renderer, int16_t maxWidth,
+                           TextAlignment defaultAlignment, double minLines);
+
+  // Width of text in the renderer's current font and style, through the width cache
+  int16_t measureText(TextRenderer& renderer, const char* text, size_t length) {
+    return static_cast<int16_t>(widthCache_.getTextWidth(renderer, text, length));
+  }
 
   // Word splitting helpers
   HyphenSplit findBestHyphenSplitForward(const Word& word, int16_t availableWidth, TextRenderer& renderer);
   HyphenSplit findBestHyphenSplitBackward(const Word& word, int16_t availableWidth, TextRenderer& renderer);
+  // Split positions of `word` into hyphenScratch_: the positions of its
+  // hyphens, or if it has none the ones its language allows; true for the
+  // latter (a '-' has to be inserted)
+  bool findHyphenPositions(const Word& word);
 
   // Shared space width used by layout and navigation
   uint16_t spaceWidth_ = 0;
 
+  // Page-scoped storage for the text of laid out words
+  TextSlab textSlab_;
+  // Widths of recently measured words; survives across pages
+  WordWidthCache widthCache_;
+  // Reusable line for callers that only need it until the next line
+  Line lineScratch_;
+  // Reusable output of findHyphenPositions()
+  std::vector<uint16_t> hyphenScratch_;
+
   // Hyphenation strategy for current language
   HyphenationStrategy* hyphenationStrategy_ = nullptr;
 };
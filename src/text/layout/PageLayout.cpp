@@ -0,0 +1,207 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "../../rendering/TextRenderer.h"
+#include "LayoutStrategy.h"
+
+using PageLayout = LayoutStrategy::PageLayout;
+
+PageLayout::PageLayout() {
+  memset(styleFonts_, 0, sizeof(styleFonts_));
+}
+
+PageLayout::~PageLayout() {
+  free(block_);
+}
+
+PageLayout::PageLayout(PageLayout&& other) noexcept {
+  *this = static_cast<PageLayout&&>(other);
+}
+
+PageLayout& PageLayout::operator=(PageLayout&& other) noexcept {
+  if (this != &other) {
+    free(block_);
+    block_ = other.block_;
+    lines_ = other.lines_;
+    words_ = other.words_;
+    runStarts_ = other.runStarts_;
+    glyphs_ = other.glyphs_;
+    advances_ = other.advances_;
+    text_ = other.text_;
+    maxLines_ = other.maxLines_;
+    maxWords_ = other.maxWords_;
+    textCapacity_ = other.textCapacity_;
+    glyphCapacity_ = other.glyphCapacity_;
+    lineCount_ = other.lineCount_;
+    wordCount_ = other.wordCount_;
+    textUsed_ = other.textUsed_;
+    glyphsUsed_ = other.glyphsUsed_;
+    memcpy(styleFonts_, other.styleFonts_, sizeof(styleFonts_));
+    growCount_ = other.growCount_;
+    endPosition = other.endPosition;
+    other.block_ = nullptr;
+    other.lines_ = nullptr;
+    other.words_ = nullptr;
+    other.runStarts_ = nullptr;
+    other.glyphs_ = nullptr;
+    other.advances_ = nullptr;
+    other.text_ = nullptr;
+    other.maxLines_ = other.maxWords_ = other.textCapacity_ = other.glyphCapacity_ = 0;
+    other.lineCount_ = other.wordCount_ = other.textUsed_ = other.glyphsUsed_ = 0;
+  }
+  return *this;
+}
+
+void PageLayout::reset() {
+  lineCount_ = 0;
+  wordCount_ = 0;
+  textUsed_ = 0;
+  glyphsUsed_ = 0;
+  memset(styleFonts_, 0, sizeof(styleFonts_));
+  endPosition = 0;
+}
+
+bool PageLayout::reserve(size_t lines, size_t words, size_t textBytes, size_t glyphs) {
+  if (block_ && lines <= maxLines_ && words <= maxWords_ && textBytes <= textCapacity_ && glyphs <= glyphCapacity_)
+    return true;
+
+  // First allocation uses the defaults; after that every region that is too
+  // small grows to twice what is needed
+  size_t newLines = block_ ? maxLines_ : DEFAULT_MAX_LINES;
+  size_t newWords = block_ ? maxWords_ : DEFAULT_MAX_WORDS;
+  size_t newText = block_ ? textCapacity_ : DEFAULT_TEXT_BYTES;
+  size_t newGlyphs = block_ ? glyphCapacity_ : DEFAULT_MAX_GLYPHS;
+  if (lines > newLines)
+    newLines = 2 * lines;
+  if (words > newWords)
+    newWords = 2 * words;
+  if (textBytes > newText)
+    newText = 2 * textBytes;
+  if (glyphs > newGlyphs)
+    newGlyphs = 2 * glyphs;
+  // Word text and glyph offsets are 16 bit
+  if (newText > 0xFFFF)
+    newText = 0xFFFF;
+  if (newGlyphs > 0xFFFF)
+    newGlyphs = 0xFFFF;
+  if (textBytes > newText || glyphs > newGlyphs || newWords > 0xFFFF)
+    return false;
+
+  // The 16-bit tables follow the word table, bytes go last
+  size_t linesBytes = newLines * sizeof(LineRecord);
+  size_t wordsOffset = (linesBytes + alignof(WordRecord) - 1) / alignof(WordRecord) * alignof(WordRecord);
+  size_t runStartsOffset = wordsOffset + newWords * sizeof(WordRecord);
+  size_t glyphsOffset = runStartsOffset + newWords * sizeof(uint16_t);
+  size_t advancesOffset = glyphsOffset + newGlyphs * sizeof(uint16_t);
+  size_t textOffset = advancesOffset + newGlyphs;
+  uint8_t* block = static_cast<uint8_t*>(malloc(textOffset + newText));
+  if (!block)
+    return false;
+
+  LineRecord* newLineTable = reinterpret_cast<LineRecord*>(block);
+  WordRecord* newWordTable = reinterpret_cast<WordRecord*>(block + wordsOffset);
+  uint16_t* newRunStarts = reinterpret_cast<uint16_t*>(block + runStartsOffset);
+  uint16_t* newGlyphTable = reinterpret_cast<uint16_t*>(block + glyphsOffset);
+  uint8_t* newAdvances = block + advancesOffset;
+  char* newTextBytes = reinterpret_cast<char*>(block + textOffset);
+  if (block_) {
+    memcpy(newLineTable, lines_, lineCount_ * sizeof(LineRecord));
+    memcpy(newWordTable, words_, wordCount_ * sizeof(WordRecord));
+    memcpy(newRunStarts, runStarts_, wordCount_ * sizeof(uint16_t));
+    memcpy(newGlyphTable, glyphs_, glyphsUsed_ * sizeof(uint16_t));
+    memcpy(newAdvances, advances_, glyphsUsed_);
+    memcpy(newTextBytes, text_, textUsed_);
+    free(block_);
+    ++growCount_;
+  }
+  block_ = block;
+  lines_ = newLineTable;
+  words_ = newWordTable;
+  runStarts_ = newRunStarts;
+  glyphs_ = newGlyphTable;
+  advances_ = newAdvances;
+  text_ = newTextBytes;
+  maxLines_ = newLines;
+  maxWords_ = newWords;
+  textCapacity_ = newText;
+  glyphCapacity_ = newGlyphs;
+  return true;
+}
+
+bool PageLayout::beginLine(TextAlignment alignment) {
+  if (!reserve(lineCount_ + 1, wordCount_, textUsed_, glyphsUsed_))
+    return false;
+  LineRecord& line = lines_[lineCount_++];
+  line.firstWord = static_cast<uint16_t>(wordCount_);
+  line.wordCount = 0;
+  line.alignment = static_cast<uint8_t>(alignment);
+  return true;
+}
+
+bool PageLayout::addWord(const Word& word, const SimpleGFXfont* font) {
+  size_t length = word.text.length();
+  // Every shaped word of a style uses the same font
+  const uint8_t style = static_cast<uint8_t>(word.style) & 3;
+  if (font && styleFonts_[style] && styleFonts_[style] != font)
+    font = nullptr;
+  // A run has at most one glyph per text byte
+  size_t maxGlyphs = font ? length : 0;
+  if (lineCount_ == 0 || !reserve(lineCount_, wordCount_ + 1, textUsed_ + length + 1, glyphsUsed_ + maxGlyphs))
+    return false;
+
+  WordRecord& record = words_[wordCount_++];
+  record.textOffset = static_cast<uint16_t>(textUsed_);
+  record.textLength = static_cast<uint16_t>(length);
+  record.x = word.x;
+  record.y = word.y;
+  record.width = word.width;
+  record.style = static_cast<uint8_t>(word.style);
+  record.flags = word.wasSplit ? FLAG_SPLIT : 0;
+  runStarts_[wordCount_ - 1] = static_cast<uint16_t>(glyphsUsed_);
+  if (font) {
+    record.flags |= FLAG_SHAPED;
+    styleFonts_[style] = font;
+    glyphsUsed_ +=
+        TextRenderer::shapeText(font, word.text.c_str(), length, glyphs_ + glyphsUsed_, advances_ + glyphsUsed_);
+  }
+  memcpy(text_ + textUsed_, word.text.c_str(), length);
+  text_[textUsed_ + length] = '\0';
+  textUsed_ += length + 1;
+  lines_[lineCount_ - 1].wordCount++;
+  return true;
+}
+
+void PageLayout::truncate(size_t line) {
+  if (line >= lineCount_)
+    return;
+  // Words, text and glyph runs are stored in line order
+  const size_t firstWord = lines_[line].firstWord;
+  if (firstWord < wordCount_) {
+    textUsed_ = words_[firstWord].textOffset;
+    glyphsUsed_ = runStarts_[firstWord];
+    wordCount_ = firstWord;
+  }
+  lineCount_ = line;
+}
+
+LayoutStrategy::Word PageLayout::getLineWord(size_t line, size_t i) const {
+  const WordRecord& record = words_[lines_[line].firstWord + i];
+  return Word(WordText(getText(record), record.textLength), record.width, record.x, record.y,
+              (record.flags & FLAG_SPLIT) != 0, static_cast<FontStyle>(record.style));
+}
+
+PageLayout::GlyphRun PageLayout::getGlyphRun(size_t index) const {
+  const WordRecord& record = words_[index];
+  GlyphRun run;
+  run.font = (record.flags & FLAG_SHAPED) ? styleFonts_[record.style & 3] : nullptr;
+  run.glyphs = glyphs_ + runStarts_[index];
+  run.advances = advances_ + runStarts_[index];
+  size_t end = index + 1 < wordCount_ ? runStarts_[index + 1] : glyphsUsed_;
+  run.count = static_cast<uint16_t>(end - runStarts_[index]);
+  return run;
+}
+
+size_t PageLayout::getCapacityBytes() const {
+  return maxLines_ * sizeof(LineRecord) + maxWords_ * (sizeof(WordRecord) + sizeof(uint16_t)) +
+         glyphCapacity_ * (sizeof(uint16_t) + sizeof(uint8_t)) + textCapacity_;
+}
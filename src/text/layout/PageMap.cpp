@@ -0,0 +1,292 @@
+#include "PageMap.h"
+
+#include <Arduino.h>
+#include <SD.h>
+
+#include <cstring>
+
+#include "../hyphenation/HyphenationStrategy.h"
+
+namespace {
+
+const char PAGE_MAP_MAGIC[4] = {'M', 'R', 'P', 'M'};
+const uint16_t PAGE_MAP_VERSION = 1;
+
+// FNV-1a, 32 bit
+const uint32_t FNV_OFFSET = 2166136261u;
+const uint32_t FNV_PRIME = 16777619u;
+
+uint32_t fnvAdd(uint32_t hash, const void* data, size_t len) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < len; ++i) {
+    hash ^= p[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+uint32_t fnvAddInt(uint32_t hash, int32_t value) {
+  uint8_t bytes[4] = {static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+                      static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24)};
+  return fnvAdd(hash, bytes, sizeof(bytes));
+}
+
+void putU16(std::vector<uint8_t>& out, uint16_t v) {
+  out.push_back(static_cast<uint8_t>(v));
+  out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t v) {
+  out.push_back(static_cast<uint8_t>(v));
+  out.push_back(static_cast<uint8_t>(v >> 8));
+  out.push_back(static_cast<uint8_t>(v >> 16));
+  out.push_back(static_cast<uint8_t>(v >> 24));
+}
+
+uint16_t getU16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t getU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+}  // namespace
+
+PageMap::PageMap() {}
+
+uint32_t PageMap::computeKey(const LayoutStrategy::LayoutConfig& config, const FontFamily* family,
+                             LayoutStrategy::Type strategyType) {
+  // Hash the fields one by one so struct padding never leaks into the key
+  uint32_t hash = FNV_OFFSET;
+  hash = fnvAddInt(hash, PAGE_MAP_VERSION);
+  hash = fnvAddInt(hash, config.marginLeft);
+  hash = fnvAddInt(hash, config.marginRight);
+  hash = fnvAddInt(hash, config.marginTop);
+  hash = fnvAddInt(hash, config.marginBottom);
+  hash = fnvAddInt(hash, config.lineHeight);
+  hash = fnvAddInt(hash, config.minSpaceWidth);
+  hash = fnvAddInt(hash, config.pageWidth);
+  hash = fnvAddInt(hash, config.pageHeight);
+  hash = fnvAddInt(hash, static_cast<int32_t>(config.alignment));
+  hash = fnvAddInt(hash, static_cast<int32_t>(config.language));
+  hash = fnvAddInt(hash, static_cast<int32_t>(strategyType));
+  if (family && family->familyName) {
+    hash = fnvAdd(hash, family->familyName, strlen(family->familyName));
+  }
+  // Include the regular variant's metrics so regenerated fonts invalidate the map
+  if (family && family->regular) {
+    hash = fnvAddInt(hash, family->regular->glyphCount);
+    hash = fnvAddInt(hash, family->regular->yAdvance);
+  }
+  // Synthetic bold is wider than the regular fallback
+  if (family && family->synthesize) {
+    hash = fnvAddInt(hash, family->synthesize);
+  }
+  return hash;
+}
+
+void PageMap::reset(uint32_t key, int chapterCount) {
+  key_ = key;
+  chapters_.clear();
+  if (chapterCount > 0)
+    chapters_.resize(chapterCount);
+  dirty_ = false;
+}
+
+bool PageMap::load(const char* path, uint32_t expectedKey, int expectedChapterCount) {
+  reset(expectedKey, expectedChapterCount);
+
+  if (!SD.exists(path))
+    return false;
+  File f = SD.open(path);
+  if (!f)
+    return false;
+
+  size_t size = f.size();
+  std::vector<uint8_t> data(size);
+  size_t read = size > 0 ? f.read(data.data(), size) : 0;
+  f.close();
+  if (read != size || size < 12)
+    return false;
+
+  const uint8_t* p = data.data();
+  const uint8_t* end = p + size;
+  if (memcmp(p, PAGE_MAP_MAGIC, 4) != 0)
+    return false;
+  uint16_t version = getU16(p + 4);
+  uint32_t key = getU32(p + 6);
+  uint16_t chapterCount = getU16(p + 10);
+  p += 12;
+  if (version != PAGE_MAP_VERSION || key != expectedKey || chapterCount != expectedChapterCount) {
+    Serial.printf("PageMap: discarding %s (layout changed)\n", path);
+    return false;
+  }
+
+  for (uint16_t c = 0; c < chapterCount; ++c) {
+    if (end - p < 9) {
+      reset(expectedKey, expectedChapterCount);
+      return false;
+    }
+    ChapterPages& ch = chapters_[c];
+    ch.complete = p[0] != 0;
+    ch.knownEnd = static_cast<int32_t>(getU32(p + 1));
+    uint32_t count = getU32(p + 5);
+    p += 9;
+    if (static_cast<size_t>(end - p) < static_cast<size_t>(count) * 4) {
+      reset(expectedKey, expectedChapterCount);
+      return false;
+    }
+    ch.starts.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      ch.starts[i] = static_cast<int32_t>(getU32(p));
+      p += 4;
+    }
+  }
+  dirty_ = false;
+  return true;
+}
+
+bool PageMap::save(const char* path) {
+  std::vector<uint8_t> out;
+  out.insert(out.end(), PAGE_MAP_MAGIC, PAGE_MAP_MAGIC + 4);
+  putU16(out, PAGE_MAP_VERSION);
+  putU32(out, key_);
+  putU16(out, static_cast<uint16_t>(chapters_.size()));
+  for (const ChapterPages& ch : chapters_) {
+    out.push_back(ch.complete ? 1 : 0);
+    putU32(out, static_cast<uint32_t>(ch.knownEnd));
+    putU32(out, static_cast<uint32_t>(ch.starts.size()));
+    for (int32_t s : ch.starts)
+      putU32(out, static_cast<uint32_t>(s));
+  }
+
+  if (SD.exists(path))
+    SD.remove(path);
+  File f = SD.open(path, FILE_WRITE);
+  if (!f) {
+    Serial.printf("PageMap: failed to open %s for writing\n", path);
+    return false;
+  }
+  size_t written = f.write(out.data(), out.size());
+  f.close();
+  if (written != out.size())
+    return false;
+  dirty_ = false;
+  return true;
+}
+
+void PageMap::recordPage(int chapter, int chapterStart, int start, int end, bool atChapterEnd) {
+  if (chapter < 0 || chapter >= static_cast<int>(chapters_.size()))
+    return;
+  ChapterPages& ch = chapters_[chapter];
+
+  // A page that makes no progress can only mark the end of the chain
+  if (end <= start) {
+    if (atChapterEnd && !ch.complete && !ch.starts.empty() && start == ch.knownEnd) {
+      ch.complete = true;
+      dirty_ = true;
+    }
+    return;
+  }
+
+  if (ch.starts.empty()) {
+    if (start != chapterStart)
+      return;
+    ch.starts.push_back(start);
+    ch.knownEnd = end;
+    ch.complete = atChapterEnd;
+    dirty_ = true;
+    return;
+  }
+
+  if (start == ch.knownEnd && !ch.complete) {
+    ch.starts.push_back(start);
+    ch.knownEnd = end;
+    ch.complete = atChapterEnd;
+    dirty_ = true;
+    return;
+  }
+
+  // Known page: make sure the stored chain agrees with the fresh layout and
+  // drop everything after it if it does not.
+  int idx = findPage(chapter, start);
+  if (idx < 0)
+    return;
+  size_t next = static_cast<size_t>(idx) + 1;
+  int storedEnd = next < ch.starts.size() ? ch.starts[next] : ch.knownEnd;
+  if (storedEnd != end) {
+    ch.starts.resize(next);
+    ch.knownEnd = end;
+    ch.complete = atChapterEnd;
+    dirty_ = true;
+  }
+}
+
+const PageMap::ChapterPages* PageMap::getChapter(int chapter) const {
+  if (chapter < 0 || chapter >= static_cast<int>(chapters_.size()))
+    return nullptr;
+  return &chapters_[chapter];
+}
+
+int PageMap::findPage(int chapter, int position) const {
+  const ChapterPages* ch = getChapter(chapter);
+  if (!ch || ch->starts.empty())
+    return -1;
+  // Starts are ascending: binary search
+  size_t lo = 0, hi = ch->starts.size();
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (ch->starts[mid] < position)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < ch->starts.size() && ch->starts[lo] == position)
+    return static_cast<int>(lo);
+  return -1;
+}
+
+int PageMap::getPageStart(int chapter, int pageIndex) const {
+  const ChapterPages* ch = getChapter(chapter);
+  if (!ch || pageIndex < 0 || pageIndex >= static_cast<int>(ch->starts.size()))
+    return -1;
+  return ch->starts[pageIndex];
+}
+
+int PageMap::getPageCount(int chapter) const {
+  const ChapterPages* ch = getChapter(chapter);
+  return ch ? static_cast<int>(ch->starts.size()) : 0;
+}
+
+int PageMap::getKnownEnd(int chapter) const {
+  const ChapterPages* ch = getChapter(chapter);
+  return ch ? ch->knownEnd : -1;
+}
+
+bool PageMap::isChapterComplete(int chapter) const {
+  const ChapterPages* ch = getChapter(chapter);
+  return ch && ch->complete;
+}
+
+bool PageMap::isComplete() const {
+  if (chapters_.empty())
+    return false;
+  for (const ChapterPages& ch : chapters_) {
+    if (!ch.complete)
+      return false;
+  }
+  return true;
+}
+
+int PageMap::getTotalPageCount() const {
+  return getPagesBefore(static_cast<int>(chapters_.size()));
+}
+
+int PageMap::getPagesBefore(int chapter) const {
+  int total = 0;
+  for (int c = 0; c < chapter && c < static_cast<int>(chapters_.size()); ++c)
+    total += static_cast<int>(chapters_[c].starts.size());
+  return total;
+}
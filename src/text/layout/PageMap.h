@@ -0,0 +1,91 @@
+#ifndef PAGE_MAP_H
+#define PAGE_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "LayoutStrategy.h"
+#include "rendering/SimpleFont.h"
+
+/**
+ * PageMap - Persistent page-start table for a single book.
+ *
+ * Stores the provider offset at which every page starts, per chapter. Pages are
+ * recorded as a contiguous chain starting at the chapter start: a page is only
+ * accepted when it starts exactly where the previous known page ended, so every
+ * stored offset is a real page boundary for the current layout.
+ *
+ * The map is keyed by a hash of everything that influences pagination
+ * (LayoutConfig, font family, hyphenation language and layout strategy). A map
+ * loaded with a different key is discarded, so changing any layout input
+ * invalidates the sidecar automatically.
+ *
+ * Sidecar format (little endian):
+ *   "MRPM" | u16 version | u32 key | u16 chapterCount
+ *   per chapter: u8 complete | u32 knownEnd | u32 pageCount | i32 starts[pageCount]
+ */
+class PageMap {
+ public:
+  PageMap();
+
+  // Compute the layout key for the given inputs
+  static uint32_t computeKey(const LayoutStrategy::LayoutConfig& config, const FontFamily* family,
+                             LayoutStrategy::Type strategyType);
+
+  // Drop all pages and start a fresh map for `chapterCount` chapters
+  void reset(uint32_t key, int chapterCount);
+
+  // Load from `path`. Returns false (and leaves an empty map) when the file is
+  // missing, corrupt or was written for a different key or chapter count.
+  bool load(const char* path, uint32_t expectedKey, int expectedChapterCount);
+  // Save to `path`. Returns true on success.
+  bool save(const char* path);
+
+  // Record that a page covering [start, end) was laid out in `chapter`.
+  // `chapterStart` is the provider index of the first page of the chapter and
+  // `atChapterEnd` tells whether `end` is the end of the chapter.
+  void recordPage(int chapter, int chapterStart, int start, int end, bool atChapterEnd);
+
+  // Page index of the page starting at `position`, or -1 if unknown
+  int findPage(int chapter, int position) const;
+  // Start offset of page `pageIndex` in `chapter`, or -1 if unknown
+  int getPageStart(int chapter, int pageIndex) const;
+  // Number of known pages in `chapter`
+  int getPageCount(int chapter) const;
+  // End offset of the last known page in `chapter` (-1 if none)
+  int getKnownEnd(int chapter) const;
+  // True once the chain reaches the end of the chapter
+  bool isChapterComplete(int chapter) const;
+  // True once every chapter is complete
+  bool isComplete() const;
+  // Total page count over all chapters (only meaningful when isComplete())
+  int getTotalPageCount() const;
+  // Number of pages in all chapters before `chapter`
+  int getPagesBefore(int chapter) const;
+
+  int getChapterCount() const {
+    return static_cast<int>(chapters_.size());
+  }
+  uint32_t getKey() const {
+    return key_;
+  }
+  // True when pages were added since the last load/save
+  bool isDirty() const {
+    return dirty_;
+  }
+
+ private:
+  struct ChapterPages {
+    std::vector<int32_t> starts;  // page start offsets, ascending
+    int32_t knownEnd = -1;        // end offset of the last page in `starts`
+    bool complete = false;        // last page reaches the end of the chapter
+  };
+
+  const ChapterPages* getChapter(int chapter) const;
+
+  std::vector<ChapterPages> chapters_;
+  uint32_t key_ = 0;
+  bool dirty_ = false;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#include "TextSlab.h"
+
+#include <cstdlib>
+#include <cstring>
+
+TextSlab::~TextSlab() {
+  for (Chunk& c : chunks_)
+    free(c.data);
+}
+
+WordText TextSlab::store(const char* text, size_t length, char suffix) {
+  size_t needed = length + (suffix ? 1 : 0) + 1;
+
+  // Move to the first chunk (reused or new) with enough room left
+  while (chunk_ < chunks_.size() && offset_ + needed > chunks_[chunk_].size) {
+    ++chunk_;
+    offset_ = 0;
+  }
+  if (chunk_ == chunks_.size()) {
+    size_t size = needed > CHUNK_SIZE ? needed : CHUNK_SIZE;
+    char* data = static_cast<char*>(malloc(size));
+    if (!data)
+      return WordText();
+    chunks_.push_back({data, size});
+    offset_ = 0;
+  }
+
+  char* dst = chunks_[chunk_].data + offset_;
+  memcpy(dst, text, length);
+  size_t n = length;
+  if (suffix)
+    dst[n++] = suffix;
+  dst[n] = '\0';
+  offset_ += needed;
+  used_ += needed;
+  return WordText(dst, static_cast<uint16_t>(n));
+}
+
+void TextSlab::reset() {
+  chunk_ = 0;
+  offset_ = 0;
+  used_ = 0;
+}
+
+size_t TextSlab::getCapacity() const {
+  size_t total = 0;
+  for (const Chunk& c : chunks_)
+    total += c.size;
+  return total;
+}
@@ -0,0 +1,80 @@
+#ifndef TEXT_SLAB_H
+#define TEXT_SLAB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * WordText - Read-only view of a NUL-terminated word stored in a TextSlab.
+ *
+ * Used as LayoutStrategy::Word::text. It is a plain pointer + length, so words
+ * can be copied around during layout without touching the heap.
+ */
+struct WordText {
+  const char* ptr = "";
+  uint16_t len = 0;
+
+  WordText() = default;
+  WordText(const char* p, uint16_t n) : ptr(p), len(n) {}
+
+  const char* c_str() const {
+    return ptr;
+  }
+  int length() const {
+    return len;
+  }
+  bool isEmpty() const {
+    return len == 0;
+  }
+  char operator[](size_t i) const {
+    return i < len ? ptr[i] : '\0';
+  }
+  // True for single-character break tokens ("\n", " ", ...)
+  bool is(char c) const {
+    return len == 1 && ptr[0] == c;
+  }
+};
+
+/**
+ * TextSlab - Page-scoped bump allocator for word text.
+ *
+ * Layout copies every word it keeps into the slab once; the resulting WordText
+ * views stay valid until reset(), which the layout strategies call at the start
+ * of each page. Chunks are kept across resets, so after the first page laying
+ * out text does not allocate.
+ */
+class TextSlab {
+ public:
+  TextSlab() = default;
+  ~TextSlab();
+  TextSlab(const TextSlab&) = delete;
+  TextSlab& operator=(const TextSlab&) = delete;
+
+  // Copy `length` bytes of `text` (plus an optional `suffix` character) and
+  // NUL-terminate. Returns an empty view if memory runs out.
+  WordText store(const char* text, size_t length, char suffix = '\0');
+
+  // Forget all stored text (views handed out before become invalid)
+  void reset();
+
+  // Bytes handed out since the last reset / bytes allocated in total
+  size_t getUsedBytes() const {
+    return used_;
+  }
+  size_t getCapacity() const;
+
+  static const size_t CHUNK_SIZE = 2048;
+
+ private:
+  struct Chunk {
+    char* data;
+    size_t size;
+  };
+  std::vector<Chunk> chunks_;
+  size_t chunk_ = 0;   // chunk currently being filled
+  size_t offset_ = 0;  // fill level of chunks_[chunk_]
+  size_t used_ = 0;
+};
+
+#endif
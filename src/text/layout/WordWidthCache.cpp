@@ -0,0 +1,96 @@
+#include "WordWidthCache.h"
+
+#include <cstring>
+
+#include "../../rendering/TextRenderer.h"
+
+WordWidthCache::WordWidthCache(size_t capacity) {
+  // Round up to a power of two so the slot index is a mask
+  size_t size = MAX_PROBES;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  capacity_ = size;
+}
+
+WordWidthCache::~WordWidthCache() {
+  delete[] entries_;
+}
+
+void WordWidthCache::clear() {
+  if (entries_) {
+    memset(entries_, 0, capacity_ * sizeof(Entry));
+  }
+}
+
+uint32_t WordWidthCache::hashKey(const char* text, size_t length, uint8_t style, const SimpleGFXfont* font) {
+  // FNV-1a over the bytes, then the style and the font pointer
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ static_cast<uint8_t>(text[i])) * 16777619u;
+  }
+  hash = (hash ^ style) * 16777619u;
+  uintptr_t fontBits = reinterpret_cast<uintptr_t>(font);
+  hash = (hash ^ static_cast<uint32_t>(fontBits >> 2)) * 16777619u;
+  // 0 is reserved for empty slots
+  return hash ? hash : 1;
+}
+
+uint16_t WordWidthCache::getTextWidth(TextRenderer& renderer, const char* text, size_t length) {
+  if (!text || length > MAX_WORD_BYTES) {
+    uncached_++;
+    return renderer.getTextWidth(text, length);
+  }
+
+  if (!entries_) {
+    entries_ = new Entry[capacity_];
+    memset(entries_, 0, capacity_ * sizeof(Entry));
+    fontGeneration_ = renderer.getFontGeneration();
+  } else if (fontGeneration_ != renderer.getFontGeneration()) {
+    // A different font family was selected: every width may have changed
+    clear();
+    fontGeneration_ = renderer.getFontGeneration();
+  }
+
+  const SimpleGFXfont* font = renderer.getFont();
+  const uint8_t style = static_cast<uint8_t>(renderer.getFontStyle());
+  const uint32_t hash = hashKey(text, length, style, font);
+  const size_t mask = capacity_ - 1;
+  const size_t home = hash & mask;
+
+  // Linear probing; slots are never emptied (only overwritten), so the first
+  // empty slot ends the search
+  Entry* slot = &entries_[home];
+  for (size_t probe = 0; probe < MAX_PROBES; probe++) {
+    Entry& entry = entries_[(home + probe) & mask];
+    if (entry.hash == 0) {
+      slot = &entry;
+      break;
+    }
+    if (entry.hash == hash && entry.length == length && entry.style == style && entry.font == font &&
+        memcmp(entry.text, text, length) == 0) {
+      hits_++;
+      return entry.width;
+    }
+  }
+
+  // Miss: measure and store (replacing the home slot if the run is full)
+  misses_++;
+  uint16_t width = renderer.getTextWidth(text, length);
+  slot->hash = hash;
+  slot->font = font;
+  slot->width = width;
+  slot->style = style;
+  slot->length = static_cast<uint8_t>(length);
+  memcpy(slot->text, text, length);
+  return width;
+}
+
+float WordWidthCache::getHitRate() const {
+  uint32_t lookups = hits_ + misses_ + uncached_;
+  return lookups ? static_cast<float>(hits_) / lookups : 0.0f;
+}
+
+size_t WordWidthCache::getMemoryBytes() const {
+  return entries_ ? capacity_ * sizeof(Entry) : 0;
+}
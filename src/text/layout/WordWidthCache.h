@@ -0,0 +1,84 @@
+#ifndef WORD_WIDTH_CACHE_H
+#define WORD_WIDTH_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rendering/SimpleFont.h"  // For FontStyle
+
+class TextRenderer;
+
+/**
+ * WordWidthCache - Memoized advance widths of short words.
+ *
+ * Layout measures the same common words ("der", "und", "the", ...) thousands
+ * of times per chapter, forward and backward. The cache is a fixed-size open
+ * addressing table keyed by the UTF-8 bytes, the font style and the font
+ * pointer; entries hold a copy of the text so a hit is exact. Words longer than
+ * MAX_WORD_BYTES are measured directly. The table is cleared when the
+ * renderer's font generation changes (setFont()/setFontFamily() selecting
+ * another font or family).
+ */
+class WordWidthCache {
+ public:
+  // Slots in the table (power of two) and the longest word that is cached
+  static const size_t DEFAULT_CAPACITY = 512;
+  static const size_t MAX_WORD_BYTES = 15;
+  // Slots examined per lookup before the home slot is overwritten
+  static const size_t MAX_PROBES = 8;
+
+  explicit WordWidthCache(size_t capacity = DEFAULT_CAPACITY);
+  ~WordWidthCache();
+  WordWidthCache(const WordWidthCache&) = delete;
+  WordWidthCache& operator=(const WordWidthCache&) = delete;
+
+  // Width of `length` bytes of text in the renderer's current font and style
+  // (same result as TextRenderer::getTextWidth)
+  uint16_t getTextWidth(TextRenderer& renderer, const char* text, size_t length);
+
+  // Drop all entries (statistics are kept)
+  void clear();
+
+  // Statistics: lookups answered from the table, measured and stored, and
+  // measured without caching (too long)
+  uint32_t getHits() const {
+    return hits_;
+  }
+  uint32_t getMisses() const {
+    return misses_;
+  }
+  uint32_t getUncached() const {
+    return uncached_;
+  }
+  // Hits as a fraction of all lookups (0 if there were none)
+  float getHitRate() const;
+  void resetStats() {
+    hits_ = misses_ = uncached_ = 0;
+  }
+
+  size_t getCapacity() const {
+    return capacity_;
+  }
+  size_t getMemoryBytes() const;
+
+ private:
+  struct Entry {
+    uint32_t hash;  // 0 marks an empty slot
+    const SimpleGFXfont* font;
+    uint16_t width;
+    uint8_t style;
+    uint8_t length;
+    char text[MAX_WORD_BYTES];
+  };
+
+  static uint32_t hashKey(const char* text, size_t length, uint8_t style, const SimpleGFXfont* font);
+
+  Entry* entries_ = nullptr;  // allocated on first use
+  size_t capacity_;
+  uint32_t fontGeneration_ = 0;
+  uint32_t hits_ = 0;
+  uint32_t misses_ = 0;
+  uint32_t uncached_ = 0;
+};
+
+#endif
@@ -59,8 +59,14 @@ void UIManager::handleButtons(Buttons& buttons) {
   screens[currentScreen]->handleButtons(buttons);
 }
 
+void UIManager::idle(Buttons& buttons) {
+  screens[currentScreen]->idle(buttons);
+}
+
 void UIManager::showSleepScreen() {
   Serial.printf("[%lu] Showing SLEEP screen\n", millis());
+  // Get the framebuffers back from a banded screen
+  screens[currentScreen]->deactivate();
   display.clearScreen(0xFF);
 
   // Draw bebop image centered
@@ -114,6 +120,8 @@ void UIManager::openTextFile(const String& sdPath) {
 
 void UIManager::showScreen(ScreenId id) {
   // Directly show the requested screen (assumed present)
+  if (id != currentScreen)
+    screens[currentScreen]->deactivate();
   currentScreen = id;
   // Call activate so screens can perform any work needed when they become
   // active (this also ensures TextViewerScreen::activate is invoked to open
@@ -35,6 +35,8 @@ class UIManager {
 
   void begin();
   void handleButtons(Buttons& buttons);
+  // Give the active screen a slice of idle time for background work
+  void idle(Buttons& buttons);
   void showSleepScreen();
   // Prepare UI for power-off: notify active screen to persist state
   void prepareForSleep();
@@ -66,7 +66,6 @@ void FileBrowserScreen::renderSdBrowser() {
 
   // Render file list centered both horizontally and vertically.
   textRenderer.setFont(&Font14);
-  const int lineHeight = 28;
   int lines = SD_LINES_PER_SCREEN;
 
   // Count how many actual rows we'll draw (clamped by available files)
@@ -80,9 +79,6 @@ void FileBrowserScreen::renderSdBrowser() {
   if (drawable == 0)
     return;
 
-  int totalHeight = drawable * lineHeight;
-  int startY = (800 - totalHeight) / 2;  // center vertically (pageHeight = 800)
-
   for (int i = 0; i < drawable; ++i) {
     int idx = sdScrollOffset + i;
     String name = sdFiles[idx];
@@ -113,8 +109,7 @@ void FileBrowserScreen::renderSdBrowser() {
     uint16_t w, h;
     textRenderer.getTextBounds(displayName.c_str(), 0, 0, &x1, &y1, &w, &h);
     int16_t centerX = (480 - (int)w) / 2;  // horizontal center (pageWidth = 480)
-    int16_t rowY = startY + i * lineHeight;
-    textRenderer.setCursor(centerX, rowY);
+    textRenderer.setCursor(centerX, rowBaseline(idx));
     textRenderer.print(displayName);
   }
 
@@ -134,6 +129,19 @@ void FileBrowserScreen::renderSdBrowser() {
   }
 }
 
+int FileBrowserScreen::rowBaseline(int index) const {
+  int drawable = std::min(SD_LINES_PER_SCREEN, (int)sdFiles.size() - sdScrollOffset);
+  int totalHeight = drawable * LINE_HEIGHT;
+  int startY = (800 - totalHeight) / 2;  // center vertically (pageHeight = 800)
+  return startY + (index - sdScrollOffset) * LINE_HEIGHT;
+}
+
+void FileBrowserScreen::markRowDirty(int index) {
+  // The row's slot of the list, from above the tallest glyphs to below the
+  // descenders, across the page (names are centered and vary in width)
+  display.markDirty(0, rowBaseline(index) - LINE_HEIGHT * 3 / 4, 480, LINE_HEIGHT);
+}
+
 void FileBrowserScreen::confirm() {
   if (!sdFiles.empty()) {
     String filename = sdFiles[sdSelectedIndex];
@@ -157,6 +165,8 @@ void FileBrowserScreen::offsetSelection(int offset) {
   if (sdFiles.empty())
     return;
 
+  int previousIndex = sdSelectedIndex;
+  int previousScroll = sdScrollOffset;
   int n = (int)sdFiles.size();
   int newIndex = sdSelectedIndex + offset;
   newIndex %= n;
@@ -170,7 +180,14 @@ void FileBrowserScreen::offsetSelection(int offset) {
     sdScrollOffset = sdSelectedIndex;
   }
 
-  show();
+  renderSdBrowser();
+  // Without scrolling only the markers move: update just the two rows (the
+  // battery line catches up with the next full redraw)
+  if (sdScrollOffset == previousScroll) {
+    markRowDirty(previousIndex);
+    markRowDirty(sdSelectedIndex);
+  }
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
 }
 
 void FileBrowserScreen::loadFolder(int maxFiles) {
@@ -30,6 +30,10 @@ class FileBrowserScreen : public Screen {
  private:
   void loadFolder(int maxFiles = 200);
   void renderSdBrowser();
+  // Baseline of the list row showing file `index` (must be on screen)
+  int rowBaseline(int index) const;
+  // Mark the row showing file `index` for a partial update
+  void markRowDirty(int index);
 
   EInkDisplay& display;
   TextRenderer& textRenderer;
@@ -41,6 +45,7 @@ class FileBrowserScreen : public Screen {
   int sdScrollOffset = 0;
 
   static const int SD_LINES_PER_SCREEN = 8;
+  static const int LINE_HEIGHT = 28;
 };
 
 #endif
@@ -16,6 +16,9 @@ class Screen {
   // Called when the screen becomes active
   virtual void activate() {}
 
+  // Called when another screen (or the sleep screen) is about to be shown
+  virtual void deactivate() {}
+
   // Called when the screen should render itself (no args for generic screens)
   virtual void show() = 0;
 
@@ -23,6 +26,11 @@ class Screen {
   // Default implementation does nothing; override in screens that need to
   // save state (e.g. `TextViewerScreen` saving current position).
   virtual void shutdown() {}
+
+  // Called from the main loop when no input is being handled. Screens can do
+  // short slices of background work here but must return quickly and check
+  // `buttons` so input is never delayed.
+  virtual void idle(Buttons& buttons) {}
 };
 
 #endif
@@ -5,12 +5,16 @@
 #include <resources/fonts/FontDefinitions.h>
 
 #include <cstring>
+#include <utility>
 
 #include "../../content/providers/EpubWordProvider.h"
 #include "../../content/providers/FileWordProvider.h"
 #include "../../content/providers/StringWordProvider.h"
 #include "../../core/Buttons.h"
 #include "../../core/SDCardManager.h"
+#include "../../rendering/FontPack.h"
+#include "../../rendering/PageImage.h"
+#include "../../rendering/SyntheticFont.h"
 #include "../../text/hyphenation/HyphenationStrategy.h"
 #include "../../text/layout/GreedyLayoutStrategy.h"
 #include "../../text/layout/KnuthPlassLayoutStrategy.h"
@@ -37,16 +41,77 @@ TextViewerScreen::TextViewerScreen(EInkDisplay& display, TextRenderer& renderer,
 
   // Set the language on the layout strategy
   layoutStrategy->setLanguage(layoutConfig.language);
+
+  paginator = new BackgroundPaginator(*layoutStrategy, pageMap);
+  readerFamily = &bookerlyFamily;
 }
 
 TextViewerScreen::~TextViewerScreen() {
+  delete paginator;
   delete layoutStrategy;
   delete provider;
+  for (FontPack* pack : fontPacks)
+    delete pack;
 }
 
 void TextViewerScreen::begin() {
   // Load persisted viewer settings (last opened file, layout) if present
   loadSettingsFromFile();
+  loadFontPacks();
+}
+
+void TextViewerScreen::loadFontPacks() {
+  if (!sdManager.ready())
+    return;
+
+  // One pack per style; the regular one is required to use the family
+  static const char* const FILES[4] = {"regular.mfp", "bold.mfp", "italic.mfp", "bolditalic.mfp"};
+  for (int i = 0; i < 4; i++) {
+    String path = String(FONT_PACK_DIR) + "/" + FILES[i];
+    if (!SD.exists(path.c_str()))
+      continue;
+    // Body text is regular; the other styles get smaller caches
+    size_t cacheBytes = i == 0 ? FontPack::DEFAULT_CACHE_BYTES : FontPack::DEFAULT_CACHE_BYTES / 4;
+    FontPack* pack = new FontPack(path.c_str(), cacheBytes);
+    if (!pack->isValid()) {
+      Serial.printf("FontPack: cannot load %s\n", path.c_str());
+      delete pack;
+      continue;
+    }
+    fontPacks[i] = pack;
+  }
+  if (!fontPacks[0])
+    return;
+
+  packFamily.familyName = fontPacks[0]->getFont()->name;
+  packFamily.regular = fontPacks[0]->getFont();
+  packFamily.bold = fontPacks[1] ? fontPacks[1]->getFont() : nullptr;
+  packFamily.italic = fontPacks[2] ? fontPacks[2]->getFont() : nullptr;
+  packFamily.boldItalic = fontPacks[3] ? fontPacks[3]->getFont() : nullptr;
+  // Styles without a pack are made from the ones there are
+  packFamily.synthesize = SYNTHESIZE_BOLD | SYNTHESIZE_ITALIC;
+  readerFamily = &packFamily;
+  Serial.printf("FontPack: using %s %d from %s\n", packFamily.familyName, packFamily.regular->size, FONT_PACK_DIR);
+}
+
+void TextViewerScreen::logFontCacheStats() {
+  static const FontStyle STYLES[3] = {FontStyle::BOLD, FontStyle::ITALIC, FontStyle::BOLD_ITALIC};
+  for (FontStyle style : STYLES) {
+    const SimpleGFXfont* font = getFontVariant(readerFamily, style);
+    if (!font || !font->synthetic)
+      continue;
+    SyntheticFont* synthetic = font->synthetic;
+    Serial.printf("SyntheticFont %s/%d: %lu hits, %lu misses\n", font->name, static_cast<int>(font->style),
+                  static_cast<unsigned long>(synthetic->getCacheHits()),
+                  static_cast<unsigned long>(synthetic->getCacheMisses()));
+  }
+  for (FontPack* pack : fontPacks) {
+    if (!pack)
+      continue;
+    Serial.printf("FontPack %s/%d: %lu hits, %lu misses (%.1f%% hit rate)\n", pack->getFont()->name,
+                  static_cast<int>(pack->getFont()->style), static_cast<unsigned long>(pack->getCacheHits()),
+                  static_cast<unsigned long>(pack->getCacheMisses()), pack->getHitRate() * 100.0f);
+  }
 }
 
 void TextViewerScreen::loadSettingsFromFile() {
@@ -138,6 +203,11 @@ void TextViewerScreen::saveSettingsToFile() {
 }
 
 void TextViewerScreen::activate() {
+  beginBanded();
+  // Page turns go on while the panel refreshes; onRefreshDone() moves on to
+  // the grayscale pass
+  display.setRefreshCallback(&TextViewerScreen::onRefreshDone, this);
+  display.setAsyncRefresh(true);
   pageStartIndex = 0;
   // If a file was pending to open from settings, open it now (first time the
   // screen becomes active) so showing happens from an explicit show() path.
@@ -148,15 +218,60 @@ void TextViewerScreen::activate() {
   }
 }
 
+void TextViewerScreen::deactivate() {
+  // Leave the page on screen in RED RAM for the next screen's fast refresh
+  // (a grayscale pass not started yet is dropped)
+  panelStage = PANEL_IDLE;
+  restoreShownPage();
+  pageOnScreen = false;
+  display.setRefreshCallback(nullptr, nullptr);
+  display.setAsyncRefresh(false);
+  savePositionToFile();
+  savePageMap();
+  saveSettingsToFile();
+
+  // Close the book: its read cache and page images are in the framebuffers
+  // the next screen draws into. activate() opens it again.
+  cancelPrefetch();
+  shownImage->attach(nullptr, 0);
+  nextImage->attach(nullptr, 0);
+  grayImage.attach(nullptr, 0);
+  if (currentFilePath.length() > 0) {
+    paginator->end();
+    delete provider;
+    provider = nullptr;
+    pendingOpenPath = currentFilePath;
+    currentFilePath = String("");
+  }
+  display.endBanded();
+}
+
+void TextViewerScreen::beginBanded() {
+  // The reader draws in bands; the framebuffers hold the book's read cache
+  // and the page images: spare buffer 0 the read cache and the grayscale
+  // planes, spare buffer 1 the bw planes of the shown and the next page
+  display.beginBanded();
+  if (!shownImage->isAttached()) {
+    uint8_t* spare = display.getSpareBuffer(1);
+    const size_t half = EInkDisplay::BUFFER_SIZE / 2;
+    shownImage->attach(spare, half);
+    nextImage->attach(spare + half, half);
+    grayImage.attach(display.getSpareBuffer(0) + READ_CACHE_BYTES, EInkDisplay::BUFFER_SIZE - READ_CACHE_BYTES);
+    grayIsNext = false;
+  }
+}
+
 // Ensure member function is in class scope
 void TextViewerScreen::handleButtons(Buttons& buttons) {
   // Long press threshold in milliseconds
   const unsigned long LONG_PRESS_MS = 500;
 
+  if (buttons.isAnyDown()) {
+    lastInputMs = millis();
+  }
+
   if (buttons.isPressed(Buttons::BACK)) {
-    // Save current position for the opened book (if any) before leaving
-    savePositionToFile();
-    saveSettingsToFile();
+    // deactivate() saves the position for the opened book (if any)
     uiManager.showScreen(UIManager::ScreenId::FileBrowser);
   } else if (buttons.isDown(Buttons::LEFT) || buttons.isDown(Buttons::VOLUME_UP)) {
     uint8_t btn = buttons.isDown(Buttons::LEFT) ? Buttons::LEFT : Buttons::VOLUME_UP;
@@ -190,125 +305,336 @@ void TextViewerScreen::show() {
   showPage();
 }
 
+namespace {
+// Baseline of the status line, and the top of the band it is drawn in
+// (clear of the tallest Font14 glyphs)
+const int16_t STATUS_LINE_BASELINE = 790;
+const int16_t STATUS_LINE_TOP = STATUS_LINE_BASELINE - 20;
+// Bytes of the status line that are shaped; what is drawn is further limited
+// to the width between the page margins
+const size_t STATUS_LINE_MAX_BYTES = 128;
+}  // namespace
+
 void TextViewerScreen::showPage() {
   Serial.println("showPage start");
   if (!provider) {
     // No provider available (no file open). Show a helpful message instead
     // of returning silently so the user knows why nothing is displayed.
-    display.clearScreen(0xFF);
-
-    textRenderer.setTextColor(TextRenderer::COLOR_BLACK);
-    textRenderer.setFontFamily(&bookerlyFamily);
-    textRenderer.setFontStyle(FontStyle::ITALIC);
-
-    const char* msg = "No document open";
-    int16_t x1, y1;
-    uint16_t w, h;
-    textRenderer.getTextBounds(msg, 0, 0, &x1, &y1, &w, &h);
-    int16_t centerX = (480 - w) / 2;
-    int16_t centerY = (800 - h) / 2;
-    textRenderer.setCursor(centerX, centerY);
-    textRenderer.print(msg);
-    display.displayBuffer(EInkDisplay::FAST_REFRESH);
+    showMessage("No document open");
     return;
   }
 
-  display.clearScreen(0xFF);
+  // Before pageLayout changes: the fast refresh compares with the page on
+  // screen
+  restoreShownPage();
+
   textRenderer.setTextColor(TextRenderer::COLOR_BLACK);
-  textRenderer.setFontFamily(&bookerlyFamily);
+  textRenderer.setFontFamily(readerFamily);
   textRenderer.setFontStyle(FontStyle::REGULAR);
 
   // print out current percentage
   Serial.print("Page start: ");
   Serial.println(provider->getCurrentIndex());
 
-  unsigned long layoutStart = millis();
-  LayoutStrategy::PageLayout layout = layoutStrategy->layoutText(*provider, textRenderer, layoutConfig);
-  unsigned long layoutEnd = millis();
-
-  Serial.print("Layout time: ");
-  Serial.print(layoutEnd - layoutStart);
-  Serial.println(" ms");
+  // A forward page turn finds the page laid out and rendered while idle
+  const bool hit = nextReady && provider->getCurrentChapter() == nextChapter &&
+                   provider->getCurrentIndex() == nextStartIndex;
+  if (hit) {
+    std::swap(pageLayout, nextLayout);
+    std::swap(shownImage, nextImage);
+    // The grayscale planes are the new page's if the prefetch got to them
+    if (!grayIsNext) {
+      grayImage.clear();
+    }
+    grayIsNext = false;
+    prefetchHits++;
+  } else {
+    unsigned long layoutStart = millis();
+    layoutStrategy->layoutText(*provider, textRenderer, layoutConfig, pageLayout);
+    unsigned long layoutEnd = millis();
+    shownImage->clear();
+    grayImage.clear();
+    grayIsNext = false;
+    prefetchMisses++;
+
+    Serial.print("Layout time: ");
+    Serial.print(layoutEnd - layoutStart);
+    Serial.println(" ms");
+  }
+  cancelPrefetch();
+  Serial.printf("Prefetch: %s (%lu hits, %lu misses)\n", hit ? "hit" : "miss",
+                static_cast<unsigned long>(prefetchHits), static_cast<unsigned long>(prefetchMisses));
 
   pageStartIndex = provider->getCurrentIndex();
-  pageEndIndex = layout.endPosition;
+  pageEndIndex = pageLayout.endPosition;
 
-  unsigned long renderStart = millis();
+  Serial.print("Page end: ");
+  Serial.println(pageEndIndex);
 
-  // Render to BW buffer
-  textRenderer.setFrameBuffer(display.getFrameBuffer());
-  textRenderer.setBitmapType(TextRenderer::BITMAP_BW);
-  layoutStrategy->renderPage(layout, textRenderer, layoutConfig);
+  recordCurrentPage();
 
-  unsigned long renderEnd = millis();
+  // page indicator - now shows book-wide percentage
+  shownIndicator = buildPageIndicator();
+
+  // Render the bw parts band by band and display them
+  unsigned long renderStart = millis();
+  sendPage(EInkDisplay::NEXT_FRAME);
 
   Serial.print("Render time: ");
-  Serial.print(renderEnd - renderStart);
+  Serial.print(millis() - renderStart);
   Serial.println(" ms");
 
-  Serial.print("Page end: ");
-  Serial.println(pageEndIndex);
+  startGrayscale();
+}
 
-  // page indicator - now shows book-wide percentage
-  {
-    // Render to BW buffer
-    textRenderer.setFrameBuffer(display.getFrameBuffer());
-    textRenderer.setBitmapType(TextRenderer::BITMAP_BW);
+void TextViewerScreen::showMessage(const char* msg) {
+  restoreShownPage();
+  pageOnScreen = false;
 
-    // Use book-wide percentage for display
-    // If at end of chapter and it's the last chapter, show 100%
-    float pagePercentage = provider->getPercentage();
-    if (provider->getChapterPercentage(pageEndIndex) >= 1.0f) {
-      // At end of current chapter - check if it's the last chapter
-      if (!provider->hasChapters() || provider->getCurrentChapter() >= provider->getChapterCount() - 1) {
-        pagePercentage = 1.0f;
-      }
+  textRenderer.setBitmapType(TextRenderer::BITMAP_BW);
+  textRenderer.setTextColor(TextRenderer::COLOR_BLACK);
+  textRenderer.setFontFamily(readerFamily);
+  textRenderer.setFontStyle(FontStyle::ITALIC);
+
+  int16_t x1, y1;
+  uint16_t w, h;
+  textRenderer.getTextBounds(msg, 0, 0, &x1, &y1, &w, &h);
+  int16_t centerX = (480 - w) / 2;
+  int16_t centerY = (800 - h) / 2;
+
+  uint8_t* band = display.getBandBuffer();
+  display.beginBands(EInkDisplay::NEXT_FRAME);
+  for (int16_t top = 0; top < EInkDisplay::DISPLAY_WIDTH; top += EInkDisplay::BAND_ROWS) {
+    memset(band, 0xFF, EInkDisplay::BAND_BYTES);
+    textRenderer.setFrameStrip(band, top, EInkDisplay::BAND_ROWS);
+    textRenderer.setCursor(centerX, centerY);
+    textRenderer.print(msg);
+    display.writeBand(top, EInkDisplay::BAND_ROWS, band);
+  }
+  display.endBands();
+  panelStage = PANEL_IDLE;
+}
+
+void TextViewerScreen::sendPage(EInkDisplay::BandTarget target) {
+  textRenderer.setTextColor(TextRenderer::COLOR_BLACK);
+  textRenderer.setFontFamily(readerFamily);
+  textRenderer.setFontStyle(FontStyle::REGULAR);
+
+  uint8_t* band = display.getBandBuffer();
+  display.beginBands(target);
+  if (shownImage->hasPlane(PageImage::BW)) {
+    // Rendered before: only decode the bands
+    textRenderer.setBitmapType(TextRenderer::BITMAP_BW);
+    for (uint8_t i = 0; i < PageImage::BAND_COUNT; i++) {
+      const int16_t top = i * EInkDisplay::BAND_ROWS;
+      shownImage->getBand(PageImage::BW, i, band, EInkDisplay::BAND_BYTES);
+      textRenderer.setFrameStrip(band, top, EInkDisplay::BAND_ROWS);
+      writePageBand(top, EInkDisplay::BAND_ROWS, band, this);
     }
+  } else {
+    recordBands = shownImage->isEmpty(PageImage::BW);
+    layoutStrategy->renderPageBands(pageLayout, textRenderer, layoutConfig, band, EInkDisplay::BAND_ROWS,
+                                    &TextViewerScreen::writePageBand, this);
+    recordBands = false;
+  }
+  display.endBands();
+  pageOnScreen = true;
+}
 
-    textRenderer.setFont(&Font14);
+void TextViewerScreen::writePageBand(int16_t top, int16_t height, uint8_t* band, void* context) {
+  TextViewerScreen* self = static_cast<TextViewerScreen*>(context);
+  // Kept without the status line, which changes with the page map
+  if (self->recordBands) {
+    self->shownImage->addBand(PageImage::BW, band, static_cast<size_t>(height / 8) * EInkDisplay::DISPLAY_HEIGHT);
+  }
+  if (top + height > STATUS_LINE_TOP) {
+    self->drawStatusLine();
+  }
+  self->display.writeBand(top, height, band);
+}
 
-    // Build indicator string: "ChapterName - Z%" or just "Z%" if no chapter name
-    String indicator;
-    String chapterName = provider->getCurrentChapterName();
-    if (!chapterName.isEmpty()) {
-      indicator = chapterName + " - ";
+void TextViewerScreen::restoreShownPage() {
+  // The grayscale planes overwrote RED RAM; put the bw page back
+  if (pageOnScreen && !display.holdsShownFrame()) {
+    sendPage(EInkDisplay::SHOWN_FRAME);
+  }
+}
+
+void TextViewerScreen::drawStatusLine() {
+  // Render into the current band. Drawn as a glyph run so the renderer keeps
+  // the reader font selected (and the layout its cached word widths).
+  textRenderer.setBitmapType(TextRenderer::BITMAP_BW);
+
+  // Shape at most STATUS_LINE_MAX_BYTES, cut at a character boundary
+  const char* text = shownIndicator.c_str();
+  size_t length = shownIndicator.length();
+  if (length > STATUS_LINE_MAX_BYTES) {
+    length = STATUS_LINE_MAX_BYTES;
+    while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80)
+      length--;
+  }
+  uint16_t glyphs[STATUS_LINE_MAX_BYTES];
+  uint8_t advances[STATUS_LINE_MAX_BYTES];
+  size_t count = TextRenderer::shapeText(&Font14, text, length, glyphs, advances);
+
+  // Draw the characters that fit between the page margins
+  const int16_t maxWidth = layoutConfig.pageWidth - layoutConfig.marginLeft - layoutConfig.marginRight;
+  int16_t w = 0;
+  size_t shown = 0;
+  while (shown < count && w + advances[shown] <= maxWidth)
+    w += advances[shown++];
+  int16_t centerX = (480 - w) / 2;
+  textRenderer.setCursor(centerX, STATUS_LINE_BASELINE);
+  textRenderer.drawGlyphRun(&Font14, glyphs, advances, shown);
+}
+
+void TextViewerScreen::refreshStatusLine() {
+  if (!provider || buildPageIndicator() == shownIndicator)
+    return;
+
+  // Redraw the page as it is on screen (no new layout) with the new status
+  // line. The controller RAM holds the grayscale planes, so the whole frame
+  // is sent.
+  restoreShownPage();
+  shownIndicator = buildPageIndicator();
+  sendPage(EInkDisplay::NEXT_FRAME);
+  startGrayscale();
+}
+
+void TextViewerScreen::showGrayscale() {
+  textRenderer.setTextColor(TextRenderer::COLOR_BLACK);
+  textRenderer.setFontFamily(readerFamily);
+  textRenderer.setFontStyle(FontStyle::REGULAR);
+
+  // Render both planes in one pass over the page, in band-sized strips that
+  // share the band buffer and are streamed to the controller RAM (or decode
+  // them if the page was rendered before)
+  unsigned long grayStart = millis();
+  uint8_t* strips = display.getBandBuffer();
+  if (!grayIsNext && grayImage.hasPlane(PageImage::GRAY_LSB) && grayImage.hasPlane(PageImage::GRAY_MSB)) {
+    for (uint8_t i = 0; i < PageImage::BAND_COUNT; i++) {
+      grayImage.getBand(PageImage::GRAY_LSB, i, strips, EInkDisplay::BAND_BYTES);
+      grayImage.getBand(PageImage::GRAY_MSB, i, strips + EInkDisplay::BAND_BYTES, EInkDisplay::BAND_BYTES);
+      display.writeGrayscaleStrip(i * EInkDisplay::BAND_ROWS, EInkDisplay::BAND_ROWS, strips,
+                                  strips + EInkDisplay::BAND_BYTES);
     }
-    indicator += String((int)(pagePercentage * 100)) + "%";
+  } else {
+    recordBands = !grayIsNext && grayImage.isEmpty(PageImage::GRAY_LSB) && grayImage.isEmpty(PageImage::GRAY_MSB);
+    layoutStrategy->renderPageGrayscale(pageLayout, textRenderer, layoutConfig, strips,
+                                        strips + EInkDisplay::BAND_BYTES, EInkDisplay::BAND_ROWS,
+                                        &TextViewerScreen::writeGrayscaleStrip, this);
+    recordBands = false;
+  }
+  textRenderer.setBitmapType(TextRenderer::BITMAP_BW);
+
+  Serial.print("Grayscale render time: ");
+  Serial.print(millis() - grayStart);
+  Serial.println(" ms");
+  logFontCacheStats();
 
-    int16_t x1, y1;
-    uint16_t w, h;
-    textRenderer.getTextBounds(indicator.c_str(), 0, 0, &x1, &y1, &w, &h);
-    int16_t centerX = (480 - w) / 2;
-    textRenderer.setCursor(centerX, 790);
-    textRenderer.print(indicator);
+  // display grayscale part
+  display.displayGrayBuffer();
+  panelStage = display.isRefreshing() ? GRAY_REFRESH : PANEL_IDLE;
+}
+
+void TextViewerScreen::startGrayscale() {
+  // The grayscale planes go into the controller RAM the bw refresh still
+  // reads: wait for it without blocking, unless it is already done
+  if (display.isRefreshing()) {
+    panelStage = BW_REFRESH;
+  } else {
+    showGrayscale();
   }
+}
 
-  // display bw parts
-  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+void TextViewerScreen::onRefreshDone(void* context) {
+  TextViewerScreen* self = static_cast<TextViewerScreen*>(context);
+  if (self->panelStage == BW_REFRESH) {
+    self->panelStage = GRAY_DUE;
+  } else if (self->panelStage == GRAY_REFRESH) {
+    self->panelStage = PANEL_IDLE;
+  }
+}
 
-  // grayscale rendering
-  {
-    textRenderer.setTextColor(TextRenderer::COLOR_BLACK);
-    textRenderer.setFontFamily(&bookerlyFamily);
-    textRenderer.setFontStyle(FontStyle::REGULAR);
+void TextViewerScreen::writeGrayscaleStrip(int16_t top, int16_t height, const uint8_t* lsb, const uint8_t* msb,
+                                           void* context) {
+  TextViewerScreen* self = static_cast<TextViewerScreen*>(context);
+  if (self->recordBands) {
+    const size_t bytes = static_cast<size_t>(height / 8) * EInkDisplay::DISPLAY_HEIGHT;
+    self->grayImage.addBand(PageImage::GRAY_LSB, lsb, bytes);
+    self->grayImage.addBand(PageImage::GRAY_MSB, msb, bytes);
+  }
+  self->display.writeGrayscaleStrip(top, height, lsb, msb);
+}
 
-    // Render and copy to LSB buffer
-    display.clearScreen(0x00);
-    textRenderer.setFrameBuffer(display.getFrameBuffer());
-    textRenderer.setBitmapType(TextRenderer::BITMAP_GRAY_LSB);
-    layoutStrategy->renderPage(layout, textRenderer, layoutConfig);
-    display.copyGrayscaleLsbBuffers(display.getFrameBuffer());
+void TextViewerScreen::prefetchNextPage() {
+  if (!pageOnScreen || !provider || !nextImage->isAttached())
+    return;
 
-    // Render and copy to MSB buffer
-    display.clearScreen(0x00);
-    textRenderer.setFrameBuffer(display.getFrameBuffer());
-    textRenderer.setBitmapType(TextRenderer::BITMAP_GRAY_MSB);
-    layoutStrategy->renderPage(layout, textRenderer, layoutConfig);
-    display.copyGrayscaleMsbBuffers(display.getFrameBuffer());
+  textRenderer.setTextColor(TextRenderer::COLOR_BLACK);
+  textRenderer.setFontFamily(readerFamily);
+  textRenderer.setFontStyle(FontStyle::REGULAR);
+  uint8_t* band = display.getBandBuffer();
+
+  if (!nextReady) {
+    // The next page is in the next chapter, which is not open yet
+    if (provider->getChapterPercentage(pageEndIndex) >= 1.0f)
+      return;
 
-    // display grayscale part
-    display.displayGrayBuffer();
+    // Lay out the page after the one on screen, leaving the position as it is
+    unsigned long start = millis();
+    provider->setPosition(pageEndIndex);
+    nextChapter = provider->getCurrentChapter();
+    nextStartIndex = provider->getCurrentIndex();
+    layoutStrategy->layoutText(*provider, textRenderer, layoutConfig, nextLayout);
+    provider->setPosition(pageStartIndex);
+
+    // Render it without its status line
+    nextImage->clear();
+    layoutStrategy->renderPageBands(nextLayout, textRenderer, layoutConfig, band, EInkDisplay::BAND_ROWS,
+                                    &TextViewerScreen::storeNextBand, nextImage);
+    nextReady = true;
+    // A plane that did not fit is rendered when the page is shown
+    Serial.printf("Prefetch: page at %d ready in %lu ms (bw %lu bytes%s)\n", nextStartIndex, millis() - start,
+                  static_cast<unsigned long>(nextImage->getUsedBytes()),
+                  nextImage->hasPlane(PageImage::BW) ? "" : ", did not fit");
   }
+
+  // The grayscale planes of the page on screen make way once they are sent
+  if (!grayIsNext && (panelStage == PANEL_IDLE || panelStage == GRAY_REFRESH)) {
+    unsigned long start = millis();
+    grayImage.clear();
+    grayIsNext = true;
+    textRenderer.setFontStyle(FontStyle::REGULAR);
+    layoutStrategy->renderPageGrayscale(nextLayout, textRenderer, layoutConfig, band, band + EInkDisplay::BAND_BYTES,
+                                        EInkDisplay::BAND_ROWS, &TextViewerScreen::storeNextStrip, &grayImage);
+    textRenderer.setBitmapType(TextRenderer::BITMAP_BW);
+    Serial.printf("Prefetch: grayscale of page at %d in %lu ms (%lu bytes%s)\n", nextStartIndex, millis() - start,
+                  static_cast<unsigned long>(grayImage.getUsedBytes()),
+                  grayImage.hasPlane(PageImage::GRAY_MSB) ? "" : ", did not fit");
+  }
+}
+
+void TextViewerScreen::cancelPrefetch() {
+  nextReady = false;
+  nextImage->clear();
+  if (grayIsNext) {
+    grayImage.clear();
+    grayIsNext = false;
+  }
+}
+
+void TextViewerScreen::storeNextBand(int16_t /*top*/, int16_t height, uint8_t* band, void* context) {
+  static_cast<PageImage*>(context)->addBand(PageImage::BW, band,
+                                            static_cast<size_t>(height / 8) * EInkDisplay::DISPLAY_HEIGHT);
+}
+
+void TextViewerScreen::storeNextStrip(int16_t /*top*/, int16_t height, const uint8_t* lsb, const uint8_t* msb,
+                                      void* context) {
+  PageImage* image = static_cast<PageImage*>(context);
+  const size_t bytes = static_cast<size_t>(height / 8) * EInkDisplay::DISPLAY_HEIGHT;
+  image->addBand(PageImage::GRAY_LSB, lsb, bytes);
+  image->addBand(PageImage::GRAY_MSB, msb, bytes);
 }
 
 void TextViewerScreen::nextPage() {
@@ -345,6 +671,14 @@ void TextViewerScreen::prevPage() {
       if (currentChapter > 0) {
         // Go to previous chapter and position at the end
         provider->setChapter(currentChapter - 1);
+        // Jump straight to the last page if the chapter is fully paginated
+        if (pageMap.isChapterComplete(currentChapter - 1)) {
+          int lastPage = pageMap.getPageCount(currentChapter - 1) - 1;
+          pageStartIndex = pageMap.getPageStart(currentChapter - 1, lastPage);
+          provider->setPosition(pageStartIndex);
+          showPage();
+          return;
+        }
         // Go to end of previous chapter by setting position to a large value
         // then use getPreviousPageStart to find the last page
         provider->setPosition(0x7FFFFFFF);  // Seek to end
@@ -357,7 +691,17 @@ void TextViewerScreen::prevPage() {
       return;
   }
 
-  textRenderer.setFontFamily(&bookerlyFamily);
+  // Use the pagination map when the previous page is already known
+  int chapter = provider->getCurrentChapter();
+  int pageIdx = pageMap.findPage(chapter, pageStartIndex);
+  if (pageIdx > 0) {
+    pageStartIndex = pageMap.getPageStart(chapter, pageIdx - 1);
+    provider->setPosition(pageStartIndex);
+    showPage();
+    return;
+  }
+
+  textRenderer.setFontFamily(readerFamily);
 
   // Find where the previous page starts
   pageStartIndex = layoutStrategy->getPreviousPageStart(*provider, textRenderer, layoutConfig, pageStartIndex);
@@ -394,8 +738,14 @@ void TextViewerScreen::jumpToNextChapter() {
     pageStartIndex = provider->getCurrentIndex();
   }
 
-  // Find where the previous page starts
-  pageStartIndex = layoutStrategy->getPreviousPageStart(*provider, textRenderer, layoutConfig, pageStartIndex);
+  // Find where the last page starts (from the pagination map when possible)
+  int chapter = provider->getCurrentChapter();
+  if (pageMap.isChapterComplete(chapter)) {
+    pageStartIndex = pageMap.getPageStart(chapter, pageMap.getPageCount(chapter) - 1);
+  } else {
+    textRenderer.setFontFamily(readerFamily);
+    pageStartIndex = layoutStrategy->getPreviousPageStart(*provider, textRenderer, layoutConfig, pageStartIndex);
+  }
   provider->setPosition(pageStartIndex);
   showPage();
 }
@@ -428,7 +778,10 @@ void TextViewerScreen::loadTextFromString(const String& content) {
   // Create provider for the entire content
   // Preserve the passed-in content on the object so the provider has
   // stable storage for its internal copy/operations.
+  paginator->end();
   delete provider;
+  beginBanded();
+  cancelPrefetch();
   loadedText = content;
   if (loadedText.length() > 0) {
     provider = new StringWordProvider(loadedText);
@@ -440,6 +793,11 @@ void TextViewerScreen::loadTextFromString(const String& content) {
   pageEndIndex = 0;
   // Clear any associated file path when loading from memory
   currentFilePath = String("");
+
+  // In-memory text is paginated on the fly only (nothing to persist)
+  chapterStartChapter = -1;
+  pageMap.reset(PageMap::computeKey(layoutConfig, readerFamily, layoutStrategy->getType()),
+                provider ? provider->getChapterCount() : 0);
 }
 
 void TextViewerScreen::openFile(const String& sdPath) {
@@ -452,13 +810,47 @@ void TextViewerScreen::openFile(const String& sdPath) {
   }
 
   // Use a buffered file-backed provider to avoid allocating the entire file in RAM.
+  paginator->end();
   delete provider;
   provider = nullptr;
   currentFilePath = sdPath;
+  pendingOpenPath = String("");
 
   // Load the saved position from SD if present
   loadPositionFromFile();
 
+  // The read cache goes into the framebuffer memory banded mode frees, in
+  // front of the grayscale page image
+  beginBanded();
+  cancelPrefetch();
+  provider = createProvider(sdPath, display.getSpareBuffer(0));
+  if (!provider) {
+    currentFilePath = String("");
+    return;
+  }
+
+  // Set chapter first (if provider supports it), then position within chapter
+  unsigned long provStart = millis();
+  if (provider->hasChapters() && currentChapter > 0) {
+    Serial.printf("Setting chapter to %d\n", currentChapter);
+    provider->setChapter(currentChapter);
+  } else {
+    Serial.printf("No chapters\n");
+    currentChapter = 0;
+    provider->setChapter(0);
+  }
+  provider->setPosition(pageStartIndex);
+  unsigned long provMs = millis() - provStart;
+  Serial.printf("  Provider setup took  %lu ms\n", provMs);
+
+  chapterStartChapter = -1;
+  loadPageMap();
+
+  unsigned long endTime = millis();
+  Serial.printf("Opened file  %s  in  %lu ms\n", sdPath.c_str(), endTime - startTime);
+}
+
+WordProvider* TextViewerScreen::createProvider(const String& sdPath, uint8_t* cacheBuffer) {
   // Check if this is an EPUB file
   bool isEpub = false;
   if (sdPath.length() >= 5) {
@@ -471,42 +863,26 @@ void TextViewerScreen::openFile(const String& sdPath) {
 
   if (isEpub) {
     // Use EPUB word provider
-    EpubWordProvider* ep = new EpubWordProvider(sdPath.c_str());
+    EpubWordProvider* ep = cacheBuffer ? new EpubWordProvider(sdPath.c_str(), READ_CACHE_BYTES, cacheBuffer)
+                                       : new EpubWordProvider(sdPath.c_str());
     if (!ep->isValid()) {
       Serial.printf("TextViewerScreen: failed to open EPUB %s\n", sdPath.c_str());
       delete ep;
-      currentFilePath = String("");
-      return;
+      return nullptr;
     }
-    provider = ep;
-  } else {
-    // Use regular file word provider for text files
-    FileWordProvider* fp = new FileWordProvider(sdPath.c_str());
-    if (!fp->isValid()) {
-      Serial.printf("TextViewerScreen: failed to open %s\n", sdPath.c_str());
-      delete fp;
-      currentFilePath = String("");
-      return;
-    }
-    provider = fp;
+    return ep;
   }
 
-  // Set chapter first (if provider supports it), then position within chapter
-  unsigned long provStart = millis();
-  if (provider->hasChapters() && currentChapter > 0) {
-    Serial.printf("Setting chapter to %d\n", currentChapter);
-    provider->setChapter(currentChapter);
-  } else {
-    Serial.printf("No chapters\n");
-    currentChapter = 0;
-    provider->setChapter(0);
+  // Use regular file word provider for text files
+  FileWordProvider* fp = cacheBuffer ? new FileWordProvider(sdPath.c_str(), READ_CACHE_BYTES, cacheBuffer)
+                                     : new FileWordProvider(sdPath.c_str());
+  if (!fp->isValid()) {
+    Serial.printf("TextViewerScreen: failed to open %s\n", sdPath.c_str());
+    delete fp;
+    return nullptr;
   }
-  provider->setPosition(pageStartIndex);
-  unsigned long provMs = millis() - provStart;
-  Serial.printf("  Provider setup took  %lu ms\n", provMs);
-
-  unsigned long endTime = millis();
-  Serial.printf("Opened file  %s  in  %lu ms\n", sdPath.c_str(), endTime - startTime);
+  fp->loadOrBuildIndex();
+  return fp;
 }
 
 void TextViewerScreen::savePositionToFile() {
@@ -564,5 +940,157 @@ void TextViewerScreen::loadPositionFromFile() {
 void TextViewerScreen::shutdown() {
   // Persist the current position for the opened file (if any)
   savePositionToFile();
+  savePageMap();
   saveSettingsToFile();
 }
+
+namespace {
+// Quiet time after the last button press before background pagination starts
+const unsigned long PAGINATION_IDLE_DELAY_MS = 1500;
+// Don't open a second provider for the paginator below this much free heap
+const uint32_t PAGINATION_MIN_FREE_HEAP = 40000;
+// Save the page map at least this often while paginating
+const int PAGINATION_SAVE_INTERVAL_PAGES = 32;
+
+bool yieldOnInput(void* context) {
+  return static_cast<Buttons*>(context)->isAnyDown();
+}
+}  // namespace
+
+void TextViewerScreen::idle(Buttons& buttons) {
+  // The grayscale pass of the page on screen once its bw refresh is done
+  if (panelStage == GRAY_DUE) {
+    showGrayscale();
+  }
+  // Then the next page (while the panel refreshes): it is what the reader
+  // waits for
+  prefetchNextPage();
+
+  if (!provider || currentFilePath.length() == 0)
+    return;
+  if (millis() - lastInputMs < PAGINATION_IDLE_DELAY_MS)
+    return;
+
+  if (!paginator->isActive()) {
+    if (pageMap.isComplete())
+      return;
+    if (ESP.getFreeHeap() < PAGINATION_MIN_FREE_HEAP)
+      return;
+    // The paginator gets its own provider so the reading position never moves.
+    // Opening it (for an EPUB: the archive and the current chapter) cannot be
+    // interrupted, so only start while no button is down, and leave the first
+    // step to the next call so input gets checked again in between.
+    if (yieldOnInput(&buttons))
+      return;
+    WordProvider* background = createProvider(currentFilePath);
+    if (!background)
+      return;
+    paginator->begin(background, layoutConfig);
+    pagesSinceMapSave = 0;
+    return;
+  }
+  // Chapters that could not be paginated are left alone until the book is reopened
+  if (!paginator->hasWork())
+    return;
+
+  textRenderer.setFontFamily(readerFamily);
+  textRenderer.setFontStyle(FontStyle::REGULAR);
+
+  int chaptersBefore = paginator->getChaptersCompleted();
+  pagesSinceMapSave += paginator->step(textRenderer, 1, yieldOnInput, &buttons);
+
+  bool finished = !paginator->hasWork();
+  if (finished || paginator->getChaptersCompleted() != chaptersBefore ||
+      pagesSinceMapSave >= PAGINATION_SAVE_INTERVAL_PAGES) {
+    savePageMap();
+    pagesSinceMapSave = 0;
+  }
+  // A finished chapter can turn the percentage into a page number
+  if (finished || paginator->getChaptersCompleted() != chaptersBefore)
+    refreshStatusLine();
+  if (finished) {
+    Serial.printf("BackgroundPaginator: %s done, %d pages\n", currentFilePath.c_str(), pageMap.getTotalPageCount());
+    if (pageMap.isComplete())
+      paginator->end();
+  }
+}
+
+void TextViewerScreen::loadPageMap() {
+  if (!provider)
+    return;
+  uint32_t key = PageMap::computeKey(layoutConfig, readerFamily, layoutStrategy->getType());
+  int chapterCount = provider->getChapterCount();
+  if (currentFilePath.length() == 0) {
+    pageMap.reset(key, chapterCount);
+    return;
+  }
+  String mapPath = currentFilePath + String(".pages");
+  if (pageMap.load(mapPath.c_str(), key, chapterCount)) {
+    Serial.printf("PageMap: loaded %d pages for %s\n", pageMap.getTotalPageCount(), currentFilePath.c_str());
+  }
+}
+
+void TextViewerScreen::savePageMap() {
+  if (currentFilePath.length() == 0 || !provider || !pageMap.isDirty())
+    return;
+  String mapPath = currentFilePath + String(".pages");
+  if (!pageMap.save(mapPath.c_str())) {
+    Serial.printf("Failed to save page map for %s\n", currentFilePath.c_str());
+  }
+}
+
+int TextViewerScreen::getChapterStartIndex() {
+  int chapter = provider->getCurrentChapter();
+  if (chapterStartChapter != chapter) {
+    // Providers may skip leading bytes (e.g. a UTF-8 BOM) at position 0, so
+    // ask the provider where reading actually starts.
+    int saved = provider->getCurrentIndex();
+    provider->setPosition(0);
+    chapterStartIndex = provider->getCurrentIndex();
+    provider->setPosition(saved);
+    chapterStartChapter = chapter;
+  }
+  return chapterStartIndex;
+}
+
+void TextViewerScreen::recordCurrentPage() {
+  int chapter = provider->getCurrentChapter();
+  bool atChapterEnd = provider->getChapterPercentage(pageEndIndex) >= 1.0f;
+  pageMap.recordPage(chapter, getChapterStartIndex(), pageStartIndex, pageEndIndex, atChapterEnd);
+}
+
+String TextViewerScreen::buildPageIndicator() {
+  int chapter = provider->getCurrentChapter();
+  int pageIdx = pageMap.findPage(chapter, pageStartIndex);
+
+  // Build indicator string: "ChapterName - X/Y" when the page count is known,
+  // otherwise "ChapterName - Z%" (chapter name omitted if not available)
+  String indicator;
+  String chapterName = provider->getCurrentChapterName();
+  if (!chapterName.isEmpty()) {
+    indicator = chapterName + " - ";
+  }
+
+  if (pageIdx >= 0 && pageMap.isComplete()) {
+    int pageNumber = pageMap.getPagesBefore(chapter) + pageIdx + 1;
+    indicator += String(pageNumber) + "/" + String(pageMap.getTotalPageCount());
+    return indicator;
+  }
+
+  // Use book-wide percentage for display
+  // If at end of chapter and it's the last chapter, show 100%
+  float pagePercentage = provider->getPercentage();
+  if (provider->getChapterPercentage(pageEndIndex) >= 1.0f) {
+    // At end of current chapter - check if it's the last chapter
+    if (!provider->hasChapters() || provider->getCurrentChapter() >= provider->getChapterCount() - 1) {
+      pagePercentage = 1.0f;
+    }
+  }
+
+  // Exact position within the chapter once the chapter itself is paginated
+  if (pageIdx >= 0 && pageMap.isChapterComplete(chapter)) {
+    indicator += String(pageIdx + 1) + "/" + String(pageMap.getPageCount(chapter)) + " - ";
+  }
+  indicator += String((int)(pagePercentage * 100)) + "%";
+  return indicator;
+}
@@ -4,11 +4,16 @@
 #include "../../content/providers/StringWordProvider.h"
 #include "../../core/EInkDisplay.h"
 #include "../../core/SDCardManager.h"
+#include "../../rendering/PageImage.h"
 #include "../../rendering/TextRenderer.h"
+#include "../../text/layout/BackgroundPaginator.h"
 #include "../../text/layout/LayoutStrategy.h"
+#include "../../text/layout/PageMap.h"
 #include "../UIManager.h"
 #include "Screen.h"
 
+class FontPack;
+
 class TextViewerScreen : public Screen {
  public:
   TextViewerScreen(EInkDisplay& display, TextRenderer& renderer, SDCardManager& sdManager, UIManager& uiManager);
@@ -16,6 +21,8 @@ class TextViewerScreen : public Screen {
 
   void begin() override;
   void activate() override;
+  // Saves the position and closes the book (its caches use the framebuffers)
+  void deactivate() override;
 
   // Load content from SD by path and display it
   void openFile(const String& sdPath);
@@ -34,6 +41,9 @@ class TextViewerScreen : public Screen {
   void handleButtons(class Buttons& buttons) override;
   // Called when device is powering down; save document position
   void shutdown() override;
+  // While the reader is idle: the grayscale pass of the page on screen, the
+  // next page, and the rest of the book paginated in small slices
+  void idle(Buttons& buttons) override;
 
   int currentChapter = 0;
   int pageStartIndex = 0;
@@ -50,6 +60,8 @@ class TextViewerScreen : public Screen {
   // Keep the loaded text alive for the lifetime of the provider
   String loadedText;
   LayoutStrategy::LayoutConfig layoutConfig;
+  // Layout of the page on screen; reused so page turns don't allocate
+  LayoutStrategy::PageLayout pageLayout;
   // Path of the currently opened SD file (empty when viewing from memory)
   String currentFilePath;
   // Path loaded from settings but not yet opened. begin() will set this and
@@ -57,9 +69,114 @@ class TextViewerScreen : public Screen {
   // an init-only function and doesn't draw to the display.
   String pendingOpenPath;
 
+  // Page-start table for the open book, persisted next to the .pos file
+  PageMap pageMap;
+  // Cached start index of the current chapter (first valid provider index)
+  int chapterStartChapter = -1;
+  int chapterStartIndex = 0;
+  // Fills `pageMap` for the remaining chapters during idle time
+  BackgroundPaginator* paginator = nullptr;
+  unsigned long lastInputMs = 0;
+  int pagesSinceMapSave = 0;
+  // Status line text on screen
+  String shownIndicator;
+  // pageLayout and shownIndicator are the page on screen
+  bool pageOnScreen = false;
+
+  // Read cache of the open book, at the start of the display's spare buffer 0
+  static const size_t READ_CACHE_BYTES = 4096;
+  // BW bands of the page on screen (without its status line) and of the next
+  // page, rendered while idle, in the display's spare buffer 1. shownImage
+  // holds pageLayout's bands or none.
+  PageImage pageImages[2];
+  PageImage* shownImage = &pageImages[0];
+  PageImage* nextImage = &pageImages[1];
+  // Grayscale bands of the next page (grayIsNext) or of pageLayout, in the
+  // rest of spare buffer 0
+  PageImage grayImage;
+  bool grayIsNext = false;
+  // Bands sent while rendering go into shownImage and grayImage
+  bool recordBands = false;
+  // nextLayout (and the images, if the page fits) is the page at
+  // nextStartIndex of nextChapter
+  LayoutStrategy::PageLayout nextLayout;
+  bool nextReady = false;
+  int nextChapter = -1;
+  int nextStartIndex = -1;
+  uint32_t prefetchHits = 0;
+  uint32_t prefetchMisses = 0;
+
+  // Where the panel is with the page on screen: its bw frame refreshing, the
+  // grayscale pass waiting for that to finish, or the grayscale refreshing.
+  // The display reports finished refreshes to onRefreshDone() and idle()
+  // starts the grayscale pass, so the next page is prepared during both
+  // waveforms instead of after them.
+  enum PanelStage : uint8_t { PANEL_IDLE, BW_REFRESH, GRAY_DUE, GRAY_REFRESH };
+  PanelStage panelStage = PANEL_IDLE;
+
+  // Font packs (regular, bold, italic, bold italic) of the reader font family;
+  // users copy the .mfp files of the family and size they want here
+  static constexpr const char* FONT_PACK_DIR = "/microreader/fonts";
+  FontPack* fontPacks[4] = {nullptr, nullptr, nullptr, nullptr};
+  FontFamily packFamily = {nullptr, nullptr, nullptr, nullptr, nullptr, 0};
+  // Family used for the book: the font packs if a regular one loaded,
+  // otherwise the compiled-in Bookerly
+  FontFamily* readerFamily;
+
   // Persist/load current reading position for `currentFilePath`
   void savePositionToFile();
   void loadPositionFromFile();
+  // Create a provider for `sdPath` (EPUB or plain text); nullptr on failure.
+  // `cacheBuffer` (READ_CACHE_BYTES bytes) holds its read cache if given.
+  WordProvider* createProvider(const String& sdPath, uint8_t* cacheBuffer = nullptr);
+  // Persist/load the pagination map for `currentFilePath`
+  void savePageMap();
+  void loadPageMap();
+  // Record the page just laid out in the pagination map
+  void recordCurrentPage();
+  // First valid provider index of the current chapter
+  int getChapterStartIndex();
+  // Build the status line text (chapter name and page or percentage)
+  String buildPageIndicator();
+  // Draw the status line at the bottom of the page into the current band
+  void drawStatusLine();
+  // Show `msg` centered on an empty page
+  void showMessage(const char* msg);
+  // Render pageLayout and its status line band by band and send it to the
+  // display (see EInkDisplay::beginBands)
+  void sendPage(EInkDisplay::BandTarget target);
+  // LayoutStrategy::BandCallback adding the status line and sending a band
+  static void writePageBand(int16_t top, int16_t height, uint8_t* band, void* context);
+  // Put the page on screen back into RED RAM if grayscale overwrote it
+  void restoreShownPage();
+  // Enter banded mode and give the page images their memory
+  void beginBanded();
+  // Lay out and render the page after the one on screen into nextLayout and
+  // the images, unless that is done or it starts another chapter. Its
+  // grayscale planes wait until those of the page on screen are sent.
+  void prefetchNextPage();
+  // Forget the prefetched page
+  void cancelPrefetch();
+  // Band and strip callbacks storing the prefetched page in a PageImage
+  static void storeNextBand(int16_t top, int16_t height, uint8_t* band, void* context);
+  static void storeNextStrip(int16_t top, int16_t height, const uint8_t* lsb, const uint8_t* msb, void* context);
+  // Update only the status line of the page on screen if its text changed
+  // (e.g. once the page count is known)
+  void refreshStatusLine();
+  // Render the grayscale planes of the page on screen and show them
+  void showGrayscale();
+  // showGrayscale() now, or from idle() once the bw refresh is done
+  void startGrayscale();
+  // EInkDisplay::RefreshCallback advancing panelStage
+  static void onRefreshDone(void* context);
+  // LayoutStrategy::StripCallback streaming grayscale strips to the display
+  // (and into grayImage while recording)
+  static void writeGrayscaleStrip(int16_t top, int16_t height, const uint8_t* lsb, const uint8_t* msb,
+                                  void* context);
+  // Load the reader family's font packs from FONT_PACK_DIR, if there are any
+  void loadFontPacks();
+  // Print the font pack and synthetic glyph cache hit rates
+  void logFontCacheStats();
   // Persist/load viewer settings (last opened file path + layout config)
   void saveSettingsToFile();
   void loadSettingsFromFile();
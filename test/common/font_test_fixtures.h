@@ -0,0 +1,92 @@
+/**
+ * font_test_fixtures.h - Shared text, page placements and font copies for
+ * the glyph rendering tests
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/EInkDisplay.h"
+#include "rendering/SimpleFont.h"
+
+namespace FontTestFixtures {
+
+// German and English text with 2- and 3-byte UTF-8 characters
+inline const char* const LINES[] = {
+    "Die Donaudampfschifffahrtsgesellschaft fuhr",
+    "\xC3\xBC" "ber den Fluss, w\xC3\xA4hrend die Sonne langsam",
+    "hinter den H\xC3\xBCgeln verschwand. The quick brown",
+    "fox jumps over the lazy dog 0123456789 !?&%",
+    "Stra\xC3\x9F" "e, \xC3\x84pfel, \xC3\x96l und \xC3\x9C" "bermut \xE2\x80\x94 gr\xC3\xB6\xC3\x9F" "er.",
+};
+inline const int LINE_COUNT = sizeof(LINES) / sizeof(LINES[0]);
+
+struct Placement {
+  int16_t x;
+  int16_t y;
+};
+
+// A page of text, shifted down by `dy`, plus lines hanging over every edge
+inline std::vector<Placement> pagePlacements(int16_t dy = 0) {
+  std::vector<Placement> placements;
+  for (int16_t y = 40; y < 780; y += 34)
+    placements.push_back({static_cast<int16_t>(10 + (y % 7)), static_cast<int16_t>(y + dy)});
+  const Placement edges[] = {{-13, 300}, {-200, 330}, {300, 360}, {420, 400}, {5, 3},   {5, -10},
+                             {5, 799},   {40, 812},   {-7, 2},    {470, 805}, {0, 0},   {479, 799}};
+  for (const Placement& p : edges)
+    placements.push_back({p.x, static_cast<int16_t>(p.y + dy)});
+  return placements;
+}
+
+// Fill a framebuffer with pseudo-random content
+inline void fillPattern(uint8_t* buffer, uint32_t seed) {
+  for (uint32_t i = 0; i < EInkDisplay::BUFFER_SIZE; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    buffer[i] = static_cast<uint8_t>(seed >> 24);
+  }
+}
+
+// Column-major copy of a font (same layout as bitmap_utils.to_column_major)
+struct ColumnMajorFont {
+  std::vector<uint8_t> planes[3];  // BW, gray LSB, gray MSB
+  std::vector<SimpleGFXglyph> glyphs;
+  SimpleGFXfont font;
+
+  explicit ColumnMajorFont(const SimpleGFXfont* source) {
+    const uint8_t* sourcePlanes[3] = {source->bitmap, source->bitmap_gray_lsb, source->bitmap_gray_msb};
+    glyphs.assign(source->glyph, source->glyph + source->glyphCount);
+    for (SimpleGFXglyph& glyph : glyphs) {
+      uint16_t offset = static_cast<uint16_t>(planes[0].size());
+      for (int p = 0; p < 3; p++) {
+        if (sourcePlanes[p])
+          repack(sourcePlanes[p], glyph, planes[p]);
+      }
+      glyph.bitmapOffset = offset;
+    }
+    font = *source;
+    font.bitmap = planes[0].data();
+    font.bitmap_gray_lsb = source->bitmap_gray_lsb ? planes[1].data() : nullptr;
+    font.bitmap_gray_msb = source->bitmap_gray_msb ? planes[2].data() : nullptr;
+    font.glyph = glyphs.data();
+    font.flags = FONT_FLAG_COLUMN_MAJOR;
+  }
+
+  static void repack(const uint8_t* plane, const SimpleGFXglyph& glyph, std::vector<uint8_t>& out) {
+    const uint8_t rowStride = (glyph.width + 7) / 8;
+    const uint8_t* bits = plane + glyph.bitmapOffset;
+    for (uint8_t x = 0; x < glyph.width; x++) {
+      for (uint8_t y0 = 0; y0 < glyph.height; y0 += 8) {
+        uint8_t value = 0;
+        for (uint8_t i = 0; i < 8 && y0 + i < glyph.height; i++) {
+          uint8_t bit = (bits[(y0 + i) * rowStride + x / 8] >> (7 - x % 8)) & 1;
+          value |= bit << (7 - i);
+        }
+        out.push_back(value);
+      }
+    }
+  }
+};
+
+}  // namespace FontTestFixtures
@@ -10,10 +10,11 @@ using std::min;
 #include <fstream>
 #include <string>
 
+#include <ctime>
+
+#include <sys/stat.h>
 #ifdef _WIN32
 #include <direct.h>
-#else
-#include <sys/stat.h>
 #endif
 
 // File open modes
@@ -76,6 +77,11 @@ struct MockFile {
   size_t print(const String& str) {
     return print(str.c_str());
   }
+  // Modification time of the file on disk (0 if unknown)
+  time_t getLastWrite() const {
+    struct stat st;
+    return !filepath.empty() && stat(filepath.c_str(), &st) == 0 ? st.st_mtime : 0;
+  }
   bool isDirectory() const { return false; }
   MockFile openNextFile() const { return MockFile(); }
   const char* name() const { return filepath.c_str(); }
@@ -0,0 +1,325 @@
+#include "SSD1677Simulator.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+uint32_t countBits(uint8_t value) {
+  uint32_t bits = 0;
+  for (; value; value &= value - 1)
+    bits++;
+  return bits;
+}
+
+// Update control 2 bits (see EInkDisplay::refreshDisplay)
+const uint8_t CTRL2_TEMP_LOAD = 0x20;
+const uint8_t CTRL2_LUT_LOAD = 0x10;
+const uint8_t CTRL2_MODE_2 = 0x08;
+const uint8_t CTRL2_DISPLAY = 0x04;
+// Update control 1: RED RAM read as 0
+const uint8_t CTRL1_BYPASS_RED = 0x40;
+
+}  // namespace
+
+SSD1677Simulator::SSD1677Simulator(int cs, int dc, int rst, int busy)
+    : SSD1677Simulator(cs, dc, rst, busy, Timing()) {}
+
+SSD1677Simulator::SSD1677Simulator(int cs, int dc, int rst, int busy, const Timing& timing)
+    : csPin(cs),
+      dcPin(dc),
+      rstPin(rst),
+      busyPin(busy),
+      timing(timing),
+      bw(RAM_BYTES, 0xFF),
+      red(RAM_BYTES, 0xFF),
+      panel(RAM_BYTES, 0xFF) {}
+
+SSD1677Simulator::~SSD1677Simulator() {
+  detach();
+}
+
+void SSD1677Simulator::attach() {
+  busListener = this;
+}
+
+void SSD1677Simulator::detach() {
+  if (busListener == this)
+    busListener = nullptr;
+}
+
+uint32_t SSD1677Simulator::countPanelDifferences(const uint8_t* frame) const {
+  uint32_t pixels = 0;
+  for (uint32_t i = 0; i < RAM_BYTES; i++)
+    pixels += countBits(frame[i] ^ panel[i]);
+  return pixels;
+}
+
+void SSD1677Simulator::finishRefresh() {
+  if (nowNs < busyUntilNs)
+    nowNs = busyUntilNs;
+}
+
+uint64_t SSD1677Simulator::getWaveformNs() const {
+  uint64_t ns = 0;
+  for (const Refresh& refresh : refreshes)
+    ns += refresh.durationNs;
+  return ns;
+}
+
+void SSD1677Simulator::resetStats() {
+  refreshes.clear();
+  spiNs = 0;
+  transactions = 0;
+  memset(commandCounts, 0, sizeof(commandCounts));
+  memset(dataBytes, 0, sizeof(dataBytes));
+  ignoredBusy = 0;
+  ignoredAsleep = 0;
+}
+
+void SSD1677Simulator::transactionBegan() {
+  transactions++;
+  spiNs += timing.transactionNs;
+  nowNs += timing.transactionNs;
+}
+
+void SSD1677Simulator::bytesWritten(const uint8_t* data, size_t length) {
+  const uint64_t ns = static_cast<uint64_t>(std::llround(length * 8e9 / timing.spiHz));
+  const bool busy = isBusy();
+  spiNs += ns;
+  nowNs += ns;
+  if (!selected)
+    return;
+  if (asleep) {
+    ignoredAsleep += length;
+    return;
+  }
+  if (busy) {
+    ignoredBusy += length;
+    return;
+  }
+  for (size_t i = 0; i < length; i++) {
+    if (dataMode) {
+      acceptData(data[i]);
+    } else {
+      startCommand(data[i]);
+    }
+  }
+}
+
+void SSD1677Simulator::pinWritten(int pin, int level) {
+  if (pin < 0)
+    return;
+  if (pin == csPin) {
+    selected = level == LOW;
+  } else if (pin == dcPin) {
+    dataMode = level == HIGH;
+  } else if (pin == rstPin && level == LOW) {
+    // Hardware reset: wakes the controller, registers back to defaults
+    asleep = false;
+    entryMode = 0x03;
+    customLut = false;
+  }
+}
+
+int SSD1677Simulator::pinRead(int pin) {
+  if (pin >= 0 && pin == busyPin)
+    return isBusy() ? HIGH : LOW;
+  return -1;
+}
+
+void SSD1677Simulator::delayed(unsigned long ms) {
+  nowNs += static_cast<uint64_t>(ms) * 1000000;
+}
+
+void SSD1677Simulator::startCommand(uint8_t value) {
+  commandCounts[value]++;
+  command = value;
+  paramIndex = 0;
+  switch (value) {
+    case 0x12:  // Soft reset
+      entryMode = 0x03;
+      xStart = 0;
+      xEnd = WIDTH - 1;
+      yStart = 0;
+      yEnd = HEIGHT - 1;
+      xCounter = 0;
+      yCounter = 0;
+      customLut = false;
+      setBusy(static_cast<uint64_t>(timing.resetMs) * 1000000);
+      break;
+    case 0x20:  // Master activation
+      activate();
+      break;
+    default:
+      break;
+  }
+}
+
+void SSD1677Simulator::acceptData(uint8_t value) {
+  dataBytes[command]++;
+  const uint32_t index = paramIndex++;
+  if (index < sizeof(params))
+    params[index] = value;
+
+  switch (command) {
+    case 0x24:
+      writeRam(bw, value);
+      break;
+    case 0x26:
+      writeRam(red, value);
+      break;
+    case 0x11:
+      entryMode = value;
+      break;
+    case 0x44:
+      if (index == 3) {
+        xStart = params[0] | params[1] << 8;
+        xEnd = params[2] | params[3] << 8;
+      }
+      break;
+    case 0x45:
+      if (index == 3) {
+        yStart = params[0] | params[1] << 8;
+        yEnd = params[2] | params[3] << 8;
+      }
+      break;
+    case 0x4E:
+      if (index == 1)
+        xCounter = params[0] | params[1] << 8;
+      break;
+    case 0x4F:
+      if (index == 1)
+        yCounter = params[0] | params[1] << 8;
+      break;
+    case 0x21:
+      if (index == 0)
+        updateCtrl1 = value;
+      break;
+    case 0x22:
+      updateCtrl2 = value;
+      break;
+    case 0x32:
+      if (index < sizeof(lut))
+        lut[index] = value;
+      if (index + 1 == sizeof(lut))
+        customLut = true;
+      break;
+    case 0x46:  // Auto write: only the start level of the pattern
+      memset(bw.data(), value & 0x80 ? 0xFF : 0x00, RAM_BYTES);
+      break;
+    case 0x47:
+      memset(red.data(), value & 0x80 ? 0xFF : 0x00, RAM_BYTES);
+      break;
+    case 0x10:
+      if (value & 0x03)
+        asleep = true;
+      break;
+    default:
+      break;
+  }
+}
+
+void SSD1677Simulator::writeRam(std::vector<uint8_t>& ram, uint8_t value) {
+  if (xCounter < WIDTH && yCounter < HEIGHT)
+    ram[yCounter * ROW_BYTES + xCounter / 8] = value;
+  stepCounters();
+}
+
+void SSD1677Simulator::stepCounters() {
+  // Step one counter within its range; true when it wraps around
+  auto stepX = [this]() {
+    const int lo = xStart < xEnd ? xStart : xEnd;
+    const int hi = xStart < xEnd ? xEnd : xStart;
+    int x = xCounter + ((entryMode & 0x01) ? 8 : -8);
+    const bool wrapped = x < lo || x > hi;
+    if (wrapped)
+      x = (entryMode & 0x01) ? lo : hi & ~7;
+    xCounter = static_cast<uint16_t>(x);
+    return wrapped;
+  };
+  auto stepY = [this]() {
+    const int lo = yStart < yEnd ? yStart : yEnd;
+    const int hi = yStart < yEnd ? yEnd : yStart;
+    int y = yCounter + ((entryMode & 0x02) ? 1 : -1);
+    const bool wrapped = y < lo || y > hi;
+    if (wrapped)
+      y = (entryMode & 0x02) ? lo : hi;
+    yCounter = static_cast<uint16_t>(y);
+    return wrapped;
+  };
+
+  // AM = 0: along X, then to the next row
+  if (entryMode & 0x04) {
+    if (stepY())
+      stepX();
+  } else {
+    if (stepX())
+      stepY();
+  }
+}
+
+void SSD1677Simulator::activate() {
+  const uint8_t mode = updateCtrl2;
+  if (!(mode & CTRL2_DISPLAY))
+    return;
+
+  Refresh refresh = {};
+  refresh.startNs = nowNs;
+  if (customLut && !(mode & CTRL2_LUT_LOAD)) {
+    refresh.kind = CUSTOM_LUT;
+  } else if (mode & CTRL2_MODE_2) {
+    refresh.kind = FAST;
+  } else if (mode & CTRL2_TEMP_LOAD) {
+    refresh.kind = FULL;
+  } else {
+    // The driver writes a high temperature instead: the shorter waveform
+    refresh.kind = HALF;
+  }
+  if (mode & CTRL2_LUT_LOAD)
+    customLut = false;
+
+  switch (refresh.kind) {
+    case FULL:
+      refresh.durationNs = static_cast<uint64_t>(timing.fullMs) * 1000000;
+      break;
+    case HALF:
+      refresh.durationNs = static_cast<uint64_t>(timing.halfMs) * 1000000;
+      break;
+    case FAST:
+      refresh.durationNs = static_cast<uint64_t>(timing.fastMs) * 1000000;
+      break;
+    case CUSTOM_LUT:
+      refresh.durationNs = lutDurationNs();
+      break;
+  }
+
+  if (refresh.kind != CUSTOM_LUT) {
+    // A fast update only drives pixels whose BW and RED RAM bits differ
+    const bool bypassRed = updateCtrl1 & CTRL1_BYPASS_RED;
+    for (uint32_t i = 0; i < RAM_BYTES; i++) {
+      uint8_t drive;
+      if (refresh.kind == FAST) {
+        drive = bw[i] ^ (bypassRed ? 0x00 : red[i]);
+      } else {
+        drive = bw[i] ^ panel[i];
+      }
+      refresh.drivenPixels += countBits(drive);
+      panel[i] = (panel[i] & ~drive) | (bw[i] & drive);
+      refresh.ghostPixels += countBits(panel[i] ^ bw[i]);
+    }
+  }
+
+  refreshes.push_back(refresh);
+  setBusy(refresh.durationNs);
+}
+
+uint64_t SSD1677Simulator::lutDurationNs() const {
+  // Ten groups after the 50 voltage bytes: four phase lengths and a repeat
+  uint32_t frames = 0;
+  for (int group = 0; group < 10; group++) {
+    const uint8_t* tp = &lut[50 + group * 5];
+    frames += (tp[0] + tp[1] + tp[2] + tp[3]) * (tp[4] + 1);
+  }
+  return static_cast<uint64_t>(frames) * timing.lutFrameMs * 1000000;
+}
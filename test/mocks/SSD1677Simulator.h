@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "platform_stubs.h"
+
+/**
+ * SSD1677Simulator - The e-ink controller behind the SPI and GPIO mocks.
+ *
+ * Attached, it sees every byte EInkDisplay sends and decodes the command
+ * stream like the controller: data entry mode, RAM windows and counters
+ * (0x11, 0x44/0x45, 0x4E/0x4F), BW and RED RAM writes (0x24/0x26, auto
+ * writes 0x46/0x47), update control and activation (0x21, 0x22, 0x20),
+ * custom LUT loads (0x32) and deep sleep (0x10, left by a reset on RST).
+ * It keeps both RAMs and a model of the panel:
+ * - A full or half refresh drives every pixel to BW RAM
+ * - A fast refresh drives only pixels where BW RAM differs from RED RAM (0
+ *   when update control 1 bypasses it), so a RED RAM that does not hold the
+ *   frame on the panel leaves ghost pixels
+ * - A refresh with a custom LUT (grayscale and its revert) is recorded but
+ *   leaves the bw panel model alone
+ *
+ * Time is simulated: each SPI byte and transaction costs bus time, a refresh
+ * keeps BUSY high for the waveform of its mode (custom LUTs: their frame
+ * count), and delay() advances the clock, so a waitWhileBusy() loop ends
+ * after the waveform without waiting for it. Bytes sent while BUSY is high
+ * or the controller sleeps are ignored and counted.
+ *
+ * RAM and panel are ROW_BYTES per RAM row (Y), 8 pixels per byte along X,
+ * 1 = white, in controller coordinates (EInkDisplay sends rows bottom up).
+ */
+class SSD1677Simulator : public BusListener {
+ public:
+  static const uint16_t WIDTH = 800;  // RAM X, pixels
+  static const uint16_t HEIGHT = 480;  // RAM Y
+  static const uint16_t ROW_BYTES = WIDTH / 8;
+  static const uint32_t RAM_BYTES = static_cast<uint32_t>(ROW_BYTES) * HEIGHT;
+
+  // Costs of the bus and waveform times of the panel
+  struct Timing {
+    double spiHz = 40e6;
+    uint32_t transactionNs = 5000;  // driver and SPI setup per transaction
+    uint32_t resetMs = 10;
+    uint32_t fullMs = 2000;
+    uint32_t halfMs = 1720;
+    uint32_t fastMs = 400;
+    uint32_t lutFrameMs = 20;  // per frame of a custom LUT
+  };
+
+  enum RefreshKind : uint8_t { FULL, HALF, FAST, CUSTOM_LUT };
+  struct Refresh {
+    RefreshKind kind;
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint32_t drivenPixels;  // pixels the waveform drives (0 for custom LUTs)
+    uint32_t ghostPixels;   // panel pixels left unlike BW RAM afterwards
+  };
+
+  SSD1677Simulator(int cs, int dc, int rst, int busy);
+  SSD1677Simulator(int cs, int dc, int rst, int busy, const Timing& timing);
+  ~SSD1677Simulator();
+
+  // Become (or stop being) the device behind the mocks
+  void attach();
+  void detach();
+
+  const uint8_t* getBwRam() const {
+    return bw.data();
+  }
+  const uint8_t* getRedRam() const {
+    return red.data();
+  }
+  const uint8_t* getPanel() const {
+    return panel.data();
+  }
+  // Pixels of `frame` (RAM layout) unlike the panel
+  uint32_t countPanelDifferences(const uint8_t* frame) const;
+
+  uint64_t getNowNs() const {
+    return nowNs;
+  }
+  bool isBusy() const {
+    return nowNs < busyUntilNs;
+  }
+  // Let simulated time pass
+  void advance(uint64_t ns) {
+    nowNs += ns;
+  }
+  // Until BUSY drops
+  void finishRefresh();
+
+  const std::vector<Refresh>& getRefreshes() const {
+    return refreshes;
+  }
+  // Time spent on the bus and with BUSY high
+  uint64_t getSpiNs() const {
+    return spiNs;
+  }
+  uint64_t getWaveformNs() const;
+  uint32_t getTransactions() const {
+    return transactions;
+  }
+  // Bytes accepted after command `command` (its parameters or RAM data)
+  uint32_t getDataBytes(uint8_t command) const {
+    return dataBytes[command];
+  }
+  uint32_t getCommandCount(uint8_t command) const {
+    return commandCounts[command];
+  }
+  uint32_t getBytesIgnoredBusy() const {
+    return ignoredBusy;
+  }
+  uint32_t getBytesIgnoredAsleep() const {
+    return ignoredAsleep;
+  }
+  bool isAsleep() const {
+    return asleep;
+  }
+  // Drop recorded refreshes and counters (RAM, panel and clock stay)
+  void resetStats();
+
+  // BusListener
+  void transactionBegan() override;
+  void bytesWritten(const uint8_t* data, size_t length) override;
+  void pinWritten(int pin, int level) override;
+  int pinRead(int pin) override;
+  void delayed(unsigned long ms) override;
+
+ private:
+  int csPin, dcPin, rstPin, busyPin;
+  Timing timing;
+
+  std::vector<uint8_t> bw;
+  std::vector<uint8_t> red;
+  std::vector<uint8_t> panel;
+
+  // Interface lines and the command being received
+  bool selected = false;
+  bool dataMode = true;
+  bool asleep = false;
+  uint8_t command = 0;
+  uint32_t paramIndex = 0;
+  uint8_t params[8] = {};
+
+  // RAM addressing: ranges and counters (X in pixels), data entry mode
+  uint8_t entryMode = 0x03;
+  uint16_t xStart = 0, xEnd = WIDTH - 1, yStart = 0, yEnd = HEIGHT - 1;
+  uint16_t xCounter = 0, yCounter = 0;
+
+  // Update settings
+  uint8_t updateCtrl1 = 0;
+  uint8_t updateCtrl2 = 0;
+  uint8_t lut[105] = {};
+  bool customLut = false;
+
+  uint64_t nowNs = 0;
+  uint64_t busyUntilNs = 0;
+  uint64_t spiNs = 0;
+  uint32_t transactions = 0;
+  uint32_t commandCounts[256] = {};
+  uint32_t dataBytes[256] = {};
+  uint32_t ignoredBusy = 0;
+  uint32_t ignoredAsleep = 0;
+  std::vector<Refresh> refreshes;
+
+  void startCommand(uint8_t value);
+  void acceptData(uint8_t value);
+  void writeRam(std::vector<uint8_t>& ram, uint8_t value);
+  void stepCounters();
+  void activate();
+  uint64_t lutDurationNs() const;
+  void setBusy(uint64_t ns) {
+    busyUntilNs = nowNs + ns;
+  }
+};
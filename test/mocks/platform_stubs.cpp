@@ -64,6 +64,12 @@ void MockSerial::print(const String& s) {
 // Provide a concrete SPI object for host tests
 MockSPI SPI;
 
+// No simulated devices unless a test attaches one
+BusListener* busListener = nullptr;
+
+// Provide GPIO input levels
+MockGPIO GPIO;
+
 // Provide ESP mock object
 MockESP ESP;
 
@@ -4,6 +4,7 @@
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
+#include <vector>
 
 // PROGMEM / pgm_read helpers for host builds
 #ifndef PROGMEM
@@ -19,18 +20,54 @@ struct SPISettings {
   SPISettings(uint32_t, int, int) {}
 };
 
-// Minimal SPI mock
+// Sees what the driver does on the SPI bus and GPIO lines, e.g. a simulated
+// controller (see SSD1677Simulator.h); none by default
+struct BusListener {
+  virtual ~BusListener() = default;
+  virtual void transactionBegan() = 0;
+  virtual void bytesWritten(const uint8_t* data, size_t length) = 0;
+  virtual void pinWritten(int pin, int level) = 0;
+  // Level of an input pin, or -1 to leave it to the GPIO mock
+  virtual int pinRead(int pin) = 0;
+  virtual void delayed(unsigned long ms) = 0;
+};
+
+extern BusListener* busListener;
+
+// Minimal SPI mock (counts the bytes sent and records the size of each
+// writeBytes() block, and the bytes of each transaction between
+// beginTransaction() and endTransaction())
 struct MockSPI {
+  size_t bytesSent = 0;
+  std::vector<size_t> writeSizes;
+  std::vector<size_t> transactionSizes;
+  size_t transactionStart = 0;
+
   void begin(int sclk = -1, int miso = -1, int mosi = -1, int ssel = -1) {
     (void)sclk;
     (void)miso;
     (void)mosi;
     (void)ssel;
   }
-  void beginTransaction(const SPISettings&) {}
-  void endTransaction() {}
-  void transfer(uint8_t) {}
-  void writeBytes(const uint8_t* data, size_t length) {}
+  void beginTransaction(const SPISettings&) {
+    transactionStart = bytesSent;
+    if (busListener)
+      busListener->transactionBegan();
+  }
+  void endTransaction() {
+    transactionSizes.push_back(bytesSent - transactionStart);
+  }
+  void transfer(uint8_t data) {
+    bytesSent++;
+    if (busListener)
+      busListener->bytesWritten(&data, 1);
+  }
+  void writeBytes(const uint8_t* data, size_t length) {
+    bytesSent += length;
+    writeSizes.push_back(length);
+    if (busListener)
+      busListener->bytesWritten(data, length);
+  }
 };
 
 extern MockSPI SPI;
@@ -46,14 +83,6 @@ extern MockSPI SPI;
 // Forward-declare Arduino-like String used by test WString.h
 class String;
 
-// Arduino GPIO and timing stubs (inline so header-only callers work)
-inline void pinMode(int, int) {}
-inline void digitalWrite(int, int) {}
-inline int digitalRead(int) {
-  return 0;
-}
-inline void delay(unsigned long) {}
-
 // Arduino constants
 #ifndef OUTPUT
 #define OUTPUT 1
@@ -68,6 +97,39 @@ inline void delay(unsigned long) {}
 #define LOW 0
 #endif
 
+// Input levels for host tests: pins read LOW, except that a pin reads HIGH
+// for its next highReads[pin] reads (e.g. the display's BUSY line while the
+// panel refreshes)
+struct MockGPIO {
+  static const int PIN_COUNT = 64;
+  int highReads[PIN_COUNT] = {};
+};
+
+extern MockGPIO GPIO;
+
+// Arduino GPIO and timing stubs (inline so header-only callers work)
+inline void pinMode(int, int) {}
+inline void digitalWrite(int pin, int level) {
+  if (busListener)
+    busListener->pinWritten(pin, level);
+}
+inline int digitalRead(int pin) {
+  if (pin >= 0 && pin < MockGPIO::PIN_COUNT && GPIO.highReads[pin] > 0) {
+    GPIO.highReads[pin]--;
+    return HIGH;
+  }
+  if (busListener) {
+    int level = busListener->pinRead(pin);
+    if (level >= 0)
+      return level;
+  }
+  return LOW;
+}
+inline void delay(unsigned long ms) {
+  if (busListener)
+    busListener->delayed(ms);
+}
+
 // Minimal Print class and Serial mock declaration
 class Print {
  public:
@@ -0,0 +1,134 @@
+/**
+ * AsyncRefreshTest.cpp - Display refreshes that return while the panel updates
+ *
+ * Drives the display's BUSY line through the GPIO mock and checks that:
+ * - Without asynchronous refreshes nothing changes: the refresh is over when
+ *   displayBuffer() returns and no callback is called
+ * - An asynchronous refresh returns at once; pollRefresh() reports it as
+ *   running while BUSY is high and calls the callback exactly once after
+ * - The caller can lay out a page meanwhile without touching the controller
+ * - A display call during a refresh waits for it first, and the callback
+ *   then reports the panel idle once for both refreshes
+ * - Banded frames, grayscale and deep sleep go through the same path
+ */
+
+#include <string>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+
+namespace {
+
+const int BUSY_PIN = 5;
+
+int callbacks = 0;
+
+void countRefresh(void* context) {
+  (*static_cast<int*>(context))++;
+}
+
+// Polls until the refresh is reported done; returns the polls that saw it
+// running
+int pollsWhileRunning(EInkDisplay& display) {
+  int polls = 0;
+  while (!display.pollRefresh() && polls < 1000)
+    polls++;
+  return polls;
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Async Refresh Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, BUSY_PIN);
+  display.begin();
+  display.setRefreshCallback(countRefresh, &callbacks);
+
+  // Synchronous (default): displayBuffer() waits for BUSY to drop
+  GPIO.highReads[BUSY_PIN] = 5;
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(GPIO.highReads[BUSY_PIN] == 0 && !display.isRefreshing(), "synchronous refresh waits");
+  runner.expectTrue(display.pollRefresh() && callbacks == 0, "synchronous refresh is not reported");
+
+  // Asynchronous: back at once, reported when BUSY drops
+  display.setAsyncRefresh(true);
+  display.clearScreen(0xFF);
+  GPIO.highReads[BUSY_PIN] = 3;
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(display.isRefreshing() && GPIO.highReads[BUSY_PIN] == 3, "asynchronous refresh returns at once");
+
+  // Work that does not need the controller goes on meanwhile
+  TextRenderer renderer(display);
+  KnuthPlassLayoutStrategy layout;
+  LayoutStrategy::LayoutConfig config;
+  config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+  config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+  config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+  config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+  config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+  config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+  config.pageWidth = TestConfig::DISPLAY_WIDTH;
+  config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+  config.alignment = LayoutStrategy::ALIGN_LEFT;
+  renderer.setFontFamily(&bookerlyFamily);
+  StringWordProvider provider(String("The next page is laid out while the panel is still busy with this one."));
+  LayoutStrategy::PageLayout page;
+  const size_t sentBefore = SPI.bytesSent;
+  layout.layoutText(provider, renderer, config, page);
+  runner.expectTrue(page.getLineCount() > 0 && SPI.bytesSent == sentBefore && display.isRefreshing(),
+                    "page laid out during the refresh");
+
+  runner.expectTrue(pollsWhileRunning(display) == 3, "polls see the refresh running while BUSY is high");
+  runner.expectTrue(callbacks == 1 && !display.isRefreshing(), "callback called once the panel is idle");
+  runner.expectTrue(display.pollRefresh() && callbacks == 1, "callback is not repeated");
+
+  // A display call during a refresh waits for it first; the panel going idle
+  // after both is reported once
+  GPIO.highReads[BUSY_PIN] = 50;
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(GPIO.highReads[BUSY_PIN] == 0 && display.isRefreshing(),
+                    "second refresh waited for the first");
+  GPIO.highReads[BUSY_PIN] = 2;
+  runner.expectTrue(pollsWhileRunning(display) == 2 && callbacks == 2, "one report for both refreshes",
+                    std::to_string(callbacks) + " callbacks");
+
+  // Banded frames and the grayscale pass of a page turn
+  display.beginBanded();
+  uint8_t* band = display.getBandBuffer();
+  for (uint32_t i = 0; i < EInkDisplay::BAND_BYTES; i++)
+    band[i] = 0xFF;
+  display.beginBands(EInkDisplay::NEXT_FRAME);
+  for (int16_t top = 0; top < EInkDisplay::DISPLAY_WIDTH; top += EInkDisplay::BAND_ROWS)
+    display.writeBand(top, EInkDisplay::BAND_ROWS, band);
+  GPIO.highReads[BUSY_PIN] = 4;
+  display.endBands();
+  runner.expectTrue(display.isRefreshing(), "banded frame refreshes asynchronously");
+  runner.expectTrue(pollsWhileRunning(display) == 4 && callbacks == 3, "banded refresh reported");
+
+  for (int16_t top = 0; top < EInkDisplay::DISPLAY_WIDTH; top += EInkDisplay::BAND_ROWS)
+    display.writeGrayscaleStrip(top, EInkDisplay::BAND_ROWS, band, band);
+  GPIO.highReads[BUSY_PIN] = 4;
+  display.displayGrayBuffer();
+  runner.expectTrue(display.isRefreshing(), "grayscale refreshes asynchronously");
+  runner.expectTrue(pollsWhileRunning(display) == 4 && callbacks == 4, "grayscale refresh reported");
+  display.endBanded();
+
+  // Deep sleep waits for the panel
+  GPIO.highReads[BUSY_PIN] = 10;
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  display.deepSleep();
+  runner.expectTrue(GPIO.highReads[BUSY_PIN] == 0 && !display.isRefreshing(), "deep sleep waits for the refresh");
+  runner.expectTrue(display.pollRefresh() && callbacks == 5, "refresh before sleep still reported");
+
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+/**
+ * BandedRenderTest.cpp - Pages drawn band by band without framebuffers
+ *
+ * Renders reader pages with LayoutStrategy::renderPageBands() and streams the
+ * bands to EInkDisplay in banded mode:
+ * - The bands put together are the frame renderPage() draws, for several band
+ *   heights
+ * - In banded mode the framebuffers are lent out and displayBuffer() sends
+ *   nothing
+ * - A fast refresh sends only the BW RAM while RED RAM holds the frame on the
+ *   panel, and becomes a half refresh when it does not
+ * - Putting the shown frame back into RED RAM costs one plane
+ * - After endBanded() the first fast refresh still needs only the BW RAM
+ * - Prints RAM use and SPI bytes and time (at 40 MHz) next to full-frame mode
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+
+namespace {
+
+const uint32_t PLANE = EInkDisplay::BUFFER_SIZE;
+const double SPI_HZ = 40e6;
+
+std::string buildText() {
+  const char* words[] = {"Die",    "Donaudampfschifffahrtsgesellschaft", "fuhr",   "über",  "den",
+                         "Fluss,", "während",                            "die",    "Sonne", "langsam",
+                         "hinter", "den",                                "Hügeln", "verschwand."};
+  const int wordCount = sizeof(words) / sizeof(words[0]);
+  std::string text;
+  for (int p = 0; p < 30; ++p) {
+    int n = 20 + (p * 13) % 50;
+    for (int w = 0; w < n; ++w) {
+      text += words[(p + w * 7) % wordCount];
+      if (w + 1 < n)
+        text += ' ';
+    }
+    text += "\n";
+  }
+  return text;
+}
+
+// Puts bands back together into a framebuffer and counts them
+struct Assembler {
+  std::vector<uint8_t> frame = std::vector<uint8_t>(EInkDisplay::BUFFER_SIZE, 0x00);
+  int bands = 0;
+  bool ordered = true;
+  int16_t nextTop = 0;
+};
+
+void assembleBand(int16_t top, int16_t height, uint8_t* band, void* context) {
+  Assembler* out = static_cast<Assembler*>(context);
+  const int bytes = height / 8;
+  for (int row = 0; row < EInkDisplay::DISPLAY_HEIGHT; ++row) {
+    memcpy(&out->frame[row * EInkDisplay::DISPLAY_WIDTH_BYTES + top / 8], band + row * bytes, bytes);
+  }
+  out->ordered = out->ordered && top == out->nextTop;
+  out->nextTop = top + height;
+  out->bands++;
+}
+
+void sendBand(int16_t top, int16_t height, uint8_t* band, void* context) {
+  static_cast<EInkDisplay*>(context)->writeBand(top, height, band);
+}
+
+double spiMs(uint32_t bytes) {
+  return bytes * 8 / SPI_HZ * 1000.0;
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Banded Render Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  KnuthPlassLayoutStrategy layout;
+  LayoutStrategy::LayoutConfig config;
+  config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+  config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+  config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+  config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+  config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+  config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+  config.pageWidth = TestConfig::DISPLAY_WIDTH;
+  config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+  config.alignment = LayoutStrategy::ALIGN_LEFT;
+  config.language = Language::GERMAN;
+  layout.setLanguage(config.language);
+
+  std::string text = buildText();
+  StringWordProvider provider(String(text.c_str()));
+  renderer.setFontFamily(&bookerlyFamily);
+  LayoutStrategy::PageLayout pages[2];
+  layout.layoutText(provider, renderer, config, pages[0]);
+  provider.setPosition(pages[0].endPosition);
+  layout.layoutText(provider, renderer, config, pages[1]);
+  runner.expectTrue(pages[0].getLineCount() > 10 && pages[1].getLineCount() > 10, "two full pages");
+
+  // Reference: the whole page drawn into the framebuffer
+  display.clearScreen(0xFF);
+  renderer.setFrameBuffer(display.getFrameBuffer());
+  renderer.setBitmapType(TextRenderer::BITMAP_BW);
+  renderer.setTextColor(TextRenderer::COLOR_BLACK);
+  renderer.setFontStyle(FontStyle::REGULAR);
+  layout.renderPage(pages[0], renderer, config);
+  std::vector<uint8_t> reference(display.getFrameBuffer(), display.getFrameBuffer() + PLANE);
+
+  // Band heights that divide the page, and one that leaves a short last band
+  const int16_t heights[] = {EInkDisplay::BAND_ROWS, 16, 200, 96};
+  for (int16_t height : heights) {
+    std::vector<uint8_t> band(static_cast<size_t>(height / 8) * EInkDisplay::DISPLAY_HEIGHT);
+    Assembler out;
+    renderer.setFontStyle(FontStyle::REGULAR);
+    layout.renderPageBands(pages[0], renderer, config, band.data(), height, assembleBand, &out);
+    const int expected = (EInkDisplay::DISPLAY_WIDTH + height - 1) / height;
+    runner.expectTrue(out.frame == reference, "bands of " + std::to_string(height) + " rows match renderPage");
+    runner.expectTrue(out.bands == expected && out.ordered && out.nextTop == EInkDisplay::DISPLAY_WIDTH,
+                      "bands of " + std::to_string(height) + " rows cover the page top to bottom",
+                      std::to_string(out.bands) + " bands");
+  }
+
+  // Full-frame mode: show the page once (screen off: half refresh)
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(display.holdsShownFrame(), "after a half refresh RED RAM holds the frame");
+  uint32_t fullFrameTurn = 0;
+  display.clearScreen(0xFF);
+  renderer.setFrameBuffer(display.getFrameBuffer());
+  layout.renderPage(pages[1], renderer, config);
+  display.clearDirty();
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  fullFrameTurn = display.getLastUploadBytes();
+
+  // Banded mode lends out the framebuffers
+  runner.expectTrue(display.getSpareBuffer(0) == nullptr, "no spare buffers in full-frame mode");
+  display.beginBanded();
+  runner.expectTrue(display.isBanded() && display.getFrameBuffer() == nullptr, "no framebuffer in banded mode");
+  uint8_t* spare0 = display.getSpareBuffer(0);
+  uint8_t* spare1 = display.getSpareBuffer(1);
+  runner.expectTrue(spare0 && spare1 && spare0 != spare1, "two spare buffers in banded mode");
+  memset(spare0, 0xA5, PLANE);
+  memset(spare1, 0x5A, PLANE);
+
+  size_t sentBefore = SPI.bytesSent;
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(SPI.bytesSent == sentBefore, "displayBuffer sends nothing in banded mode");
+
+  // beginBanded() put the frame on the panel into RED RAM: BW only
+  uint8_t* band = display.getBandBuffer();
+  display.beginBands(EInkDisplay::NEXT_FRAME);
+  renderer.setFontStyle(FontStyle::REGULAR);
+  layout.renderPageBands(pages[0], renderer, config, band, EInkDisplay::BAND_ROWS, sendBand, &display);
+  display.endBands();
+  uint32_t bandedTurn = display.getLastUploadBytes();
+  runner.expectTrue(bandedTurn == PLANE, "banded fast refresh sends the BW RAM only",
+                    std::to_string(bandedTurn) + " bytes");
+  runner.expectTrue(!display.holdsShownFrame(), "after a fast refresh RED RAM lags a frame");
+
+  // Without the shown frame in RED RAM the fast refresh becomes a half one
+  display.beginBands(EInkDisplay::NEXT_FRAME);
+  layout.renderPageBands(pages[1], renderer, config, band, EInkDisplay::BAND_ROWS, sendBand, &display);
+  display.endBands();
+  runner.expectTrue(display.getLastUploadBytes() == 2 * PLANE, "fast refresh without the shown frame sends both",
+                    std::to_string(display.getLastUploadBytes()) + " bytes");
+
+  // Grayscale overwrites both planes; the reader puts the shown page back
+  uint8_t* lsb = band;
+  uint8_t* msb = band + EInkDisplay::BAND_BYTES;
+  memset(lsb, 0x00, EInkDisplay::BAND_BYTES);
+  memset(msb, 0x00, EInkDisplay::BAND_BYTES);
+  for (int16_t top = 0; top < EInkDisplay::DISPLAY_WIDTH; top += EInkDisplay::BAND_ROWS)
+    display.writeGrayscaleStrip(top, EInkDisplay::BAND_ROWS, lsb, msb);
+  runner.expectTrue(!display.holdsShownFrame(), "grayscale planes replace the shown frame");
+  display.beginBands(EInkDisplay::SHOWN_FRAME);
+  layout.renderPageBands(pages[1], renderer, config, band, EInkDisplay::BAND_ROWS, sendBand, &display);
+  display.endBands();
+  uint32_t restore = display.getLastUploadBytes();
+  runner.expectTrue(restore == PLANE && display.holdsShownFrame(), "restoring the shown frame sends RED RAM only",
+                    std::to_string(restore) + " bytes");
+  display.beginBands(EInkDisplay::NEXT_FRAME);
+  layout.renderPageBands(pages[0], renderer, config, band, EInkDisplay::BAND_ROWS, sendBand, &display);
+  display.endBands();
+  runner.expectTrue(display.getLastUploadBytes() == PLANE, "then the next page sends BW RAM only");
+
+  // The spare buffers were not touched by any of it
+  bool spareIntact = true;
+  for (uint32_t i = 0; i < PLANE; ++i)
+    spareIntact = spareIntact && spare0[i] == 0xA5 && spare1[i] == 0x5A;
+  runner.expectTrue(spareIntact, "banded frames leave the spare buffers alone");
+
+  // Back to full-frame mode: white framebuffers, RED RAM put back first
+  display.beginBands(EInkDisplay::SHOWN_FRAME);
+  layout.renderPageBands(pages[0], renderer, config, band, EInkDisplay::BAND_ROWS, sendBand, &display);
+  display.endBands();
+  display.endBanded();
+  uint8_t* frame = display.getFrameBuffer();
+  bool white = frame != nullptr;
+  for (uint32_t i = 0; white && i < PLANE; ++i)
+    white = frame[i] == 0xFF;
+  runner.expectTrue(white && display.getSpareBuffer(0) == nullptr, "endBanded gives back white framebuffers");
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(display.getLastUploadBytes() == PLANE, "first full-frame fast refresh sends BW RAM only",
+                    std::to_string(display.getLastUploadBytes()) + " bytes");
+
+  // Without the shown frame anywhere the next screen gets a half refresh
+  display.beginBanded();
+  display.beginBands(EInkDisplay::NEXT_FRAME);
+  layout.renderPageBands(pages[1], renderer, config, band, EInkDisplay::BAND_ROWS, sendBand, &display);
+  display.endBands();
+  display.endBanded();
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(display.getLastUploadBytes() == 2 * PLANE, "nothing to compare with: half refresh");
+
+  printf("\n  %-34s %8s %10s\n", "", "RAM", "page SPI");
+  printf("  %-34s %8u %7u B %5.1f ms\n", "full frame (2 framebuffers)", static_cast<unsigned>(2 * PLANE),
+         static_cast<unsigned>(fullFrameTurn), spiMs(fullFrameTurn));
+  printf("  %-34s %8u %7u B %5.1f ms\n", "banded (band buffer)", static_cast<unsigned>(2 * EInkDisplay::BAND_BYTES),
+         static_cast<unsigned>(bandedTurn), spiMs(bandedTurn));
+  printf("  %-34s %8s %7u B %5.1f ms\n", "  + shown frame after grayscale", "", static_cast<unsigned>(restore),
+         spiMs(restore));
+  printf("  %-34s %8u\n", "freed for chapter caches", static_cast<unsigned>(2 * PLANE));
+
+  return runner.allPassed() ? 0 : 1;
+}
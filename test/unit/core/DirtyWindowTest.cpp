@@ -0,0 +1,126 @@
+/**
+ * DirtyWindowTest.cpp - Partial-window display updates
+ *
+ * Checks the bytes EInkDisplay::displayBuffer sends to the controller RAM
+ * with and without dirty marks:
+ * - At start, in a non-fast mode or when every row changed, the whole frame
+ *   goes to both RAMs
+ * - A fast refresh with marks sends only their windows, plus RED RAM for the
+ *   windows of the previous fast update (the whole panel after a full one)
+ * - Marks are clipped to the page and rounded out to whole RAM bytes;
+ *   touching marks merge and at most MAX_DIRTY_WINDOWS are kept
+ * - Grayscale writes, or marks covering too much, fall back to the full frame
+ * - The mock SPI bus sees what getLastUploadBytes() reports, plus commands
+ */
+
+#include <string>
+
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+const uint32_t FULL_UPLOAD = 2 * EInkDisplay::BUFFER_SIZE;
+// A list row of the file browser: 24 portrait rows (3 RAM bytes) across the page
+const uint32_t ROW_BYTES = 3 * EInkDisplay::DISPLAY_HEIGHT;
+
+// Display the frame and return the bytes sent to RAM; `busBytes` gets all
+// bytes seen on the SPI bus, commands included
+uint32_t update(EInkDisplay& display, EInkDisplay::RefreshMode mode, size_t* busBytes = nullptr) {
+  size_t before = SPI.bytesSent;
+  display.displayBuffer(mode);
+  if (busBytes)
+    *busBytes = SPI.bytesSent - before;
+  return display.getLastUploadBytes();
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Dirty Window Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+
+  // The first update (screen off: half refresh) sends everything, marks or not
+  display.markDirty(0, 400, 480, 24);
+  runner.expectTrue(update(display, EInkDisplay::FAST_REFRESH) == FULL_UPLOAD, "first update sends the whole frame");
+  runner.expectTrue(display.getDirtyWindowCount() == 0, "displayBuffer clears the marks");
+
+  // After a half refresh both RAMs hold the frame: only the window is sent
+  display.markDirty(0, 400, 480, 24);
+  size_t bus = 0;
+  uint32_t bytes = update(display, EInkDisplay::FAST_REFRESH, &bus);
+  runner.expectTrue(bytes == 2 * ROW_BYTES, "one row after a half refresh", std::to_string(bytes) + " bytes");
+  runner.expectTrue(bus >= bytes && bus < bytes + 100, "bus carries the window plus a few commands",
+                    std::to_string(bus) + " bus bytes");
+
+  // Moving the selection: RED RAM of the previous row is brought up to date
+  display.markDirty(0, 424, 480, 24);
+  bytes = update(display, EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(bytes == 3 * ROW_BYTES, "next row also refreshes the previous row's RED RAM",
+                    std::to_string(bytes) + " bytes");
+
+  // Two rows at once (previous and new selection) stay two windows
+  display.markDirty(0, 400, 480, 24);
+  display.markDirty(0, 456, 480, 24);
+  runner.expectTrue(display.getDirtyWindowCount() == 2, "separate rows are separate windows");
+  bytes = update(display, EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(bytes == 5 * ROW_BYTES, "two rows after one", std::to_string(bytes) + " bytes");
+
+  // A full fast update (every row changed) leaves RED RAM one frame behind
+  display.clearScreen(0x00);
+  runner.expectTrue(update(display, EInkDisplay::FAST_REFRESH) == FULL_UPLOAD, "a changed page sends the whole frame");
+  display.markDirty(0, 400, 480, 24);
+  bytes = update(display, EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(bytes == EInkDisplay::BUFFER_SIZE + 2 * ROW_BYTES, "first window after a full fast update",
+                    std::to_string(bytes) + " bytes");
+
+  // Non-fast modes ignore the marks and leave both RAMs equal
+  display.markDirty(0, 400, 480, 24);
+  runner.expectTrue(update(display, EInkDisplay::HALF_REFRESH) == FULL_UPLOAD, "half refresh sends the whole frame");
+  runner.expectTrue(display.getDirtyWindowCount() == 0, "half refresh clears the marks");
+
+  // Rounding to RAM bytes and clipping to the page
+  display.markDirty(10, 3, 20, 2);
+  bytes = update(display, EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(bytes == 2 * 20, "portrait rows round out to a RAM byte", std::to_string(bytes) + " bytes");
+  display.markDirty(-10, 790, 600, 100);
+  display.markDirty(100, 100, 0, 50);
+  display.markDirty(500, 100, 20, 20);
+  runner.expectTrue(display.getDirtyWindowCount() == 1, "empty and off-page marks are dropped");
+  bytes = update(display, EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(bytes == 20 + 2 * 2 * EInkDisplay::DISPLAY_HEIGHT, "marks are clipped to the page",
+                    std::to_string(bytes) + " bytes");
+
+  // Merging
+  display.markDirty(0, 100, 100, 20);
+  display.markDirty(50, 110, 100, 20);
+  runner.expectTrue(display.getDirtyWindowCount() == 1, "overlapping marks merge");
+  display.markDirty(0, 120, 100, 20);
+  runner.expectTrue(display.getDirtyWindowCount() == 1, "touching marks merge");
+  display.markDirty(0, 300, 16, 8);
+  display.markDirty(0, 400, 16, 8);
+  display.markDirty(0, 500, 16, 8);
+  display.markDirty(0, 600, 16, 8);
+  runner.expectTrue(display.getDirtyWindowCount() == EInkDisplay::MAX_DIRTY_WINDOWS, "at most MAX_DIRTY_WINDOWS",
+                    std::to_string(display.getDirtyWindowCount()) + " windows");
+  display.clearDirty();
+  runner.expectTrue(display.getDirtyWindowCount() == 0, "clearDirty drops the marks");
+
+  // Grayscale writes replace the frame in RAM: the next update sends it all
+  static uint8_t strip[EInkDisplay::BUFFER_SIZE / 2];
+  display.writeGrayscaleStrip(0, EInkDisplay::DISPLAY_WIDTH / 2, strip, strip);
+  display.displayGrayBuffer();
+  display.markDirty(0, 400, 480, 24);
+  runner.expectTrue(update(display, EInkDisplay::FAST_REFRESH) == FULL_UPLOAD, "update after grayscale is full");
+
+  // Marks over most of the page cost more than the frame
+  display.markDirty(0, 0, 480, 800);
+  runner.expectTrue(update(display, EInkDisplay::FAST_REFRESH) == FULL_UPLOAD, "page-sized marks send the frame");
+
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/**
+ * RowDiffUploadTest.cpp - Fast refresh sends only the changed rows
+ *
+ * Renders reader pages into the display framebuffer and checks what
+ * EInkDisplay::displayBuffer(FAST_REFRESH) sends when the frame is compared
+ * with the one on the panel:
+ * - An unchanged frame sends no BW data, a second one nothing at all
+ * - A changed status line sends a few percent of the frame
+ * - A page turn sends less than both full buffers
+ * - The mock SPI blocks add up to getLastUploadBytes(): the RAM data goes
+ *   out row by row, one block per window row
+ * - Prints the bytes per update next to the full 96000
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "resources/fonts/Font14.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+
+namespace {
+
+const uint32_t FULL_UPLOAD = 2 * EInkDisplay::BUFFER_SIZE;
+
+std::string buildText() {
+  const char* words[] = {"Die",    "Donaudampfschifffahrtsgesellschaft", "fuhr",   "über",  "den",
+                         "Fluss,", "während",                            "die",    "Sonne", "langsam",
+                         "hinter", "den",                                "Hügeln", "verschwand."};
+  const int wordCount = sizeof(words) / sizeof(words[0]);
+  std::string text;
+  for (int p = 0; p < 30; ++p) {
+    int n = 20 + (p * 13) % 50;
+    for (int w = 0; w < n; ++w) {
+      text += words[(p + w * 7) % wordCount];
+      if (w + 1 < n)
+        text += ' ';
+    }
+    text += "\n";
+  }
+  return text;
+}
+
+struct Reader {
+  EInkDisplay& display;
+  TextRenderer renderer;
+  KnuthPlassLayoutStrategy layout;
+  LayoutStrategy::LayoutConfig config;
+  LayoutStrategy::PageLayout pages[2];
+
+  explicit Reader(EInkDisplay& display, StringWordProvider& provider) : display(display), renderer(display) {
+    config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+    config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+    config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+    config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+    config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+    config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+    config.pageWidth = TestConfig::DISPLAY_WIDTH;
+    config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+    config.alignment = LayoutStrategy::ALIGN_LEFT;
+    config.language = Language::GERMAN;
+    layout.setLanguage(config.language);
+    renderer.setFontFamily(&bookerlyFamily);
+    layout.layoutText(provider, renderer, config, pages[0]);
+    provider.setPosition(pages[0].endPosition);
+    layout.layoutText(provider, renderer, config, pages[1]);
+  }
+
+  // Draw page `page` and its status line into the back buffer, as the
+  // viewer does for every update
+  void draw(int page, const char* status) {
+    display.clearScreen(0xFF);
+    renderer.setFrameBuffer(display.getFrameBuffer());
+    renderer.setBitmapType(TextRenderer::BITMAP_BW);
+    renderer.setTextColor(TextRenderer::COLOR_BLACK);
+    renderer.setFontFamily(&bookerlyFamily);
+    renderer.setFontStyle(FontStyle::REGULAR);
+    layout.renderPage(pages[page], renderer, config);
+    renderer.setFont(&Font14);
+    renderer.setCursor(200, 790);
+    renderer.print(status);
+  }
+};
+
+// Display the frame; returns the RAM bytes sent, and checks that the SPI
+// blocks add up to them
+uint32_t update(TestUtils::TestRunner& runner, EInkDisplay& display, const std::string& name) {
+  SPI.writeSizes.clear();
+  display.displayBuffer(EInkDisplay::FAST_REFRESH);
+  uint32_t bytes = display.getLastUploadBytes();
+  size_t blocks = 0;
+  for (size_t size : SPI.writeSizes)
+    blocks += size;
+  runner.expectTrue(blocks == bytes, name + ": SPI blocks add up to the upload",
+                    std::to_string(blocks) + " vs " + std::to_string(bytes), true);
+  printf("  %-28s %6u bytes (%4.1f%% of full)\n", name.c_str(), static_cast<unsigned>(bytes), 100.0 * bytes / FULL_UPLOAD);
+  return bytes;
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Row Diff Upload Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  std::string text = buildText();
+  StringWordProvider provider(String(text.c_str()));
+  Reader reader(display, provider);
+  runner.expectTrue(reader.pages[0].getLineCount() > 10 && reader.pages[1].getLineCount() > 10, "two full pages");
+
+  // The first update (screen off: half refresh) has nothing to compare with
+  reader.draw(0, "1/20");
+  runner.expectTrue(update(runner, display, "first page (half refresh)") == FULL_UPLOAD,
+                    "first update sends the whole frame");
+
+  // Same frame again: no BW rows, and RED RAM already matches
+  reader.draw(0, "1/20");
+  runner.expectTrue(update(runner, display, "unchanged page") == 0, "unchanged frame after a half refresh sends nothing");
+
+  // Status line only
+  reader.draw(0, "1/21");
+  uint32_t statusBytes = update(runner, display, "status line changed");
+  runner.expectTrue(statusBytes > 0 && statusBytes < FULL_UPLOAD / 20, "status line sends under 5% of the frame",
+                    std::to_string(statusBytes) + " bytes");
+
+  // Unchanged again: only the RED RAM behind the status line
+  reader.draw(0, "1/21");
+  uint32_t settle = update(runner, display, "unchanged after status");
+  runner.expectTrue(settle == statusBytes / 2, "then only the previous windows' RED RAM",
+                    std::to_string(settle) + " bytes");
+
+  // Page turns: the text moves in most rows, the margins do not
+  reader.draw(1, "2/21");
+  uint32_t turn = update(runner, display, "page turn");
+  runner.expectTrue(turn > FULL_UPLOAD / 2 && turn < FULL_UPLOAD, "page turn sends less than the full frame",
+                    std::to_string(turn) + " bytes");
+  reader.draw(0, "1/21");
+  turn = update(runner, display, "page turn back");
+  runner.expectTrue(turn < FULL_UPLOAD, "turn after a turn sends less than the full frame",
+                    std::to_string(turn) + " bytes");
+
+  // Every row changed (inverted page): cheaper to send the whole frame
+  reader.draw(0, "1/21");
+  uint8_t* frame = display.getFrameBuffer();
+  for (uint32_t i = 0; i < EInkDisplay::BUFFER_SIZE; ++i)
+    frame[i] = ~frame[i];
+  runner.expectTrue(update(runner, display, "inverted page") == FULL_UPLOAD, "all rows changed sends the frame");
+
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,335 @@
+/**
+ * SSD1677SimulatorTest.cpp - The display driver against a simulated controller
+ *
+ * Runs EInkDisplay with SSD1677Simulator behind the SPI and GPIO mocks and
+ * checks that:
+ * - Full-frame, row diff and dirty window refreshes leave BW RAM and the
+ *   panel holding the frame, with no ghost pixels: a fast refresh drives
+ *   exactly the pixels that changed
+ * - Banded frames land in the right RAM columns; the grayscale pass leaves
+ *   the LSB plane in BW RAM and the MSB plane in RED RAM with the 12 frame
+ *   LUT, and the next page turn reverts it (24 frames) and restores the
+ *   shown frame so the fast refresh ghosts nothing
+ * - No byte reaches the controller while BUSY is high, asynchronous
+ *   refreshes included; deep sleep drops everything until a reset
+ * - The model itself: bytes sent while busy are ignored, and a fast refresh
+ *   against a RED RAM that does not hold the panel leaves ghost pixels
+ * - Prints bus, waveform and total time of each refresh strategy
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "SSD1677Simulator.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+const int CS_PIN = 1;
+const int DC_PIN = 2;
+const int RST_PIN = 3;
+const int BUSY_PIN = 4;
+
+const uint32_t FRAME = EInkDisplay::BUFFER_SIZE;
+const uint16_t ROW_BYTES = EInkDisplay::DISPLAY_WIDTH_BYTES;
+const uint16_t ROWS = EInkDisplay::DISPLAY_HEIGHT;
+
+typedef std::vector<uint8_t> Frame;
+
+uint32_t countBits(uint8_t value) {
+  uint32_t bits = 0;
+  for (; value; value &= value - 1)
+    bits++;
+  return bits;
+}
+
+// The framebuffer as the controller stores it: rows bottom up
+Frame toRam(const Frame& frame) {
+  Frame ram(FRAME);
+  for (uint16_t row = 0; row < ROWS; row++)
+    memcpy(&ram[(ROWS - 1 - row) * ROW_BYTES], &frame[row * ROW_BYTES], ROW_BYTES);
+  return ram;
+}
+
+bool ramHolds(const uint8_t* ram, const Frame& frame) {
+  return memcmp(ram, toRam(frame).data(), FRAME) == 0;
+}
+
+uint32_t pixelsChanged(const Frame& a, const Frame& b) {
+  uint32_t pixels = 0;
+  for (uint32_t i = 0; i < FRAME; i++)
+    pixels += countBits(a[i] ^ b[i]);
+  return pixels;
+}
+
+// A page-like frame: black "text" rows on white, varying with `seed`
+Frame makePage(uint32_t seed) {
+  Frame frame(FRAME, 0xFF);
+  uint32_t state = seed * 2654435761u + 1;
+  for (uint16_t row = 40; row < ROWS - 40; row++) {
+    if ((row / 12) % 2)
+      continue;
+    for (uint16_t col = 5; col < ROW_BYTES - 5; col++) {
+      state = state * 1664525u + 1013904223u;
+      frame[row * ROW_BYTES + col] = static_cast<uint8_t>(state >> 24);
+    }
+  }
+  return frame;
+}
+
+void showFrame(EInkDisplay& display, const Frame& frame, EInkDisplay::RefreshMode mode) {
+  memcpy(display.getFrameBuffer(), frame.data(), FRAME);
+  display.displayBuffer(mode);
+}
+
+// Band of portrait rows [top, top + BAND_ROWS) = RAM columns of the frame
+void cutBand(const Frame& frame, int16_t top, uint8_t* band) {
+  const uint16_t bandBytes = EInkDisplay::BAND_ROWS / 8;
+  for (uint16_t row = 0; row < ROWS; row++)
+    memcpy(&band[row * bandBytes], &frame[row * ROW_BYTES + top / 8], bandBytes);
+}
+
+void sendBands(EInkDisplay& display, EInkDisplay::BandTarget target, const Frame& frame) {
+  uint8_t* band = display.getBandBuffer();
+  display.beginBands(target);
+  for (int16_t top = 0; top < EInkDisplay::DISPLAY_WIDTH; top += EInkDisplay::BAND_ROWS) {
+    cutBand(frame, top, band);
+    display.writeBand(top, EInkDisplay::BAND_ROWS, band);
+  }
+  display.endBands();
+}
+
+void sendGrayscale(EInkDisplay& display, const Frame& lsb, const Frame& msb) {
+  std::vector<uint8_t> lsbBand(EInkDisplay::BAND_BYTES), msbBand(EInkDisplay::BAND_BYTES);
+  for (int16_t top = 0; top < EInkDisplay::DISPLAY_WIDTH; top += EInkDisplay::BAND_ROWS) {
+    cutBand(lsb, top, lsbBand.data());
+    cutBand(msb, top, msbBand.data());
+    display.writeGrayscaleStrip(top, EInkDisplay::BAND_ROWS, lsbBand.data(), msbBand.data());
+  }
+  display.displayGrayBuffer();
+}
+
+// Raw bytes on the bus, bypassing the driver
+void rawCommand(uint8_t command, const std::vector<uint8_t>& params) {
+  SPI.beginTransaction(SPISettings(40000000, MSBFIRST, SPI_MODE0));
+  digitalWrite(CS_PIN, LOW);
+  digitalWrite(DC_PIN, LOW);
+  SPI.transfer(command);
+  digitalWrite(DC_PIN, HIGH);
+  for (uint8_t param : params)
+    SPI.transfer(param);
+  digitalWrite(CS_PIN, HIGH);
+  SPI.endTransaction();
+}
+
+const SSD1677Simulator::Refresh& lastRefresh(const SSD1677Simulator& sim) {
+  return sim.getRefreshes().back();
+}
+
+// Simulated time of one strategy, measured from `mark`
+struct Cost {
+  uint64_t spiNs, waveformNs, nowNs;
+};
+
+Cost mark(const SSD1677Simulator& sim) {
+  return {sim.getSpiNs(), sim.getWaveformNs(), sim.getNowNs()};
+}
+
+void printCost(const char* name, const SSD1677Simulator& sim, const Cost& from) {
+  printf("  %-34s %7.1f ms bus %8.1f ms waveform %8.1f ms total\n", name, (sim.getSpiNs() - from.spiNs) / 1e6,
+         (sim.getWaveformNs() - from.waveformNs) / 1e6, (sim.getNowNs() - from.nowNs) / 1e6);
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("SSD1677 Simulator Test");
+
+  const SSD1677Simulator::Timing timing;
+  SSD1677Simulator sim(CS_PIN, DC_PIN, RST_PIN, BUSY_PIN, timing);
+  sim.attach();
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, CS_PIN, DC_PIN, RST_PIN, BUSY_PIN);
+  display.begin();
+  runner.expectTrue(sim.getCommandCount(0x12) == 1 && !sim.isAsleep() && sim.getRefreshes().empty(),
+                    "controller reset and initialized");
+
+  // Full-frame refreshes
+  Frame shown = makePage(1);
+  showFrame(display, shown, EInkDisplay::HALF_REFRESH);
+  runner.expectTrue(ramHolds(sim.getBwRam(), shown) && ramHolds(sim.getRedRam(), shown),
+                    "half refresh: both RAMs hold the frame, rows bottom up");
+  runner.expectTrue(lastRefresh(sim).kind == SSD1677Simulator::HALF && sim.countPanelDifferences(toRam(shown).data()) == 0,
+                    "half refresh: panel shows the frame");
+
+  // Fast refresh of the rows that changed
+  Frame next = shown;
+  memset(&next[100 * ROW_BYTES], 0x00, 24 * ROW_BYTES);
+  showFrame(display, next, EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(ramHolds(sim.getBwRam(), next) && sim.countPanelDifferences(toRam(next).data()) == 0,
+                    "row diff: panel shows the new frame");
+  runner.expectTrue(lastRefresh(sim).kind == SSD1677Simulator::FAST &&
+                        lastRefresh(sim).drivenPixels == pixelsChanged(shown, next) &&
+                        lastRefresh(sim).ghostPixels == 0,
+                    "row diff: drives exactly the changed pixels, no ghosts",
+                    std::to_string(lastRefresh(sim).drivenPixels) + " driven, " +
+                        std::to_string(lastRefresh(sim).ghostPixels) + " ghosts");
+  shown = next;
+
+  // Dirty windows, several turns in a row
+  bool windowsClean = true;
+  for (int turn = 0; turn < 4; turn++) {
+    next = shown;
+    const int16_t x = 64 + turn * 96;
+    const int16_t y = 60 + turn * 80;
+    for (int16_t row = y; row < y + 40; row++)
+      memset(&next[row * ROW_BYTES + x / 8], turn % 2 ? 0xFF : 0x0F, 12);
+    memcpy(display.getFrameBuffer(), next.data(), FRAME);
+    // Portrait coordinates: rows are framebuffer columns, columns framebuffer
+    // rows from the bottom
+    display.markDirty(ROWS - y - 40, x, 40, 96);
+    display.displayBuffer(EInkDisplay::FAST_REFRESH);
+    const SSD1677Simulator::Refresh& refresh = lastRefresh(sim);
+    windowsClean = windowsClean && refresh.kind == SSD1677Simulator::FAST &&
+                   refresh.drivenPixels == pixelsChanged(shown, next) && refresh.ghostPixels == 0 &&
+                   sim.countPanelDifferences(toRam(next).data()) == 0;
+    shown = next;
+  }
+  runner.expectTrue(windowsClean, "dirty windows: every turn exact, no ghosts");
+
+  // Banded page turns with the grayscale pass
+  display.beginBanded();
+  next = makePage(2);
+  sendBands(display, EInkDisplay::NEXT_FRAME, next);
+  runner.expectTrue(ramHolds(sim.getBwRam(), next) && sim.countPanelDifferences(toRam(next).data()) == 0 &&
+                        lastRefresh(sim).ghostPixels == 0,
+                    "banded frame: bands in the right RAM columns");
+  shown = next;
+
+  const Frame lsb = makePage(3);
+  const Frame msb = makePage(4);
+  sendGrayscale(display, lsb, msb);
+  runner.expectTrue(ramHolds(sim.getBwRam(), lsb) && ramHolds(sim.getRedRam(), msb),
+                    "grayscale: LSB plane in BW RAM, MSB plane in RED RAM");
+  runner.expectTrue(lastRefresh(sim).kind == SSD1677Simulator::CUSTOM_LUT &&
+                        lastRefresh(sim).durationNs == 12ull * timing.lutFrameMs * 1000000,
+                    "grayscale: refreshed with the 12 frame LUT");
+
+  const size_t beforeTurn = sim.getRefreshes().size();
+  next = makePage(5);
+  sendBands(display, EInkDisplay::SHOWN_FRAME, shown);
+  sendBands(display, EInkDisplay::NEXT_FRAME, next);
+  const std::vector<SSD1677Simulator::Refresh>& refreshes = sim.getRefreshes();
+  runner.expectTrue(refreshes.size() == beforeTurn + 2 && refreshes[beforeTurn].kind == SSD1677Simulator::CUSTOM_LUT &&
+                        refreshes[beforeTurn].durationNs == 24ull * timing.lutFrameMs * 1000000,
+                    "page turn: grayscale reverted with the 24 frame LUT");
+  runner.expectTrue(lastRefresh(sim).kind == SSD1677Simulator::FAST &&
+                        lastRefresh(sim).drivenPixels == pixelsChanged(shown, next) &&
+                        lastRefresh(sim).ghostPixels == 0 && sim.countPanelDifferences(toRam(next).data()) == 0,
+                    "page turn: restored shown frame, fast refresh without ghosts");
+  shown = next;
+
+  // The model catches a stale RED RAM: fast refresh to white with RED
+  // holding an older frame leaves the pixels black on the panel but white in
+  // that frame
+  const Frame stale = makePage(2);
+  rawCommand(0x46, {0xF7});
+  rawCommand(0x21, {0x00});
+  rawCommand(0x22, {0x1C});
+  rawCommand(0x20, {});
+  sim.finishRefresh();
+  uint32_t expectedGhosts = 0;
+  for (uint32_t i = 0; i < FRAME; i++)
+    expectedGhosts += countBits(~shown[i] & stale[i]);
+  runner.expectTrue(expectedGhosts > 0 && lastRefresh(sim).ghostPixels == expectedGhosts,
+                    "model: stale RED RAM leaves ghost pixels",
+                    std::to_string(lastRefresh(sim).ghostPixels) + " vs " + std::to_string(expectedGhosts));
+  display.endBanded();
+
+  // Nothing sent while busy, asynchronous refreshes included
+  runner.expectTrue(sim.getBytesIgnoredBusy() == 0, "no bytes sent while BUSY is high",
+                    std::to_string(sim.getBytesIgnoredBusy()) + " ignored");
+  display.setAsyncRefresh(true);
+  showFrame(display, makePage(6), EInkDisplay::HALF_REFRESH);
+  const bool returnedEarly = sim.isBusy();
+  showFrame(display, makePage(7), EInkDisplay::FAST_REFRESH);
+  uint32_t waitedMs = 0;
+  while (!display.pollRefresh() && waitedMs < 10000) {
+    delay(1);
+    waitedMs++;
+  }
+  runner.expectTrue(returnedEarly && sim.getBytesIgnoredBusy() == 0 && waitedMs > 0 &&
+                        waitedMs <= timing.fastMs + 1 && !sim.isBusy(),
+                    "async: refresh returns early, the next one waits, polling ends with BUSY",
+                    std::to_string(waitedMs) + " ms polled");
+  display.setAsyncRefresh(false);
+
+  // The model catches a driver that does not wait
+  showFrame(display, makePage(8), EInkDisplay::FULL_REFRESH);
+  display.setAsyncRefresh(true);
+  showFrame(display, makePage(9), EInkDisplay::FAST_REFRESH);
+  rawCommand(0x24, {0x00, 0x00});
+  runner.expectTrue(sim.getBytesIgnoredBusy() == 3, "model: bytes sent while busy are ignored");
+  display.waitForRefresh();
+  display.setAsyncRefresh(false);
+
+  // Deep sleep until a reset
+  display.deepSleep();
+  const size_t beforeSleep = sim.getRefreshes().size();
+  showFrame(display, makePage(10), EInkDisplay::FAST_REFRESH);
+  runner.expectTrue(sim.isAsleep() && sim.getBytesIgnoredAsleep() > 0 && sim.getRefreshes().size() == beforeSleep,
+                    "deep sleep: commands ignored");
+  display.begin();
+  shown = makePage(11);
+  showFrame(display, shown, EInkDisplay::HALF_REFRESH);
+  runner.expectTrue(!sim.isAsleep() && sim.countPanelDifferences(toRam(shown).data()) == 0,
+                    "reset wakes the controller");
+
+  // Cost of each strategy (bus at 40 MHz; waveform times are estimates)
+  printf("\n  Strategy costs (simulated)\n");
+  Cost from = mark(sim);
+  shown = makePage(12);
+  showFrame(display, shown, EInkDisplay::HALF_REFRESH);
+  printCost("half refresh, full frame", sim, from);
+
+  from = mark(sim);
+  next = shown;
+  for (uint8_t& byte : next)
+    byte = static_cast<uint8_t>(~byte);
+  showFrame(display, next, EInkDisplay::FAST_REFRESH);
+  printCost("fast refresh, every row changed", sim, from);
+  shown = next;
+
+  from = mark(sim);
+  memset(&next[200 * ROW_BYTES], 0xAA, 20 * ROW_BYTES);
+  showFrame(display, next, EInkDisplay::FAST_REFRESH);
+  printCost("fast refresh, one line changed", sim, from);
+  shown = next;
+
+  display.beginBanded();
+  from = mark(sim);
+  next = makePage(13);
+  sendBands(display, EInkDisplay::NEXT_FRAME, next);
+  printCost("banded frame", sim, from);
+  shown = next;
+
+  sendGrayscale(display, lsb, msb);
+  from = mark(sim);
+  next = makePage(14);
+  sendBands(display, EInkDisplay::SHOWN_FRAME, shown);
+  sendBands(display, EInkDisplay::NEXT_FRAME, next);
+  sendGrayscale(display, lsb, msb);
+  printCost("banded page turn with grayscale", sim, from);
+  display.endBanded();
+
+  runner.expectTrue(sim.getBytesIgnoredBusy() == 3 && sim.countPanelDifferences(toRam(next).data()) == 0,
+                    "strategies: nothing more ignored, panel holds the last frame");
+
+  sim.detach();
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/**
+ * SpiTransactionTest.cpp - SPI transactions of a page turn
+ *
+ * Records the transaction boundaries the display driver produces (SPI mock)
+ * and checks that:
+ * - Setting the RAM area is one transaction, and a RAM write (command and
+ *   data) another, for frames, bands and grayscale strips
+ * - A LUT load and the refresh commands are one transaction each
+ * - Every byte sent is inside a transaction
+ * - Prints the transactions, bytes and wire time (at 40 MHz) of a reader
+ *   page turn: grayscale revert, restoring the shown frame, the new bw frame
+ *   and its grayscale pass
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+const double SPI_HZ = 40e6;
+const size_t BAND = EInkDisplay::BAND_BYTES;
+
+// Transactions recorded since `from`
+std::vector<size_t> since(size_t from) {
+  return std::vector<size_t>(SPI.transactionSizes.begin() + from, SPI.transactionSizes.end());
+}
+
+size_t total(const std::vector<size_t>& sizes) {
+  size_t bytes = 0;
+  for (size_t size : sizes)
+    bytes += size;
+  return bytes;
+}
+
+// A RAM area (5 commands with 13 parameter bytes) followed by RAM writes of
+// `planes` x `bytes`, `count` times over
+bool areaThenWrites(const std::vector<size_t>& sizes, size_t begin, int count, int planes, size_t bytes) {
+  if (sizes.size() < begin + static_cast<size_t>(count) * (1 + planes))
+    return false;
+  for (int i = 0; i < count; i++) {
+    if (sizes[begin++] != 5 + 13)
+      return false;
+    for (int p = 0; p < planes; p++) {
+      if (sizes[begin++] != 1 + bytes)
+        return false;
+    }
+  }
+  return true;
+}
+
+void sendBands(EInkDisplay& display, EInkDisplay::BandTarget target, const uint8_t* band) {
+  display.beginBands(target);
+  for (int16_t top = 0; top < EInkDisplay::DISPLAY_WIDTH; top += EInkDisplay::BAND_ROWS)
+    display.writeBand(top, EInkDisplay::BAND_ROWS, band);
+  display.endBands();
+}
+
+void sendGrayscale(EInkDisplay& display, const uint8_t* band) {
+  for (int16_t top = 0; top < EInkDisplay::DISPLAY_WIDTH; top += EInkDisplay::BAND_ROWS)
+    display.writeGrayscaleStrip(top, EInkDisplay::BAND_ROWS, band, band);
+  display.displayGrayBuffer();
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("SPI Transaction Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  size_t from = SPI.transactionSizes.size();
+  size_t sentBefore = SPI.bytesSent;
+  display.begin();
+  std::vector<size_t> init = since(from);
+  runner.expectTrue(total(init) == SPI.bytesSent - sentBefore, "every byte of the init is in a transaction");
+  runner.expectTrue(init.size() <= 5, "controller init in a few transactions", std::to_string(init.size()));
+
+  // Full-frame mode: RAM area, BW, RED, refresh
+  from = SPI.transactionSizes.size();
+  display.displayBuffer(EInkDisplay::HALF_REFRESH);
+  std::vector<size_t> frame = since(from);
+  runner.expectTrue(frame.size() == 4 && areaThenWrites(frame, 0, 1, 2, EInkDisplay::BUFFER_SIZE),
+                    "full frame: RAM area and one transaction per plane", std::to_string(frame.size()));
+  runner.expectTrue(frame.back() == 2 + 2 + 2 + 1, "half refresh commands in one transaction",
+                    std::to_string(frame.back()) + " bytes");
+
+  // Banded page turns
+  display.beginBanded();
+  uint8_t* band = display.getBandBuffer();
+  for (size_t i = 0; i < BAND; i++)
+    band[i] = static_cast<uint8_t>(i);
+
+  from = SPI.transactionSizes.size();
+  sendBands(display, EInkDisplay::NEXT_FRAME, band);
+  std::vector<size_t> bands = since(from);
+  runner.expectTrue(bands.size() == 10 * 2 + 1 && areaThenWrites(bands, 0, 10, 1, BAND),
+                    "fast banded frame: two transactions per band", std::to_string(bands.size()));
+  runner.expectTrue(bands.back() == 2 + 2 + 1, "fast refresh commands in one transaction");
+
+  from = SPI.transactionSizes.size();
+  sendGrayscale(display, band);
+  std::vector<size_t> gray = since(from);
+  runner.expectTrue(areaThenWrites(gray, 0, 10, 2, BAND), "grayscale strip: RAM area and one transaction per plane");
+  runner.expectTrue(gray.size() == 10 * 3 + 2 && gray[30] == 1 + 105 + 2 + 4 + 2,
+                    "LUT and voltages in one transaction",
+                    std::to_string(gray.size()) + " transactions");
+
+  // A reader page turn after grayscale
+  from = SPI.transactionSizes.size();
+  sentBefore = SPI.bytesSent;
+  sendBands(display, EInkDisplay::SHOWN_FRAME, band);
+  sendBands(display, EInkDisplay::NEXT_FRAME, band);
+  sendGrayscale(display, band);
+  std::vector<size_t> turn = since(from);
+  const size_t turnBytes = SPI.bytesSent - sentBefore;
+  runner.expectTrue(total(turn) == turnBytes, "every byte of the page turn is in a transaction");
+  // Revert (LUT, refresh), shown frame, new frame, refresh, grayscale
+  const size_t expected = 2 + 20 + 20 + 1 + 32;
+  runner.expectTrue(turn.size() == expected, "page turn transactions",
+                    std::to_string(turn.size()) + " vs " + std::to_string(expected));
+  printf("  page turn: %u transactions, %u bytes, %.1f ms on the wire at 40 MHz\n", static_cast<unsigned>(turn.size()),
+         static_cast<unsigned>(turnBytes), turnBytes * 8 / SPI_HZ * 1000.0);
+
+  from = SPI.transactionSizes.size();
+  display.deepSleep();
+  runner.expectTrue(since(from).size() == 1, "deep sleep in one transaction");
+
+  return runner.allPassed() ? 0 : 1;
+}
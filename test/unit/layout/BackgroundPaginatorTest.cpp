@@ -0,0 +1,262 @@
+/**
+ * BackgroundPaginatorTest.cpp - Background Pagination Test
+ *
+ * Tests the cooperative background paginator:
+ * - Paginating all chapters gives the same page starts as laying out pages one by one
+ * - The yield callback stops work before any page is laid out
+ * - Progress saved with the page map is resumed instead of recomputed
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/BackgroundPaginator.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+#include "text/layout/PageMap.h"
+
+namespace {
+
+const char* MAP_PATH = "test/output/background_paginator_test.pages";
+
+// Minimal multi-chapter provider: one StringWordProvider per chapter
+class ChapterStringProvider : public WordProvider {
+ public:
+  explicit ChapterStringProvider(const std::vector<String>& chapters) {
+    for (const String& c : chapters)
+      chapters_.push_back(new StringWordProvider(c));
+  }
+  ~ChapterStringProvider() override {
+    for (StringWordProvider* p : chapters_)
+      delete p;
+  }
+
+  bool hasNextWord() override {
+    return cur()->hasNextWord();
+  }
+  bool hasPrevWord() override {
+    return cur()->hasPrevWord();
+  }
+  StyledWord getNextWord() override {
+    return cur()->getNextWord();
+  }
+  StyledWord getPrevWord() override {
+    return cur()->getPrevWord();
+  }
+  float getPercentage() override {
+    return cur()->getPercentage();
+  }
+  float getPercentage(int index) override {
+    return cur()->getPercentage(index);
+  }
+  void setPosition(int index) override {
+    cur()->setPosition(index);
+  }
+  int getCurrentIndex() override {
+    return cur()->getCurrentIndex();
+  }
+  char peekChar(int offset = 0) override {
+    return cur()->peekChar(offset);
+  }
+  int consumeChars(int n) override {
+    return cur()->consumeChars(n);
+  }
+  bool isInsideWord() override {
+    return cur()->isInsideWord();
+  }
+  void ungetWord() override {
+    cur()->ungetWord();
+  }
+  void reset() override {
+    cur()->reset();
+  }
+  int getChapterCount() override {
+    return static_cast<int>(chapters_.size());
+  }
+  int getCurrentChapter() override {
+    return chapter_;
+  }
+  bool setChapter(int chapterIndex) override {
+    if (chapterIndex < 0 || chapterIndex >= getChapterCount())
+      return false;
+    chapter_ = chapterIndex;
+    ++chapterSwitches;
+    cur()->reset();
+    return true;
+  }
+  bool hasChapters() override {
+    return true;
+  }
+
+  int chapterSwitches = 0;
+
+ private:
+  StringWordProvider* cur() {
+    return chapters_[chapter_];
+  }
+  std::vector<StringWordProvider*> chapters_;
+  int chapter_ = 0;
+};
+
+std::vector<String> buildChapters() {
+  static const char* words[] = {"Es",      "war",   "einmal", "ein",         "kleines",       "Dorf",
+                                "am",      "Rande", "eines",  "Waldes,",     "in",            "dem",
+                                "Menschen", "lebten", "die", "Geschichten", "erzählten.",    "Abends"};
+  const int wordCount = sizeof(words) / sizeof(words[0]);
+  std::vector<String> chapters;
+  for (int ch = 0; ch < 3; ++ch) {
+    std::string text;
+    int paragraphs = 12 + ch * 8;
+    for (int para = 0; para < paragraphs; ++para) {
+      int len = 15 + (para * 11 + ch) % 70;
+      for (int i = 0; i < len; ++i) {
+        text += words[(para * 7 + i * 5 + ch) % wordCount];
+        text += (i + 1 < len) ? " " : "";
+      }
+      text += "\n";
+    }
+    chapters.push_back(String(text.c_str()));
+  }
+  return chapters;
+}
+
+LayoutStrategy::LayoutConfig makeConfig() {
+  LayoutStrategy::LayoutConfig config;
+  config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+  config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+  config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+  config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+  config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+  config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+  config.pageWidth = TestConfig::DISPLAY_WIDTH;
+  config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+  config.alignment = LayoutStrategy::ALIGN_LEFT;
+  config.language = Language::GERMAN;
+  return config;
+}
+
+bool alwaysYield(void*) {
+  return true;
+}
+
+bool yieldAfterCount(void* context) {
+  int* remaining = static_cast<int*>(context);
+  if (*remaining <= 0)
+    return true;
+  --(*remaining);
+  return false;
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Background Paginator Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  renderer.setFontFamily(&bookerlyFamily);
+
+  std::vector<String> chapters = buildChapters();
+  KnuthPlassLayoutStrategy layout;
+  LayoutStrategy::LayoutConfig config = makeConfig();
+  layout.setLanguage(config.language);
+  uint32_t key = PageMap::computeKey(config, &bookerlyFamily, layout.getType());
+
+  // Reference: lay out every chapter page by page
+  std::vector<std::vector<int>> expected;
+  {
+    ChapterStringProvider provider(chapters);
+    for (int ch = 0; ch < provider.getChapterCount(); ++ch) {
+      provider.setChapter(ch);
+      std::vector<int> starts;
+      int start = provider.getCurrentIndex();
+      while (true) {
+        provider.setPosition(start);
+        LayoutStrategy::PageLayout page = layout.layoutText(provider, renderer, config);
+        starts.push_back(start);
+        if (provider.getChapterPercentage(page.endPosition) >= 1.0f || page.endPosition <= start)
+          break;
+        start = page.endPosition;
+      }
+      expected.push_back(starts);
+    }
+  }
+
+  // Yield callback is honoured before any work is done
+  {
+    PageMap map;
+    map.reset(key, static_cast<int>(chapters.size()));
+    BackgroundPaginator paginator(layout, map);
+    paginator.begin(new ChapterStringProvider(chapters), config);
+    runner.expectTrue(paginator.hasWork(), "fresh map has work");
+    int pages = paginator.step(renderer, 10, alwaysYield, nullptr);
+    runner.expectTrue(pages == 0 && map.getPageCount(0) == 0, "pending input stops pagination immediately");
+  }
+
+  // Session 1: a few pages, then "sleep" (save the map)
+  int firstSessionPages = 0;
+  {
+    PageMap map;
+    map.reset(key, static_cast<int>(chapters.size()));
+    BackgroundPaginator paginator(layout, map);
+    paginator.begin(new ChapterStringProvider(chapters), config);
+    int budget = static_cast<int>(expected[0].size()) + 2;  // finish chapter 0 and start chapter 1
+    firstSessionPages = paginator.step(renderer, 100, yieldAfterCount, &budget);
+    runner.expectTrue(firstSessionPages == static_cast<int>(expected[0].size()) + 2,
+                      "step stops when the yield callback fires");
+    runner.expectTrue(map.isChapterComplete(0) && !map.isChapterComplete(1), "first chapter paginated");
+    runner.expectTrue(map.save(MAP_PATH), "map saved");
+  }
+
+  // Session 2: reload and finish the book
+  {
+    PageMap map;
+    runner.expectTrue(map.load(MAP_PATH, key, static_cast<int>(chapters.size())), "map reloaded");
+    BackgroundPaginator paginator(layout, map);
+    ChapterStringProvider* provider = new ChapterStringProvider(chapters);
+    paginator.begin(provider, config);
+    int steps = 0;
+    while (paginator.hasWork() && steps < 1000) {
+      paginator.step(renderer, 1);
+      ++steps;
+    }
+    runner.expectTrue(map.isComplete(), "book fully paginated after second session");
+
+    int totalExpected = 0;
+    for (const std::vector<int>& starts : expected)
+      totalExpected += static_cast<int>(starts.size());
+    runner.expectTrue(paginator.getPagesLaidOut() == totalExpected - firstSessionPages,
+                      "second session resumes instead of recomputing",
+                      std::to_string(paginator.getPagesLaidOut()) + " pages laid out, expected " +
+                          std::to_string(totalExpected - firstSessionPages));
+    runner.expectTrue(provider->chapterSwitches <= static_cast<int>(chapters.size()),
+                      "each chapter is opened once");
+
+    bool startsMatch = true;
+    for (size_t ch = 0; ch < expected.size(); ++ch) {
+      if (map.getPageCount(ch) != static_cast<int>(expected[ch].size())) {
+        startsMatch = false;
+        continue;
+      }
+      for (size_t i = 0; i < expected[ch].size(); ++i) {
+        if (map.getPageStart(ch, i) != expected[ch][i])
+          startsMatch = false;
+      }
+    }
+    runner.expectTrue(startsMatch, "background page starts match forward layout");
+    runner.expectTrue(map.getTotalPageCount() == totalExpected, "total page count");
+  }
+
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+/**
+ * GlyphRunTest.cpp - Pre-shaped glyph runs in the page layout
+ *
+ * - Every laid-out word carries a glyph run in the font its style resolves to
+ * - renderPage from the stored runs is bit-identical to printing each word's
+ *   text, for the BW and both grayscale planes
+ * - Runs with missing glyphs and malformed UTF-8 advance like print()
+ * - Runs live in the page arena: reusing a layout does not grow it, and a
+ *   moved layout keeps its runs
+ * - Benchmark: printing the words vs drawing the stored runs
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/GreedyLayoutStrategy.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+
+namespace {
+
+typedef LayoutStrategy::PageLayout PageLayout;
+
+std::string buildText() {
+  const char* words[] = {"Die",    "Donaudampfschifffahrtsgesellschaft", "fuhr",   "über",  "den",
+                         "Fluss,", "während",                            "die",    "Sonne", "langsam",
+                         "hinter", "den",                                "Hügeln", "verschwand.",
+                         "Straße", "Geschwindigkeitsbegrenzungen",       "—",      "Œuvre"};
+  const int wordCount = sizeof(words) / sizeof(words[0]);
+  std::string text;
+  for (int p = 0; p < 12; ++p) {
+    int n = 20 + (p * 13) % 50;
+    for (int w = 0; w < n; ++w) {
+      text += words[(p + w * 7) % wordCount];
+      if (w + 1 < n)
+        text += ' ';
+    }
+    text += "\n";
+  }
+  return text;
+}
+
+LayoutStrategy::LayoutConfig makeConfig() {
+  LayoutStrategy::LayoutConfig config;
+  config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+  config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+  config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+  config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+  config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+  config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+  config.pageWidth = TestConfig::DISPLAY_WIDTH;
+  config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+  config.alignment = LayoutStrategy::ALIGN_LEFT;
+  config.language = Language::GERMAN;
+  return config;
+}
+
+// The previous renderPage: decode and look up every word's text again
+void printPage(const PageLayout& page, TextRenderer& renderer) {
+  for (size_t i = 0; i < page.getWordCount(); ++i) {
+    const PageLayout::WordRecord& word = page.getWord(i);
+    renderer.setFontStyle(static_cast<FontStyle>(word.style));
+    renderer.setCursor(word.x, word.y);
+    renderer.print(page.getText(word));
+  }
+}
+
+// Number of characters print() draws for a word
+size_t countCodepoints(const char* text) {
+  size_t count = 0;
+  for (const unsigned char* p = reinterpret_cast<const unsigned char*>(text); *p; ++p)
+    if ((*p & 0xC0) != 0x80)
+      ++count;
+  return count;
+}
+
+bool runsMatchStyles(const PageLayout& page) {
+  for (size_t i = 0; i < page.getWordCount(); ++i) {
+    const PageLayout::WordRecord& word = page.getWord(i);
+    PageLayout::GlyphRun run = page.getGlyphRun(i);
+    if (run.font != getFontVariant(&bookerlyFamily, static_cast<FontStyle>(word.style)) ||
+        run.count != countCodepoints(page.getText(word)))
+      return false;
+  }
+  return true;
+}
+
+void checkStrategy(TestUtils::TestRunner& runner, const char* name, LayoutStrategy& layout, TextRenderer& renderer,
+                   uint8_t* frame) {
+  std::string text = buildText();
+  StringWordProvider provider(String(text.c_str()));
+  LayoutStrategy::LayoutConfig config = makeConfig();
+  layout.setLanguage(config.language);
+  renderer.setFontFamily(&bookerlyFamily);
+  PageLayout page;
+  layout.layoutText(provider, renderer, config, page);
+
+  runner.expectTrue(page.getWordCount() > 50 && runsMatchStyles(page),
+                    std::string(name) + ": every word has a glyph run in its style's font",
+                    std::to_string(page.getWordCount()) + " words");
+
+  std::vector<uint8_t> expected(EInkDisplay::BUFFER_SIZE);
+  const TextRenderer::BitmapType types[] = {TextRenderer::BITMAP_BW, TextRenderer::BITMAP_GRAY_LSB,
+                                            TextRenderer::BITMAP_GRAY_MSB};
+  const char* typeNames[] = {"BW", "gray LSB", "gray MSB"};
+  for (int t = 0; t < 3; ++t) {
+    renderer.setBitmapType(types[t]);
+    memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+    printPage(page, renderer);
+    memcpy(expected.data(), frame, EInkDisplay::BUFFER_SIZE);
+    memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+    // A different style selected beforehand must not matter
+    renderer.setFontStyle(FontStyle::BOLD_ITALIC);
+    layout.renderPage(page, renderer, config);
+    runner.expectTrue(memcmp(expected.data(), frame, EInkDisplay::BUFFER_SIZE) == 0,
+                      std::string(name) + " " + typeNames[t] + ": glyph runs are bit-identical to print()");
+  }
+  renderer.setBitmapType(TextRenderer::BITMAP_BW);
+
+  // The next page reuses the arena
+  size_t capacity = page.getCapacityBytes();
+  uint32_t grown = page.getGrowCount();
+  provider.setPosition(page.endPosition);
+  layout.layoutText(provider, renderer, config, page);
+  runner.expectTrue(page.getWordCount() > 0 && runsMatchStyles(page) && page.getCapacityBytes() == capacity &&
+                        page.getGrowCount() == grown,
+                    std::string(name) + ": next page reuses the arena for its runs");
+
+  // Moving keeps the runs
+  memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+  layout.renderPage(page, renderer, config);
+  memcpy(expected.data(), frame, EInkDisplay::BUFFER_SIZE);
+  PageLayout moved(static_cast<PageLayout&&>(page));
+  memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+  layout.renderPage(moved, renderer, config);
+  runner.expectTrue(runsMatchStyles(moved) && memcmp(expected.data(), frame, EInkDisplay::BUFFER_SIZE) == 0,
+                    std::string(name) + ": a moved layout keeps its runs");
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Glyph Run Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  uint8_t* frame = display.getFrameBuffer();
+  renderer.setFrameBuffer(frame);
+
+  GreedyLayoutStrategy greedy;
+  checkStrategy(runner, "Greedy", greedy, renderer, frame);
+  KnuthPlassLayoutStrategy knuthPlass;
+  checkStrategy(runner, "Knuth-Plass", knuthPlass, renderer, frame);
+
+  // Missing glyphs and malformed UTF-8
+  {
+    const char* samples[] = {"snow\xE2\x98\x83man", "bad\xC3(byte", "cut\xE2\x82", "\xF0\x9F\x98\x80!", "plain"};
+    const SimpleGFXfont* font = getFontVariant(&bookerlyFamily, FontStyle::REGULAR);
+    renderer.setFont(font);
+    std::vector<uint8_t> expected(EInkDisplay::BUFFER_SIZE);
+    bool identical = true;
+    for (const char* sample : samples) {
+      memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+      renderer.setCursor(30, 100);
+      renderer.print(sample);
+      renderer.print("|");
+      memcpy(expected.data(), frame, EInkDisplay::BUFFER_SIZE);
+
+      size_t length = strlen(sample);
+      std::vector<uint16_t> glyphs(length);
+      std::vector<uint8_t> advances(length);
+      size_t count = TextRenderer::shapeText(font, sample, length, glyphs.data(), advances.data());
+      memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+      renderer.setCursor(30, 100);
+      renderer.drawGlyphRun(font, glyphs.data(), advances.data(), count);
+      renderer.print("|");
+      if (memcmp(expected.data(), frame, EInkDisplay::BUFFER_SIZE) != 0)
+        identical = false;
+    }
+    runner.expectTrue(identical, "runs with missing glyphs and malformed UTF-8 match print()");
+  }
+
+  // Words added without a font have no run and are printed
+  {
+    PageLayout page;
+    page.beginLine(LayoutStrategy::ALIGN_LEFT);
+    LayoutStrategy::Word word(WordText("Wasser", 6), 0, 40, 100, false, FontStyle::ITALIC);
+    page.addWord(word);
+    renderer.setFontFamily(&bookerlyFamily);
+    memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+    printPage(page, renderer);
+    std::vector<uint8_t> expected(frame, frame + EInkDisplay::BUFFER_SIZE);
+    memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+    GreedyLayoutStrategy layout;
+    layout.renderPage(page, renderer, makeConfig());
+    runner.expectTrue(page.getGlyphRun(0).font == nullptr &&
+                          memcmp(expected.data(), frame, EInkDisplay::BUFFER_SIZE) == 0,
+                      "unshaped words fall back to print()");
+  }
+
+  // Benchmark
+  {
+    std::string text = buildText();
+    StringWordProvider provider(String(text.c_str()));
+    LayoutStrategy::LayoutConfig config = makeConfig();
+    KnuthPlassLayoutStrategy layout;
+    layout.setLanguage(config.language);
+    renderer.setFontFamily(&bookerlyFamily);
+    PageLayout page;
+    layout.layoutText(provider, renderer, config, page);
+    const int rounds = 50;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      printPage(page, renderer);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      layout.renderPage(page, renderer, config);
+    auto t2 = std::chrono::steady_clock::now();
+    printf("  Benchmark (host): print %.3f ms/page, glyph runs %.3f ms/page; arena %zu bytes\n",
+           std::chrono::duration<double>(t1 - t0).count() * 1e3 / rounds,
+           std::chrono::duration<double>(t2 - t1).count() * 1e3 / rounds, page.getCapacityBytes());
+  }
+
+  return runner.allPassed() ? 0 : 1;
+}
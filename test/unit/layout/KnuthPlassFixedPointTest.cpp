@@ -0,0 +1,410 @@
+/**
+ * KnuthPlassFixedPointTest.cpp - Integer Knuth-Plass line breaker
+ *
+ * Compares the fixed-point line breaker against the previous floating point
+ * implementation (kept here as a reference):
+ * - Identical break decisions on generated paragraphs, with and without
+ *   hyphenated (split) words and oversized words. Where two break sets have
+ *   exactly the same demerits, the float version picks one depending on
+ *   rounding order; the fixed-point one must then pick an equally good set.
+ * - Saturated paragraphs: once total demerits reach 10000 the float version
+ *   cannot reach the paragraph end and leaves it unbroken. The fixed-point
+ *   version rebases its totals instead and must break these paragraphs as
+ *   well as a double precision reference without that limit.
+ * - Justified lines distribute the slack evenly and end flush at the margin
+ * - Cost: the float operations the float version performs per paragraph,
+ *   each a soft-float library call on the ESP32-C3 (no FPU); the fixed-point
+ *   version performs none. Host timings are printed for information only.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+
+namespace {
+
+typedef LayoutStrategy::Word Word;
+
+// A float that counts the operations performed on it. The ESP32-C3 has no
+// FPU, so each of them is a call into the soft-float library there (__addsf3,
+// __mulsf3, __divsf3, __ltsf2, __floatsisf, ...).
+struct CountedFloat {
+  float value;
+
+  static uint64_t addSubs;
+  static uint64_t muls;
+  static uint64_t divs;
+  static uint64_t compares;
+  static uint64_t conversions;
+
+  CountedFloat(float v = 0.0f) : value(v) {}
+  explicit CountedFloat(int v) : value(static_cast<float>(v)) {
+    ++conversions;
+  }
+
+  static uint64_t total() {
+    return addSubs + muls + divs + compares + conversions;
+  }
+  static void reset() {
+    addSubs = muls = divs = compares = conversions = 0;
+  }
+
+  friend CountedFloat operator+(CountedFloat a, CountedFloat b) {
+    ++addSubs;
+    return CountedFloat(a.value + b.value);
+  }
+  friend CountedFloat operator-(CountedFloat a, CountedFloat b) {
+    ++addSubs;
+    return CountedFloat(a.value - b.value);
+  }
+  friend CountedFloat operator*(CountedFloat a, CountedFloat b) {
+    ++muls;
+    return CountedFloat(a.value * b.value);
+  }
+  friend CountedFloat operator/(CountedFloat a, CountedFloat b) {
+    ++divs;
+    return CountedFloat(a.value / b.value);
+  }
+  CountedFloat& operator+=(CountedFloat b) {
+    return *this = *this + b;
+  }
+  friend bool operator<(CountedFloat a, CountedFloat b) {
+    ++compares;
+    return a.value < b.value;
+  }
+  friend bool operator>=(CountedFloat a, CountedFloat b) {
+    ++compares;
+    return a.value >= b.value;
+  }
+};
+
+uint64_t CountedFloat::addSubs = 0;
+uint64_t CountedFloat::muls = 0;
+uint64_t CountedFloat::divs = 0;
+uint64_t CountedFloat::compares = 0;
+uint64_t CountedFloat::conversions = 0;
+
+// The floating point line breaker this strategy used before it moved to
+// fixed point (with Real = float). Break decisions must stay identical.
+// Returns false if the paragraph end was unreachable because total demerits
+// reached `infinityPenalty` (10000 in the float version); the paragraph is
+// then left on one line.
+template <typename Real>
+bool referenceBreaks(const std::vector<Word>& words, int16_t maxWidth, int16_t spaceWidth,
+                     std::vector<size_t>& breaks, Real infinityPenalty = Real(10000.0f)) {
+  breaks.clear();
+  if (words.empty())
+    return true;
+  size_t n = words.size();
+  std::vector<Real> minDemerits(n + 1, infinityPenalty);
+  std::vector<int> prevBreak(n + 1, -1);
+  minDemerits[0] = Real(0.0f);
+
+  for (size_t i = 0; i < n; i++) {
+    if (minDemerits[i] >= infinityPenalty)
+      continue;
+    int16_t lineWidth = 0;
+    for (size_t j = i; j < n; j++) {
+      if (j > i)
+        lineWidth += spaceWidth;
+      lineWidth += words[j].width;
+      if (lineWidth > maxWidth) {
+        if (j == i) {
+          Real totalDemerits = minDemerits[i] + Real(150.0f);
+          if (totalDemerits < minDemerits[j + 1]) {
+            minDemerits[j + 1] = totalDemerits;
+            prevBreak[j + 1] = i;
+          }
+        }
+        break;
+      }
+      Real demerits = Real(0.0f);
+      if (j != n - 1) {
+        Real badness = Real(0.0f);
+        if (lineWidth != maxWidth) {
+          Real ratio = Real(maxWidth - lineWidth) / Real(static_cast<int>(maxWidth));
+          badness = ratio * ratio * ratio * Real(100.0f);
+        }
+        demerits = (Real(1.0f) + badness) * (Real(1.0f) + badness);
+      }
+      demerits += Real(50.0f);
+      Real totalDemerits = minDemerits[i] + demerits;
+      if (totalDemerits < minDemerits[j + 1]) {
+        minDemerits[j + 1] = totalDemerits;
+        prevBreak[j + 1] = i;
+      }
+      if (words[j].wasSplit)
+        break;
+    }
+  }
+
+  bool reached = prevBreak[n] >= 0;
+  int pos = n;
+  while (pos > 0 && prevBreak[pos] >= 0) {
+    breaks.push_back(pos);
+    pos = prevBreak[pos];
+  }
+  std::reverse(breaks.begin(), breaks.end());
+  if (!breaks.empty() && breaks.back() == n)
+    breaks.pop_back();
+  return reached;
+}
+
+// Exact (double precision) demerits of a break set, used to recognise ties
+double exactDemerits(const std::vector<Word>& words, const std::vector<size_t>& breaks, int16_t maxWidth,
+                     int16_t spaceWidth) {
+  double total = 0.0;
+  size_t start = 0;
+  for (size_t b = 0; b <= breaks.size(); ++b) {
+    size_t end = b < breaks.size() ? breaks[b] : words.size();
+    int width = 0;
+    for (size_t k = start; k < end; ++k)
+      width += words[k].width + (k > start ? spaceWidth : 0);
+    if (width > maxWidth) {
+      total += 150.0;
+    } else {
+      double ratio = static_cast<double>(maxWidth - width) / maxWidth;
+      double badness = ratio * ratio * ratio * 100.0;
+      total += (end == words.size() ? 0.0 : (1.0 + badness) * (1.0 + badness)) + 50.0;
+    }
+    start = end;
+  }
+  return total;
+}
+
+// Deterministic paragraph generator (word widths as a proportional font would produce)
+struct Lcg {
+  uint32_t state;
+  explicit Lcg(uint32_t seed) : state(seed) {}
+  uint32_t next(uint32_t range) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) % range;
+  }
+};
+
+std::vector<Word> makeParagraph(Lcg& rng, size_t count, int16_t maxWidth) {
+  std::vector<Word> words;
+  for (size_t i = 0; i < count; ++i) {
+    int16_t width = static_cast<int16_t>(12 + rng.next(110));
+    if (rng.next(40) == 0)
+      width = static_cast<int16_t>(maxWidth + rng.next(60));  // oversized word
+    bool split = rng.next(25) == 0;
+    words.push_back(Word(WordText(), width, 0, 0, split));
+  }
+  return words;
+}
+
+// Same break set, or a different one with exactly the same demerits
+bool sameOrTie(const std::vector<Word>& words, const std::vector<size_t>& expected, const std::vector<size_t>& actual,
+               int16_t maxWidth, int16_t spaceWidth, int& ties) {
+  if (expected == actual)
+    return true;
+  if (expected.size() != actual.size() ||
+      std::abs(exactDemerits(words, expected, maxWidth, spaceWidth) -
+               exactDemerits(words, actual, maxWidth, spaceWidth)) >= 1e-6)
+    return false;
+  ++ties;
+  return true;
+}
+
+void checkBreakDecisions(TestUtils::TestRunner& runner) {
+  KnuthPlassLayoutStrategy strategy;
+  Lcg rng(12345);
+  int mismatches = 0;
+  int ties = 0;
+  int saturated = 0;
+  int saturatedMismatches = 0;
+  int paragraphs = 0;
+  std::vector<size_t> expected;
+  std::vector<size_t> actual;
+  const int16_t widths[] = {460, 300, 180};
+  for (int16_t maxWidth : widths) {
+    for (int16_t spaceWidth = 6; spaceWidth <= 14; spaceWidth += 4) {
+      strategy.setSpaceWidth(spaceWidth);
+      for (int p = 0; p < 400; ++p) {
+        std::vector<Word> words = makeParagraph(rng, 1 + rng.next(90), maxWidth);
+        bool reached = referenceBreaks<float>(words, maxWidth, spaceWidth, expected);
+        strategy.test_calculateBreaks(words, maxWidth, actual);
+        if (!reached) {
+          // Beyond the float version's limit: compare with an unlimited reference
+          ++saturated;
+          referenceBreaks<double>(words, maxWidth, spaceWidth, expected, HUGE_VAL);
+          if (!sameOrTie(words, expected, actual, maxWidth, spaceWidth, ties) && saturatedMismatches++ == 0)
+            std::cerr << "  first saturated mismatch: width " << maxWidth << ", space " << spaceWidth << ", "
+                      << words.size() << " words\n";
+        } else if (!sameOrTie(words, expected, actual, maxWidth, spaceWidth, ties) && mismatches++ == 0) {
+          std::cerr << "  first mismatch: width " << maxWidth << ", space " << spaceWidth << ", " << words.size()
+                    << " words\n";
+        }
+        ++paragraphs;
+      }
+    }
+  }
+  runner.expectTrue(mismatches == 0, "break decisions match the floating point reference",
+                    std::to_string(mismatches) + " of " + std::to_string(paragraphs) + " paragraphs differ");
+  runner.expectTrue(saturated > 0 && saturatedMismatches == 0,
+                    "saturated paragraphs are broken like an unlimited reference",
+                    std::to_string(saturatedMismatches) + " of " + std::to_string(saturated) + " paragraphs differ");
+  std::cout << "  " << paragraphs << " paragraphs: " << ties << " exact ties resolved differently, " << saturated
+            << " beyond the float version's demerits limit\n";
+}
+
+String buildText() {
+  static const char* words[] = {"Die",   "Donaudampfschifffahrt", "fuhr",    "über",  "den",     "Fluss,",
+                                "a",     "während",               "die",     "Sonne", "langsam", "hinter",
+                                "Hügeln", "verschwand.",          "Kindergarten-Spielplatz"};
+  const int wordCount = sizeof(words) / sizeof(words[0]);
+  std::string text;
+  for (int p = 0; p < 30; ++p) {
+    int n = 15 + (p * 11) % 70;
+    for (int w = 0; w < n; ++w) {
+      text += words[(p * 5 + w * 7) % wordCount];
+      if (w + 1 < n)
+        text += ' ';
+    }
+    text += "\n";
+  }
+  return String(text.c_str());
+}
+
+// Every line either ends flush at the right margin (justified), uses plain
+// spaces (last line of a paragraph) or hit the stretch limit; gaps within a
+// line never differ by more than one pixel.
+void checkJustification(TestUtils::TestRunner& runner, TextRenderer& renderer) {
+  LayoutStrategy::LayoutConfig config;
+  config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+  config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+  config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+  config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+  config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+  config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+  config.pageWidth = TestConfig::DISPLAY_WIDTH;
+  config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+  config.alignment = LayoutStrategy::ALIGN_LEFT;
+  config.language = Language::GERMAN;
+
+  KnuthPlassLayoutStrategy strategy;
+  strategy.setLanguage(config.language);
+  StringWordProvider provider(buildText());
+  renderer.setFontStyle(FontStyle::REGULAR);
+  uint16_t spaceWidth = 0;
+  renderer.getTextBounds(" ", 0, 0, nullptr, nullptr, &spaceWidth, nullptr);
+  const int16_t rightEdge = config.pageWidth - config.marginRight;
+
+  int flushLines = 0;
+  int badLines = 0;
+  LayoutStrategy::PageLayout page;
+  int start = provider.getCurrentIndex();
+  for (int pageIndex = 0; pageIndex < 100; ++pageIndex) {
+    provider.setPosition(start);
+    strategy.layoutText(provider, renderer, config, page);
+    for (size_t line = 0; line < page.getLineCount(); ++line) {
+      size_t count = page.getLine(line).wordCount;
+      if (count < 2)
+        continue;
+      int minGap = 1 << 15;
+      int maxGap = 0;
+      for (size_t i = 0; i + 1 < count; ++i) {
+        Word a = page.getLineWord(line, i);
+        Word b = page.getLineWord(line, i + 1);
+        int gap = b.x - (a.x + a.width);
+        minGap = std::min(minGap, gap);
+        maxGap = std::max(maxGap, gap);
+      }
+      Word last = page.getLineWord(line, count - 1);
+      bool flush = last.x + last.width == rightEdge;
+      bool plain = minGap == spaceWidth && maxGap == spaceWidth;
+      bool limited = minGap >= 4 * spaceWidth - 1;
+      if (flush && !plain)
+        ++flushLines;
+      if (maxGap - minGap > 1 || !(flush || plain || limited))
+        ++badLines;
+    }
+    if (page.endPosition <= start || provider.getPercentage(page.endPosition) >= 1.0f)
+      break;
+    start = page.endPosition;
+  }
+  runner.expectTrue(flushLines > 50 && badLines == 0, "justified lines end flush at the margin",
+                    std::to_string(flushLines) + " flush lines, " + std::to_string(badLines) + " bad lines");
+}
+
+// Float operations of the float version per paragraph (soft-float calls on
+// the device; the fixed-point version makes none), and host timings. The
+// host has an FPU, so the timings say nothing about the ESP32-C3.
+void benchmark() {
+  KnuthPlassLayoutStrategy strategy;
+  const int16_t maxWidth = 460;
+  const int16_t spaceWidth = 10;
+  strategy.setSpaceWidth(spaceWidth);
+  Lcg rng(777);
+  std::vector<std::vector<Word>> paragraphs;
+  for (int p = 0; p < 200; ++p)
+    paragraphs.push_back(makeParagraph(rng, 40 + rng.next(80), maxWidth));
+
+  std::vector<size_t> breaks;
+  CountedFloat::reset();
+  for (const std::vector<Word>& words : paragraphs)
+    referenceBreaks<CountedFloat>(words, maxWidth, spaceWidth, breaks);
+  const double perParagraph = 1.0 / paragraphs.size();
+  printf("  Float version, per paragraph: %.0f soft-float calls (%.0f add/sub, %.0f mul, %.0f div, %.0f compare, "
+         "%.0f int->float); fixed point: 0\n",
+         CountedFloat::total() * perParagraph, CountedFloat::addSubs * perParagraph, CountedFloat::muls * perParagraph,
+         CountedFloat::divs * perParagraph, CountedFloat::compares * perParagraph,
+         CountedFloat::conversions * perParagraph);
+
+  size_t checksum = 0;
+  const int rounds = 50;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    for (const std::vector<Word>& words : paragraphs) {
+      referenceBreaks<float>(words, maxWidth, spaceWidth, breaks);
+      checksum += breaks.size();
+    }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    for (const std::vector<Word>& words : paragraphs) {
+      strategy.test_calculateBreaks(words, maxWidth, breaks);
+      checksum += breaks.size();
+    }
+  auto t2 = std::chrono::steady_clock::now();
+
+  double count = static_cast<double>(rounds * paragraphs.size());
+  double floatUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / count;
+  double fixedUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / count;
+  printf("  Host timing (hardware FPU), per paragraph: float %.2f us, fixed point %.2f us (checksum %zu)\n", floatUs,
+         fixedUs, checksum);
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Knuth-Plass Fixed Point Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  renderer.setFontFamily(&bookerlyFamily);
+
+  checkBreakDecisions(runner);
+  checkJustification(runner, renderer);
+  benchmark();
+
+  return runner.allPassed() ? 0 : 1;
+}
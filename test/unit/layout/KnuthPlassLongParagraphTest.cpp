@@ -0,0 +1,204 @@
+/**
+ * KnuthPlassLongParagraphTest.cpp - Active-node line breaking of long paragraphs
+ *
+ * Checks the Knuth-Plass breaker against an unbounded optimal line breaker
+ * (double precision, one entry per word):
+ * - Paragraphs that fit in the breakpoint window are broken optimally
+ * - A 20,000-word paragraph keeps at most MAX_BREAK_NODES breakpoints, stays
+ *   within 1% of the optimum and never produces overfull lines
+ * - Split (hyphenated) words always end a line
+ * - Breakpoints visited per word stay flat from 2,000 to 20,000 words (host
+ *   timings are printed, not checked)
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "test_utils.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+
+namespace {
+
+typedef LayoutStrategy::Word Word;
+
+const int16_t MAX_WIDTH = 460;
+const int16_t SPACE_WIDTH = 10;
+
+struct Lcg {
+  uint32_t state;
+  explicit Lcg(uint32_t seed) : state(seed) {}
+  uint32_t next(uint32_t range) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) % range;
+  }
+};
+
+std::vector<Word> makeParagraph(Lcg& rng, size_t count) {
+  std::vector<Word> words;
+  words.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    int16_t width = static_cast<int16_t>(12 + rng.next(110));
+    bool split = rng.next(30) == 0;
+    words.push_back(Word(WordText(), width, 0, 0, split));
+  }
+  return words;
+}
+
+int lineWidth(const std::vector<Word>& words, size_t start, size_t end) {
+  int width = 0;
+  for (size_t k = start; k < end; ++k)
+    width += words[k].width + (k > start ? SPACE_WIDTH : 0);
+  return width;
+}
+
+double lineDemerits(const std::vector<Word>& words, size_t start, size_t end) {
+  int width = lineWidth(words, start, end);
+  if (width > MAX_WIDTH)
+    return 150.0;
+  if (end == words.size())
+    return 50.0;
+  double ratio = static_cast<double>(MAX_WIDTH - width) / MAX_WIDTH;
+  double badness = ratio * ratio * ratio * 100.0;
+  return (1.0 + badness) * (1.0 + badness) + 50.0;
+}
+
+double totalDemerits(const std::vector<Word>& words, const std::vector<size_t>& breaks) {
+  double total = 0.0;
+  size_t start = 0;
+  for (size_t b = 0; b <= breaks.size(); ++b) {
+    size_t end = b < breaks.size() ? breaks[b] : words.size();
+    total += lineDemerits(words, start, end);
+    start = end;
+  }
+  return total;
+}
+
+// Optimal total demerits without any window or demerits limit
+double optimalDemerits(const std::vector<Word>& words) {
+  size_t n = words.size();
+  std::vector<double> best(n + 1, 1e300);
+  best[0] = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    if (best[i] >= 1e300)
+      continue;
+    for (size_t j = i; j < n; ++j) {
+      if (lineWidth(words, i, j + 1) > MAX_WIDTH && j > i)
+        break;
+      double total = best[i] + lineDemerits(words, i, j + 1);
+      if (total < best[j + 1])
+        best[j + 1] = total;
+      if (words[j].wasSplit || lineWidth(words, i, j + 1) > MAX_WIDTH)
+        break;
+    }
+  }
+  return best[n];
+}
+
+// No overfull lines (other than oversized single words), breaks in order and
+// every split word ends its line
+bool validBreaks(const std::vector<Word>& words, const std::vector<size_t>& breaks) {
+  size_t start = 0;
+  for (size_t b = 0; b <= breaks.size(); ++b) {
+    size_t end = b < breaks.size() ? breaks[b] : words.size();
+    if (end <= start)
+      return false;
+    if (end - start > 1 && lineWidth(words, start, end) > MAX_WIDTH)
+      return false;
+    for (size_t k = start; k + 1 < end; ++k)
+      if (words[k].wasSplit)
+        return false;
+    start = end;
+  }
+  return true;
+}
+
+double secondsPerWord(KnuthPlassLayoutStrategy& strategy, const std::vector<Word>& words, int rounds) {
+  std::vector<size_t> breaks;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    strategy.test_calculateBreaks(words, MAX_WIDTH, breaks);
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(t1 - t0).count() / (static_cast<double>(rounds) * words.size());
+}
+
+// Breakpoints the breaker visits per word of `words`
+double visitsPerWord(const std::vector<Word>& words) {
+  KnuthPlassLayoutStrategy strategy;
+  strategy.setSpaceWidth(SPACE_WIDTH);
+  std::vector<size_t> breaks;
+  strategy.test_calculateBreaks(words, MAX_WIDTH, breaks);
+  return static_cast<double>(strategy.getBreakNodeVisits()) / words.size();
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Knuth-Plass Long Paragraph Test");
+
+  Lcg rng(2024);
+  std::vector<size_t> breaks;
+
+  // Paragraphs within the window are broken optimally
+  {
+    KnuthPlassLayoutStrategy strategy;
+    strategy.setSpaceWidth(SPACE_WIDTH);
+    int worse = 0;
+    int invalid = 0;
+    for (int p = 0; p < 60; ++p) {
+      std::vector<Word> words = makeParagraph(rng, 100 + rng.next(380));
+      strategy.test_calculateBreaks(words, MAX_WIDTH, breaks);
+      if (!validBreaks(words, breaks))
+        ++invalid;
+      // Fixed-point rounding may pick a set that is worse by a rounding error
+      if (totalDemerits(words, breaks) > optimalDemerits(words) + 1e-2)
+        ++worse;
+    }
+    runner.expectTrue(invalid == 0 && worse == 0, "paragraphs within the window are optimal",
+                      std::to_string(worse) + " suboptimal, " + std::to_string(invalid) + " invalid");
+    runner.expectTrue(strategy.getPeakBreakNodes() <= KnuthPlassLayoutStrategy::MAX_BREAK_NODES,
+                      "window paragraphs fit in the breakpoint pool");
+  }
+
+  // 20,000 words in one paragraph: bounded memory, near-optimal, valid
+  std::vector<Word> longParagraph = makeParagraph(rng, 20000);
+  {
+    KnuthPlassLayoutStrategy strategy;
+    strategy.setSpaceWidth(SPACE_WIDTH);
+    strategy.test_calculateBreaks(longParagraph, MAX_WIDTH, breaks);
+    double actual = totalDemerits(longParagraph, breaks);
+    double optimal = optimalDemerits(longParagraph);
+    runner.expectTrue(validBreaks(longParagraph, breaks) && breaks.size() > 1000, "long paragraph breaks are valid",
+                      std::to_string(breaks.size()) + " breaks");
+    runner.expectTrue(strategy.getPeakBreakNodes() <= KnuthPlassLayoutStrategy::MAX_BREAK_NODES,
+                      "long paragraph keeps a bounded number of breakpoints",
+                      std::to_string(strategy.getPeakBreakNodes()) + " breakpoints");
+    runner.expectTrue(actual <= optimal * 1.01, "long paragraph is within 1% of the optimum",
+                      std::to_string(actual) + " vs " + std::to_string(optimal));
+    printf("  20000 words: %zu lines, demerits %.1f (optimum %.1f), peak %zu breakpoints\n", breaks.size() + 1,
+           actual, optimal, strategy.getPeakBreakNodes());
+  }
+
+  // Near-linear work: breakpoints visited per word do not grow with the
+  // paragraph length. Host timings are printed for reference only.
+  {
+    std::vector<Word> shortParagraph(longParagraph.begin(), longParagraph.begin() + 2000);
+    double shortVisits = visitsPerWord(shortParagraph);
+    double longVisits = visitsPerWord(longParagraph);
+    printf("  Breakpoints visited: 2000 words %.2f/word, 20000 words %.2f/word\n", shortVisits, longVisits);
+    runner.expectTrue(longVisits <= shortVisits * 1.25, "work per word does not grow with paragraph length",
+                      std::to_string(shortVisits) + " vs " + std::to_string(longVisits));
+
+    KnuthPlassLayoutStrategy strategy;
+    strategy.setSpaceWidth(SPACE_WIDTH);
+    secondsPerWord(strategy, shortParagraph, 5);  // warm-up
+    double shortTime = secondsPerWord(strategy, shortParagraph, 50);
+    double longTime = secondsPerWord(strategy, longParagraph, 5);
+    printf("  Benchmark (host): 2000 words %.1f ns/word, 20000 words %.1f ns/word\n", shortTime * 1e9,
+           longTime * 1e9);
+  }
+
+  return runner.allPassed() ? 0 : 1;
+}
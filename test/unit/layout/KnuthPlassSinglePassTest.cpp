@@ -0,0 +1,203 @@
+/**
+ * KnuthPlassSinglePassTest.cpp - Knuth-Plass pages laid out in one pass over the provider
+ *
+ * - Laying out a page reads every word from the provider at most once
+ * - Chaining pages by endPosition reproduces the text exactly, including pages
+ *   that end in the middle of a paragraph or inside a hyphenated word
+ * - No line is wider than the page, and long words are hyphenated
+ * - Each page gets exactly the lines the break pass chose for it
+ * - getPreviousPageStart returns a page start whose page reaches the current one
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+
+namespace {
+
+// Counts how often each word is read
+class CountingProvider : public StringWordProvider {
+ public:
+  explicit CountingProvider(const String& text) : StringWordProvider(text) {}
+
+  void getNextToken(WordToken& out) override {
+    int index = getCurrentIndex();
+    StringWordProvider::getNextToken(out);
+    if (counting && !out.is('\n') && !(out.length > 0 && out.text[0] == ' '))
+      reads[index]++;
+  }
+
+  bool counting = false;
+  std::map<int, int> reads;
+};
+
+std::string buildText() {
+  const char* words[] = {"Die",    "Donaudampfschifffahrtsgesellschaft", "fuhr",   "über",  "den",
+                         "Fluss,", "während",                            "die",    "Sonne", "langsam",
+                         "hinter", "den",                                "Hügeln", "verschwand.",
+                         "Kindergarten-Spielplatz", "Geschwindigkeitsbegrenzungen", "und", "Verantwortung"};
+  const int wordCount = sizeof(words) / sizeof(words[0]);
+  std::string text;
+  for (int p = 0; p < 30; ++p) {
+    // Mostly short paragraphs, some much longer than a page
+    int n = (p % 7 == 3) ? 400 : 15 + (p * 11) % 60;
+    for (int w = 0; w < n; ++w) {
+      text += words[(p + w * 5) % wordCount];
+      if (w + 1 < n)
+        text += ' ';
+    }
+    text += (p % 5 == 4) ? "\n\n" : "\n";
+  }
+  return text;
+}
+
+// Words of the text joined by single spaces, without hyphens
+std::string expectedText(const std::string& text) {
+  std::string result;
+  bool space = false;
+  for (char c : text) {
+    if (c == ' ' || c == '\n' || c == '\r') {
+      space = !result.empty();
+    } else if (c != '-') {
+      if (space)
+        result += ' ';
+      space = false;
+      result += c;
+    }
+  }
+  return result;
+}
+
+// Append the words of a page, joining split words with the next word
+void appendPageText(const LayoutStrategy::PageLayout& page, std::string& result, bool& joinNext) {
+  for (size_t i = 0; i < page.getWordCount(); ++i) {
+    const LayoutStrategy::PageLayout::WordRecord& word = page.getWord(i);
+    if (!result.empty() && !joinNext)
+      result += ' ';
+    for (const char* c = page.getText(word); *c; ++c)
+      if (*c != '-')
+        result += *c;
+    joinNext = (word.flags & LayoutStrategy::PageLayout::FLAG_SPLIT) != 0;
+  }
+}
+
+LayoutStrategy::LayoutConfig makeConfig() {
+  LayoutStrategy::LayoutConfig config;
+  config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+  config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+  config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+  config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+  config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+  config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+  config.pageWidth = TestConfig::DISPLAY_WIDTH;
+  config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+  config.alignment = LayoutStrategy::ALIGN_LEFT;
+  config.language = Language::GERMAN;
+  return config;
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Knuth-Plass Single Pass Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  renderer.setFontFamily(&bookerlyFamily);
+
+  std::string text = buildText();
+  CountingProvider provider(String(text.c_str()));
+  KnuthPlassLayoutStrategy layout;
+  LayoutStrategy::LayoutConfig config = makeConfig();
+  layout.setLanguage(config.language);
+  const int16_t rightEdge = config.pageWidth - config.marginRight;
+
+  std::vector<int> pageStarts;
+  std::string laidOut;
+  bool joinNext = false;
+  int rereadWords = 0;
+  int overfullLines = 0;
+  int splitWords = 0;
+  int midParagraphEnds = 0;
+  LayoutStrategy::PageLayout page;
+
+  int position = 0;
+  provider.setPosition(0);
+  layout.resetLineCountMismatch();
+  while (provider.hasNextWord() && pageStarts.size() < 1000) {
+    pageStarts.push_back(position);
+    provider.reads.clear();
+    provider.counting = true;
+    layout.layoutText(provider, renderer, config, page);
+    provider.counting = false;
+
+    for (std::map<int, int>::const_iterator it = provider.reads.begin(); it != provider.reads.end(); ++it)
+      if (it->second > 1)
+        ++rereadWords;
+
+    for (size_t l = 0; l < page.getLineCount(); ++l) {
+      const LayoutStrategy::PageLayout::LineRecord& line = page.getLine(l);
+      if (line.wordCount > 1) {
+        const LayoutStrategy::PageLayout::WordRecord& last = page.getWord(line.firstWord + line.wordCount - 1);
+        if (last.x + last.width > rightEdge)
+          ++overfullLines;
+      }
+    }
+    for (size_t i = 0; i < page.getWordCount(); ++i)
+      if (page.getWord(i).flags & LayoutStrategy::PageLayout::FLAG_SPLIT)
+        ++splitWords;
+
+    appendPageText(page, laidOut, joinNext);
+    if (page.endPosition <= position)
+      break;
+    if (text[page.endPosition - 1] != '\n')
+      ++midParagraphEnds;
+    position = page.endPosition;
+    provider.setPosition(position);
+  }
+
+  runner.expectTrue(pageStarts.size() > 10 && !provider.hasNextWord(), "pages chain to the end of the text",
+                    std::to_string(pageStarts.size()) + " pages");
+  runner.expectTrue(rereadWords == 0, "no word is read twice while laying out a page",
+                    std::to_string(rereadWords) + " words read again");
+  runner.expectTrue(laidOut == expectedText(text), "chained pages reproduce the text");
+  runner.expectTrue(midParagraphEnds > 0, "pages end in the middle of paragraphs",
+                    std::to_string(midParagraphEnds) + " pages");
+  runner.expectTrue(overfullLines == 0, "no overfull lines", std::to_string(overfullLines) + " lines");
+  runner.expectTrue(splitWords > 0, "long words are hyphenated", std::to_string(splitWords) + " split words");
+  runner.expectTrue(!layout.hasLineCountMismatch(), "every line the break pass chose is placed",
+                    std::to_string(layout.getExpectedLineCount()) + " chosen, " +
+                        std::to_string(layout.getActualLineCount()) + " placed");
+
+  // Previous page: starts before the current page and its page reaches it
+  int badPrevious = 0;
+  for (size_t k = 1; k < pageStarts.size(); ++k) {
+    provider.setPosition(pageStarts[k]);
+    int previous = layout.getPreviousPageStart(provider, renderer, config, pageStarts[k]);
+    if (provider.getCurrentIndex() != pageStarts[k]) {
+      ++badPrevious;
+      continue;
+    }
+    provider.setPosition(previous);
+    layout.layoutText(provider, renderer, config, page);
+    if (previous >= pageStarts[k] || page.endPosition < pageStarts[k])
+      ++badPrevious;
+  }
+  runner.expectTrue(badPrevious == 0, "previous page start reaches the current page",
+                    std::to_string(badPrevious) + " of " + std::to_string(pageStarts.size() - 1) + " pages");
+
+  return runner.allPassed() ? 0 : 1;
+}
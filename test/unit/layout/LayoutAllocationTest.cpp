@@ -0,0 +1,313 @@
+/**
+ * LayoutAllocationTest.cpp - Heap allocations on the page layout hot path
+ *
+ * Counts calls to the global operator new while reading tokens and laying out
+ * pages:
+ * - Reading and measuring tokens from File/StringWordProvider does not allocate
+ * - Page layout into a reused PageLayout with German hyphenation does not
+ *   allocate once warmed up
+ * - PageLayout records stay compact and the arena is reused across pages
+ * - A word that does not fit the arena is refused, and a page that runs out
+ *   of room ends after the last word stored
+ * - Token widths match getTextBounds() on the same text
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "WString.h"
+#include "content/providers/FileWordProvider.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/GreedyLayoutStrategy.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+  ++g_allocations;
+  void* p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+
+namespace {
+
+const char* TEST_FILE = "test/output/layout_allocation_test.txt";
+
+std::string buildText() {
+  const char* words[] = {"Die", "Donaudampfschifffahrt", "fuhr", "über", "den", "Fluss,", "während", "die",
+                         "Sonne", "langsam", "hinter", "den", "Hügeln", "verschwand."};
+  std::string text;
+  for (int p = 0; p < 40; ++p) {
+    int n = 20 + (p * 7) % 50;
+    for (int w = 0; w < n; ++w) {
+      text += words[(p + w * 3) % 14];
+      if (w + 1 < n)
+        text += ' ';
+    }
+    text += (p % 3 == 0) ? "\r\n" : "\n";
+  }
+  return text;
+}
+
+// Read every token forward and measure it; returns the token count
+int readAndMeasure(WordProvider& provider, TextRenderer& renderer, bool& widthsMatch) {
+  int tokens = 0;
+  WordToken token;
+  provider.reset();
+  char buf[256];
+  while (provider.hasNextWord()) {
+    provider.getNextToken(token);
+    renderer.setFontStyle(token.style);
+    uint16_t w = renderer.getTextWidth(token.text, token.length);
+    if (token.length < sizeof(buf)) {
+      // Compare against the NUL-terminated measurement (stack copy, no heap)
+      for (uint16_t i = 0; i < token.length; ++i)
+        buf[i] = token.text[i];
+      buf[token.length] = '\0';
+      uint16_t bw = 0;
+      renderer.getTextBounds(buf, 0, 0, nullptr, nullptr, &bw, nullptr);
+      if (bw != w)
+        widthsMatch = false;
+    }
+    ++tokens;
+  }
+  return tokens;
+}
+
+int readBackward(WordProvider& provider) {
+  int tokens = 0;
+  WordToken token;
+  int lastIndex = -1;
+  while (provider.hasPrevWord() && provider.getCurrentIndex() != lastIndex) {
+    lastIndex = provider.getCurrentIndex();
+    provider.getPrevToken(token);
+    ++tokens;
+  }
+  return tokens;
+}
+
+LayoutStrategy::LayoutConfig makeConfig() {
+  LayoutStrategy::LayoutConfig config;
+  config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+  config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+  config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+  config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+  config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+  config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+  config.pageWidth = TestConfig::DISPLAY_WIDTH;
+  config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+  config.alignment = LayoutStrategy::ALIGN_LEFT;
+  config.language = Language::GERMAN;
+  return config;
+}
+
+// Lay out every page twice (the first pass warms up reusable buffers) and
+// check that the second pass does not allocate at all, German hyphenation of
+// every word (KnuthPlass) or of every overflowing word (Greedy) included
+void checkLayout(TestUtils::TestRunner& runner, LayoutStrategy& layout, WordProvider& provider, TextRenderer& renderer,
+                 const char* name) {
+  LayoutStrategy::LayoutConfig config = makeConfig();
+  layout.setLanguage(config.language);
+  size_t allocations = 0;
+  size_t lines = 0;
+  size_t words = 0;
+  LayoutStrategy::PageLayout result;
+  for (int pass = 0; pass < 2; ++pass) {
+    provider.reset();
+    int start = provider.getCurrentIndex();
+    for (int page = 0; page < 100; ++page) {
+      provider.setPosition(start);
+      size_t before = g_allocations;
+      layout.layoutText(provider, renderer, config, result);
+      if (pass == 1) {
+        allocations += g_allocations - before;
+        lines += result.getLineCount();
+        for (size_t i = 0; i < result.getLineCount(); ++i)
+          words += result.getLine(i).wordCount;
+      }
+      if (result.endPosition <= start || provider.getPercentage(result.endPosition) >= 1.0f)
+        break;
+      start = result.endPosition;
+    }
+  }
+  runner.expectTrue(words > 2 * lines && allocations == 0, std::string(name) + ": no per-word allocations",
+                    std::to_string(allocations) + " allocations for " + std::to_string(lines) + " lines / " +
+                        std::to_string(words) + " words");
+}
+
+// Arena bookkeeping: records are compact, text is stored NUL-terminated and
+// reset() keeps the arena for the next page
+void checkPageLayout(TestUtils::TestRunner& runner) {
+  runner.expectTrue(sizeof(LayoutStrategy::PageLayout::WordRecord) <= 12, "WordRecord is at most 12 bytes",
+                    std::to_string(sizeof(LayoutStrategy::PageLayout::WordRecord)));
+
+  LayoutStrategy::PageLayout page;
+  page.beginLine(LayoutStrategy::ALIGN_CENTER);
+  page.addWord(LayoutStrategy::Word(WordText("Fluss,", 6), 40, 10, 20, false, FontStyle::BOLD));
+  page.addWord(LayoutStrategy::Word(WordText("Donau-", 6), 44, 60, 20, true));
+  page.beginLine(LayoutStrategy::ALIGN_LEFT);
+  bool ok = page.getLineCount() == 2 && page.getWordCount() == 2 && page.getLine(0).wordCount == 2 &&
+            page.getLine(1).wordCount == 0 && page.getLineAlignment(0) == LayoutStrategy::ALIGN_CENTER;
+  LayoutStrategy::Word w = page.getLineWord(0, 1);
+  ok = ok && std::string(page.getText(page.getWord(0))) == "Fluss," && w.text.length() == 6 &&
+       std::string(w.text.c_str()) == "Donau-" && w.wasSplit && w.x == 60 && w.width == 44 &&
+       page.getWord(0).style == static_cast<uint8_t>(FontStyle::BOLD);
+  runner.expectTrue(ok, "PageLayout stores lines, words and text");
+
+  size_t capacity = page.getCapacityBytes();
+  page.reset();
+  runner.expectTrue(page.getLineCount() == 0 && page.getWordCount() == 0 && page.getCapacityBytes() == capacity,
+                    "reset() keeps the arena");
+
+  // Grows once past the defaults and keeps earlier words intact
+  page.beginLine(LayoutStrategy::ALIGN_LEFT);
+  for (size_t i = 0; i < LayoutStrategy::PageLayout::DEFAULT_MAX_WORDS + 10; ++i)
+    page.addWord(LayoutStrategy::Word(WordText("word", 4), 30, 0, 0, false));
+  runner.expectTrue(page.getWordCount() == LayoutStrategy::PageLayout::DEFAULT_MAX_WORDS + 10 &&
+                        page.getGrowCount() == 1 && std::string(page.getText(page.getWord(0))) == "word",
+                    "arena grows and keeps its content", std::to_string(page.getGrowCount()) + " grows");
+
+  // Word text is limited to 64 KB: a word past it is refused and not stored
+  bool added = true;
+  while (added && page.getWordCount() < 0xFFFF)
+    added = page.addWord(LayoutStrategy::Word(WordText("word", 4), 30, 0, 0, false));
+  const size_t stored = page.getWordCount();
+  runner.expectTrue(!added && stored < 0xFFFF && !page.addWord(LayoutStrategy::Word(WordText("w", 1), 8, 0, 0, false)) &&
+                        page.getWordCount() == stored,
+                    "a word that does not fit is refused", std::to_string(stored) + " words stored");
+
+  // truncate() drops lines with their words
+  page.reset();
+  page.beginLine(LayoutStrategy::ALIGN_LEFT);
+  page.addWord(LayoutStrategy::Word(WordText("Fluss,", 6), 40, 10, 20, false));
+  page.beginLine(LayoutStrategy::ALIGN_LEFT);
+  page.addWord(LayoutStrategy::Word(WordText("Donau", 5), 44, 60, 40, false));
+  page.truncate(1);
+  page.beginLine(LayoutStrategy::ALIGN_LEFT);
+  page.addWord(LayoutStrategy::Word(WordText("Sonne", 5), 44, 60, 40, false));
+  runner.expectTrue(page.getLineCount() == 2 && page.getWordCount() == 2 &&
+                        std::string(page.getText(page.getWord(1))) == "Sonne" &&
+                        std::string(page.getText(page.getWord(0))) == "Fluss,",
+                    "truncate() drops the lines after it");
+}
+
+// A page whose text does not fit the arena (word text offsets are 16 bit)
+// ends after the last line stored, so the next page starts right after the
+// last stored word (or word fragment, the text has no hyphens of its own)
+void checkFullPage(TestUtils::TestRunner& runner, LayoutStrategy& layout, TextRenderer& renderer,
+                   const std::string& text, const char* name) {
+  StringWordProvider provider(String(text.c_str()));
+  LayoutStrategy::LayoutConfig config = makeConfig();
+  config.lineHeight = 8;
+  config.pageHeight = 32000;
+  layout.setLanguage(config.language);
+  LayoutStrategy::PageLayout page;
+  layout.layoutText(provider, renderer, config, page);
+
+  // The stored words without inserted hyphens must spell out the text before
+  // the page end, whitespace aside
+  auto isSpace = [](char c) { return c == ' ' || c == '\r' || c == '\n'; };
+  std::string stored;
+  for (size_t i = 0; i < page.getWordCount(); ++i) {
+    for (const char* c = page.getText(page.getWord(i)); *c; ++c) {
+      if (*c != '-' && !isSpace(*c))
+        stored += *c;
+    }
+  }
+  std::string expected;
+  const size_t end = page.endPosition > 0 ? static_cast<size_t>(page.endPosition) : 0;
+  for (size_t i = 0; i < end && i < text.size(); ++i) {
+    if (!isSpace(text[i]))
+      expected += text[i];
+  }
+  const bool stopped = end > 0 && end < text.size();
+  runner.expectTrue(stopped && page.getWordCount() > 0 && stored == expected,
+                    std::string(name) + ": full page ends after the last word stored",
+                    std::to_string(stored.size()) + " bytes stored, " + std::to_string(expected.size()) +
+                        " before the end");
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Layout Allocation Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  renderer.setFontFamily(&bookerlyFamily);
+
+  std::string text = buildText();
+  {
+    std::ofstream out(TEST_FILE, std::ios::binary);
+    out << text;
+  }
+
+  FileWordProvider fileProvider(TEST_FILE, 2048);
+  StringWordProvider stringProvider(String(text.c_str()));
+
+  // Token API: zero allocations once the provider's scratch buffers exist
+  {
+    bool widthsMatch = true;
+    readAndMeasure(fileProvider, renderer, widthsMatch);  // warm-up
+    size_t before = g_allocations;
+    int tokens = readAndMeasure(fileProvider, renderer, widthsMatch);
+    size_t count = g_allocations - before;
+    runner.expectTrue(tokens > 1000 && count == 0, "FileWordProvider tokens do not allocate",
+                      std::to_string(count) + " allocations for " + std::to_string(tokens) + " tokens");
+
+    before = g_allocations;
+    tokens = readAndMeasure(stringProvider, renderer, widthsMatch);
+    count = g_allocations - before;
+    runner.expectTrue(tokens > 1000 && count == 0, "StringWordProvider tokens do not allocate",
+                      std::to_string(count) + " allocations");
+    runner.expectTrue(widthsMatch, "getTextWidth matches getTextBounds");
+
+    fileProvider.setPosition(static_cast<int>(text.size()));
+    readBackward(fileProvider);  // warm-up
+    fileProvider.setPosition(static_cast<int>(text.size()));
+    before = g_allocations;
+    tokens = readBackward(fileProvider);
+    count = g_allocations - before;
+    runner.expectTrue(tokens > 1000 && count == 0, "backward tokens do not allocate",
+                      std::to_string(count) + " allocations");
+
+  }
+
+  checkPageLayout(runner);
+
+  GreedyLayoutStrategy greedy;
+  KnuthPlassLayoutStrategy knuthPlass;
+  checkLayout(runner, greedy, fileProvider, renderer, "Greedy/File");
+  checkLayout(runner, knuthPlass, fileProvider, renderer, "KnuthPlass/File");
+  checkLayout(runner, knuthPlass, stringProvider, renderer, "KnuthPlass/String");
+
+  std::string longText;
+  for (int i = 0; i < 8; ++i)
+    longText += text;
+  checkFullPage(runner, greedy, renderer, longText, "Greedy");
+  checkFullPage(runner, knuthPlass, renderer, longText, "KnuthPlass");
+
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+/**
+ * PageMapTest.cpp - Pagination Map Test
+ *
+ * Tests the persistent page-start table used by the text viewer:
+ * - Recording a full forward pagination builds a complete chain
+ * - Recorded starts reproduce the same pages when laid out again
+ * - Save/load round trip with the same layout key
+ * - A changed layout input invalidates the stored map
+ * - Pages that do not continue the chain are ignored, stale tails are dropped
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+#include "text/layout/PageMap.h"
+
+namespace {
+
+const char* MAP_PATH = "test/output/page_map_test.pages";
+
+String buildSampleText() {
+  static const char* words[] = {"Lorem",     "ipsum",  "dolor",          "sit",     "amet,",   "consectetur",
+                                "adipiscing", "elit.", "Donaudampfschiff", "fährt", "über",    "den",
+                                "Bodensee",   "und",   "weiter",         "nach",    "Konstanz.", "Sed"};
+  const int wordCount = sizeof(words) / sizeof(words[0]);
+  std::string text;
+  for (int para = 0; para < 40; ++para) {
+    int len = 20 + (para * 7) % 60;
+    for (int i = 0; i < len; ++i) {
+      text += words[(para * 5 + i * 3) % wordCount];
+      text += (i + 1 < len) ? " " : "";
+    }
+    text += "\n";
+  }
+  return String(text.c_str());
+}
+
+LayoutStrategy::LayoutConfig makeConfig() {
+  LayoutStrategy::LayoutConfig config;
+  config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+  config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+  config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+  config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+  config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+  config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+  config.pageWidth = TestConfig::DISPLAY_WIDTH;
+  config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+  config.alignment = LayoutStrategy::ALIGN_LEFT;
+  config.language = Language::GERMAN;
+  return config;
+}
+
+// Paginate the whole provider forward, recording every page in the map
+std::vector<std::pair<int, int>> paginate(WordProvider& provider, LayoutStrategy& layout, TextRenderer& renderer,
+                                          const LayoutStrategy::LayoutConfig& config, PageMap& map) {
+  std::vector<std::pair<int, int>> pages;
+  provider.setPosition(0);
+  int chapterStart = provider.getCurrentIndex();
+  int start = chapterStart;
+  while (pages.size() < 1000) {
+    provider.setPosition(start);
+    LayoutStrategy::PageLayout page = layout.layoutText(provider, renderer, config);
+    bool atEnd = provider.getChapterPercentage(page.endPosition) >= 1.0f;
+    map.recordPage(0, chapterStart, start, page.endPosition, atEnd);
+    pages.push_back(std::make_pair(start, page.endPosition));
+    if (atEnd || page.endPosition <= start)
+      break;
+    start = page.endPosition;
+  }
+  return pages;
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Page Map Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  renderer.setFontFamily(&bookerlyFamily);
+
+  String text = buildSampleText();
+  StringWordProvider provider(text);
+  KnuthPlassLayoutStrategy layout;
+  LayoutStrategy::LayoutConfig config = makeConfig();
+  layout.setLanguage(config.language);
+
+  uint32_t key = PageMap::computeKey(config, &bookerlyFamily, layout.getType());
+  PageMap map;
+  map.reset(key, 1);
+
+  // Forward pagination builds a complete chain
+  std::vector<std::pair<int, int>> pages = paginate(provider, layout, renderer, config, map);
+  runner.expectTrue(pages.size() > 3, "sample text spans several pages");
+  runner.expectTrue(map.isChapterComplete(0) && map.isComplete(), "map complete after full pagination");
+  runner.expectTrue(map.getPageCount(0) == static_cast<int>(pages.size()), "page count matches pagination",
+                    std::to_string(map.getPageCount(0)) + " vs " + std::to_string(pages.size()));
+  runner.expectTrue(map.getTotalPageCount() == static_cast<int>(pages.size()), "total page count");
+
+  bool lookupsOk = true;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    if (map.findPage(0, pages[i].first) != static_cast<int>(i) || map.getPageStart(0, i) != pages[i].first)
+      lookupsOk = false;
+  }
+  runner.expectTrue(lookupsOk, "findPage/getPageStart agree with pagination");
+  runner.expectTrue(map.findPage(0, pages[1].first + 1) == -1, "offsets inside a page are not page starts");
+
+  // Previous page via the map lays out to exactly the page before
+  bool prevOk = true;
+  for (size_t i = 1; i < pages.size(); ++i) {
+    int idx = map.findPage(0, pages[i].first);
+    int prevStart = map.getPageStart(0, idx - 1);
+    provider.setPosition(prevStart);
+    LayoutStrategy::PageLayout prev = layout.layoutText(provider, renderer, config);
+    if (prev.endPosition != pages[i].first)
+      prevOk = false;
+  }
+  runner.expectTrue(prevOk, "map previous page ends where the current page starts");
+
+  // Recording the same pages again changes nothing
+  map.save(MAP_PATH);
+  paginate(provider, layout, renderer, config, map);
+  runner.expectTrue(!map.isDirty(), "re-recording identical pages keeps the map clean");
+
+  // Save/load round trip
+  PageMap loaded;
+  runner.expectTrue(loaded.load(MAP_PATH, key, 1), "map loads with matching key");
+  runner.expectTrue(loaded.isComplete() && loaded.getPageCount(0) == map.getPageCount(0), "loaded map is complete");
+  bool sameStarts = true;
+  for (int i = 0; i < map.getPageCount(0); ++i) {
+    if (loaded.getPageStart(0, i) != map.getPageStart(0, i))
+      sameStarts = false;
+  }
+  runner.expectTrue(sameStarts, "loaded page starts match");
+
+  // Any layout input change produces a new key and the stored map is discarded
+  LayoutStrategy::LayoutConfig changed = config;
+  changed.lineHeight += 2;
+  uint32_t changedKey = PageMap::computeKey(changed, &bookerlyFamily, layout.getType());
+  runner.expectTrue(changedKey != key, "line height changes the key");
+  runner.expectTrue(PageMap::computeKey(config, &notoSansFamily, layout.getType()) != key,
+                    "font family changes the key");
+  LayoutStrategy::LayoutConfig otherLanguage = config;
+  otherLanguage.language = Language::ENGLISH;
+  runner.expectTrue(PageMap::computeKey(otherLanguage, &bookerlyFamily, layout.getType()) != key,
+                    "language changes the key");
+  PageMap stale;
+  runner.expectTrue(!stale.load(MAP_PATH, changedKey, 1), "map with other key is discarded");
+  runner.expectTrue(stale.getPageCount(0) == 0 && !stale.isComplete(), "discarded map is empty");
+  runner.expectTrue(!stale.load(MAP_PATH, key, 2), "map with other chapter count is discarded");
+
+  // Pages that do not continue the chain are ignored
+  PageMap partial;
+  partial.reset(key, 1);
+  partial.recordPage(0, pages[0].first, pages[1].first, pages[1].second, false);
+  runner.expectTrue(partial.getPageCount(0) == 0, "page not at chapter start is ignored on empty chain");
+  partial.recordPage(0, pages[0].first, pages[0].first, pages[0].second, false);
+  partial.recordPage(0, pages[0].first, pages[2].first, pages[2].second, false);
+  runner.expectTrue(partial.getPageCount(0) == 1, "gap in the chain is ignored");
+  partial.recordPage(0, pages[0].first, pages[1].first, pages[1].second, false);
+  runner.expectTrue(partial.getPageCount(0) == 2 && partial.getKnownEnd(0) == pages[1].second,
+                    "contiguous page extends the chain");
+
+  // A known page that now ends elsewhere truncates the stale tail
+  partial.recordPage(0, pages[0].first, pages[0].first, pages[0].second - 5, false);
+  runner.expectTrue(partial.getPageCount(0) == 1 && partial.getKnownEnd(0) == pages[0].second - 5,
+                    "inconsistent page truncates the chain");
+
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+/**
+ * WordWidthCacheTest.cpp - Memoized word widths
+ *
+ * - Cached widths match TextRenderer::getTextWidth for every word and style
+ * - Common words are answered from the table (hit rate on running text)
+ * - Selecting another font family invalidates the cached widths; selecting
+ *   the same one again does not
+ * - A tiny table that constantly evicts entries stays exact
+ * - Page layout measures through the cache
+ * - Benchmark: cached vs direct measurement
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/GreedyLayoutStrategy.h"
+#include "text/layout/WordWidthCache.h"
+
+namespace {
+
+// Running text with a natural mix of frequent short words and rarer long ones
+std::vector<std::string> buildWords() {
+  const char* common[] = {"der", "die", "und", "in", "den", "von", "zu", "das", "mit", "sich", "the", "and", "of"};
+  const char* rare[] = {"Donaudampfschifffahrt", "Verantwortung", "Hügeln", "verschwand.", "Straße", "Kindergarten",
+                        "langsam", "während", "Fluss,", "Sonne", "schön", "Bundesverfassungsgericht"};
+  std::vector<std::string> words;
+  uint32_t state = 7;
+  for (int i = 0; i < 5000; ++i) {
+    state = state * 1664525u + 1013904223u;
+    uint32_t r = state >> 8;
+    if (r % 3 != 0) {
+      words.push_back(common[r % 13]);
+    } else {
+      // Rare words with a numbered suffix so the vocabulary keeps growing
+      std::string word = rare[(r / 3) % 12];
+      if ((r / 41) % 4 == 0)
+        word += std::to_string((r / 7) % 300);
+      words.push_back(word);
+    }
+  }
+  return words;
+}
+
+bool allWidthsMatch(WordWidthCache& cache, TextRenderer& renderer, const std::vector<std::string>& words) {
+  const FontStyle styles[] = {FontStyle::REGULAR, FontStyle::BOLD, FontStyle::ITALIC};
+  bool match = true;
+  for (size_t i = 0; i < words.size(); ++i) {
+    renderer.setFontStyle(styles[i % 3]);
+    uint16_t expected = renderer.getTextWidth(words[i].c_str(), words[i].size());
+    if (cache.getTextWidth(renderer, words[i].c_str(), words[i].size()) != expected)
+      match = false;
+  }
+  return match;
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Word Width Cache Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  renderer.setFontFamily(&bookerlyFamily);
+
+  std::vector<std::string> words = buildWords();
+
+  // Exact widths and hit rate
+  {
+    WordWidthCache cache;
+    runner.expectTrue(allWidthsMatch(cache, renderer, words), "cached widths match getTextWidth");
+    runner.expectTrue(cache.getHits() + cache.getMisses() + cache.getUncached() == words.size(),
+                      "every lookup is counted");
+    runner.expectTrue(cache.getHitRate() > 0.8f, "common words hit the cache",
+                      std::to_string(cache.getHitRate()) + " hit rate");
+    printf("  %u hits, %u misses, %u uncached, %zu bytes\n", cache.getHits(), cache.getMisses(), cache.getUncached(),
+           cache.getMemoryBytes());
+  }
+
+  // Switching the font family invalidates the table
+  {
+    WordWidthCache cache;
+    renderer.setFontFamily(&bookerlyFamily);
+    renderer.setFontStyle(FontStyle::REGULAR);
+    uint16_t bookerly = cache.getTextWidth(renderer, "Wasser", 6);
+    renderer.setFontFamily(&font14Family);
+    uint16_t expected = renderer.getTextWidth("Wasser", 6);
+    uint16_t cached = cache.getTextWidth(renderer, "Wasser", 6);
+    runner.expectTrue(bookerly != expected && cached == expected, "setFontFamily invalidates cached widths",
+                      std::to_string(bookerly) + " / " + std::to_string(cached) + " / " + std::to_string(expected));
+    runner.expectTrue(allWidthsMatch(cache, renderer, words), "widths match after a font change");
+    renderer.setFontFamily(&bookerlyFamily);
+  }
+
+  // Constant eviction in a tiny table
+  {
+    WordWidthCache cache(8);
+    runner.expectTrue(cache.getCapacity() == 8, "capacity is a power of two");
+    runner.expectTrue(allWidthsMatch(cache, renderer, words), "tiny table stays exact");
+  }
+
+  // Layout measures through the cache
+  {
+    std::string text;
+    for (size_t i = 0; i < 600; ++i)
+      text += words[i] + ((i % 50 == 49) ? "\n" : " ");
+    StringWordProvider provider(String(text.c_str()));
+    GreedyLayoutStrategy layout;
+    layout.setLanguage(Language::GERMAN);
+    LayoutStrategy::LayoutConfig config;
+    config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+    config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+    config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+    config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+    config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+    config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+    config.pageWidth = TestConfig::DISPLAY_WIDTH;
+    config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+    config.alignment = LayoutStrategy::ALIGN_LEFT;
+    config.language = Language::GERMAN;
+    LayoutStrategy::PageLayout page;
+    layout.layoutText(provider, renderer, config, page);
+    const WordWidthCache& cache = layout.getWidthCache();
+    runner.expectTrue(page.getWordCount() > 0 && cache.getHits() > cache.getMisses(), "layout uses the width cache",
+                      std::to_string(cache.getHits()) + " hits, " + std::to_string(cache.getMisses()) + " misses");
+
+    // The reader selects its family again before every page: the cached
+    // widths must survive that
+    const uint32_t misses = cache.getMisses();
+    renderer.setFontFamily(&bookerlyFamily);
+    renderer.setFontFamily(&bookerlyFamily);
+    provider.reset();
+    LayoutStrategy::PageLayout again;
+    layout.layoutText(provider, renderer, config, again);
+    runner.expectTrue(again.getWordCount() == page.getWordCount() && cache.getMisses() == misses,
+                      "selecting the same family keeps cached widths",
+                      std::to_string(cache.getMisses() - misses) + " new misses");
+  }
+
+  // Benchmark
+  {
+    WordWidthCache cache;
+    renderer.setFontStyle(FontStyle::REGULAR);
+    uint32_t sink = 0;
+    const int rounds = 20;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      for (size_t i = 0; i < words.size(); ++i)
+        sink += renderer.getTextWidth(words[i].c_str(), words[i].size());
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      for (size_t i = 0; i < words.size(); ++i)
+        sink += cache.getTextWidth(renderer, words[i].c_str(), words[i].size());
+    auto t2 = std::chrono::steady_clock::now();
+    double lookups = static_cast<double>(rounds) * words.size();
+    printf("  Benchmark (host): direct %.1f ns/word, cached %.1f ns/word (checksum %u)\n",
+           std::chrono::duration<double>(t1 - t0).count() * 1e9 / lookups,
+           std::chrono::duration<double>(t2 - t1).count() * 1e9 / lookups, sink);
+  }
+
+  return runner.allPassed() ? 0 : 1;
+}
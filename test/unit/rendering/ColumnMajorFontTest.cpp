@@ -0,0 +1,156 @@
+/**
+ * ColumnMajorFontTest.cpp - Pre-rotated (column-major) glyph bitmaps
+ *
+ * Builds column-major copies of the bundled fonts the way
+ * `generate_simplefont --column-major` packs them and renders the same text
+ * with both layouts:
+ * - Framebuffers are bit-identical for the BW and both grayscale planes, on
+ *   white and on existing content, at every vertical bit offset
+ * - Glyphs clipped at every page edge match as well
+ * - BITMAP_GRAY writes both planes in one pass, same as the LSB and MSB passes
+ * - Benchmark: time per page for row-major and column-major fonts
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "core/EInkDisplay.h"
+#include "font_test_fixtures.h"
+#include "platform_stubs.h"
+#include "rendering/SimpleFont.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+using FontTestFixtures::ColumnMajorFont;
+using FontTestFixtures::fillPattern;
+using FontTestFixtures::LINE_COUNT;
+using FontTestFixtures::LINES;
+using FontTestFixtures::pagePlacements;
+using FontTestFixtures::Placement;
+
+void renderPage(TextRenderer& renderer, const SimpleGFXfont* font, TextRenderer::BitmapType type,
+                const std::vector<Placement>& placements) {
+  renderer.setFont(font);
+  renderer.setBitmapType(type);
+  for (size_t i = 0; i < placements.size(); ++i) {
+    renderer.setCursor(placements[i].x, placements[i].y);
+    renderer.print(LINES[i % LINE_COUNT]);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Column-Major Font Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  uint8_t* frame = display.getFrameBuffer();
+  renderer.setFrameBuffer(frame);
+
+  std::vector<uint8_t> expected(EInkDisplay::BUFFER_SIZE);
+
+  struct FontCase {
+    const char* name;
+    const SimpleGFXfont* font;
+  };
+  const FontCase fonts[] = {{"Bookerly regular", getFontVariant(&bookerlyFamily, FontStyle::REGULAR)},
+                            {"Bookerly italic", getFontVariant(&bookerlyFamily, FontStyle::ITALIC)},
+                            {"NotoSans bold italic", &NotoSans26BoldItalic},
+                            {"Font14", &Font14},
+                            {"Font27", &Font27}};
+  const TextRenderer::BitmapType types[] = {TextRenderer::BITMAP_BW, TextRenderer::BITMAP_GRAY_LSB,
+                                            TextRenderer::BITMAP_GRAY_MSB};
+  const char* typeNames[] = {"BW", "gray LSB", "gray MSB"};
+
+  runner.expectTrue(fonts[0].font->flags == 0, "generated fonts are row-major");
+
+  for (const FontCase& fc : fonts) {
+    ColumnMajorFont columns(fc.font);
+    for (int t = 0; t < 3; ++t) {
+      bool identical = true;
+      for (int16_t dy = 0; dy < 8; ++dy) {
+        std::vector<Placement> placements = pagePlacements(dy);
+        for (int background = 0; background < 2; ++background) {
+          if (background == 0)
+            memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+          else
+            fillPattern(frame, 7 + dy);
+          renderPage(renderer, fc.font, types[t], placements);
+          memcpy(expected.data(), frame, EInkDisplay::BUFFER_SIZE);
+
+          if (background == 0)
+            memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+          else
+            fillPattern(frame, 7 + dy);
+          renderPage(renderer, &columns.font, types[t], placements);
+          if (memcmp(expected.data(), frame, EInkDisplay::BUFFER_SIZE) != 0)
+            identical = false;
+        }
+      }
+      runner.expectTrue(identical, std::string(fc.name) + " " + typeNames[t] + ": column-major font is bit-identical");
+    }
+  }
+
+  // Both grayscale planes in one pass
+  {
+    std::vector<uint8_t> lsb(EInkDisplay::BUFFER_SIZE);
+    std::vector<uint8_t> msb(EInkDisplay::BUFFER_SIZE);
+    std::vector<uint8_t> expectedMsb(EInkDisplay::BUFFER_SIZE);
+    std::vector<Placement> placements = pagePlacements(3);
+    ColumnMajorFont columns(fonts[0].font);
+    bool identical = true;
+    for (int f = 0; f < 2; ++f) {
+      const SimpleGFXfont* font = f == 0 ? fonts[0].font : &columns.font;
+      fillPattern(frame, 11);
+      renderPage(renderer, font, TextRenderer::BITMAP_GRAY_LSB, placements);
+      memcpy(expected.data(), frame, EInkDisplay::BUFFER_SIZE);
+      fillPattern(frame, 12);
+      renderPage(renderer, font, TextRenderer::BITMAP_GRAY_MSB, placements);
+      memcpy(expectedMsb.data(), frame, EInkDisplay::BUFFER_SIZE);
+
+      fillPattern(lsb.data(), 11);
+      fillPattern(msb.data(), 12);
+      renderer.setGrayscaleStrips(lsb.data(), msb.data(), 0, EInkDisplay::DISPLAY_WIDTH);
+      renderPage(renderer, font, TextRenderer::BITMAP_GRAY, placements);
+      renderer.setFrameBuffer(frame);
+      if (lsb != expected || msb != expectedMsb)
+        identical = false;
+    }
+    runner.expectTrue(identical, "BITMAP_GRAY matches separate LSB and MSB passes");
+  }
+
+  // Benchmark: one page of body text
+  {
+    const SimpleGFXfont* font = getFontVariant(&bookerlyFamily, FontStyle::REGULAR);
+    ColumnMajorFont columns(font);
+    std::vector<Placement> page;
+    for (int16_t y = 40; y < 780; y += 34)
+      page.push_back({10, y});
+    const int rounds = 50;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      renderPage(renderer, font, TextRenderer::BITMAP_BW, page);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      renderPage(renderer, &columns.font, TextRenderer::BITMAP_BW, page);
+    auto t2 = std::chrono::steady_clock::now();
+    double rows = std::chrono::duration<double>(t1 - t0).count() * 1e3 / rounds;
+    double cols = std::chrono::duration<double>(t2 - t1).count() * 1e3 / rounds;
+    printf("  Benchmark (host): row-major %.3f ms/page, column-major %.3f ms/page (%.1fx)\n", rows, cols,
+           rows / cols);
+    printf("  Bookerly regular BW plane: %zu bytes column-major\n", columns.planes[0].size());
+  }
+
+  renderer.setBitmapType(TextRenderer::BITMAP_BW);
+  return runner.allPassed() ? 0 : 1;
+}
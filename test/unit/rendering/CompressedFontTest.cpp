@@ -0,0 +1,378 @@
+/**
+ * CompressedFontTest.cpp - Run-length coded glyph bitmaps (FONT_FLAG_COMPRESSED)
+ *
+ * Compresses the bundled fonts the way `generate_simplefont --compress` does
+ * and renders the same text from the streams and from the plane bitmaps:
+ * - Framebuffers are bit-identical for BW and both grayscale planes, on white
+ *   and on existing content, at every vertical bit offset and clipped at
+ *   every page edge
+ * - BITMAP_GRAY and strips (glyphs starting above the strip) match too
+ * - A compressed font pack renders the same with a smaller cache, and
+ *   corrupt streams are rejected when their block is loaded
+ * - Size: stream bytes against plane bytes per font
+ * - Benchmark: time per page for plane and compressed fonts
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "core/EInkDisplay.h"
+#include "font_test_fixtures.h"
+#include "platform_stubs.h"
+#include "rendering/FontPack.h"
+#include "rendering/SimpleFont.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+using FontTestFixtures::fillPattern;
+using FontTestFixtures::LINE_COUNT;
+using FontTestFixtures::LINES;
+using FontTestFixtures::pagePlacements;
+using FontTestFixtures::Placement;
+
+const char* PACK_PATH = "test/output/compressed_font_test.mfp";
+
+// Compressed copy of a font (same coding as bitmap_utils.compress_glyph)
+struct CompressedFont {
+  std::vector<uint8_t> stream;
+  std::vector<SimpleGFXglyph> glyphs;
+  SimpleGFXfont font;
+  bool valid = true;
+
+  explicit CompressedFont(const SimpleGFXfont* source) {
+    glyphs.assign(source->glyph, source->glyph + source->glyphCount);
+    for (SimpleGFXglyph& glyph : glyphs) {
+      uint16_t offset = static_cast<uint16_t>(stream.size());
+      compress(source, glyph);
+      glyph.bitmapOffset = offset;
+    }
+    font = *source;
+    font.bitmap = stream.data();
+    font.bitmap_gray_lsb = source->bitmap_gray_lsb ? stream.data() : nullptr;
+    font.bitmap_gray_msb = source->bitmap_gray_msb ? stream.data() : nullptr;
+    font.glyph = glyphs.data();
+    font.flags = FONT_FLAG_COMPRESSED;
+  }
+
+  static int level(int bw, int lsb, int msb) {
+    const int bits = (bw << 2) | (lsb << 1) | msb;
+    switch (bits) {
+      case 4:
+        return 0;
+      case 6:
+        return 1;
+      case 1:
+        return 2;
+      case 3:
+        return 3;
+      case 0:
+        return 4;
+    }
+    return -1;
+  }
+
+  void compress(const SimpleGFXfont* source, const SimpleGFXglyph& glyph) {
+    const uint8_t rowStride = (glyph.width + 7) / 8;
+    std::vector<int> levels;
+    for (uint8_t y = 0; y < glyph.height; y++) {
+      for (uint8_t x = 0; x < glyph.width; x++) {
+        const size_t index = glyph.bitmapOffset + y * rowStride + x / 8;
+        const int shift = 7 - x % 8;
+        auto bit = [&](const uint8_t* plane) { return plane ? (plane[index] >> shift) & 1 : 0; };
+        int l = level(bit(source->bitmap), bit(source->bitmap_gray_lsb), bit(source->bitmap_gray_msb));
+        if (l < 0)
+          valid = false;
+        levels.push_back(l < 0 ? 0 : l);
+      }
+    }
+    std::vector<uint8_t> nibbles;
+    for (size_t i = 0; i < levels.size();) {
+      const int l = levels[i];
+      const size_t limit = (l == 0 || l == 4) ? 134 : 1;
+      size_t run = 1;
+      while (i + run < levels.size() && levels[i + run] == l && run < limit)
+        run++;
+      if (l >= 1 && l <= 3) {
+        nibbles.push_back(static_cast<uint8_t>(11 + l));
+      } else if (run <= 6) {
+        nibbles.push_back(static_cast<uint8_t>(l == 0 ? run - 1 : run + 5));
+      } else {
+        const uint8_t value = static_cast<uint8_t>((l == 4 ? 0x80 : 0) | (run - 7));
+        nibbles.push_back(15);
+        nibbles.push_back(value >> 4);
+        nibbles.push_back(value & 0x0F);
+      }
+      i += run;
+    }
+    if (nibbles.size() % 2)
+      nibbles.push_back(0);
+    for (size_t k = 0; k < nibbles.size(); k += 2)
+      stream.push_back(static_cast<uint8_t>((nibbles[k] << 4) | nibbles[k + 1]));
+  }
+};
+
+size_t planeBytes(const SimpleGFXfont* font) {
+  size_t bytes = 0;
+  for (uint16_t i = 0; i < font->glyphCount; i++)
+    bytes += ((font->glyph[i].width + 7) / 8) * font->glyph[i].height;
+  return bytes * (font->bitmap_gray_lsb ? 3 : 1);
+}
+
+void putU16(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(value & 0xFF);
+  out.push_back(value >> 8);
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t value) {
+  putU16(out, value & 0xFFFF);
+  putU16(out, value >> 16);
+}
+
+// Font pack of a compressed font with glyphs sorted by codepoint (same
+// layout as writer.write_font_pack --compress): one stream plane per block
+std::vector<uint8_t> buildCompressedPack(const CompressedFont& compressed) {
+  const SimpleGFXfont* font = &compressed.font;
+  std::vector<uint16_t> order(font->glyphCount);
+  for (uint16_t i = 0; i < font->glyphCount; i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [font](uint16_t a, uint16_t b) { return font->glyph[a].codepoint < font->glyph[b].codepoint; });
+
+  struct Block {
+    uint16_t number;
+    uint16_t firstGlyph;
+    uint16_t glyphCount;
+    std::vector<uint8_t> plane;
+  };
+  std::vector<Block> blocks;
+  std::vector<uint8_t> glyphRecords;
+  for (uint16_t i = 0; i < font->glyphCount; i++) {
+    const uint16_t index = order[i];
+    const SimpleGFXglyph& glyph = font->glyph[index];
+    uint16_t number = static_cast<uint16_t>(glyph.codepoint >> FontPack::BLOCK_SHIFT);
+    if (blocks.empty() || blocks.back().number != number)
+      blocks.push_back({number, i, 0, {}});
+    Block& block = blocks.back();
+    // A glyph's stream runs up to the next glyph's in the source buffer
+    const size_t end = index + 1 < font->glyphCount ? font->glyph[index + 1].bitmapOffset : compressed.stream.size();
+    uint16_t offset = static_cast<uint16_t>(block.plane.size());
+    block.plane.insert(block.plane.end(), compressed.stream.begin() + glyph.bitmapOffset,
+                       compressed.stream.begin() + end);
+    block.glyphCount++;
+    putU32(glyphRecords, glyph.codepoint);
+    putU16(glyphRecords, offset);
+    glyphRecords.push_back(glyph.width);
+    glyphRecords.push_back(glyph.height);
+    glyphRecords.push_back(glyph.xAdvance);
+    glyphRecords.push_back(static_cast<uint8_t>(glyph.xOffset));
+    glyphRecords.push_back(static_cast<uint8_t>(glyph.yOffset));
+  }
+
+  const uint8_t flags = FONT_FLAG_COMPRESSED | (font->bitmap_gray_lsb ? FontPack::FLAG_GRAYSCALE : 0);
+  std::vector<uint8_t> out = {'M', 'R', 'F', 'P', FontPack::VERSION, flags, font->yAdvance, font->size,
+                              static_cast<uint8_t>(font->style), 0};
+  putU16(out, font->glyphCount);
+  putU16(out, static_cast<uint16_t>(blocks.size()));
+  putU16(out, 0);
+  char name[FontPack::NAME_SIZE] = "Compressed";
+  out.insert(out.end(), name, name + sizeof(name));
+  uint32_t dataOffset = static_cast<uint32_t>(out.size() + blocks.size() * FontPack::BLOCK_RECORD_SIZE +
+                                              glyphRecords.size());
+  std::vector<uint8_t> data;
+  for (const Block& block : blocks) {
+    putU16(out, block.number);
+    putU16(out, block.firstGlyph);
+    putU16(out, block.glyphCount);
+    putU16(out, static_cast<uint16_t>(block.plane.size()));
+    putU32(out, dataOffset + static_cast<uint32_t>(data.size()));
+    data.insert(data.end(), block.plane.begin(), block.plane.end());
+  }
+  out.insert(out.end(), glyphRecords.begin(), glyphRecords.end());
+  out.insert(out.end(), data.begin(), data.end());
+  return out;
+}
+
+void writeFile(const char* path, const std::vector<uint8_t>& bytes) {
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+void renderPage(TextRenderer& renderer, const SimpleGFXfont* font, TextRenderer::BitmapType type,
+                const std::vector<Placement>& placements) {
+  renderer.setFont(font);
+  renderer.setBitmapType(type);
+  for (size_t i = 0; i < placements.size(); ++i) {
+    renderer.setCursor(placements[i].x, placements[i].y);
+    renderer.print(LINES[i % LINE_COUNT]);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Compressed Font Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  uint8_t* frame = display.getFrameBuffer();
+  renderer.setFrameBuffer(frame);
+
+  std::vector<uint8_t> expected(EInkDisplay::BUFFER_SIZE);
+
+  struct FontCase {
+    const char* name;
+    const SimpleGFXfont* font;
+  };
+  const FontCase fonts[] = {{"Bookerly regular", getFontVariant(&bookerlyFamily, FontStyle::REGULAR)},
+                            {"Bookerly bold", getFontVariant(&bookerlyFamily, FontStyle::BOLD)},
+                            {"Bookerly italic", getFontVariant(&bookerlyFamily, FontStyle::ITALIC)},
+                            {"NotoSans bold italic", &NotoSans26BoldItalic},
+                            {"Font14", &Font14},
+                            {"Font27", &Font27}};
+  const TextRenderer::BitmapType types[] = {TextRenderer::BITMAP_BW, TextRenderer::BITMAP_GRAY_LSB,
+                                            TextRenderer::BITMAP_GRAY_MSB};
+  const char* typeNames[] = {"BW", "gray LSB", "gray MSB"};
+
+  for (const FontCase& fc : fonts) {
+    CompressedFont compressed(fc.font);
+    runner.expectTrue(compressed.valid, std::string(fc.name) + ": every pixel has a compressed level");
+    size_t planes = planeBytes(fc.font);
+    printf("  %s: %zu plane bytes, %zu compressed (%.0f%%)\n", fc.name, planes, compressed.stream.size(),
+           100.0 * compressed.stream.size() / planes);
+    if (fc.font->bitmap_gray_lsb)
+      runner.expectTrue(compressed.stream.size() * 2 < planes, std::string(fc.name) + ": less than half the size");
+
+    for (int t = 0; t < 3; ++t) {
+      bool identical = true;
+      for (int16_t dy = 0; dy < 8; ++dy) {
+        std::vector<Placement> placements = pagePlacements(dy);
+        for (int background = 0; background < 2; ++background) {
+          if (background == 0)
+            memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+          else
+            fillPattern(frame, 7 + dy);
+          renderPage(renderer, fc.font, types[t], placements);
+          memcpy(expected.data(), frame, EInkDisplay::BUFFER_SIZE);
+
+          if (background == 0)
+            memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+          else
+            fillPattern(frame, 7 + dy);
+          renderPage(renderer, &compressed.font, types[t], placements);
+          if (memcmp(expected.data(), frame, EInkDisplay::BUFFER_SIZE) != 0)
+            identical = false;
+        }
+      }
+      runner.expectTrue(identical, std::string(fc.name) + " " + typeNames[t] + ": compressed font is bit-identical");
+    }
+  }
+
+  const SimpleGFXfont* regular = fonts[0].font;
+  CompressedFont compressed(regular);
+
+  // Both grayscale planes in one pass, in strips that cut through glyphs
+  {
+    const int16_t stripHeight = 72;
+    std::vector<uint8_t> lsb(EInkDisplay::BUFFER_SIZE);
+    std::vector<uint8_t> msb(EInkDisplay::BUFFER_SIZE);
+    std::vector<uint8_t> planes[2][2];
+    std::vector<Placement> placements = pagePlacements(3);
+    for (int f = 0; f < 2; ++f) {
+      const SimpleGFXfont* font = f == 0 ? regular : &compressed.font;
+      planes[f][0].assign(EInkDisplay::BUFFER_SIZE, 0);
+      planes[f][1].assign(EInkDisplay::BUFFER_SIZE, 0);
+      for (int16_t top = 0; top < EInkDisplay::DISPLAY_WIDTH; top += stripHeight) {
+        int16_t height = top + stripHeight > EInkDisplay::DISPLAY_WIDTH ? EInkDisplay::DISPLAY_WIDTH - top : stripHeight;
+        const size_t stripBytes = static_cast<size_t>(EInkDisplay::DISPLAY_HEIGHT) * (height / 8);
+        fillPattern(lsb.data(), 11 + top);
+        fillPattern(msb.data(), 12 + top);
+        renderer.setGrayscaleStrips(lsb.data(), msb.data(), top, height);
+        renderPage(renderer, font, TextRenderer::BITMAP_GRAY, placements);
+        // Keep the strips side by side in the order they were produced
+        memcpy(planes[f][0].data() + top * EInkDisplay::DISPLAY_HEIGHT / 8, lsb.data(), stripBytes);
+        memcpy(planes[f][1].data() + top * EInkDisplay::DISPLAY_HEIGHT / 8, msb.data(), stripBytes);
+      }
+    }
+    renderer.setFrameBuffer(frame);
+    runner.expectTrue(planes[0][0] == planes[1][0] && planes[0][1] == planes[1][1],
+                      "BITMAP_GRAY strips are bit-identical");
+  }
+
+  // Compressed font pack
+  {
+    std::vector<uint8_t> bytes = buildCompressedPack(compressed);
+    writeFile(PACK_PATH, bytes);
+    FontPack pack(PACK_PATH, 1);
+    runner.expectTrue(pack.isValid() && pack.hasGrayscale() &&
+                          (pack.getFont()->flags & FONT_FLAG_COMPRESSED) != 0,
+                      "compressed pack loads");
+    if (pack.isValid()) {
+      bool identical = true;
+      std::vector<Placement> placements = pagePlacements(5);
+      for (int t = 0; t < 3; ++t) {
+        fillPattern(frame, 3);
+        renderPage(renderer, &compressed.font, types[t], placements);
+        memcpy(expected.data(), frame, EInkDisplay::BUFFER_SIZE);
+        fillPattern(frame, 3);
+        renderPage(renderer, pack.getFont(), types[t], placements);
+        if (memcmp(expected.data(), frame, EInkDisplay::BUFFER_SIZE) != 0)
+          identical = false;
+      }
+      runner.expectTrue(identical, "compressed pack renders bit-identical with the smallest cache");
+      printf("  Pack cache: %zu slots, %u hits, %u misses\n", pack.getCacheSlotCount(), pack.getCacheHits(),
+             pack.getCacheMisses());
+
+      FontPack defaultCache(PACK_PATH);
+      printf("  Default cache: %zu slots of one stream plane, %zu bytes of RAM\n", defaultCache.getCacheSlotCount(),
+             defaultCache.getMemoryBytes());
+    }
+
+    // Streams that run past their block's plane
+    std::vector<uint8_t> broken = bytes;
+    const size_t firstBlock = FontPack::HEADER_SIZE;
+    const uint16_t planeSize = static_cast<uint16_t>(broken[firstBlock + 6] | (broken[firstBlock + 7] << 8));
+    const uint32_t dataOffset = broken[firstBlock + 8] | (broken[firstBlock + 9] << 8) |
+                                (broken[firstBlock + 10] << 16) | (static_cast<uint32_t>(broken[firstBlock + 11]) << 24);
+    for (size_t i = dataOffset; i < dataOffset + planeSize; i++)
+      broken[i] = 0x00;  // white runs of one pixel: every stream ends late
+    writeFile(PACK_PATH, broken);
+    FontPack corrupt(PACK_PATH);
+    runner.expectTrue(corrupt.isValid() && corrupt.getPlane(0, FontPack::PLANE_BW) == nullptr,
+                      "corrupt streams are rejected when their block is loaded");
+    std::remove(PACK_PATH);
+  }
+
+  // Benchmark: one page of body text
+  {
+    std::vector<Placement> page;
+    for (int16_t y = 40; y < 780; y += 34)
+      page.push_back({10, y});
+    const int rounds = 50;
+    for (int t = 0; t < 2; ++t) {
+      auto t0 = std::chrono::steady_clock::now();
+      for (int r = 0; r < rounds; ++r)
+        renderPage(renderer, regular, types[t], page);
+      auto t1 = std::chrono::steady_clock::now();
+      for (int r = 0; r < rounds; ++r)
+        renderPage(renderer, &compressed.font, types[t], page);
+      auto t2 = std::chrono::steady_clock::now();
+      double plain = std::chrono::duration<double>(t1 - t0).count() * 1e3 / rounds;
+      double packed = std::chrono::duration<double>(t2 - t1).count() * 1e3 / rounds;
+      printf("  Benchmark (host) %s: planes %.3f ms/page, compressed %.3f ms/page\n", typeNames[t], plain, packed);
+    }
+  }
+
+  renderer.setBitmapType(TextRenderer::BITMAP_BW);
+  return runner.allPassed() ? 0 : 1;
+}
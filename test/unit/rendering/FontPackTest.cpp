@@ -0,0 +1,316 @@
+/**
+ * FontPackTest.cpp - Fonts loaded on demand from a binary font pack
+ *
+ * Writes the bundled fonts as .mfp packs (the layout generate_simplefont
+ * --pack writes) and renders the same text from the pack and from flash:
+ * - Metrics match: glyph count, advances, line height, style
+ * - Framebuffers are bit-identical for BW, both grayscale planes and
+ *   BITMAP_GRAY, for print() and for pre-shaped glyph runs
+ * - Column-major packs render like their in-memory fonts
+ * - A cache of two slots still renders correctly, evicting blocks; hits and
+ *   misses are counted per drawn glyph
+ * - Missing, truncated and malformed packs are rejected
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "core/EInkDisplay.h"
+#include "font_test_fixtures.h"
+#include "platform_stubs.h"
+#include "rendering/FontPack.h"
+#include "rendering/SimpleFont.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+using FontTestFixtures::ColumnMajorFont;
+using FontTestFixtures::LINE_COUNT;
+using FontTestFixtures::LINES;
+
+const char* PACK_PATH = "test/output/font_pack_test.mfp";
+const char* BROKEN_PATH = "test/output/font_pack_broken.mfp";
+
+void putU16(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(value & 0xFF);
+  out.push_back(value >> 8);
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t value) {
+  putU16(out, value & 0xFFFF);
+  putU16(out, value >> 16);
+}
+
+size_t glyphBytes(const SimpleGFXfont* font, const SimpleGFXglyph& glyph) {
+  if (font->flags & FONT_FLAG_COLUMN_MAJOR)
+    return glyph.width * ((glyph.height + 7) / 8);
+  return ((glyph.width + 7) / 8) * glyph.height;
+}
+
+// Glyph indices in codepoint order (the bundled fonts end with a few
+// unsorted glyphs; the pack writer sorts them)
+std::vector<uint16_t> codepointOrder(const SimpleGFXfont* font) {
+  std::vector<uint16_t> order(font->glyphCount);
+  for (uint16_t i = 0; i < font->glyphCount; i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [font](uint16_t a, uint16_t b) { return font->glyph[a].codepoint < font->glyph[b].codepoint; });
+  return order;
+}
+
+// Font pack bytes for a font (same layout as writer.write_font_pack)
+std::vector<uint8_t> buildPack(const SimpleGFXfont* font, const char* name) {
+  const bool grayscale = font->bitmap_gray_lsb && font->bitmap_gray_msb;
+  const uint8_t* planes[3] = {font->bitmap, font->bitmap_gray_lsb, font->bitmap_gray_msb};
+  const int planeCount = grayscale ? 3 : 1;
+
+  struct Block {
+    uint16_t number;
+    uint16_t firstGlyph;
+    uint16_t glyphCount;
+    std::vector<uint8_t> planes[3];
+  };
+  std::vector<Block> blocks;
+  std::vector<uint8_t> glyphRecords;
+  const std::vector<uint16_t> order = codepointOrder(font);
+  for (uint16_t i = 0; i < font->glyphCount; i++) {
+    const SimpleGFXglyph& glyph = font->glyph[order[i]];
+    uint16_t number = static_cast<uint16_t>(glyph.codepoint >> FontPack::BLOCK_SHIFT);
+    if (blocks.empty() || blocks.back().number != number)
+      blocks.push_back({number, i, 0, {}});
+    Block& block = blocks.back();
+    uint16_t offset = static_cast<uint16_t>(block.planes[0].size());
+    for (int p = 0; p < planeCount; p++) {
+      const uint8_t* bits = planes[p] + glyph.bitmapOffset;
+      block.planes[p].insert(block.planes[p].end(), bits, bits + glyphBytes(font, glyph));
+    }
+    block.glyphCount++;
+    putU32(glyphRecords, glyph.codepoint);
+    putU16(glyphRecords, offset);
+    glyphRecords.push_back(glyph.width);
+    glyphRecords.push_back(glyph.height);
+    glyphRecords.push_back(glyph.xAdvance);
+    glyphRecords.push_back(static_cast<uint8_t>(glyph.xOffset));
+    glyphRecords.push_back(static_cast<uint8_t>(glyph.yOffset));
+  }
+
+  std::vector<uint8_t> out = {'M', 'R', 'F', 'P', FontPack::VERSION,
+                              static_cast<uint8_t>(font->flags | (grayscale ? FontPack::FLAG_GRAYSCALE : 0)),
+                              font->yAdvance, font->size, static_cast<uint8_t>(font->style), 0};
+  putU16(out, font->glyphCount);
+  putU16(out, static_cast<uint16_t>(blocks.size()));
+  putU16(out, 0);
+  char padded[FontPack::NAME_SIZE] = {};
+  strncpy(padded, name, sizeof(padded));
+  out.insert(out.end(), padded, padded + sizeof(padded));
+
+  uint32_t dataOffset = static_cast<uint32_t>(out.size() + blocks.size() * FontPack::BLOCK_RECORD_SIZE +
+                                              glyphRecords.size());
+  std::vector<uint8_t> data;
+  for (const Block& block : blocks) {
+    putU16(out, block.number);
+    putU16(out, block.firstGlyph);
+    putU16(out, block.glyphCount);
+    putU16(out, static_cast<uint16_t>(block.planes[0].size()));
+    putU32(out, dataOffset + static_cast<uint32_t>(data.size()));
+    for (int p = 0; p < planeCount; p++)
+      data.insert(data.end(), block.planes[p].begin(), block.planes[p].end());
+  }
+  out.insert(out.end(), glyphRecords.begin(), glyphRecords.end());
+  out.insert(out.end(), data.begin(), data.end());
+  return out;
+}
+
+void writeFile(const char* path, const std::vector<uint8_t>& bytes) {
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+// A page of text with print(), or as pre-shaped glyph runs
+void renderPage(TextRenderer& renderer, const SimpleGFXfont* font, bool runs) {
+  renderer.setFont(font);
+  int line = 0;
+  for (int16_t y = 36; y < 800; y += 34, line++) {
+    const char* text = LINES[line % LINE_COUNT];
+    renderer.setCursor(static_cast<int16_t>(8 + line % 5), y);
+    if (!runs) {
+      renderer.print(text);
+      continue;
+    }
+    uint16_t glyphs[128];
+    uint8_t advances[128];
+    size_t count = TextRenderer::shapeText(font, text, strlen(text), glyphs, advances);
+    renderer.drawGlyphRun(font, glyphs, advances, count);
+  }
+}
+
+// Renders `type` with both fonts and compares the framebuffers
+bool rendersIdentical(TextRenderer& renderer, EInkDisplay& display, const SimpleGFXfont* expectedFont,
+                      const SimpleGFXfont* packFont, TextRenderer::BitmapType type, bool runs) {
+  static std::vector<uint8_t> expected[2];
+  static std::vector<uint8_t> actual[2];
+  for (int pass = 0; pass < 2; pass++) {
+    std::vector<uint8_t>* out = pass == 0 ? expected : actual;
+    out[0].assign(EInkDisplay::BUFFER_SIZE, 0xFF);
+    out[1].assign(EInkDisplay::BUFFER_SIZE, 0xFF);
+    if (type == TextRenderer::BITMAP_GRAY)
+      renderer.setGrayscaleStrips(out[0].data(), out[1].data(), 0, EInkDisplay::DISPLAY_WIDTH);
+    else
+      renderer.setFrameBuffer(out[0].data());
+    renderer.setBitmapType(type);
+    renderPage(renderer, pass == 0 ? expectedFont : packFont, runs);
+  }
+  renderer.setFrameBuffer(display.getFrameBuffer());
+  return expected[0] == actual[0] && expected[1] == actual[1];
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Font Pack Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  renderer.setFrameBuffer(display.getFrameBuffer());
+
+  const SimpleGFXfont* regular = getFontVariant(&bookerlyFamily, FontStyle::REGULAR);
+  const SimpleGFXfont* italic = getFontVariant(&bookerlyFamily, FontStyle::ITALIC);
+
+  // Metrics
+  {
+    writeFile(PACK_PATH, buildPack(italic, "Bookerly26"));
+    FontPack pack(PACK_PATH);
+    runner.expectTrue(pack.isValid(), "pack of the italic font loads");
+    const SimpleGFXfont* font = pack.getFont();
+    runner.expectTrue(font && font->pack == &pack, "pack font reads bitmaps through the pack");
+    if (font) {
+      runner.expectTrue(font->glyphCount == italic->glyphCount && font->yAdvance == italic->yAdvance &&
+                            font->size == italic->size && font->style == italic->style,
+                        "glyph count, line height, size and style match");
+      runner.expectTrue(strcmp(font->name, "Bookerly26") == 0, "name is read from the header");
+      bool metrics = true;
+      const std::vector<uint16_t> order = codepointOrder(italic);
+      for (uint16_t i = 0; i < font->glyphCount; i++) {
+        const SimpleGFXglyph& a = italic->glyph[order[i]];
+        const SimpleGFXglyph& b = font->glyph[i];
+        if (a.codepoint != b.codepoint || a.width != b.width || a.height != b.height || a.xAdvance != b.xAdvance ||
+            a.xOffset != b.xOffset || a.yOffset != b.yOffset)
+          metrics = false;
+      }
+      runner.expectTrue(metrics, "glyph metrics match");
+      bool widths = true;
+      for (int i = 0; i < LINE_COUNT; i++) {
+        int16_t x1, y1;
+        uint16_t w1, h1, w2, h2;
+        renderer.setFont(italic);
+        renderer.getTextBounds(LINES[i], 0, 0, &x1, &y1, &w1, &h1);
+        renderer.setFont(font);
+        renderer.getTextBounds(LINES[i], 0, 0, &x1, &y1, &w2, &h2);
+        if (w1 != w2 || h1 != h2)
+          widths = false;
+      }
+      runner.expectTrue(widths, "text bounds match");
+    }
+  }
+
+  // Rendering, with the default cache and with two slots
+  const TextRenderer::BitmapType types[] = {TextRenderer::BITMAP_BW, TextRenderer::BITMAP_GRAY_LSB,
+                                            TextRenderer::BITMAP_GRAY_MSB, TextRenderer::BITMAP_GRAY};
+  const char* typeNames[] = {"BW", "gray LSB", "gray MSB", "gray both planes"};
+  const size_t cacheSizes[] = {FontPack::DEFAULT_CACHE_BYTES, 1};
+  writeFile(PACK_PATH, buildPack(regular, "Bookerly26"));
+  for (size_t cacheBytes : cacheSizes) {
+    FontPack pack(PACK_PATH, cacheBytes);
+    if (!pack.isValid()) {
+      runner.expectTrue(false, "pack of the regular font loads");
+      continue;
+    }
+    std::string cache = cacheBytes == 1 ? " (2 slots)" : "";
+    for (int t = 0; t < 4; t++) {
+      for (int runs = 0; runs < 2; runs++) {
+        runner.expectTrue(rendersIdentical(renderer, display, regular, pack.getFont(), types[t], runs != 0),
+                          std::string(typeNames[t]) + (runs ? " glyph runs" : " print()") + cache +
+                              ": pack renders bit-identical");
+      }
+    }
+    if (cacheBytes == 1) {
+      runner.expectTrue(pack.getCacheSlotCount() == FontPack::MIN_CACHE_SLOTS, "tiny cache gets the minimum slots");
+      runner.expectTrue(pack.getCacheMisses() > 8, "small cache evicts and reloads blocks");
+    } else {
+      runner.expectTrue(pack.getCacheSlotCount() > 4, "default cache holds several block planes");
+      runner.expectTrue(pack.getHitRate() > 0.99f, "default cache hit rate over 99%");
+      printf("  Default cache: %zu slots, %u hits, %u misses, %zu bytes of RAM\n", pack.getCacheSlotCount(),
+             pack.getCacheHits(), pack.getCacheMisses(), pack.getMemoryBytes());
+    }
+    pack.resetCacheStats();
+    runner.expectTrue(pack.getCacheHits() == 0 && pack.getCacheMisses() == 0 && pack.getHitRate() == 0.0f,
+                      "cache stats reset");
+  }
+
+  // Column-major and BW-only packs
+  {
+    ColumnMajorFont columns(regular);
+    writeFile(PACK_PATH, buildPack(&columns.font, "Bookerly26"));
+    FontPack pack(PACK_PATH);
+    bool identical = pack.isValid() && (pack.getFont()->flags & FONT_FLAG_COLUMN_MAJOR);
+    for (int t = 0; identical && t < 4; t++)
+      identical = rendersIdentical(renderer, display, &columns.font, pack.getFont(), types[t], true);
+    runner.expectTrue(identical, "column-major pack renders bit-identical");
+
+    SimpleGFXfont bwOnly = *regular;
+    bwOnly.bitmap_gray_lsb = nullptr;
+    bwOnly.bitmap_gray_msb = nullptr;
+    writeFile(PACK_PATH, buildPack(&bwOnly, "Bookerly26"));
+    FontPack bwPack(PACK_PATH);
+    runner.expectTrue(bwPack.isValid() && rendersIdentical(renderer, display, &bwOnly, bwPack.getFont(),
+                                                           TextRenderer::BITMAP_BW, false),
+                      "BW-only pack renders bit-identical");
+    runner.expectTrue(bwPack.getPlane(0, FontPack::PLANE_GRAY_LSB) == nullptr, "BW-only pack has no gray planes");
+  }
+
+  // Broken packs
+  {
+    FontPack missing("test/output/no_such_font_pack.mfp");
+    runner.expectTrue(!missing.isValid() && missing.getFont() == nullptr, "missing pack is rejected");
+
+    std::vector<uint8_t> bytes = buildPack(regular, "Bookerly26");
+    std::vector<uint8_t> broken = bytes;
+    broken[0] = 'X';
+    writeFile(BROKEN_PATH, broken);
+    runner.expectTrue(!FontPack(BROKEN_PATH).isValid(), "bad magic is rejected");
+
+    broken = bytes;
+    broken[4] = FontPack::VERSION + 1;
+    writeFile(BROKEN_PATH, broken);
+    runner.expectTrue(!FontPack(BROKEN_PATH).isValid(), "unknown version is rejected");
+
+    broken.assign(bytes.begin(), bytes.end() - 100);
+    writeFile(BROKEN_PATH, broken);
+    runner.expectTrue(!FontPack(BROKEN_PATH).isValid(), "truncated bitmap data is rejected");
+
+    broken.assign(bytes.begin(), bytes.begin() + FontPack::HEADER_SIZE + 20);
+    writeFile(BROKEN_PATH, broken);
+    runner.expectTrue(!FontPack(BROKEN_PATH).isValid(), "truncated tables are rejected");
+
+    // First glyph record moved to another block
+    broken = bytes;
+    const uint16_t blockCount = static_cast<uint16_t>(bytes[12] | (bytes[13] << 8));
+    size_t firstGlyph = FontPack::HEADER_SIZE + blockCount * FontPack::BLOCK_RECORD_SIZE;
+    broken[firstGlyph + 1] ^= 0x01;
+    writeFile(BROKEN_PATH, broken);
+    runner.expectTrue(!FontPack(BROKEN_PATH).isValid(), "glyph outside its block is rejected");
+    std::remove(BROKEN_PATH);
+  }
+
+  std::remove(PACK_PATH);
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+/**
+ * GlyphBlitTest.cpp - Glyph blitting into the rotated framebuffer
+ *
+ * Renders pages of text through TextRenderer::print and through a reference
+ * that draws every glyph pixel with drawPixel (the previous drawChar loop):
+ * - Framebuffers are bit-identical for the BW and both grayscale bitmaps,
+ *   on top of arbitrary existing content
+ * - Glyphs clipped at every page edge match as well
+ * - The saved PBM images are identical (test/output/glyph_blit_*.pbm)
+ * - The blitter updates under half as many framebuffer bytes per page (host
+ *   timings are printed, not checked)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "core/EInkDisplay.h"
+#include "font_test_fixtures.h"
+#include "platform_stubs.h"
+#include "rendering/SimpleFont.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+using FontTestFixtures::fillPattern;
+using FontTestFixtures::LINE_COUNT;
+using FontTestFixtures::LINES;
+using FontTestFixtures::pagePlacements;
+using FontTestFixtures::Placement;
+
+// Decode UTF-8 (valid input only)
+std::vector<uint32_t> decode(const char* s) {
+  std::vector<uint32_t> cps;
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+  while (*p) {
+    if (*p < 0x80) {
+      cps.push_back(*p++);
+    } else if ((*p & 0xE0) == 0xC0) {
+      cps.push_back(((p[0] & 0x1F) << 6) | (p[1] & 0x3F));
+      p += 2;
+    } else {
+      cps.push_back(((p[0] & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F));
+      p += 3;
+    }
+  }
+  return cps;
+}
+
+// The previous drawChar: one drawPixel per glyph pixel
+void referencePrint(TextRenderer& renderer, const SimpleGFXfont* f, TextRenderer::BitmapType type, int16_t x,
+                    int16_t y, const char* text) {
+  const uint8_t* bitmap = type == TextRenderer::BITMAP_BW         ? f->bitmap
+                          : type == TextRenderer::BITMAP_GRAY_LSB ? f->bitmap_gray_lsb
+                                                                  : f->bitmap_gray_msb;
+  for (uint32_t cp : decode(text)) {
+    int index = findGlyphIndexBinary(f, cp);
+    if (index < 0) {
+      x += MISSING_GLYPH_ADVANCE;
+      continue;
+    }
+    const SimpleGFXglyph* glyph = &f->glyph[index];
+    if (bitmap) {
+      uint8_t rowStride = (glyph->width + 7) / 8;
+      for (uint8_t yy = 0; yy < glyph->height; yy++) {
+        for (uint8_t xx = 0; xx < glyph->width; xx++) {
+          uint16_t byteIndex = glyph->bitmapOffset + yy * rowStride + xx / 8;
+          uint8_t bitMask = 1 << (7 - (xx % 8));
+          int16_t px = x + glyph->xOffset + xx;
+          int16_t py = y + glyph->yOffset + yy;
+          if (type != TextRenderer::BITMAP_BW) {
+            if ((f->bitmap_gray_lsb[byteIndex] & bitMask) == 0 || (f->bitmap_gray_msb[byteIndex] & bitMask) == 0)
+              renderer.drawPixel(px, py, (bitmap[byteIndex] & bitMask) == 0);
+          } else if ((bitmap[byteIndex] & bitMask) == 0) {
+            renderer.drawPixel(px, py, true);
+          }
+        }
+      }
+    }
+    x += glyph->xAdvance;
+  }
+}
+
+void renderPage(TextRenderer& renderer, const SimpleGFXfont* font, TextRenderer::BitmapType type, bool reference,
+                const std::vector<Placement>& placements) {
+  renderer.setFont(font);
+  renderer.setBitmapType(type);
+  for (size_t i = 0; i < placements.size(); ++i) {
+    const char* line = LINES[i % LINE_COUNT];
+    if (reference) {
+      referencePrint(renderer, font, type, placements[i].x, placements[i].y, line);
+    } else {
+      renderer.setCursor(placements[i].x, placements[i].y);
+      renderer.print(line);
+    }
+  }
+}
+
+std::string readFile(const char* path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Glyph Blit Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  uint8_t* frame = display.getFrameBuffer();
+  renderer.setFrameBuffer(frame);
+
+  std::vector<uint8_t> expected(EInkDisplay::BUFFER_SIZE);
+  std::vector<Placement> placements = pagePlacements();
+
+  struct FontCase {
+    const char* name;
+    const SimpleGFXfont* font;
+  };
+  const FontCase fonts[] = {{"Bookerly regular", getFontVariant(&bookerlyFamily, FontStyle::REGULAR)},
+                            {"Bookerly bold", getFontVariant(&bookerlyFamily, FontStyle::BOLD)},
+                            {"Bookerly italic", getFontVariant(&bookerlyFamily, FontStyle::ITALIC)},
+                            {"NotoSans bold italic", &NotoSans26BoldItalic},
+                            {"Font14", &Font14},
+                            {"Font27", &Font27}};
+  const TextRenderer::BitmapType types[] = {TextRenderer::BITMAP_BW, TextRenderer::BITMAP_GRAY_LSB,
+                                            TextRenderer::BITMAP_GRAY_MSB};
+  const char* typeNames[] = {"BW", "gray LSB", "gray MSB"};
+
+  // Bit-identical on white and on existing content
+  for (const FontCase& fc : fonts) {
+    for (int t = 0; t < 3; ++t) {
+      bool identical = true;
+      for (int background = 0; background < 2; ++background) {
+        if (background == 0)
+          memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+        else
+          fillPattern(frame, 99);
+        renderPage(renderer, fc.font, types[t], true, placements);
+        memcpy(expected.data(), frame, EInkDisplay::BUFFER_SIZE);
+
+        if (background == 0)
+          memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+        else
+          fillPattern(frame, 99);
+        renderPage(renderer, fc.font, types[t], false, placements);
+        if (memcmp(expected.data(), frame, EInkDisplay::BUFFER_SIZE) != 0)
+          identical = false;
+      }
+      runner.expectTrue(identical, std::string(fc.name) + " " + typeNames[t] + ": framebuffer is bit-identical");
+    }
+  }
+
+  // Golden images
+  {
+    const SimpleGFXfont* font = getFontVariant(&bookerlyFamily, FontStyle::REGULAR);
+    memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+    renderPage(renderer, font, TextRenderer::BITMAP_BW, true, placements);
+    display.saveFrameBufferAsPBM("test/output/glyph_blit_reference.pbm");
+    memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+    renderPage(renderer, font, TextRenderer::BITMAP_BW, false, placements);
+    display.saveFrameBufferAsPBM("test/output/glyph_blit.pbm");
+    std::string reference = readFile("test/output/glyph_blit_reference.pbm");
+    runner.expectTrue(!reference.empty() && reference == readFile("test/output/glyph_blit.pbm"),
+                      "PBM output matches the reference image");
+  }
+
+  // One page of body text: framebuffer updates per page for both paths.
+  // Host timings are printed for reference only.
+  {
+    const SimpleGFXfont* font = getFontVariant(&bookerlyFamily, FontStyle::REGULAR);
+    std::vector<Placement> page;
+    for (int16_t y = 40; y < 780; y += 34)
+      page.push_back({10, y});
+    uint32_t start = renderer.getFrameBufferWrites();
+    renderPage(renderer, font, TextRenderer::BITMAP_BW, true, page);
+    uint32_t referenceWrites = renderer.getFrameBufferWrites() - start;
+    start = renderer.getFrameBufferWrites();
+    renderPage(renderer, font, TextRenderer::BITMAP_BW, false, page);
+    uint32_t blitWrites = renderer.getFrameBufferWrites() - start;
+    printf("  Framebuffer updates per page: drawPixel %u, blitter %u\n", static_cast<unsigned>(referenceWrites),
+           static_cast<unsigned>(blitWrites));
+    runner.expectTrue(blitWrites * 2 < referenceWrites, "blitter updates under half as many framebuffer bytes",
+                      std::to_string(blitWrites) + " vs " + std::to_string(referenceWrites));
+
+    const int rounds = 20;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      renderPage(renderer, font, TextRenderer::BITMAP_BW, true, page);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      renderPage(renderer, font, TextRenderer::BITMAP_BW, false, page);
+    auto t2 = std::chrono::steady_clock::now();
+    double before = std::chrono::duration<double>(t1 - t0).count() * 1e3 / rounds;
+    double after = std::chrono::duration<double>(t2 - t1).count() * 1e3 / rounds;
+    printf("  Benchmark (host): drawPixel %.3f ms/page, blitter %.3f ms/page (%.1fx)\n", before, after,
+           before / after);
+  }
+
+  renderer.setBitmapType(TextRenderer::BITMAP_BW);
+  return runner.allPassed() ? 0 : 1;
+}
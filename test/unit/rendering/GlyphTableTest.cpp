@@ -0,0 +1,205 @@
+/**
+ * GlyphTableTest.cpp - Direct-indexed glyph lookup
+ *
+ * - The glyph table finds the same glyph as a binary search over the glyph
+ *   array for every codepoint of the BMP and plane 1, in every built-in font
+ * - getTextWidth/getTextBounds widths are unchanged for ASCII, Latin
+ *   extended, higher planes, missing glyphs and malformed UTF-8
+ * - Tables stay correct when more fonts are used than tables are kept
+ * - Width by the table fast path compares no glyph entries, where the binary
+ *   search (before) compares several per character (host timings are
+ *   printed, not checked)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/SimpleFont.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+struct NamedFont {
+  const char* name;
+  const SimpleGFXfont* font;
+};
+
+const NamedFont FONTS[] = {
+    {"NotoSans26", &NotoSans26},       {"NotoSans26Bold", &NotoSans26Bold},
+    {"NotoSans26Italic", &NotoSans26Italic}, {"NotoSans26BoldItalic", &NotoSans26BoldItalic},
+    {"Font14", &Font14},               {"Font27", &Font27},
+};
+
+// Width as computed before glyph tables: decode and binary-search every codepoint
+uint16_t referenceWidth(const SimpleGFXfont* font, const std::string& text) {
+  uint16_t width = 0;
+  size_t i = 0;
+  while (i < text.size()) {
+    unsigned char c = text[i];
+    uint32_t cp = 0xFFFD;
+    size_t len = 1;
+    size_t need = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+    if (need == 1) {
+      cp = c;
+    } else if (need > 1 && i + need <= text.size()) {
+      bool valid = true;
+      for (size_t k = 1; k < need; ++k)
+        valid = valid && (static_cast<unsigned char>(text[i + k]) & 0xC0) == 0x80;
+      if (valid) {
+        cp = c & (need == 2 ? 0x1F : need == 3 ? 0x0F : 0x07);
+        for (size_t k = 1; k < need; ++k)
+          cp = (cp << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+        len = need;
+      }
+    }
+    i += len;
+    int index = findGlyphIndexBinary(font, cp);
+    width += index >= 0 ? font->glyph[index].xAdvance : MISSING_GLYPH_ADVANCE;
+  }
+  return width;
+}
+
+bool tableMatchesSearch(const SimpleGFXfont* font, std::string& detail) {
+  const GlyphTable* table = getGlyphTable(font);
+  if (!table) {
+    detail = "no table";
+    return false;
+  }
+  for (uint32_t cp = 0; cp < 0x20000; ++cp) {
+    int expected = findGlyphIndexBinary(font, cp);
+    int actual = table->indexOf(cp);
+    bool same = (expected < 0) ? actual < 0
+                               : actual >= 0 && font->glyph[actual].codepoint == cp &&
+                                     font->glyph[actual].xAdvance == font->glyph[expected].xAdvance;
+    uint8_t advance = expected < 0 ? MISSING_GLYPH_ADVANCE : font->glyph[expected].xAdvance;
+    if (!same || table->advanceOf(cp) != advance) {
+      detail = "U+" + std::to_string(cp);
+      return false;
+    }
+  }
+  detail = std::to_string(font->glyphCount) + " glyphs, " + std::to_string(table->getPageCount()) + " pages, " +
+           std::to_string(table->getMemoryBytes()) + " bytes";
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Glyph Table Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+
+  // Every font's table agrees with binary search
+  const FontFamily* families[] = {&bookerlyFamily, &notoSansFamily};
+  const FontStyle styles[] = {FontStyle::REGULAR, FontStyle::BOLD, FontStyle::ITALIC, FontStyle::BOLD_ITALIC};
+  for (const FontFamily* family : families) {
+    for (FontStyle style : styles) {
+      const SimpleGFXfont* font = getFontVariant(family, style);
+      std::string name = std::string(family->familyName) + " style " + std::to_string(static_cast<int>(style));
+      std::string detail;
+      runner.expectTrue(tableMatchesSearch(font, detail), "table matches binary search: " + name, detail);
+      printf("  %s: %s\n", name.c_str(), detail.c_str());
+    }
+  }
+  for (const NamedFont& named : FONTS) {
+    std::string detail;
+    runner.expectTrue(tableMatchesSearch(named.font, detail), std::string("table matches binary search: ") + named.name,
+                      detail);
+  }
+
+  // Widths are unchanged
+  const std::string samples[] = {
+      "Hello, world!",
+      "Die Donaudampfschifffahrtsgesellschaft fuhr über den Fluss, während die Sonne unterging.",
+      "\xE2\x80\x9E" "Anführungszeichen" "\xE2\x80\x9C \xE2\x80\x94 Gedankenstrich \xE2\x80\xA6",
+      "\xC5\x81\xC3\xB3" "d\xC5\xBA \xC8\x98tefan \xC6\x92 \xC9\x8F",
+      "Emoji \xF0\x9F\x98\x80 and CJK \xE4\xB8\xAD\xE6\x96\x87",
+      "Broken \xC3 sequence \xE2\x82 and stray \x80\xBF bytes \xF0\x9F",
+  };
+  bool widthsMatch = true;
+  bool boundsMatch = true;
+  for (const NamedFont& named : FONTS) {
+    renderer.setFont(named.font);
+    for (const std::string& sample : samples) {
+      uint16_t width = renderer.getTextWidth(sample.c_str(), sample.size());
+      if (width != referenceWidth(named.font, sample)) {
+        widthsMatch = false;
+        printf("  width mismatch in %s: %u vs %u for \"%s\"\n", named.name, width, referenceWidth(named.font, sample),
+               sample.c_str());
+      }
+      uint16_t boundsWidth = 0;
+      renderer.getTextBounds(sample.c_str(), 0, 0, nullptr, nullptr, &boundsWidth, nullptr);
+      if (boundsWidth != width)
+        boundsMatch = false;
+    }
+  }
+  runner.expectTrue(widthsMatch, "getTextWidth is unchanged");
+  runner.expectTrue(boundsMatch, "getTextBounds width matches getTextWidth");
+
+  // More fonts than kept tables (FONTS and both families): lookups stay correct
+  bool cycled = true;
+  for (int round = 0; round < 3; ++round) {
+    for (const NamedFont& named : FONTS) {
+      for (uint32_t cp = 0; cp < 0x2100; cp += 7) {
+        int expected = findGlyphIndexBinary(named.font, cp);
+        int actual = findGlyphIndex(named.font, cp);
+        if ((expected < 0) != (actual < 0) || (actual >= 0 && named.font->glyph[actual].codepoint != cp))
+          cycled = false;
+      }
+    }
+    for (const FontFamily* family : families)
+      for (FontStyle style : styles)
+        if (findGlyphIndex(getFontVariant(family, style), 'A') != findGlyphIndexBinary(getFontVariant(family, style), 'A'))
+          cycled = false;
+  }
+  runner.expectTrue(cycled, "tables are rebuilt correctly after eviction");
+
+  // Lookup work for a page of text: glyph entries compared per byte by the
+  // binary search (before) and the table fast path (after). Host timings are
+  // printed for reference only.
+  {
+    renderer.setFontFamily(&bookerlyFamily);
+    renderer.setFontStyle(FontStyle::REGULAR);
+    const SimpleGFXfont* font = getFontVariant(&bookerlyFamily, FontStyle::REGULAR);
+    std::string text;
+    for (int i = 0; i < 20; ++i)
+      text += samples[1] + " " + samples[2] + " ";
+    uint32_t sink = renderer.getTextWidth(text.c_str(), text.size());  // table built
+    uint32_t start = getGlyphSearchProbes();
+    sink += referenceWidth(font, text);
+    uint32_t searchProbes = getGlyphSearchProbes() - start;
+    start = getGlyphSearchProbes();
+    sink += renderer.getTextWidth(text.c_str(), text.size());
+    uint32_t tableProbes = getGlyphSearchProbes() - start;
+    printf("  Glyph entries compared for %zu bytes: binary search %u, glyph table %u\n", text.size(),
+           static_cast<unsigned>(searchProbes), static_cast<unsigned>(tableProbes));
+    runner.expectTrue(searchProbes > text.size() && tableProbes == 0, "glyph table width needs no glyph search",
+                      std::to_string(tableProbes) + " probes");
+
+    const int rounds = 200;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      sink += referenceWidth(font, text);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+      sink += renderer.getTextWidth(text.c_str(), text.size());
+    auto t2 = std::chrono::steady_clock::now();
+    double bytes = static_cast<double>(rounds) * text.size();
+    double before = std::chrono::duration<double>(t1 - t0).count() * 1e9 / bytes;
+    double after = std::chrono::duration<double>(t2 - t1).count() * 1e9 / bytes;
+    printf("  Benchmark (host): binary search %.2f ns/byte, glyph table %.2f ns/byte (checksum %u)\n", before, after,
+           sink);
+  }
+
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+/**
+ * GrayscaleStripTest.cpp - Single-pass rendering of both grayscale planes
+ *
+ * Compares LayoutStrategy::renderPageGrayscale (one walk over the page,
+ * BITMAP_GRAY into strip buffers) with the previous path (clear the
+ * framebuffer and render the page once per plane):
+ * - The strips, put back together, are bit-identical to both planes, for
+ *   half-page strips, strips small enough that many lines cross a strip
+ *   boundary and strips that do not divide the page evenly
+ * - Strips are emitted top to bottom and cover the page exactly once
+ * - Benchmark: time per page for both paths
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "platform_stubs.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/GreedyLayoutStrategy.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+
+namespace {
+
+const int16_t PAGE_ROWS = EInkDisplay::DISPLAY_WIDTH;
+
+// Reassembles emitted strips into full-page planes
+struct StripCollector {
+  std::vector<uint8_t> lsb;
+  std::vector<uint8_t> msb;
+  int16_t nextTop = 0;
+  bool inOrder = true;
+  int strips = 0;
+
+  StripCollector() : lsb(EInkDisplay::BUFFER_SIZE, 0xAA), msb(EInkDisplay::BUFFER_SIZE, 0xAA) {}
+
+  static void emit(int16_t top, int16_t height, const uint8_t* lsbStrip, const uint8_t* msbStrip, void* context) {
+    StripCollector* self = static_cast<StripCollector*>(context);
+    if (top != self->nextTop)
+      self->inOrder = false;
+    self->nextTop = top + height;
+    self->strips++;
+    const int stripStride = height / 8;
+    for (int row = 0; row < EInkDisplay::DISPLAY_HEIGHT; ++row) {
+      memcpy(&self->lsb[row * EInkDisplay::DISPLAY_WIDTH_BYTES + top / 8], lsbStrip + row * stripStride, stripStride);
+      memcpy(&self->msb[row * EInkDisplay::DISPLAY_WIDTH_BYTES + top / 8], msbStrip + row * stripStride, stripStride);
+    }
+  }
+};
+
+std::string buildText() {
+  const char* words[] = {"Die",    "Donaudampfschifffahrtsgesellschaft", "fuhr",   "über",  "den",
+                         "Fluss,", "während",                            "die",    "Sonne", "langsam",
+                         "hinter", "den",                                "Hügeln", "verschwand.",
+                         "Ägypten", "Quellwasser", "jagt", "gyp"};
+  const int wordCount = sizeof(words) / sizeof(words[0]);
+  std::string text;
+  for (int p = 0; p < 12; ++p) {
+    int n = 20 + (p * 13) % 50;
+    for (int w = 0; w < n; ++w) {
+      text += words[(p + w * 7) % wordCount];
+      if (w + 1 < n)
+        text += ' ';
+    }
+    text += "\n";
+  }
+  return text;
+}
+
+LayoutStrategy::LayoutConfig makeConfig() {
+  LayoutStrategy::LayoutConfig config;
+  config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+  config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+  config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+  config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+  config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+  config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+  config.pageWidth = TestConfig::DISPLAY_WIDTH;
+  config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+  config.alignment = LayoutStrategy::ALIGN_LEFT;
+  config.language = Language::GERMAN;
+  return config;
+}
+
+// The previous path: one cleared full-page plane per renderPage call
+void renderPlanes(LayoutStrategy& layout, const LayoutStrategy::PageLayout& page, TextRenderer& renderer,
+                  const LayoutStrategy::LayoutConfig& config, uint8_t* frame, std::vector<uint8_t>& lsb,
+                  std::vector<uint8_t>& msb) {
+  renderer.setFrameBuffer(frame);
+  memset(frame, 0x00, EInkDisplay::BUFFER_SIZE);
+  renderer.setBitmapType(TextRenderer::BITMAP_GRAY_LSB);
+  layout.renderPage(page, renderer, config);
+  lsb.assign(frame, frame + EInkDisplay::BUFFER_SIZE);
+  memset(frame, 0x00, EInkDisplay::BUFFER_SIZE);
+  renderer.setBitmapType(TextRenderer::BITMAP_GRAY_MSB);
+  layout.renderPage(page, renderer, config);
+  msb.assign(frame, frame + EInkDisplay::BUFFER_SIZE);
+}
+
+void checkStrategy(TestUtils::TestRunner& runner, const char* name, LayoutStrategy& layout, TextRenderer& renderer,
+                   uint8_t* frame) {
+  std::string text = buildText();
+  StringWordProvider provider(String(text.c_str()));
+  LayoutStrategy::LayoutConfig config = makeConfig();
+  layout.setLanguage(config.language);
+  renderer.setFontFamily(&bookerlyFamily);
+  LayoutStrategy::PageLayout page;
+  layout.layoutText(provider, renderer, config, page);
+
+  std::vector<uint8_t> lsb;
+  std::vector<uint8_t> msb;
+  renderPlanes(layout, page, renderer, config, frame, lsb, msb);
+  bool hasGray = false;
+  for (size_t i = 0; i < lsb.size() && !hasGray; ++i)
+    hasGray = lsb[i] != 0 || msb[i] != 0;
+  runner.expectTrue(page.getLineCount() > 10 && hasGray, std::string(name) + ": page has grayscale pixels");
+
+  const int16_t stripHeights[] = {PAGE_ROWS / 2, 200, 104, 16, PAGE_ROWS};
+  for (int16_t stripHeight : stripHeights) {
+    // The strips share one buffer, like the back buffer on the device
+    const size_t stripBytes = static_cast<size_t>(stripHeight / 8) * EInkDisplay::DISPLAY_HEIGHT;
+    std::vector<uint8_t> strips(2 * stripBytes, 0x55);
+    StripCollector collector;
+    layout.renderPageGrayscale(page, renderer, config, strips.data(), strips.data() + stripBytes, stripHeight,
+                               &StripCollector::emit, &collector);
+    bool covered = collector.inOrder && collector.nextTop == PAGE_ROWS &&
+                   collector.strips == (PAGE_ROWS + stripHeight - 1) / stripHeight;
+    runner.expectTrue(covered, std::string(name) + ", " + std::to_string(stripHeight) + "-row strips cover the page",
+                      std::to_string(collector.strips) + " strips");
+    runner.expectTrue(collector.lsb == lsb && collector.msb == msb,
+                      std::string(name) + ", " + std::to_string(stripHeight) + "-row strips: planes are bit-identical");
+  }
+  renderer.setFrameBuffer(frame);
+  renderer.setBitmapType(TextRenderer::BITMAP_BW);
+}
+
+void benchmark(TextRenderer& renderer, uint8_t* frame) {
+  std::string text = buildText();
+  StringWordProvider provider(String(text.c_str()));
+  LayoutStrategy::LayoutConfig config = makeConfig();
+  KnuthPlassLayoutStrategy layout;
+  layout.setLanguage(config.language);
+  renderer.setFontFamily(&bookerlyFamily);
+  LayoutStrategy::PageLayout page;
+  layout.layoutText(provider, renderer, config, page);
+
+  std::vector<uint8_t> lsb;
+  std::vector<uint8_t> msb;
+  StripCollector collector;
+  const int rounds = 20;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    renderPlanes(layout, page, renderer, config, frame, lsb, msb);
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r)
+    layout.renderPageGrayscale(page, renderer, config, frame, frame + EInkDisplay::BUFFER_SIZE / 2, PAGE_ROWS / 2,
+                               &StripCollector::emit, &collector);
+  auto t2 = std::chrono::steady_clock::now();
+  // Both include copying the planes out (the display transfer on the device)
+  printf("  Benchmark (host): two passes %.3f ms/page, one pass in strips %.3f ms/page\n",
+         std::chrono::duration<double>(t1 - t0).count() * 1e3 / rounds,
+         std::chrono::duration<double>(t2 - t1).count() * 1e3 / rounds);
+  renderer.setFrameBuffer(frame);
+  renderer.setBitmapType(TextRenderer::BITMAP_BW);
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Grayscale Strip Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  uint8_t* frame = display.getFrameBuffer();
+
+  GreedyLayoutStrategy greedy;
+  checkStrategy(runner, "Greedy", greedy, renderer, frame);
+  KnuthPlassLayoutStrategy knuthPlass;
+  checkStrategy(runner, "Knuth-Plass", knuthPlass, renderer, frame);
+
+  // BW rendering is unaffected by the strip state left behind
+  {
+    renderer.setFrameBuffer(frame);
+    renderer.setBitmapType(TextRenderer::BITMAP_BW);
+    memset(frame, 0xFF, EInkDisplay::BUFFER_SIZE);
+    renderer.setFontStyle(FontStyle::REGULAR);
+    renderer.setCursor(20, 790);
+    renderer.print("Seite 12");
+    bool drawn = false;
+    for (uint32_t i = 0; i < EInkDisplay::BUFFER_SIZE && !drawn; ++i)
+      drawn = frame[i] != 0xFF;
+    runner.expectTrue(drawn, "setFrameBuffer draws on the whole page again");
+  }
+
+  benchmark(renderer, frame);
+
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,232 @@
+/**
+ * PageImageTest.cpp - Compressed page bands for the prefetched page
+ *
+ * Renders reader pages band by band into a PageImage, as the text viewer does
+ * for the next page while idle, and checks that:
+ * - Every band of all three planes decodes to what was rendered
+ * - The planes of a page fit the memory the viewer gives them: half of a
+ *   framebuffer for the bw plane, a framebuffer less the read cache for the
+ *   grayscale planes
+ * - Corner cases of the coding (runs longer than 128, no runs, single
+ *   bytes) round-trip
+ * - A band that does not fit leaves the plane incomplete and the image usable
+ * - Prints the coded size of each page and the time to render a page next to the
+ *   time to decode it (what a prefetch hit saves on a page turn)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+#include "content/providers/StringWordProvider.h"
+#include "core/EInkDisplay.h"
+#include "rendering/PageImage.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "test_config.h"
+#include "test_utils.h"
+#include "text/hyphenation/HyphenationStrategy.h"
+#include "text/layout/KnuthPlassLayoutStrategy.h"
+
+namespace {
+
+typedef std::vector<uint8_t> Bytes;
+
+std::string buildText() {
+  const char* words[] = {"Die",    "Donaudampfschifffahrtsgesellschaft", "fuhr",   "über",  "den",
+                         "Fluss,", "während",                            "die",    "Sonne", "langsam",
+                         "hinter", "den",                                "Hügeln", "verschwand."};
+  const int wordCount = sizeof(words) / sizeof(words[0]);
+  std::string text;
+  for (int p = 0; p < 30; ++p) {
+    int n = 20 + (p * 13) % 50;
+    for (int w = 0; w < n; ++w) {
+      text += words[(p + w * 7) % wordCount];
+      if (w + 1 < n)
+        text += ' ';
+    }
+    text += "\n";
+  }
+  return text;
+}
+
+// Bands as rendered, per plane, and the images they go into
+struct Capture {
+  PageImage* bw;
+  PageImage* gray;
+  std::vector<Bytes> planes[PageImage::PLANE_COUNT];
+};
+
+void captureBand(int16_t /*top*/, int16_t height, uint8_t* band, void* context) {
+  Capture* capture = static_cast<Capture*>(context);
+  const size_t bytes = static_cast<size_t>(height / 8) * EInkDisplay::DISPLAY_HEIGHT;
+  capture->planes[PageImage::BW].push_back(Bytes(band, band + bytes));
+  capture->bw->addBand(PageImage::BW, band, bytes);
+}
+
+void captureStrip(int16_t /*top*/, int16_t height, const uint8_t* lsb, const uint8_t* msb, void* context) {
+  Capture* capture = static_cast<Capture*>(context);
+  const size_t bytes = static_cast<size_t>(height / 8) * EInkDisplay::DISPLAY_HEIGHT;
+  capture->planes[PageImage::GRAY_LSB].push_back(Bytes(lsb, lsb + bytes));
+  capture->planes[PageImage::GRAY_MSB].push_back(Bytes(msb, msb + bytes));
+  capture->gray->addBand(PageImage::GRAY_LSB, lsb, bytes);
+  capture->gray->addBand(PageImage::GRAY_MSB, msb, bytes);
+}
+
+void discardBand(int16_t, int16_t, uint8_t*, void*) {}
+void discardStrip(int16_t, int16_t, const uint8_t*, const uint8_t*, void*) {}
+
+bool decodesTo(const PageImage& image, PageImage::Plane plane, const std::vector<Bytes>& bands) {
+  if (!image.hasPlane(plane) || bands.size() != PageImage::BAND_COUNT)
+    return false;
+  Bytes out(EInkDisplay::BAND_BYTES);
+  for (uint8_t i = 0; i < PageImage::BAND_COUNT; i++) {
+    if (!image.getBand(plane, i, out.data(), out.size()) || out != bands[i])
+      return false;
+  }
+  return true;
+}
+
+// Round-trip one band pattern through all BAND_COUNT bands of a plane
+bool roundTrips(const Bytes& band) {
+  Bytes storage(2 * PageImage::BAND_COUNT * band.size());
+  PageImage image;
+  image.attach(storage.data(), storage.size());
+  for (uint8_t i = 0; i < PageImage::BAND_COUNT; i++) {
+    if (!image.addBand(PageImage::BW, band.data(), band.size()))
+      return false;
+  }
+  Bytes out(band.size());
+  for (uint8_t i = 0; i < PageImage::BAND_COUNT; i++) {
+    if (!image.getBand(PageImage::BW, i, out.data(), out.size()) || out != band)
+      return false;
+  }
+  return true;
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Page Image Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  TextRenderer renderer(display);
+  KnuthPlassLayoutStrategy layout;
+  LayoutStrategy::LayoutConfig config;
+  config.marginLeft = TestConfig::DEFAULT_MARGIN_LEFT;
+  config.marginRight = TestConfig::DEFAULT_MARGIN_RIGHT;
+  config.marginTop = TestConfig::DEFAULT_MARGIN_TOP;
+  config.marginBottom = TestConfig::DEFAULT_MARGIN_BOTTOM;
+  config.lineHeight = TestConfig::DEFAULT_LINE_HEIGHT;
+  config.minSpaceWidth = TestConfig::DEFAULT_MIN_SPACE_WIDTH;
+  config.pageWidth = TestConfig::DISPLAY_WIDTH;
+  config.pageHeight = TestConfig::DISPLAY_HEIGHT;
+  config.alignment = LayoutStrategy::ALIGN_LEFT;
+  config.language = Language::GERMAN;
+  layout.setLanguage(config.language);
+
+  std::string text = buildText();
+  StringWordProvider provider(String(text.c_str()));
+  renderer.setFontFamily(&bookerlyFamily);
+  renderer.setTextColor(TextRenderer::COLOR_BLACK);
+
+  // Memory the viewer gives the page images
+  Bytes bwStorage(EInkDisplay::BUFFER_SIZE / 2);
+  Bytes grayStorage(EInkDisplay::BUFFER_SIZE - 4096);
+  Bytes band(2 * EInkDisplay::BAND_BYTES);
+  uint8_t* lsb = band.data();
+  uint8_t* msb = band.data() + EInkDisplay::BAND_BYTES;
+
+  printf("  %-6s %8s %8s\n", "page", "bw", "gray");
+  for (int page = 0; page < 3; page++) {
+    LayoutStrategy::PageLayout pageLayout;
+    auto layoutStart = std::chrono::steady_clock::now();
+    layout.layoutText(provider, renderer, config, pageLayout);
+    double layoutMs = msSince(layoutStart);
+    provider.setPosition(pageLayout.endPosition);
+
+    PageImage bw;
+    PageImage gray;
+    bw.attach(bwStorage.data(), bwStorage.size());
+    gray.attach(grayStorage.data(), grayStorage.size());
+    Capture capture;
+    capture.bw = &bw;
+    capture.gray = &gray;
+    renderer.setFontStyle(FontStyle::REGULAR);
+    layout.renderPageBands(pageLayout, renderer, config, band.data(), EInkDisplay::BAND_ROWS, captureBand, &capture);
+    layout.renderPageGrayscale(pageLayout, renderer, config, lsb, msb, EInkDisplay::BAND_ROWS, captureStrip,
+                               &capture);
+
+    const std::string name = "page " + std::to_string(page + 1);
+    runner.expectTrue(decodesTo(bw, PageImage::BW, capture.planes[PageImage::BW]), name + ": bw bands decode",
+                      std::to_string(bw.getUsedBytes()) + " bytes");
+    runner.expectTrue(decodesTo(gray, PageImage::GRAY_LSB, capture.planes[PageImage::GRAY_LSB]) &&
+                          decodesTo(gray, PageImage::GRAY_MSB, capture.planes[PageImage::GRAY_MSB]),
+                      name + ": grayscale bands decode", std::to_string(gray.getUsedBytes()) + " bytes");
+    printf("  %-6d %8u %8u bytes\n", page + 1, static_cast<unsigned>(bw.getUsedBytes()),
+           static_cast<unsigned>(gray.getUsedBytes()));
+
+    // What a hit saves: render (and lay out) against decode
+    auto renderStart = std::chrono::steady_clock::now();
+    renderer.setFontStyle(FontStyle::REGULAR);
+    layout.renderPageBands(pageLayout, renderer, config, band.data(), EInkDisplay::BAND_ROWS, discardBand, nullptr);
+    layout.renderPageGrayscale(pageLayout, renderer, config, lsb, msb, EInkDisplay::BAND_ROWS, discardStrip,
+                               nullptr);
+    double renderMs = msSince(renderStart);
+    auto decodeStart = std::chrono::steady_clock::now();
+    for (uint8_t i = 0; i < PageImage::BAND_COUNT; i++) {
+      bw.getBand(PageImage::BW, i, band.data(), EInkDisplay::BAND_BYTES);
+      gray.getBand(PageImage::GRAY_LSB, i, lsb, EInkDisplay::BAND_BYTES);
+      gray.getBand(PageImage::GRAY_MSB, i, msb, EInkDisplay::BAND_BYTES);
+    }
+    double decodeMs = msSince(decodeStart);
+    printf("         host: layout %.2f ms + render %.2f ms, decode %.2f ms\n", layoutMs, renderMs, decodeMs);
+  }
+
+  // Coding corner cases
+  Bytes white(EInkDisplay::BAND_BYTES, 0xFF);
+  runner.expectTrue(roundTrips(white), "one long run round-trips");
+  Bytes noRuns(EInkDisplay::BAND_BYTES);
+  for (size_t i = 0; i < noRuns.size(); i++)
+    noRuns[i] = static_cast<uint8_t>(i * 7 + 1);
+  runner.expectTrue(roundTrips(noRuns), "band without runs round-trips");
+  Bytes mixed(EInkDisplay::BAND_BYTES, 0x00);
+  for (size_t i = 0; i < mixed.size(); i += 131)
+    mixed[i] = 0x55;
+  for (size_t i = 1; i < mixed.size(); i += 257)
+    mixed[i] = mixed[i - 1];
+  runner.expectTrue(roundTrips(mixed), "runs broken by single and paired bytes round-trip");
+  runner.expectTrue(roundTrips(Bytes(1, 0x42)), "single byte band round-trips");
+
+  // Out of room: the plane stays incomplete, other planes still work
+  Bytes small(EInkDisplay::BAND_BYTES + 100);
+  PageImage image;
+  image.attach(small.data(), small.size());
+  runner.expectTrue(image.addBand(PageImage::BW, white.data(), white.size()), "small band fits");
+  runner.expectTrue(!image.addBand(PageImage::BW, noRuns.data(), noRuns.size()), "band too big is refused");
+  runner.expectTrue(!image.addBand(PageImage::BW, white.data(), white.size()), "later bands of the plane are ignored");
+  runner.expectTrue(!image.hasPlane(PageImage::BW) && !image.isEmpty(PageImage::BW), "plane stays incomplete");
+  Bytes out(white.size());
+  runner.expectTrue(!image.getBand(PageImage::BW, 0, out.data(), out.size()), "incomplete plane does not decode");
+  for (uint8_t i = 0; i < PageImage::BAND_COUNT; i++)
+    image.addBand(PageImage::GRAY_LSB, white.data(), white.size());
+  runner.expectTrue(image.hasPlane(PageImage::GRAY_LSB) && image.getBand(PageImage::GRAY_LSB, 9, out.data(),
+                                                                         out.size()) &&
+                        out == white,
+                    "other planes still fill up");
+  image.clear();
+  runner.expectTrue(image.isEmpty(PageImage::BW) && image.getUsedBytes() == 0, "clear empties the image");
+  image.attach(nullptr, 0);
+  runner.expectTrue(!image.isAttached() && !image.addBand(PageImage::BW, white.data(), white.size()),
+                    "detached image takes nothing");
+
+  return runner.allPassed() ? 0 : 1;
+}
@@ -0,0 +1,457 @@
+/**
+ * SyntheticFontTest.cpp - Bold and italic variants made at run time
+ *
+ * Builds the expected synthetic glyphs pixel by pixel (dilated and sheared
+ * gray levels) as an ordinary in-memory font and renders the same text with
+ * it and with SyntheticFont:
+ * - Metrics: bold widens glyphs and advances, italic keeps the advance and
+ *   moves the glyph box by the shear of its bottom row
+ * - Framebuffers are bit-identical for BW, both grayscale planes and
+ *   BITMAP_GRAY, for print() and for pre-shaped glyph runs
+ * - Column-major, font pack and BW-only bases give the same glyphs
+ * - getFontVariant() synthesizes only missing variants the family asks for
+ * - A one-glyph cache still renders correctly; a page is all hits once cached
+ * - Benchmark: time per page with a cold and a warm glyph cache
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "core/EInkDisplay.h"
+#include "font_test_fixtures.h"
+#include "platform_stubs.h"
+#include "rendering/FontPack.h"
+#include "rendering/SimpleFont.h"
+#include "rendering/SyntheticFont.h"
+#include "rendering/TextRenderer.h"
+#include "resources/fonts/FontDefinitions.h"
+#include "resources/fonts/Font14.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+using FontTestFixtures::ColumnMajorFont;
+using FontTestFixtures::LINE_COUNT;
+using FontTestFixtures::LINES;
+
+const char* PACK_PATH = "test/output/synthetic_font_test.mfp";
+
+// (BW, LSB, MSB) of the gray levels white .. black, and back
+const uint8_t LEVEL_BITS[5][3] = {{1, 0, 0}, {1, 1, 0}, {0, 0, 1}, {0, 1, 1}, {0, 0, 0}};
+
+int levelOf(bool bw, bool lsb, bool msb, bool grayscale) {
+  if (!grayscale)
+    return bw ? 0 : 4;
+  for (int level = 0; level < 5; level++) {
+    if (LEVEL_BITS[level][0] == bw && LEVEL_BITS[level][1] == lsb && LEVEL_BITS[level][2] == msb)
+      return level;
+  }
+  return bw ? 0 : 4;
+}
+
+bool bitAt(const uint8_t* plane, const SimpleGFXglyph& glyph, int x, int y) {
+  const uint8_t* bits = plane + glyph.bitmapOffset;
+  return (bits[y * ((glyph.width + 7) / 8) + x / 8] >> (7 - x % 8)) & 1;
+}
+
+// Expected synthetic font, built pixel by pixel from a row-major font
+struct ReferenceFont {
+  std::vector<uint8_t> planes[3];
+  std::vector<SimpleGFXglyph> glyphs;
+  SimpleGFXfont font;
+
+  ReferenceFont(const SimpleGFXfont* source, FontStyle transform) {
+    const bool grayscale = source->bitmap_gray_lsb && source->bitmap_gray_msb;
+    const bool bold = transform == FontStyle::BOLD || transform == FontStyle::BOLD_ITALIC;
+    const bool slant = transform == FontStyle::ITALIC || transform == FontStyle::BOLD_ITALIC;
+    const int boldPixels = bold ? 1 + source->yAdvance / 40 : 0;
+    auto shear = [slant](const SimpleGFXglyph& g, int row) {
+      return slant ? static_cast<int>(std::floor(-(g.yOffset + row) / double(SyntheticFont::SLANT_ROWS))) : 0;
+    };
+
+    glyphs.assign(source->glyph, source->glyph + source->glyphCount);
+    for (uint16_t i = 0; i < source->glyphCount; i++) {
+      const SimpleGFXglyph& in = source->glyph[i];
+      SimpleGFXglyph& out = glyphs[i];
+      out.bitmapOffset = static_cast<uint16_t>(planes[0].size());
+      out.xAdvance = in.xAdvance + boldPixels;
+      if (in.width == 0 || in.height == 0)
+        continue;
+      const int bottom = shear(in, in.height - 1);
+      out.width = in.width + boldPixels + shear(in, 0) - bottom;
+      out.xOffset = in.xOffset + bottom;
+      const int stride = (out.width + 7) / 8;
+      for (int p = 0; p < 3; p++)
+        planes[p].resize(planes[p].size() + stride * out.height, p == 0 ? 0xFF : 0x00);
+      for (int y = 0; y < out.height; y++) {
+        for (int x = 0; x < out.width; x++) {
+          int level = 0;
+          for (int k = 0; k <= boldPixels; k++) {
+            int sx = x + bottom - shear(in, y) - k;
+            if (sx < 0 || sx >= in.width)
+              continue;
+            int l = levelOf(bitAt(source->bitmap, in, sx, y), grayscale && bitAt(source->bitmap_gray_lsb, in, sx, y),
+                            grayscale && bitAt(source->bitmap_gray_msb, in, sx, y), grayscale);
+            level = std::max(level, l);
+          }
+          const size_t index = out.bitmapOffset + y * stride + x / 8;
+          const uint8_t mask = 0x80 >> (x % 8);
+          if (!LEVEL_BITS[level][0])
+            planes[0][index] &= ~mask;
+          if (LEVEL_BITS[level][1])
+            planes[1][index] |= mask;
+          if (LEVEL_BITS[level][2])
+            planes[2][index] |= mask;
+        }
+      }
+    }
+    font = *source;
+    font.bitmap = planes[0].data();
+    font.bitmap_gray_lsb = grayscale ? planes[1].data() : nullptr;
+    font.bitmap_gray_msb = grayscale ? planes[2].data() : nullptr;
+    font.glyph = glyphs.data();
+  }
+};
+
+void putU16(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(value & 0xFF);
+  out.push_back(value >> 8);
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t value) {
+  putU16(out, value & 0xFFFF);
+  putU16(out, value >> 16);
+}
+
+// Font pack bytes for a row-major font (same layout as writer.write_font_pack)
+std::vector<uint8_t> buildPack(const SimpleGFXfont* font) {
+  const bool grayscale = font->bitmap_gray_lsb && font->bitmap_gray_msb;
+  const uint8_t* planes[3] = {font->bitmap, font->bitmap_gray_lsb, font->bitmap_gray_msb};
+  const int planeCount = grayscale ? 3 : 1;
+  std::vector<uint16_t> order(font->glyphCount);
+  for (uint16_t i = 0; i < font->glyphCount; i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [font](uint16_t a, uint16_t b) { return font->glyph[a].codepoint < font->glyph[b].codepoint; });
+
+  struct Block {
+    uint16_t number;
+    uint16_t firstGlyph;
+    uint16_t glyphCount;
+    std::vector<uint8_t> planes[3];
+  };
+  std::vector<Block> blocks;
+  std::vector<uint8_t> glyphRecords;
+  for (uint16_t i = 0; i < font->glyphCount; i++) {
+    const SimpleGFXglyph& glyph = font->glyph[order[i]];
+    uint16_t number = static_cast<uint16_t>(glyph.codepoint >> FontPack::BLOCK_SHIFT);
+    if (blocks.empty() || blocks.back().number != number)
+      blocks.push_back({number, i, 0, {}});
+    Block& block = blocks.back();
+    uint16_t offset = static_cast<uint16_t>(block.planes[0].size());
+    for (int p = 0; p < planeCount; p++) {
+      const uint8_t* bits = planes[p] + glyph.bitmapOffset;
+      block.planes[p].insert(block.planes[p].end(), bits, bits + ((glyph.width + 7) / 8) * glyph.height);
+    }
+    block.glyphCount++;
+    putU32(glyphRecords, glyph.codepoint);
+    putU16(glyphRecords, offset);
+    glyphRecords.push_back(glyph.width);
+    glyphRecords.push_back(glyph.height);
+    glyphRecords.push_back(glyph.xAdvance);
+    glyphRecords.push_back(static_cast<uint8_t>(glyph.xOffset));
+    glyphRecords.push_back(static_cast<uint8_t>(glyph.yOffset));
+  }
+
+  std::vector<uint8_t> out = {'M', 'R', 'F', 'P', FontPack::VERSION,
+                              static_cast<uint8_t>(grayscale ? FontPack::FLAG_GRAYSCALE : 0),
+                              font->yAdvance, font->size, static_cast<uint8_t>(font->style), 0};
+  putU16(out, font->glyphCount);
+  putU16(out, static_cast<uint16_t>(blocks.size()));
+  putU16(out, 0);
+  char padded[FontPack::NAME_SIZE] = {};
+  strncpy(padded, "Bookerly26", sizeof(padded));
+  out.insert(out.end(), padded, padded + sizeof(padded));
+
+  uint32_t dataOffset = static_cast<uint32_t>(out.size() + blocks.size() * FontPack::BLOCK_RECORD_SIZE +
+                                              glyphRecords.size());
+  std::vector<uint8_t> data;
+  for (const Block& block : blocks) {
+    putU16(out, block.number);
+    putU16(out, block.firstGlyph);
+    putU16(out, block.glyphCount);
+    putU16(out, static_cast<uint16_t>(block.planes[0].size()));
+    putU32(out, dataOffset + static_cast<uint32_t>(data.size()));
+    for (int p = 0; p < planeCount; p++)
+      data.insert(data.end(), block.planes[p].begin(), block.planes[p].end());
+  }
+  out.insert(out.end(), glyphRecords.begin(), glyphRecords.end());
+  out.insert(out.end(), data.begin(), data.end());
+  return out;
+}
+
+// A page of text with print(), or as pre-shaped glyph runs
+void renderPage(TextRenderer& renderer, const SimpleGFXfont* font, bool runs) {
+  renderer.setFont(font);
+  int line = 0;
+  for (int16_t y = 36; y < 800; y += 34, line++) {
+    const char* text = LINES[line % LINE_COUNT];
+    renderer.setCursor(static_cast<int16_t>(line % 5) - 2, y);
+    if (!runs) {
+      renderer.print(text);
+      continue;
+    }
+    uint16_t glyphs[128];
+    uint8_t advances[128];
+    size_t count = TextRenderer::shapeText(font, text, strlen(text), glyphs, advances);
+    renderer.drawGlyphRun(font, glyphs, advances, count);
+  }
+}
+
+// Renders `type` with both fonts and compares the framebuffers
+bool rendersIdentical(TextRenderer& renderer, EInkDisplay& display, const SimpleGFXfont* expectedFont,
+                      const SimpleGFXfont* actualFont, TextRenderer::BitmapType type, bool runs) {
+  static std::vector<uint8_t> expected[2];
+  static std::vector<uint8_t> actual[2];
+  for (int pass = 0; pass < 2; pass++) {
+    std::vector<uint8_t>* out = pass == 0 ? expected : actual;
+    out[0].assign(EInkDisplay::BUFFER_SIZE, 0xFF);
+    out[1].assign(EInkDisplay::BUFFER_SIZE, 0xFF);
+    if (type == TextRenderer::BITMAP_GRAY)
+      renderer.setGrayscaleStrips(out[0].data(), out[1].data(), 0, EInkDisplay::DISPLAY_WIDTH);
+    else
+      renderer.setFrameBuffer(out[0].data());
+    renderer.setBitmapType(type);
+    renderPage(renderer, pass == 0 ? expectedFont : actualFont, runs);
+  }
+  renderer.setFrameBuffer(display.getFrameBuffer());
+  renderer.setBitmapType(TextRenderer::BITMAP_BW);
+  return expected[0] == actual[0] && expected[1] == actual[1];
+}
+
+bool rendersIdenticalAllTypes(TextRenderer& renderer, EInkDisplay& display, const SimpleGFXfont* expectedFont,
+                              const SimpleGFXfont* actualFont, bool grayscale) {
+  const TextRenderer::BitmapType types[] = {TextRenderer::BITMAP_BW, TextRenderer::BITMAP_GRAY_LSB,
+                                            TextRenderer::BITMAP_GRAY_MSB, TextRenderer::BITMAP_GRAY};
+  for (int t = 0; t < (grayscale ? 4 : 1); t++) {
+    for (int runs = 0; runs < 2; runs++) {
+      if (!rendersIdentical(renderer, display, expectedFont, actualFont, types[t], runs != 0))
+        return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("Synthetic Font Test");
+
+  EInkDisplay display(TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN,
+                      TestConfig::DUMMY_PIN, TestConfig::DUMMY_PIN);
+  display.begin();
+  TextRenderer renderer(display);
+  renderer.setFrameBuffer(display.getFrameBuffer());
+
+  const SimpleGFXfont* regular = bookerlyFamily.regular;
+  const SimpleGFXfont* bold = bookerlyFamily.bold;
+  const FontStyle transforms[] = {FontStyle::BOLD, FontStyle::ITALIC, FontStyle::BOLD_ITALIC};
+  const char* transformNames[] = {"bold", "italic", "bold-italic"};
+
+  // Metrics
+  {
+    SyntheticFont synthBold(regular, FontStyle::BOLD);
+    SyntheticFont synthItalic(regular, FontStyle::ITALIC);
+    runner.expectTrue(synthBold.isValid() && synthItalic.isValid(), "synthetic variants of Bookerly build");
+    const SimpleGFXfont* boldFont = synthBold.getFont();
+    const SimpleGFXfont* italicFont = synthItalic.getFont();
+    runner.expectTrue(boldFont->style == FontStyle::BOLD && italicFont->style == FontStyle::ITALIC,
+                      "synthetic fonts carry their style");
+    runner.expectTrue(boldFont->synthetic == &synthBold && !boldFont->pack && !boldFont->bitmap,
+                      "synthetic font reads bitmaps through its cache");
+    runner.expectTrue(synthBold.getBoldPixels() == 1 && synthItalic.getBoldPixels() == 0,
+                      "text sizes embolden by one pixel");
+
+    bool advances = true;
+    bool italicBoxes = true;
+    for (uint16_t i = 0; i < regular->glyphCount; i++) {
+      const SimpleGFXglyph& base = regular->glyph[i];
+      const SimpleGFXglyph& b = boldFont->glyph[i];
+      const SimpleGFXglyph& it = italicFont->glyph[i];
+      advances &= b.xAdvance == base.xAdvance + 1 && it.xAdvance == base.xAdvance && b.yOffset == base.yOffset &&
+                  b.height == base.height && b.codepoint == base.codepoint;
+      if (base.width && base.height) {
+        advances &= b.width == base.width + 1 && b.xOffset == base.xOffset;
+        // Glyphs reaching below the baseline start further left, others do not
+        bool descends = base.yOffset + base.height > 1;
+        italicBoxes &= it.width >= base.width && (descends ? it.xOffset < base.xOffset : it.xOffset >= base.xOffset);
+      }
+    }
+    runner.expectTrue(advances, "bold widens glyphs and advances by one pixel");
+    runner.expectTrue(italicBoxes, "italic keeps the advance and shears the glyph box");
+
+    const char* text = "The quick brown fox";
+    renderer.setFont(regular);
+    uint16_t regularWidth = renderer.getTextWidth(text, strlen(text));
+    renderer.setFont(boldFont);
+    uint16_t boldWidth = renderer.getTextWidth(text, strlen(text));
+    runner.expectTrue(boldWidth == regularWidth + strlen(text), "bold text is one pixel per character wider");
+    runner.expectTrue(synthBold.getMemoryBytes() < 32 * 1024, "synthetic font RAM under 32 KB",
+                      std::to_string(synthBold.getMemoryBytes()));
+  }
+
+  // Pixels: every transform, every bitmap type, print() and glyph runs
+  for (int t = 0; t < 3; t++) {
+    ReferenceFont reference(regular, transforms[t]);
+    SyntheticFont synthetic(regular, transforms[t]);
+    runner.expectTrue(rendersIdenticalAllTypes(renderer, display, &reference.font, synthetic.getFont(), true),
+                      std::string("synthetic ") + transformNames[t] + " renders like the reference");
+  }
+
+  // A black pixel stays black when emboldened, and grows to the right
+  {
+    SyntheticFont synthBold(regular, FontStyle::BOLD);
+    int index = findGlyphIndex(regular, 'l');
+    const uint8_t* planes[3];
+    bool loaded = index >= 0 && synthBold.getGlyph(static_cast<uint16_t>(index), planes);
+    runner.expectTrue(loaded && planes[1] && planes[2], "glyph planes load with grayscale");
+    bool covers = loaded;
+    const SimpleGFXglyph& base = regular->glyph[index];
+    const SimpleGFXglyph& glyph = synthBold.getFont()->glyph[index];
+    for (int y = 0; loaded && y < base.height; y++) {
+      for (int x = 0; x < base.width; x++) {
+        if (!bitAt(regular->bitmap, base, x, y)) {
+          covers &= !bitAt(planes[0], glyph, x, y) && !bitAt(planes[0], glyph, x + 1, y);
+        }
+      }
+    }
+    runner.expectTrue(covers, "emboldening keeps black pixels and extends them");
+  }
+
+  // Other base layouts give the same glyphs
+  {
+    ReferenceFont reference(regular, FontStyle::BOLD_ITALIC);
+    ColumnMajorFont columns(regular);
+    SyntheticFont fromColumns(&columns.font, FontStyle::BOLD_ITALIC);
+    runner.expectTrue(rendersIdenticalAllTypes(renderer, display, &reference.font, fromColumns.getFont(), true),
+                      "synthetic font of a column-major base renders the same");
+
+    std::vector<uint8_t> bytes = buildPack(regular);
+    std::ofstream(PACK_PATH, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    FontPack pack(PACK_PATH);
+    SyntheticFont fromPack(pack.getFont(), FontStyle::BOLD_ITALIC);
+    runner.expectTrue(pack.isValid() && fromPack.isValid(), "synthetic font of a font pack builds");
+    bool identical = true;
+    for (int line = 0; line < LINE_COUNT; line++) {
+      int16_t x1, y1;
+      uint16_t wPack, wRef, h;
+      renderer.setFont(fromPack.getFont());
+      renderer.getTextBounds(LINES[line], 0, 0, &x1, &y1, &wPack, &h);
+      renderer.setFont(&reference.font);
+      renderer.getTextBounds(LINES[line], 0, 0, &x1, &y1, &wRef, &h);
+      identical &= wPack == wRef;
+    }
+    runner.expectTrue(identical, "pack-based synthetic widths match");
+    runner.expectTrue(rendersIdenticalAllTypes(renderer, display, &reference.font, fromPack.getFont(), true),
+                      "synthetic font of a font pack renders the same");
+
+    ReferenceFont bwReference(&Font14, FontStyle::BOLD_ITALIC);
+    SyntheticFont bwSynthetic(&Font14, FontStyle::BOLD_ITALIC);
+    runner.expectTrue(rendersIdenticalAllTypes(renderer, display, &bwReference.font, bwSynthetic.getFont(), false),
+                      "synthetic font of a BW-only base renders the same");
+    const uint8_t* planes[3];
+    runner.expectTrue(bwSynthetic.getGlyph(1, planes) && planes[0] && !planes[1] && !planes[2],
+                      "BW-only base has no gray planes");
+  }
+
+  // Family selection
+  {
+    FontFamily plain = {"Plain", regular, nullptr, nullptr, nullptr, 0};
+    runner.expectTrue(getFontVariant(&plain, FontStyle::BOLD) == regular &&
+                          getFontVariant(&plain, FontStyle::BOLD_ITALIC) == regular,
+                      "without synthesize missing variants fall back to regular");
+
+    FontFamily synth = {"Synth", regular, nullptr, nullptr, nullptr, SYNTHESIZE_BOLD | SYNTHESIZE_ITALIC};
+    const SimpleGFXfont* b = getFontVariant(&synth, FontStyle::BOLD);
+    const SimpleGFXfont* i = getFontVariant(&synth, FontStyle::ITALIC);
+    const SimpleGFXfont* bi = getFontVariant(&synth, FontStyle::BOLD_ITALIC);
+    runner.expectTrue(getFontVariant(&synth, FontStyle::REGULAR) == regular, "regular is never synthesized");
+    runner.expectTrue(b && b->synthetic && b->style == FontStyle::BOLD && i && i->synthetic &&
+                          i->style == FontStyle::ITALIC && bi && bi->synthetic && bi->style == FontStyle::BOLD_ITALIC,
+                      "missing variants are synthesized");
+    runner.expectTrue(getFontVariant(&synth, FontStyle::BOLD) == b, "synthetic variants are built once");
+
+    FontFamily boldOnly = {"BoldOnly", regular, nullptr, nullptr, nullptr, SYNTHESIZE_BOLD};
+    runner.expectTrue(getFontVariant(&boldOnly, FontStyle::ITALIC) == regular &&
+                          getFontVariant(&boldOnly, FontStyle::BOLD_ITALIC) == getFontVariant(&boldOnly, FontStyle::BOLD),
+                      "only the requested transforms are synthesized");
+
+    FontFamily withBold = {"WithBold", regular, bold, nullptr, nullptr, SYNTHESIZE_BOLD | SYNTHESIZE_ITALIC};
+    const SimpleGFXfont* slanted = getFontVariant(&withBold, FontStyle::BOLD_ITALIC);
+    runner.expectTrue(getFontVariant(&withBold, FontStyle::BOLD) == bold, "real variants win over synthetic ones");
+    runner.expectTrue(slanted && slanted->synthetic && slanted->synthetic->getBase() == bold &&
+                          slanted->synthetic->getTransform() == FontStyle::ITALIC,
+                      "bold-italic slants the real bold");
+
+    renderer.setFontFamily(&synth);
+    renderer.setFontStyle(FontStyle::ITALIC);
+    runner.expectTrue(renderer.getFont() == i, "renderer selects the synthetic variant");
+    renderer.setFont(regular);
+
+    releaseSyntheticFonts(regular);
+    releaseSyntheticFonts(bold);
+    const SimpleGFXfont* rebuilt = getFontVariant(&synth, FontStyle::BOLD);
+    runner.expectTrue(rebuilt && rebuilt->synthetic, "variants are rebuilt after release");
+    releaseSyntheticFonts(regular);
+  }
+
+  // Cache
+  {
+    ReferenceFont reference(regular, FontStyle::ITALIC);
+    SyntheticFont tiny(regular, FontStyle::ITALIC, 1);
+    runner.expectTrue(tiny.getCacheBytes() > 1 && tiny.getCacheBytes() < 1024, "tiny cache fits the largest glyph");
+    runner.expectTrue(rendersIdenticalAllTypes(renderer, display, &reference.font, tiny.getFont(), true),
+                      "one-glyph cache renders correctly");
+    runner.expectTrue(tiny.getCacheMisses() > 100, "tiny cache remakes glyphs");
+
+    // A page in one style: every glyph is made on its first draw only
+    SyntheticFont synthetic(regular, FontStyle::BOLD_ITALIC);
+    renderPage(renderer, synthetic.getFont(), false);
+    uint32_t misses = synthetic.getCacheMisses();
+    synthetic.resetCacheStats();
+    renderPage(renderer, synthetic.getFont(), true);
+    runner.expectTrue(misses > 40 && misses < 80 && synthetic.getCacheMisses() == 0 && synthetic.getCacheHits() > 500,
+                      "default cache holds a page's glyphs", std::to_string(misses) + " misses on the first page");
+
+    // Benchmark: one page of body text, glyphs made from scratch vs cached
+    const int rounds = 20;
+    double cold = 0;
+    for (int r = 0; r < rounds; r++) {
+      SyntheticFont fresh(regular, FontStyle::BOLD_ITALIC);
+      auto t0 = std::chrono::steady_clock::now();
+      renderPage(renderer, fresh.getFont(), false);
+      cold += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+    SyntheticFont warm(regular, FontStyle::BOLD_ITALIC);
+    renderPage(renderer, warm.getFont(), false);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+      renderPage(renderer, warm.getFont(), false);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+      renderPage(renderer, bold, false);
+    auto t2 = std::chrono::steady_clock::now();
+    printf("  Benchmark (host): real bold %.3f ms/page, synthetic cold %.3f ms/page, warm %.3f ms/page\n",
+           std::chrono::duration<double>(t2 - t1).count() * 1e3 / rounds, cold * 1e3 / rounds,
+           std::chrono::duration<double>(t1 - t0).count() * 1e3 / rounds);
+  }
+
+  runner.printSummary();
+  return runner.allPassed() ? 0 : 1;
+}
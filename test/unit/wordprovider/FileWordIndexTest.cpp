@@ -0,0 +1,225 @@
+/**
+ * FileWordIndexTest.cpp - FileWordProvider sidecar index tests
+ *
+ * Compares a FileWordProvider using the `.idx` sidecar against one that scans
+ * the file, on a generated file with style and alignment ESC tokens, long
+ * paragraphs (so checkpoints are used), CRLF line endings and a UTF-8 BOM.
+ *
+ * Test cases:
+ * 1. Index build: paragraph entries and checkpoints, sidecar written
+ * 2. setPosition at every offset: same style, alignment and next word
+ * 3. Full backward traversal: same words, styles and alignments
+ * 4. Sidecar reuse and rebuild when the text file changes (size, write time
+ *    or content at the start)
+ * 5. RAM budget: an index over budget is not used
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <sys/stat.h>
+#include <utime.h>
+
+#include "WString.h"
+#include "content/providers/FileWordProvider.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+const char* TEST_FILE = "test/output/word_index_test.txt";
+const char* TEST_INDEX = "test/output/word_index_test.txt.idx";
+// Small window so the index builder and the providers cross buffer edges often
+const size_t SMALL_BUFFER = 64;
+
+void writeTestFile(const char* path, int paragraphs) {
+  const char ESC = '\x1B';
+  const char* words[] = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta", "Straße", "café"};
+  const char alignStarts[] = {'L', 'C', 'R', 'J'};
+  const char alignEnds[] = {'l', 'c', 'r', 'j'};
+  const char styleStarts[] = {'B', 'I', 'X'};
+  const char styleEnds[] = {'b', 'i', 'x'};
+
+  std::ofstream out(path, std::ios::binary);
+  out << "\xEF\xBB\xBF";
+  for (int p = 0; p < paragraphs; ++p) {
+    int align = p % 5;  // 4 = no alignment token
+    if (align < 4)
+      out << ESC << alignStarts[align];
+    // Every third paragraph is long enough to get checkpoints
+    int wordCount = (p % 3 == 0) ? 260 + p : 8 + (p * 7) % 30;
+    int openStyle = -1;
+    for (int w = 0; w < wordCount; ++w) {
+      if (w % 17 == 3 && openStyle < 0) {
+        openStyle = (p + w) % 3;
+        out << ESC << styleStarts[openStyle];
+      }
+      out << words[(p * 3 + w) % 10];
+      if (w % 17 == 9 && openStyle >= 0) {
+        out << ESC << styleEnds[openStyle];
+        openStyle = -1;
+      }
+      if (w + 1 < wordCount)
+        out << ((w % 41 == 40) ? "\t" : " ");
+    }
+    // Leave some styles open across the paragraph end
+    if (openStyle >= 0 && p % 2 == 0)
+      out << ESC << styleEnds[openStyle];
+    if (align < 4)
+      out << ESC << alignEnds[align];
+    out << ((p % 4 == 1) ? "\r\n" : "\n");
+    if (p % 7 == 6)
+      out << "\n";  // empty paragraph
+  }
+  // Token directly before a newline and at the very end of the file
+  out << ESC << 'B' << "tail" << ESC << "\n" << "end" << ESC << 'b';
+}
+
+std::string readFile(const char* path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+// Turn the first `count` spaces after `from` into line breaks (same size)
+void splitAt(std::string& text, size_t from, int count) {
+  size_t split = from;
+  for (int i = 0; i < count; ++i) {
+    split = text.find(' ', split + 1);
+    text[split] = '\n';
+  }
+}
+
+time_t fileTime(const char* path) {
+  struct stat st;
+  return stat(path, &st) == 0 ? st.st_mtime : 0;
+}
+
+void setFileTime(const char* path, time_t modified) {
+  struct utimbuf times;
+  times.actime = modified;
+  times.modtime = modified;
+  utime(path, &times);
+}
+
+std::string describe(const StyledWord& w, TextAlign align) {
+  return std::string(w.text.c_str()) + "|" + std::to_string(static_cast<int>(w.style)) + "|" +
+         std::to_string(static_cast<int>(align));
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("File Word Index Test");
+
+  std::remove(TEST_INDEX);
+  writeTestFile(TEST_FILE, 60);
+
+  FileWordProvider plain(TEST_FILE, SMALL_BUFFER);
+  FileWordProvider indexed(TEST_FILE, SMALL_BUFFER);
+  runner.expectTrue(plain.isValid() && indexed.isValid(), "providers opened");
+
+  // 1. Build
+  runner.expectTrue(indexed.loadOrBuildIndex(), "index built");
+  const FileWordIndex* index = indexed.getIndex();
+  runner.expectTrue(index && index->getParagraphCount() > 60, "paragraph entries recorded",
+                    index ? std::to_string(index->getParagraphCount()) : "no index");
+  runner.expectTrue(index && index->getEntryCount() > index->getParagraphCount(), "checkpoints recorded");
+  std::ifstream sidecar(TEST_INDEX, std::ios::binary);
+  runner.expectTrue(sidecar.good(), "sidecar written next to the text file");
+  sidecar.close();
+
+  // 2. setPosition at every offset
+  std::ifstream in(TEST_FILE, std::ios::binary | std::ios::ate);
+  int fileSize = static_cast<int>(in.tellg());
+  in.close();
+  int mismatches = 0;
+  std::string firstMismatch;
+  for (int pos = 0; pos <= fileSize; ++pos) {
+    plain.setPosition(pos);
+    indexed.setPosition(pos);
+    TextAlign a1 = plain.getParagraphAlignment();
+    TextAlign a2 = indexed.getParagraphAlignment();
+    std::string w1 = describe(plain.getNextWord(), a1);
+    std::string w2 = describe(indexed.getNextWord(), a2);
+    if (w1 != w2 || plain.getCurrentIndex() != indexed.getCurrentIndex()) {
+      if (mismatches++ == 0)
+        firstMismatch = "pos " + std::to_string(pos) + ": '" + w1 + "' vs '" + w2 + "'";
+    }
+  }
+  runner.expectTrue(mismatches == 0, "setPosition matches at every offset", firstMismatch);
+
+  // 3. Backward traversal from the end
+  plain.setPosition(fileSize);
+  indexed.setPosition(fileSize);
+  mismatches = 0;
+  firstMismatch.clear();
+  int steps = 0;
+  // Stop when the position stops moving (index 3, after the BOM, still reports hasPrevWord)
+  int lastIndex = -1;
+  while (plain.hasPrevWord() && plain.getCurrentIndex() != lastIndex) {
+    lastIndex = plain.getCurrentIndex();
+    std::string w1 = describe(plain.getPrevWord(), plain.getParagraphAlignment());
+    std::string w2 = describe(indexed.getPrevWord(), indexed.getParagraphAlignment());
+    if (w1 != w2 || plain.getCurrentIndex() != indexed.getCurrentIndex()) {
+      if (mismatches++ == 0)
+        firstMismatch = "step " + std::to_string(steps) + ": '" + w1 + "' vs '" + w2 + "'";
+    }
+    ++steps;
+  }
+  runner.expectTrue(mismatches == 0 && steps > 1000, "backward traversal matches", firstMismatch);
+
+  // 4. Sidecar reuse and rebuild
+  {
+    FileWordProvider reopened(TEST_FILE, SMALL_BUFFER);
+    runner.expectTrue(reopened.loadOrBuildIndex(), "sidecar loaded");
+    runner.expectTrue(reopened.getIndex()->getEntryCount() == index->getEntryCount(), "loaded index matches built");
+  }
+  {
+    // Same size, edited in the middle, written a little later: only the write
+    // time tells this apart from the indexed file
+    std::string text = readFile(TEST_FILE);
+    const time_t written = fileTime(TEST_FILE);
+    splitAt(text, text.size() / 2, 4);
+    std::ofstream(TEST_FILE, std::ios::binary) << text;
+    setFileTime(TEST_FILE, written + 2);
+
+    FileWordProvider edited(TEST_FILE, SMALL_BUFFER);
+    runner.expectTrue(edited.loadOrBuildIndex(), "index rebuilt for file edited in the middle");
+    runner.expectTrue(edited.getIndex()->getParagraphCount() == index->getParagraphCount() + 4,
+                      "stale sidecar replaced (write time mismatch)",
+                      std::to_string(edited.getIndex()->getParagraphCount()));
+  }
+  {
+    // Same size and write time, edited at the start (a clock-less writer):
+    // caught by the fingerprint
+    std::string text = readFile(TEST_FILE);
+    const time_t written = fileTime(TEST_FILE);
+    splitAt(text, 0, 4);
+    std::ofstream(TEST_FILE, std::ios::binary) << text;
+    setFileTime(TEST_FILE, written);
+
+    FileWordProvider edited(TEST_FILE, SMALL_BUFFER);
+    runner.expectTrue(edited.loadOrBuildIndex(), "index rebuilt for file edited at the start");
+    runner.expectTrue(edited.getIndex()->getParagraphCount() == index->getParagraphCount() + 8,
+                      "stale sidecar replaced (fingerprint mismatch)",
+                      std::to_string(edited.getIndex()->getParagraphCount()));
+  }
+  writeTestFile(TEST_FILE, 45);
+  {
+    FileWordProvider changed(TEST_FILE, SMALL_BUFFER);
+    runner.expectTrue(changed.loadOrBuildIndex(), "index rebuilt for changed file");
+    runner.expectTrue(changed.getIndex()->getEntryCount() < index->getEntryCount(),
+                      "stale sidecar replaced (size mismatch)");
+  }
+
+  // 5. Budget
+  {
+    FileWordProvider tight(TEST_FILE, SMALL_BUFFER);
+    runner.expectTrue(!tight.loadOrBuildIndex(16) && !tight.hasIndex(), "index over RAM budget is not loaded");
+  }
+
+  return runner.allPassed() ? 0 : 1;
+}
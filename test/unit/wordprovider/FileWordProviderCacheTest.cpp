@@ -0,0 +1,114 @@
+/**
+ * FileWordProviderCacheTest.cpp - FileWordProvider block cache tests
+ *
+ * Test cases:
+ * 1. Words read through small and large caches are identical
+ * 2. Back-and-forth access around a block edge does not re-read blocks
+ * 3. Backward traversal re-reads each block at most once
+ */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+#include "content/providers/FileWordProvider.h"
+#include "test_config.h"
+#include "test_utils.h"
+
+namespace {
+
+const char* TEST_FILE = "test/output/word_cache_test.txt";
+
+void writeTestFile(const char* path) {
+  const char* words[] = {"Lorem", "ipsum", "dolor", "sit", "amet,", "consectetur", "adipiscing", "elit."};
+  std::ofstream out(path, std::ios::binary);
+  for (int p = 0; p < 80; ++p) {
+    if (p % 3 == 0)
+      out << "\x1B" << 'J';
+    int len = 20 + (p * 13) % 60;
+    for (int w = 0; w < len; ++w) {
+      if (w == 5)
+        out << "\x1B" << 'I';
+      out << words[(p + w) % 8];
+      if (w == 9)
+        out << "\x1B" << 'i';
+      if (w + 1 < len)
+        out << ' ';
+    }
+    if (p % 3 == 0)
+      out << "\x1B" << 'j';
+    out << "\n";
+  }
+}
+
+std::vector<std::string> readForward(FileWordProvider& provider) {
+  std::vector<std::string> words;
+  provider.reset();
+  while (provider.hasNextWord()) {
+    StyledWord w = provider.getNextWord();
+    words.push_back(std::string(w.text.c_str()) + "|" + std::to_string(static_cast<int>(w.style)));
+  }
+  return words;
+}
+
+}  // namespace
+
+int main() {
+  TestUtils::TestRunner runner("FileWordProvider Cache Test");
+  writeTestFile(TEST_FILE);
+
+  // 1. Same words regardless of cache geometry
+  {
+    FileWordProvider tiny(TEST_FILE, 64);
+    FileWordProvider large(TEST_FILE, 4096);
+    runner.expectTrue(tiny.isValid() && large.isValid(), "providers opened");
+    runner.expectTrue(tiny.getCacheBlockCount() == 2, "tiny buffer split into two blocks");
+    runner.expectTrue(large.getCacheBlockCount() == 4096 / FileWordProvider::BLOCK_SIZE,
+                      "large buffer split into sector blocks");
+    std::vector<std::string> a = readForward(tiny);
+    std::vector<std::string> b = readForward(large);
+    runner.expectTrue(!a.empty() && a == b, "forward words identical across cache sizes");
+  }
+
+  // 2. Alternating access across a block edge
+  {
+    FileWordProvider provider(TEST_FILE, 2048);
+    const int edge = static_cast<int>(FileWordProvider::BLOCK_SIZE) * 3;
+    provider.setPosition(edge - 8);
+    provider.resetCacheStats();
+    for (int i = 0; i < 50; ++i) {
+      provider.setPosition(edge - 8);
+      provider.getNextWord();
+      provider.getNextWord();
+      provider.setPosition(edge + 8);
+      provider.getPrevWord();
+      provider.getPrevWord();
+    }
+    runner.expectTrue(provider.getCacheMisses() <= 4, "straddling reads stay cached",
+                      std::to_string(provider.getCacheMisses()) + " misses");
+    runner.expectTrue(provider.getCacheHits() > 1000, "hits counted", std::to_string(provider.getCacheHits()));
+  }
+
+  // 3. Backward traversal reads each block about once
+  {
+    FileWordProvider provider(TEST_FILE, 2048);
+    std::ifstream in(TEST_FILE, std::ios::binary | std::ios::ate);
+    size_t fileSize = static_cast<size_t>(in.tellg());
+    provider.setPosition(static_cast<int>(fileSize));
+    provider.resetCacheStats();
+    int lastIndex = -1;
+    while (provider.hasPrevWord() && provider.getCurrentIndex() != lastIndex) {
+      lastIndex = provider.getCurrentIndex();
+      provider.getPrevWord();
+    }
+    size_t blocks = (fileSize + FileWordProvider::BLOCK_SIZE - 1) / FileWordProvider::BLOCK_SIZE;
+    // Paragraph scans reach back into earlier blocks, but never more than one
+    // re-read per block with a four-block cache
+    runner.expectTrue(provider.getCacheMisses() <= 2 * blocks, "backward traversal does not thrash",
+                      std::to_string(provider.getCacheMisses()) + " misses for " + std::to_string(blocks) + " blocks");
+  }
+
+  return runner.allPassed() ? 0 : 1;
+}